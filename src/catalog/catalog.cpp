@@ -9,7 +9,7 @@
 #include <sstream>
 #include <cstring> // memset
 #include <stdexcept>
-#include "../util/config.h"              // PAGE_SIZE 常量（按项目实际路径）
+#include "../util/config.h"
 #include "../storage/index/bplus_tree.h" // <-- 必须改成你实际的 B+ 树头文件路径
 
 namespace minidb
@@ -74,9 +74,9 @@ namespace minidb
         schema.owner = owner;
         schema.created_at = time(nullptr);
 
-        // 分配首个数据页
+        // 分配首个数据页：新建一个段，表的后续数据页从同一段的区中分配
         page_id_t pid;
-        Page *data_page = storage_engine_->CreatePage(&pid);
+        Page *data_page = storage_engine_->CreateExtentPage(&pid, INVALID_PAGE_ID);
         if (!data_page)
             throw std::runtime_error("CreateTable failed: cannot create first data page");
 
@@ -88,12 +88,9 @@ namespace minidb
         tables_[table_name] = schema;
 
         // ===== 统一使用 SaveToStorage() 更新 CatalogPage =====
+        // next_page_id 已由 DiskManager 分配时推进（含整区预留），这里不再回写
         SaveToStorage();
 
-        // 更新元数据中的next_page_id，确保新分配的页面ID被正确保存
-        // 直接更新StorageEngine的元数据，确保next_page_id正确递增
-        storage_engine_->SetNextPageId(pid + 1);
-
         std::cout << "[CreateTable] 表 " << table_name << " 创建成功" << std::endl;
         global_log_info(std::string("[CreateTable] 表 ") + table_name + " 创建成功，目录已保存，首个数据页 = " + std::to_string(pid));
     }
@@ -168,7 +165,7 @@ namespace minidb
 
         catalog_page->InitializePage(PageType::CATALOG_PAGE);
         char *page_data = catalog_page->GetData() + PAGE_HEADER_SIZE;
-        size_t copy_size = std::min(data.size(), static_cast<size_t>(PAGE_SIZE - PAGE_HEADER_SIZE));
+        size_t copy_size = std::min(data.size(), catalog_page->GetPageSize() - PAGE_HEADER_SIZE);
         std::memcpy(page_data, data.data(), copy_size);
 
         storage_engine_->PutPage(catalog_page->GetPageId(), true);
@@ -190,7 +187,7 @@ namespace minidb
         tables_.clear();
 
         char *page_data = catalog_page->GetData() + PAGE_HEADER_SIZE;
-        size_t data_size = PAGE_SIZE - PAGE_HEADER_SIZE;
+        size_t data_size = catalog_page->GetPageSize() - PAGE_HEADER_SIZE;
 
         std::string tmp(page_data, data_size);
         std::istringstream iss(tmp);
@@ -7,6 +7,8 @@
 #include <sstream>
 #include <cctype>
 #include <functional>
+#include <unordered_set>
+#include <thread>
 
 #include "../../util/logger.h"
 #include "../../catalog/catalog.h"          // Catalog
@@ -15,6 +17,14 @@
 #include "../../storage/page/page.h"
 #include "../../storage/page/page_utils.h" // <-- 新增，用于 GetRow / GetSlotCount / HasSpaceFor 等
 #include "../operators/row.h"
+#include "../operators/physical_operators.h"
+#include "../operators/hash_join_operator.h"
+#include "../operators/hash_aggregate_operator.h"
+#include "../operators/sort_operator.h"
+#include "../operators/parallel_scan_operator.h"
+#include "../operators/parallel_aggregate_operator.h"
+#include "../operators/parallel_join_operator.h"
+#include "../operators/vectorized_aggregate_operator.h"
 #include "../../util/config.h"      // PAGE_SIZE, DEFAULT_MAX_PAGES (如果有)
 #include "../../util/status.h"      // Status
 #include "../../util/table_utils.h" // TableUtils
@@ -112,171 +122,106 @@ namespace minidb
         return s;
     }
 
-    // 判断 Row 是否匹配 predicate
-    bool matchesPredicate(const Row &row, const std::string &predicate)
+    // 表的列名（按列序号），用于把谓词绑定到列序号
+    static std::vector<std::string> SchemaColumnNames(const minidb::TableSchema &schema)
     {
-        if (predicate.empty())
-            return true;
-
-        auto trim = [](const std::string &s) -> std::string
-        {
-            size_t start = s.find_first_not_of(" \t\n\r");
-            size_t end = s.find_last_not_of(" \t\n\r");
-            return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
-        };
-
-        std::string trimmed = trim(predicate);
-
-        // 支持 col1 = col2 或 col = value
-        auto pos_eq = trimmed.find('=');
-        if (pos_eq != std::string::npos)
-        {
-            std::string left = trim(trimmed.substr(0, pos_eq));
-            std::string right = trim(trimmed.substr(pos_eq + 1));
+        std::vector<std::string> names;
+        names.reserve(schema.columns.size());
+        for (const auto &col : schema.columns)
+            names.push_back(col.name);
+        return names;
+    }
 
-            // 判断右侧是列还是常量
-            std::string left_val = row.getValue(left);
-            std::string right_val = row.getValue(right);
+    static std::vector<ValueType> SchemaColumnTypes(const minidb::TableSchema &schema)
+    {
+        std::vector<ValueType> types;
+        types.reserve(schema.columns.size());
+        for (const auto &col : schema.columns)
+            types.push_back(ValueTypeFromSchema(col.type));
+        return types;
+    }
 
-            if (!right_val.empty())
-            {
-                // col1 = col2
-                return left_val == right_val;
-            }
-            else
-            {
-                // col = constant
-                return left_val == right;
-            }
-        }
+    // 输出行直接来自表扫描时按表的列类型编译谓词，否则类型未知
+    static std::vector<ValueType> ScanColumnTypes(const PhysicalOperator *op)
+    {
+        if (auto *scan = dynamic_cast<const SeqScanOperator *>(op))
+            return SchemaColumnTypes(scan->GetSchema());
+        if (auto *scan = dynamic_cast<const ParallelSeqScanOperator *>(op))
+            return SchemaColumnTypes(scan->GetSchema());
+        return {};
+    }
 
-        // 支持 >, <
-        auto handleCmp = [&](char op) -> bool
+    // 同步遍历两条页链，只读页头；a 不长于 b 时返回 true。代价为 2 * min(页数)
+    static bool ChainNotLonger(StorageEngine *engine, page_id_t a, page_id_t b)
+    {
+        std::unordered_set<page_id_t> seen_a, seen_b;
+        auto step = [engine](page_id_t &pid, std::unordered_set<page_id_t> &seen)
         {
-            size_t pos = trimmed.find(op);
-            if (pos == std::string::npos)
-                return false;
-            std::string col = trim(trimmed.substr(0, pos));
-            std::string val = trim(trimmed.substr(pos + 1));
-            std::string row_val_str = trim(row.getValue(col));
-            try
-            {
-                int row_val = std::stoi(row_val_str);
-                int cmp_val = std::stoi(val);
-                if (op == '>')
-                    return row_val > cmp_val;
-                else
-                    return row_val < cmp_val;
-            }
-            catch (...)
+            if (pid == INVALID_PAGE_ID || !seen.insert(pid).second)
             {
-                return false;
+                pid = INVALID_PAGE_ID;
+                return;
             }
+            Page *page = engine->GetPage(pid);
+            page_id_t next = page ? page->GetNextPageId() : INVALID_PAGE_ID;
+            if (page)
+                engine->PutPage(pid, false);
+            pid = next;
         };
-
-        if (trimmed.find('>') != std::string::npos)
-            return handleCmp('>');
-        if (trimmed.find('<') != std::string::npos)
-            return handleCmp('<');
-
-        return false;
+        while (a != INVALID_PAGE_ID && b != INVALID_PAGE_ID)
+        {
+            step(a, seen_a);
+            step(b, seen_b);
+        }
+        return a == INVALID_PAGE_ID;
     }
 
-    // Helper: trim both ends
-    static std::string trim(const std::string &s)
+    // 页链长度（只读页头），数到 limit 页为止
+    static size_t ChainPageCount(StorageEngine *engine, page_id_t pid, size_t limit)
     {
-        size_t a = 0, b = s.size();
-        while (a < b && std::isspace((unsigned char)s[a]))
-            ++a;
-        while (b > a && std::isspace((unsigned char)s[b - 1]))
-            --b;
-        return s.substr(a, b - a);
+        std::unordered_set<page_id_t> seen;
+        size_t pages = 0;
+        while (pid != INVALID_PAGE_ID && pages < limit && seen.insert(pid).second)
+        {
+            Page *page = engine->GetPage(pid);
+            if (!page)
+                break;
+            page_id_t next = page->GetNextPageId();
+            engine->PutPage(pid, false);
+            pid = next;
+            ++pages;
+        }
+        return pages;
     }
 
-    // Try to interpret predicate like "colX > 10" or "col1 = Alice".
-    // If that fails, fallback to substring matching in any column.
-    static bool row_matches_predicate(const Row &row, const std::string &predicate)
-    {
-        std::string pred = trim(predicate);
-        if (pred.empty())
-            return true; // empty predicate matches all
+    // 解码后的行（含列名字符串与哈希表条目）相对页内原始字节的膨胀系数估计
+    constexpr size_t kJoinRowExpansion = 4;
 
-        std::istringstream iss(pred);
-        std::string left, op, right;
-        if ((iss >> left) && (iss >> op) && (iss >> right))
+    // 按子算子的输出布局一次性编译谓词，再挂上 Filter
+    static std::unique_ptr<PhysicalOperator> MakeFilter(std::unique_ptr<PhysicalOperator> child,
+                                                        const std::shared_ptr<PlanExpr> &expr,
+                                                        const std::string &predicate)
+    {
+        // 并行扫描：谓词下推到扫描线程中执行；单个 "列 op 常量" 比较按列批量（SIMD）求值
+        if (auto *scan = dynamic_cast<ParallelSeqScanOperator *>(child.get()); scan && !scan->HasPredicate())
         {
-            if (right.size() >= 2 && ((right.front() == '"' && right.back() == '"') || (right.front() == '\'' && right.back() == '\'')))
-            {
-                right = right.substr(1, right.size() - 2);
-            }
-
-            // find column by name
-            std::string left_trimmed = trim(left);
-            int col_idx = -1;
-            for (size_t i = 0; i < row.columns.size(); ++i)
+            if (GetRuntimeConfig().exec_vectorized)
             {
-                if (row.columns[i].col_name == left_trimmed)
-                {
-                    col_idx = static_cast<int>(i);
-                    break;
-                }
-            }
-
-            if (col_idx == -1)
-            {
-                bool all_digits = !left_trimmed.empty() && std::all_of(left_trimmed.begin(), left_trimmed.end(), ::isdigit);
-                if (all_digits)
-                {
-                    int idx = std::stoi(left_trimmed);
-                    if (idx >= 0 && static_cast<size_t>(idx) < row.columns.size())
-                        col_idx = idx;
-                }
-            }
-
-            if (col_idx != -1)
-            {
-                const std::string &colval = row.columns[col_idx].value;
-                bool left_is_num = !colval.empty() && (std::all_of(colval.begin(), colval.end(), [](char c)
-                                                                   { return std::isdigit((unsigned char)c) || c == '-' || c == '+'; }));
-                bool right_is_num = !right.empty() && (std::all_of(right.begin(), right.end(), [](char c)
-                                                                   { return std::isdigit((unsigned char)c) || c == '-' || c == '+'; }));
-                try
-                {
-                    if ((op == ">" || op == "<" || op == ">=" || op == "<=") && left_is_num && right_is_num)
-                    {
-                        long long L = std::stoll(colval);
-                        long long R = std::stoll(right);
-                        if (op == ">")
-                            return L > R;
-                        if (op == "<")
-                            return L < R;
-                        if (op == ">=")
-                            return L >= R;
-                        if (op == "<=")
-                            return L <= R;
-                    }
-                    else if (op == "=" || op == "==")
-                    {
-                        if (left_is_num && right_is_num)
-                            return std::stoll(colval) == std::stoll(right);
-                        else
-                            return colval == right;
-                    }
-                }
-                catch (...)
+                std::shared_ptr<PlanExpr> tree = expr;
+                if (!tree && !predicate.empty())
+                    tree = ParsePredicateString(predicate, child->OutputColumns());
+                VectorPredicate vpred;
+                if (tree && CompileVectorPredicate(tree.get(), scan->GetSchema(), vpred))
                 {
-                    // fall through to substring fallback
+                    scan->SetVectorPredicate(std::move(vpred));
+                    return child;
                 }
             }
+            scan->SetPredicate(CompilePlanPredicate(expr, predicate, child->OutputColumns(), ScanColumnTypes(scan)));
+            return child;
         }
-
-        // fallback: substring match any column
-        for (const auto &c : row.columns)
-        {
-            if (c.value.find(predicate) != std::string::npos)
-                return true;
-        }
-        return false;
+        RowPredicate pred = CompilePlanPredicate(expr, predicate, child->OutputColumns(), ScanColumnTypes(child.get()));
+        return std::make_unique<FilterOperator>(std::move(child), std::move(pred));
     }
 
     int getColumnIndex(const minidb::TableSchema &schema, const std::string &col_name)
@@ -417,7 +362,7 @@ namespace minidb
             if (first_page_id == INVALID_PAGE_ID)
             {
                 page_id_t new_pid = INVALID_PAGE_ID;
-                cur_page = storage_engine_->CreateDataPage(&new_pid);
+                cur_page = storage_engine_->CreateDataPage(&new_pid, INVALID_PAGE_ID);
                 if (!cur_page)
                 {
                     global_log_error("[Executor] 无法创建表数据页");
@@ -436,7 +381,7 @@ namespace minidb
                 {
                     // 首页丢失或被覆盖，尝试重新创建并设置
                     page_id_t new_pid = INVALID_PAGE_ID;
-                    cur_page = storage_engine_->CreateDataPage(&new_pid);
+                    cur_page = storage_engine_->CreateDataPage(&new_pid, INVALID_PAGE_ID);
                     if (!cur_page)
                     {
                         global_log_error("[Executor] 无法获得或创建首页");
@@ -550,18 +495,49 @@ namespace minidb
                 bool appended = storage_engine_->AppendRecordToPage(cur_page, buf.data(), static_cast<uint16_t>(buf.size()));
                 if (!appended)
                 {
-                    // 当前页满：分配新页，链接，然后写入新页
+                    // 当前页满：先按空闲空间映射找表内还有空间的页，不遍历页链
+                    page_id_t target = storage_engine_->FindPageWithSpace(first_page_id, static_cast<uint16_t>(buf.size()));
+                    if (target != INVALID_PAGE_ID && target != cur_page->GetPageId())
+                    {
+                        Page *page = storage_engine_->GetDataPage(target);
+                        if (page && storage_engine_->AppendRecordToPage(page, buf.data(), static_cast<uint16_t>(buf.size())))
+                        {
+                            storage_engine_->PutPage(cur_page->GetPageId(), true);
+                            cur_page = page;
+                            appended = true;
+                        }
+                        else if (page)
+                        {
+                            storage_engine_->PutPage(target, false);
+                        }
+                    }
+                }
+                if (!appended)
+                {
+                    // 没有可用页：在表所在段的区中分配新页，接在段内最近分配的页（即页链尾）之后，
+                    // 页链顺序与文件中的页序一致；找不到时接在当前页之后。两种情况都保留原有的后继
+                    page_id_t prev_pid = storage_engine_->GetSegmentLastPage(first_page_id);
                     page_id_t new_pid = INVALID_PAGE_ID;
-                    Page *new_page = storage_engine_->CreateDataPage(&new_pid);
+                    Page *new_page = storage_engine_->CreateDataPage(&new_pid, first_page_id);
                     if (!new_page)
                     {
                         global_log_error("[Executor] 无法分配新数据页");
                         SetOperationSummary("[Insert][ERROR] 无法分配新数据页");
                         return {};
                     }
-                    // 链接旧页 -> 新页
-                    storage_engine_->LinkPages(cur_page->GetPageId(), new_pid);
-                    // 记得 unpin 旧页（如果需要），但 AppendRecordToPage/PutPage 负责
+                    Page *prev_page = nullptr;
+                    if (prev_pid != INVALID_PAGE_ID && prev_pid != cur_page->GetPageId() && prev_pid != new_pid)
+                        prev_page = storage_engine_->GetDataPage(prev_pid);
+                    if (!prev_page)
+                    {
+                        prev_page = cur_page;
+                        prev_pid = cur_page->GetPageId();
+                    }
+                    new_page->SetNextPageId(prev_page->GetNextPageId());
+                    prev_page->SetNextPageId(new_pid);
+                    if (prev_page != cur_page)
+                        storage_engine_->PutPage(prev_pid, true);
+                    storage_engine_->PutPage(cur_page->GetPageId(), true);
                     cur_page = new_page;
 
                     // 再次尝试追加（若仍失败说明记录超大）
@@ -648,50 +624,12 @@ namespace minidb
             SetOperationSummary(std::string("[Insert] 插入 ") + std::to_string(inserted_pids.size()) + " 行");
             return {};
         }
-        // SeqScan（修复）
+        // SeqScan
         case PlanType::SeqScan:
         {
             logger.log("SEQSCAN " + node->table_name);
             global_log_debug(std::string("[Executor] 顺序扫描表: ") + node->table_name);
-
-            // 权限校验：DBA 总是允许；否则按表权限检查
-            if (!auth_service_)
-            {
-                std::cerr << "[SeqScan] No auth_service_ set!" << std::endl;
-                throw std::runtime_error("No authentication service available");
-            }
-            else if (!permissionChecker_)
-            {
-                std::cerr << "[SeqScan] No permissionChecker_ set!" << std::endl;
-                throw std::runtime_error("No permission checker available");
-            }
-            else if (auth_service_->isDBA())
-            {
-                std::cout << "[SeqScan] DBA user, allowing access to table: " << node->table_name << std::endl;
-                // allow
-            }
-            else if (!permissionChecker_->checkTablePermission(node->table_name, Permission::SELECT))
-            {
-                std::cerr << "[SeqScan] Permission denied on table: " << node->table_name << std::endl;
-                throw std::runtime_error(std::string("Permission denied: ") + node->table_name);
-            }
-
-            auto rows = SeqScanAll(node->table_name);
-            global_log_debug(std::string("[SeqScan] 扫描到 ") + std::to_string(rows.size()) + " 行");
-
-            // 只在调试时显示前几行，避免输出过多
-            size_t show_count = std::min(rows.size(), size_t(5));
-            for (size_t i = 0; i < show_count; ++i)
-            {
-                global_log_debug( std::string("[Row] ") + rows[i].toString());
-            }
-            if (rows.size() > show_count)
-            {
-                global_log_debug( std::string("[SeqScan] ... 还有 ") + std::to_string(rows.size() - show_count) + " 行");
-            }
-            // ===== 添加表格输出 =====
-            // TablePrinter::printResults(rows, "SELECT");
-            return rows;
+            return DrainOperator(BuildOperator(node));
         }
 
         case PlanType::Delete:
@@ -707,6 +645,8 @@ namespace minidb
                 return {};
 
             const auto &schema = catalog_->GetTable(node->table_name);
+            RowPredicate row_matches = CompilePlanPredicate(node->predicate_expr, node->predicate, SchemaColumnNames(schema),
+                                                            SchemaColumnTypes(schema));
             size_t deleted = 0;
 
             // ===== 优先查找索引 =====
@@ -743,7 +683,7 @@ namespace minidb
                                         reinterpret_cast<const unsigned char *>(rec.first),
                                         rec.second,
                                         schema);
-                                    if (!matchesPredicate(row, node->predicate))
+                                    if (!row_matches(row))
                                     {
                                         new_records.push_back(rec);
                                     }
@@ -755,12 +695,7 @@ namespace minidb
                                     }
                                 }
 
-                                // 重写数据页
-                                p->InitializePage(PageType::DATA_PAGE);
-                                for (auto &rec : new_records)
-                                {
-                                    storage_engine_->AppendRecordToPage(p, rec.first, rec.second);
-                                }
+                                storage_engine_->RewriteDataPage(p, new_records);
                                 storage_engine_->PutPage(rid.page_id, true);
                             }
                         }
@@ -786,7 +721,7 @@ namespace minidb
                 for (auto &rec : records)
                 {
                     auto row = Row::Deserialize(reinterpret_cast<const unsigned char *>(rec.first), rec.second, schema);
-                    if (!matchesPredicate(row, node->predicate))
+                    if (!row_matches(row))
                     {
                         new_records.push_back(rec);
                     }
@@ -798,11 +733,7 @@ namespace minidb
 
                 if (deleted > 0)
                 {
-                    p->InitializePage(PageType::DATA_PAGE);
-                    for (auto &rec : new_records)
-                    {
-                        storage_engine_->AppendRecordToPage(p, rec.first, rec.second);
-                    }
+                    storage_engine_->RewriteDataPage(p, new_records);
                     storage_engine_->PutPage(pid, true);
                 }
                 else
@@ -817,137 +748,18 @@ namespace minidb
             return {};
         }
 
-        // ===== Filter =====（修复）
+        // ===== Filter / Project =====（火山模型流水线）
         case PlanType::Filter:
         {
             logger.log("FILTER on " + node->predicate);
-            std::cout << "[Executor] 过滤条件: " << node->predicate << std::endl;
-            // 从子节点获取数据
-            std::vector<Row> input_rows;
-            if (!node->children.empty())
-            {
-                input_rows = execute(node->children[0].get());
-            }
-            else
-            {
-                // 没有子节点，直接全表扫描
-                if (catalog_ && catalog_->HasTable(node->table_name))
-                {
-                    input_rows = SeqScanAll(node->table_name);
-                }
-            }
-
-            // 应用过滤条件
-            std::vector<Row> filtered;
-            for (const auto &row : input_rows)
-            {
-                if (matchesPredicate(row, node->predicate))
-                {
-                    filtered.push_back(row);
-                }
-            }
-
-            std::cout << "[Filter] 过滤后 " << filtered.size() << " 行:" << std::endl;
-            for (auto &row : filtered)
-                /* suppress row preview in terminal */
-            // ===== 添加表格输出 =====
-            // TablePrinter::printResults(filtered, "SELECT");
-            return filtered;
+            global_log_debug(std::string("[Executor] 过滤条件: ") + node->predicate);
+            return DrainOperator(BuildOperator(node));
         }
 
-        // ===== Project =====（修复）
         case PlanType::Project:
         {
             logger.log("PROJECT columns");
-            global_log_debug("[Executor] 投影列: ");
-
-            // 处理 SELECT * 的情况
-            std::vector<std::string> projection_columns;
-            if (node->columns.empty())
-            {
-                // SELECT * - 获取表的所有列
-                std::cout << "* (所有列)";
-                if (catalog_ && catalog_->HasTable(node->table_name))
-                {
-                    const auto &schema = catalog_->GetTable(node->table_name);
-                    for (const auto &col : schema.columns)
-                    {
-                        projection_columns.push_back(col.name);
-                    }
-                }
-            }
-            else
-            {
-                // 具体列名
-                projection_columns = node->columns;
-                for (auto &col : projection_columns) // 将node->columns换为projection_columns
-                    std::cout << col << " ";
-            }
-            std::cout << std::endl;
-            // 从子节点获取数据
-            std::vector<Row> input_rows;
-            if (!node->children.empty())
-            {
-                // 有子节点，执行子节点获取数据
-                input_rows = execute(node->children[0].get());
-            }
-            else
-            {
-                // 没有子节点，直接全表扫描
-                if (catalog_ && catalog_->HasTable(node->table_name))
-                {
-                    input_rows = SeqScanAll(node->table_name);
-                }
-            }
-
-            // 执行投影
-            std::vector<Row> projected;
-            for (const auto &input_row : input_rows)
-            {
-                Row projected_row;
-
-                if (projection_columns.empty())
-                {
-                    // 如果投影列仍为空，返回所有列
-                    projected_row = input_row;
-                }
-                else
-                {
-                    // 按指定列进行投影
-                    for (const auto &col_name : projection_columns)
-                    {
-                        // 在输入行中查找对应列
-                        bool found = false;
-                        for (const auto &input_col : input_row.columns)
-                        {
-                            if (input_col.col_name == col_name)
-                            {
-                                projected_row.columns.push_back(input_col);
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if (!found)
-                        {
-                            // 如果没找到列，添加空值
-                            ColumnValue cv;
-                            cv.col_name = col_name;
-                            cv.value = "";
-                            projected_row.columns.push_back(cv);
-                        }
-                    }
-                }
-
-                projected.push_back(projected_row);
-            }
-
-            global_log_debug(std::string("[Project] 投影后 ") + std::to_string(projected.size()) + " 行");
-            for (auto &row : projected)
-                global_log_debug(std::string("[Row] ") + row.toString());
-            // ===== 添加表格输出 =====
-            // TablePrinter::printResults(projected, "SELECT");
-            return projected;
+            return DrainOperator(BuildOperator(node));
         }
 
         case PlanType::Update:
@@ -961,346 +773,34 @@ namespace minidb
         case PlanType::GroupBy:
         {
             logger.log("GROUP BY on " + node->table_name);
-            std::cout << "[Executor] GroupBy 执行，表: " << node->table_name << std::endl;
-
-            if (!catalog_ || !catalog_->HasTable(node->table_name))
-                break;
-
-            // Step1: 先从子节点拿数据
-            std::vector<Row> rows;
-            if (!node->children.empty())
-                rows = execute(node->children[0].get());
-            else
-                rows = SeqScanAll(node->table_name);
-
-            // Step2: 按 group_keys 分组
-            std::map<std::string, std::vector<Row>> groups;
-            for (auto &row : rows)
-            {
-                std::string key;
-                for (auto &col : node->group_keys)
-                    key += row.getValue(col) + "|";
-                groups[key].push_back(row);
-            }
-
-            // Step3: 聚合
-            std::vector<Row> result_rows;
-            for (auto &[gkey, grows] : groups)
-            {
-                Row out;
-
-                // 分组键
-                for (auto &col : node->group_keys)
-                {
-                    ColumnValue cv;
-                    cv.col_name = col;
-                    cv.value = grows[0].getValue(col);
-                    out.columns.push_back(cv);
-                }
-
-                // 聚合函数
-                for (auto &agg : node->aggregates)
-                {
-                    std::string val;
-
-                    if (agg.func == "COUNT")
-                        val = std::to_string(grows.size());
-                    else if (agg.func == "SUM")
-                    {
-                        long long sum = 0;
-                        for (auto &r : grows)
-                            sum += std::stoll(r.getValue(agg.column));
-                        val = std::to_string(sum);
-                    }
-                    else if (agg.func == "AVG")
-                    {
-                        long long sum = 0;
-                        for (auto &r : grows)
-                            sum += std::stoll(r.getValue(agg.column));
-                        double avg = grows.empty() ? 0.0 : (double)sum / grows.size();
-                        val = std::to_string(avg);
-                    }
-                    else if (agg.func == "MIN")
-                    {
-                        long long m = LLONG_MAX;
-                        for (auto &r : grows)
-                            m = std::min(m, std::stoll(r.getValue(agg.column)));
-                        val = std::to_string(m);
-                    }
-                    else if (agg.func == "MAX")
-                    {
-                        long long m = LLONG_MIN;
-                        for (auto &r : grows)
-                            m = std::max(m, std::stoll(r.getValue(agg.column)));
-                        val = std::to_string(m);
-                    }
-
-                    ColumnValue cv;
-                    cv.col_name = agg.as_name.empty() ? agg.func + "(" + agg.column + ")" : agg.as_name;
-                    cv.value = val;
-                    out.columns.push_back(cv);
-                }
-
-                result_rows.push_back(out);
-            }
-
-            // Step4: 如果有 HAVING 条件，统一过滤
-            if (!node->having_predicate.empty())
-            {
-                std::vector<Row> filtered;
-                for (auto &row : result_rows)
-                {
-                    if (matchesPredicate(row, node->having_predicate))
-                        filtered.push_back(row);
-                }
-                result_rows = std::move(filtered);
-            }
-            // std::cout << "[GroupBy] 结果: " << result_rows.size() << " 行" << std::endl;
-            // for (auto &r : result_rows){
-            //     std::cout <<  "[Row] " << r.toString() << std::endl;
-            // }
-            // ===== 新增：输出结果 =====
-            if (!node->having_predicate.empty())
-            {
-                // TablePrinter::printResults(result_rows, "GROUP BY with HAVING");
-            }
-            else
-            {
-                // TablePrinter::printResults(result_rows, "GROUP BY");
-            }
-            return result_rows;
+            global_log_debug(std::string("[Executor] GroupBy 执行，表: ") + node->table_name);
+            return DrainOperator(BuildOperator(node));
         }
 
         case PlanType::Having:
         {
             logger.log("HAVING " + node->predicate);
-            std::cout << "[Executor] Having 执行，条件: " << node->predicate << std::endl;
-
-            if (node->children.empty())
-                return {}; // 没有子节点直接返回空
-
-            // 执行子节点（通常是 GroupBy）
-            auto rows = execute(node->children[0].get());
-            std::vector<Row> result_rows;
-
-            // 过滤每一行，使用你的 matchesPredicate
-            for (auto &row : rows)
-            {
-                if (matchesPredicate(row, node->predicate))
-                    result_rows.push_back(row);
-            }
-
-            std::cout << "[Having] 过滤后结果: " << result_rows.size() << " 行" << std::endl;
-            for (auto &r : result_rows)
-                std::cout << r.toString() << std::endl;
-
-            return result_rows;
+            global_log_debug(std::string("[Executor] Having 执行，条件: ") + node->predicate);
+            return DrainOperator(BuildOperator(node));
         }
 
         case PlanType::Join:
         {
             logger.log("JOIN tables");
-
-            // 自动生成 SeqScan 子节点（如果 children 为空且 from_tables 至少有两个表）
-            if (node->children.empty() && node->from_tables.size() >= 2)
-            {
-                for (auto &tbl : node->from_tables)
-                {
-                    auto scan = std::make_unique<PlanNode>();
-                    scan->type = PlanType::SeqScan;
-                    scan->table_name = tbl;
-                    node->children.push_back(std::move(scan));
-                }
-            }
-
-            if (node->children.size() < 2)
-            {
-                global_log_error("[Join] 需要至少两个子节点");
-                return {};
-            }
-
-            // 扫描第一个子节点
-            std::vector<Row> joined_rows = execute(node->children[0].get());
-            // 给列加表名前缀
-            for (auto &row : joined_rows)
-                for (auto &col : row.columns)
-                    if (col.col_name.find('.') == std::string::npos)
-                        col.col_name = node->from_tables[0] + "." + col.col_name;
-
-            // 对后续子节点依次 JOIN
-            for (size_t i = 1; i < node->children.size(); ++i)
-            {
-                std::vector<Row> right_rows = execute(node->children[i].get());
-                // 给右表列加前缀
-                for (auto &row : right_rows)
-                    for (auto &col : row.columns)
-                        if (col.col_name.find('.') == std::string::npos)
-                            col.col_name = node->from_tables[i] + "." + col.col_name;
-
-                std::vector<Row> tmp;
-
-                std::string join_predicate = node->predicate;
-                auto trim = [](const std::string &s) -> std::string
-                {
-                    size_t start = s.find_first_not_of(" \t\n\r");
-                    size_t end = s.find_last_not_of(" \t\n\r");
-                    return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
-                };
-                auto pos_eq = join_predicate.find('=');
-                if (pos_eq == std::string::npos)
-                {
-                    global_log_error("[Join] 仅支持 col=col 条件");
-                    return {};
-                }
-
-                std::string left_col = trim(join_predicate.substr(0, pos_eq));
-                std::string right_col = trim(join_predicate.substr(pos_eq + 1));
-
-                for (auto &lrow : joined_rows)
-                {
-                    for (auto &rrow : right_rows)
-                    {
-                        std::string lval = lrow.getValue(left_col);
-                        std::string rval = rrow.getValue(right_col);
-
-                        if (lval == rval)
-                        {
-                            Row combined = lrow;
-                            combined.columns.insert(combined.columns.end(), rrow.columns.begin(), rrow.columns.end());
-                            tmp.push_back(std::move(combined));
-                        }
-                    }
-                }
-
-                joined_rows.swap(tmp);
-            }
-
-            global_log_debug(std::string("[Join] 连接后 ") + std::to_string(joined_rows.size()) + " 行:");
-            for (auto &row : joined_rows)
-                global_log_debug(  std::string("[Row] ") + row.toString());
-
-            return joined_rows;
+            return DrainOperator(BuildOperator(node));
         }
 
         case PlanType::OrderBy:
         {
             logger.log("ORDER BY");
             global_log_info(std::string("[Executor] OrderBy 执行"));
-            if (node->children.empty())
-            {
-                global_log_error(std::string("[OrderBy] 缺少子节点"));
-                return {};
-            }
-
-            std::vector<Row> rows = execute(node->children[0].get());
-            global_log_debug(std::string("[OrderBy] 从子节点获得 ") + std::to_string(rows.size()) + " 行数据");
-
-            if (rows.empty() || node->order_by_cols.empty())
-                return rows;
-
-            TableSchema schema = catalog_->GetTable(node->children[0]->table_name);
-
-            // 单列索引优化
-            bool use_index = false;
-            std::string index_name;
-            int order_col_idx = -1;
-
-            if (node->order_by_cols.size() == 1)
-            {
-                index_name = catalog_->FindIndexByColumn(schema.table_name, node->order_by_cols[0]);
-                order_col_idx = schema.getColumnIndex(node->order_by_cols[0]);
-                use_index = (!index_name.empty() && order_col_idx != -1);
-            }
-
-            if (use_index)
-            {
-                logger.log("[OrderBy] 使用 B+ 树索引");
-
-                BPlusTree tree(storage_engine_.get());
-                // 索引 root 已经在 IndexSchema 中
-                IndexSchema idx = catalog_->GetIndex(index_name);
-                tree.SetRoot(idx.root_page_id);
-
-                // 获取按索引顺序的 RID
-                std::vector<RID> rids = tree.Range(INT32_MIN, INT32_MAX);
-
-                rows.clear();
-                for (auto &rid : rids)
-                {
-                    Page *p = storage_engine_->GetDataPage(rid.page_id);
-                    if (!p)
-                        continue;
-
-                    auto records = storage_engine_->GetPageRecords(p);
-
-                    // 用 slot 直接访问记录
-                    if (rid.slot < records.size())
-                    {
-                        const auto &rec = records[rid.slot];
-                        Row row = Row::Deserialize(reinterpret_cast<const unsigned char *>(rec.first), rec.second, schema);
-                        rows.push_back(row);
-                    }
-                }
-
-                if (node->order_by_desc)
-                    std::reverse(rows.begin(), rows.end());
-            }
-            else
-            {
-                // 普通内存排序
-                std::vector<int> order_col_idxs;
-                std::vector<std::string> order_col_types;
-                for (auto &col : node->order_by_cols)
-                {
-                    int idx = schema.getColumnIndex(col);
-                    if (idx == -1)
-                    {
-                        global_log_error(std::string("[OrderBy] 列不存在: ") + col);
-                        return {};
-                    }
-                    order_col_idxs.push_back(idx);
-                    order_col_types.push_back(schema.columns[idx].type);
-                }
-
-                std::sort(rows.begin(), rows.end(), [&](const Row &a, const Row &b)
-                          {
-                              for (size_t i = 0; i < order_col_idxs.size(); ++i)
-                              {
-                                  const std::string &aval_str = a.columns[order_col_idxs[i]].value;
-                                  const std::string &bval_str = b.columns[order_col_idxs[i]].value;
-                                  const std::string &type = order_col_types[i];
-
-                                  bool cmp_result = false;
-
-                                  if (type == "INT")
-                                  {
-                                      int aval = aval_str.empty() ? 0 : std::stoi(aval_str);
-                                      int bval = bval_str.empty() ? 0 : std::stoi(bval_str);
-                                      cmp_result = node->order_by_desc ? aval > bval : aval < bval;
-                                      if (aval != bval)
-                                          return cmp_result;
-                                  }
-                                  else if (type == "DOUBLE")
-                                  {
-                                      double aval = aval_str.empty() ? 0.0 : std::stod(aval_str);
-                                      double bval = bval_str.empty() ? 0.0 : std::stod(bval_str);
-                                      cmp_result = node->order_by_desc ? aval > bval : aval < bval;
-                                      if (aval != bval)
-                                          return cmp_result;
-                                  }
-                                  else // 字符串类型
-                                  {
-                                      cmp_result = node->order_by_desc ? aval_str > bval_str : aval_str < bval_str;
-                                      if (aval_str != bval_str)
-                                          return cmp_result;
-                                  }
-                              }
-                              return false; // 所有排序列相等
-                          });
-            }
+            return DrainOperator(BuildOperator(node));
+        }
 
-            global_log_debug(std::string("[OrderBy] 排序后 ") + std::to_string(rows.size()) + " 行");
-            return rows;
+        case PlanType::Limit:
+        {
+            logger.log("LIMIT " + std::to_string(node->limit) + " OFFSET " + std::to_string(node->offset));
+            return DrainOperator(BuildOperator(node));
         }
 
         case PlanType::ShowTables:
@@ -1560,40 +1060,6 @@ namespace minidb
         return {};
     }
 
-    // Helper: 从 RID 定位并反序列化一行（返回 optional）
-    static std::optional<Row> FetchRowByRID(StorageEngine *storage_engine,
-                                            const RID &rid,
-                                            const minidb::TableSchema &schema)
-    {
-        if (!storage_engine)
-            return std::nullopt;
-        Page *page = storage_engine->GetDataPage(rid.page_id);
-        if (!page)
-            return std::nullopt;
-
-        // 检查 slot 合法性
-        uint16_t slot_count = page->GetSlotCount();
-        if (rid.slot >= slot_count)
-        {
-            // slot 不合法，释放页并返回空
-            storage_engine->PutPage(page->GetPageId(), false);
-            return std::nullopt;
-        }
-
-        // 通过 page_utils 提取记录指针与长度
-        uint16_t rec_len = 0;
-        const unsigned char *rec_ptr = minidb::GetRow(page, rid.slot, &rec_len);
-        if (!rec_ptr || rec_len == 0)
-        {
-            storage_engine->PutPage(page->GetPageId(), false);
-            return std::nullopt;
-        }
-
-        Row row = Row::Deserialize(rec_ptr, rec_len, schema);
-        storage_engine->PutPage(page->GetPageId(), false);
-        return row;
-    }
-
     // 单页扫描（保持原样）
     std::vector<Row> Executor::SeqScan(Page *page, const minidb::TableSchema &schema)
     {
@@ -1612,100 +1078,411 @@ namespace minidb
         return result;
     }
 
-    // 遍历整张表 —— 优先尝试使用单列 B+ 树索引作全表扫描（Range(-INF,+INF)）
-    // 否则回退到页链全表扫描（原实现）
+    // 遍历整张表（物化版本，供 Insert/Delete 等非查询路径使用）
     std::vector<Row> Executor::SeqScanAll(const std::string &table_name)
     {
         global_log_debug(std::string("[Executor] ==> 进入 SeqScanAll，表名: ") + table_name);
-        std::vector<Row> all_rows;
         if (!storage_engine_ || !catalog_)
         {
-            std::cout << "[Executor] 存储引擎或 Catalog 未初始化，返回空结果。" << std::endl;
-            return all_rows;
+            global_log_warn("[Executor] 存储引擎或 Catalog 未初始化，返回空结果。");
+            return {};
         }
+        return DrainOperator(MakeTableScan(table_name));
+    }
 
-        const auto &schema = catalog_->GetTable(table_name);
+    // 构造表扫描算子 —— 优先使用单列 B+ 树索引顺序（Range(-INF,+INF)），否则走页链
+    std::unique_ptr<PhysicalOperator> Executor::MakeTableScan(const std::string &table_name)
+    {
+        TableSchema schema = catalog_->GetTable(table_name);
 
-        // ------------------------
-        // 1) 优化器尝试选择最佳索引
-        // ------------------------
-        global_log_debug("[Executor] 阶段1: 尝试调用优化器选择最佳索引...");
-        BPlusTree *best_index = nullptr;
+        // 1) 优化器尝试选择最佳索引（返回对象由调用方释放）
+        std::unique_ptr<BPlusTree> best_index;
         if (optimizer_)
+            best_index.reset(optimizer_->ChooseBestIndex(table_name, INT32_MIN, INT32_MAX));
+        if (best_index)
         {
-            best_index = optimizer_->ChooseBestIndex(table_name, INT32_MIN, INT32_MAX);
+            global_log_debug("[Executor] 优化器返回了可用索引，按 B+ 树顺序扫描。");
+            return std::make_unique<SeqScanOperator>(storage_engine_.get(), std::move(schema),
+                                                     best_index->Range(INT32_MIN, INT32_MAX));
         }
 
-        if (best_index)
+        // 2) 第一个单列 B+ 树索引
+        for (const auto &idx : catalog_->GetTableIndexes(table_name))
         {
-            std::cout << "[Executor] 优化器返回了可用索引，使用 B+ 树进行全表扫描。" << std::endl;
-            auto rids = best_index->Range(INT32_MIN, INT32_MAX);
-            all_rows.reserve(rids.size());
+            if (idx.type == "BPLUS" && idx.cols.size() == 1 && idx.root_page_id != INVALID_PAGE_ID)
+            {
+                global_log_debug("[Executor] 找到一个单列 B+ 树索引，按索引顺序扫描。");
+                BPlusTree bpt(storage_engine_.get());
+                bpt.SetRoot(idx.root_page_id);
+                return std::make_unique<SeqScanOperator>(storage_engine_.get(), std::move(schema),
+                                                         bpt.Range(INT32_MIN, INT32_MAX));
+            }
+        }
 
-            for (const RID &rid : rids)
+        // 3) 页链扫描：并行度大于 1 时按 morsel 分给多个线程；开启向量化时串行也走 morsel 扫描（单线程）
+        const auto &cfg = GetRuntimeConfig();
+        size_t threads = cfg.exec_scan_threads;
+        if (threads == 0)
+            threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 16);
+        if (threads > 1 || cfg.exec_vectorized)
+        {
+            global_log_debug("[Executor] 没有索引可用，使用并行页链扫描。");
+            return std::make_unique<ParallelSeqScanOperator>(storage_engine_.get(), std::move(schema),
+                                                             threads, cfg.exec_scan_morsel_pages);
+        }
+        global_log_debug("[Executor] 没有索引可用，使用页链扫描。");
+        return std::make_unique<SeqScanOperator>(storage_engine_.get(), std::move(schema));
+    }
+
+    // SELECT 权限校验：DBA 总是允许；否则按表权限检查
+    void Executor::CheckSelectPermission(const std::string &table_name)
+    {
+        if (!auth_service_)
+        {
+            global_log_error("[SeqScan] No auth_service_ set!");
+            throw std::runtime_error("No authentication service available");
+        }
+        if (!permissionChecker_)
+        {
+            global_log_error("[SeqScan] No permissionChecker_ set!");
+            throw std::runtime_error("No permission checker available");
+        }
+        if (auth_service_->isDBA())
+            return;
+        if (!permissionChecker_->checkTablePermission(table_name, Permission::SELECT))
+        {
+            global_log_error(std::string("[SeqScan] Permission denied on table: ") + table_name);
+            throw std::runtime_error(std::string("Permission denied: ") + table_name);
+        }
+    }
+
+    // 把查询类 PlanNode 翻译为火山模型算子树；尚未流式化的节点包装为 MaterializedOperator
+    std::unique_ptr<PhysicalOperator> Executor::BuildOperator(PlanNode *node)
+    {
+        if (!node)
+            return std::make_unique<MaterializedOperator>(nullptr);
+
+        // 没有子节点时的输入：直接扫描 node->table_name（不做权限校验，与旧实现一致）
+        auto child_or_scan = [this, node]() -> std::unique_ptr<PhysicalOperator>
+        {
+            if (!node->children.empty())
+                return BuildOperator(node->children[0].get());
+            if (storage_engine_ && catalog_ && catalog_->HasTable(node->table_name))
+                return MakeTableScan(node->table_name);
+            return std::make_unique<MaterializedOperator>(nullptr);
+        };
+
+        switch (node->type)
+        {
+        case PlanType::SeqScan:
+        {
+            CheckSelectPermission(node->table_name);
+            if (!storage_engine_ || !catalog_)
+                return std::make_unique<MaterializedOperator>(nullptr);
+            auto scan = MakeTableScan(node->table_name);
+            // ORDER BY 路径会把 WHERE 挂在 SeqScan 上
+            if (node->predicate_expr || !node->predicate.empty())
+                return MakeFilter(std::move(scan), node->predicate_expr, node->predicate);
+            return scan;
+        }
+
+        case PlanType::Filter:
+        {
+            return MakeFilter(child_or_scan(), node->predicate_expr, node->predicate);
+        }
+
+        case PlanType::Project:
+        {
+            // SELECT * —— 展开为表的所有列
+            std::vector<std::string> projection_columns = node->columns;
+            if (projection_columns.empty() && catalog_ && catalog_->HasTable(node->table_name))
+            {
+                for (const auto &col : catalog_->GetTable(node->table_name).columns)
+                    projection_columns.push_back(col.name);
+            }
+            return std::make_unique<ProjectOperator>(child_or_scan(), std::move(projection_columns));
+        }
+
+        case PlanType::GroupBy:
+        {
+            if (!catalog_ || !catalog_->HasTable(node->table_name))
+                return std::make_unique<MaterializedOperator>(nullptr);
+
+            // 分组列 / 聚合列按声明类型解析一次，之后只比较类型化的值
+            TableSchema schema = catalog_->GetTable(node->table_name);
+            auto type_of = [&schema](const std::string &col)
+            {
+                int idx = schema.getColumnIndex(col);
+                return idx == -1 ? ValueType::String : ValueTypeFromSchema(schema.columns[idx].type);
+            };
+            std::vector<ValueType> key_types, agg_types;
+            for (const auto &col : node->group_keys)
+                key_types.push_back(type_of(col));
+            for (const auto &agg : node->aggregates)
+                agg_types.push_back(type_of(agg.column));
+
+            std::unique_ptr<PhysicalOperator> input = child_or_scan();
+            std::unique_ptr<PhysicalOperator> op;
+            // 输入是页链扫描时：能向量化则按列批聚合；否则并行度大于 1 时在扫描线程内预聚合，再按分区并行合并
+            auto *scan_input = dynamic_cast<ParallelSeqScanOperator *>(input.get());
+            if (scan_input && GetRuntimeConfig().exec_vectorized && !scan_input->HasRowPredicate() &&
+                VectorizedAggregateOperator::Supports(scan_input->GetSchema(), node->group_keys, node->aggregates))
+            {
+                std::unique_ptr<ParallelSeqScanOperator> scan(static_cast<ParallelSeqScanOperator *>(input.release()));
+                op = std::make_unique<VectorizedAggregateOperator>(std::move(scan), node->group_keys, node->aggregates,
+                                                                   GetRuntimeConfig().exec_agg_max_groups);
+            }
+            else if (scan_input && scan_input->GetDegree() > 1)
+            {
+                std::unique_ptr<ParallelSeqScanOperator> scan(static_cast<ParallelSeqScanOperator *>(input.release()));
+                op = std::make_unique<ParallelHashAggregateOperator>(
+                    std::move(scan), node->group_keys, std::move(key_types), node->aggregates, std::move(agg_types),
+                    GetRuntimeConfig().exec_agg_max_groups);
+            }
+            else
             {
-                auto maybe_row = FetchRowByRID(storage_engine_.get(), rid, schema);
-                if (maybe_row.has_value())
-                    all_rows.push_back(std::move(maybe_row.value()));
+                op = std::make_unique<HashAggregateOperator>(
+                    std::move(input), node->group_keys, std::move(key_types), node->aggregates, std::move(agg_types),
+                    storage_engine_.get(), GetRuntimeConfig().exec_agg_max_groups);
             }
+            if (node->having_expr || !node->having_predicate.empty())
+                op = MakeFilter(std::move(op), node->having_expr, node->having_predicate);
+            return op;
+        }
 
-            global_log_debug(std::string("[Executor] 使用索引完成扫描，返回 ") + std::to_string(all_rows.size()) + " 行。");
-            return all_rows; // 成功用索引完成扫描
+        case PlanType::Having:
+        {
+            if (node->children.empty())
+                return std::make_unique<MaterializedOperator>(nullptr);
+            return MakeFilter(BuildOperator(node->children[0].get()), node->predicate_expr, node->predicate);
         }
 
-        // ------------------------
-        // 2) 尝试第一个单列 B+ 树索引做叶链扫描
-        // ------------------------
-        global_log_debug("[Executor] 阶段2: 没有优化器索引，尝试第一个单列 B+ 树索引...");
-        std::vector<IndexSchema> idxs = catalog_->GetTableIndexes(table_name);
-        IndexSchema usable_idx;
-        bool found_idx = false;
-        for (const auto &idx : idxs)
+        case PlanType::Join:
         {
-            if (idx.type == "BPLUS" && idx.cols.size() == 1)
+            // 自动生成 SeqScan 子节点（如果 children 为空且 from_tables 至少有两个表）
+            if (node->children.empty() && node->from_tables.size() >= 2)
             {
-                usable_idx = idx;
-                found_idx = true;
-                break;
+                for (auto &tbl : node->from_tables)
+                {
+                    auto scan = std::make_unique<PlanNode>();
+                    scan->type = PlanType::SeqScan;
+                    scan->table_name = tbl;
+                    node->children.push_back(std::move(scan));
+                }
             }
+            if (node->children.size() < 2 || node->from_tables.size() < node->children.size())
+            {
+                global_log_error("[Join] 需要至少两个子节点");
+                return std::make_unique<MaterializedOperator>(nullptr);
+            }
+
+            auto trim = [](const std::string &s) -> std::string
+            {
+                size_t start = s.find_first_not_of(" \t\n\r");
+                size_t end = s.find_last_not_of(" \t\n\r");
+                return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
+            };
+            auto pos_eq = node->predicate.find('=');
+            if (pos_eq == std::string::npos)
+            {
+                global_log_error("[Join] 仅支持 col=col 条件");
+                return std::make_unique<MaterializedOperator>(nullptr);
+            }
+            const std::string key_a = trim(node->predicate.substr(0, pos_eq));
+            const std::string key_b = trim(node->predicate.substr(pos_eq + 1));
+
+            // 连接列的声明类型：带表名前缀时查对应表，否则取第一个含该列的表
+            auto column_type = [this, node](const std::string &col) -> ValueType
+            {
+                size_t dot = col.find('.');
+                for (const auto &tbl : node->from_tables)
+                {
+                    if (dot != std::string::npos && col.compare(0, dot, tbl) != 0)
+                        continue;
+                    if (!catalog_->HasTable(tbl))
+                        continue;
+                    TableSchema schema = catalog_->GetTable(tbl);
+                    int idx = schema.getColumnIndex(dot == std::string::npos ? col : col.substr(dot + 1));
+                    if (idx != -1)
+                        return ValueTypeFromSchema(schema.columns[idx].type);
+                }
+                return ValueType::String;
+            };
+            ValueType ta = column_type(key_a), tb = column_type(key_b);
+            JoinKeySpec key;
+            if (ta == ValueType::Int && tb == ValueType::Int)
+                key.type = ValueType::Int;
+            else if (ta != ValueType::String && tb != ValueType::String)
+                key.type = ValueType::Double;
+            else
+                key.type = ValueType::String;
+
+            const size_t budget = GetRuntimeConfig().exec_join_memory_bytes;
+            auto qualified = [](std::vector<std::string> names, const std::string &table)
+            {
+                for (auto &n : names)
+                    if (n.find('.') == std::string::npos)
+                        n = table + "." + n;
+                return names;
+            };
+            std::unique_ptr<PhysicalOperator> op = BuildOperator(node->children[0].get());
+            for (size_t i = 1; i < node->children.size(); ++i)
+            {
+                PlanNode *right_node = node->children[i].get();
+                std::unique_ptr<PhysicalOperator> right = BuildOperator(right_node);
+                // 第一次连接前左输入还是基表，列名尚未加表前缀
+                std::vector<std::string> left_cols = i == 1 ? qualified(op->OutputColumns(), node->from_tables[0]) : op->OutputColumns();
+                std::vector<std::string> right_cols = qualified(right->OutputColumns(), node->from_tables[i]);
+
+                // 条件两侧可以写反：哪一列能在右输入中解析到，哪一列就是右连接列
+                key.left_column = key_a;
+                key.right_column = key_b;
+                if (ResolveColumnOrdinal(right_cols, key_a) != -1 && ResolveColumnOrdinal(left_cols, key_b) != -1)
+                    std::swap(key.left_column, key.right_column);
+
+                // 第一次连接时两侧都是基表，用较小的一侧建哈希表；之后左侧是中间结果，固定用右表建
+                bool build_left = false;
+                PlanNode *left_node = node->children[0].get();
+                if (i == 1 && left_node->type == PlanType::SeqScan && right_node->type == PlanType::SeqScan &&
+                    catalog_->HasTable(left_node->table_name) && catalog_->HasTable(right_node->table_name))
+                {
+                    build_left = ChainNotLonger(storage_engine_.get(),
+                                                catalog_->GetTable(left_node->table_name).first_page_id,
+                                                catalog_->GetTable(right_node->table_name).first_page_id);
+                }
+                global_log_debug(std::string("[Join] 哈希连接 ") + key.left_column + " = " + key.right_column +
+                                 "，构建侧: " + (build_left ? "左" : "右"));
+
+                // 两侧都是并行扫描且构建侧估计能放进内存预算时，走并行基数分区连接
+                auto *left_scan = dynamic_cast<ParallelSeqScanOperator *>(op.get());
+                auto *right_scan = dynamic_cast<ParallelSeqScanOperator *>(right.get());
+                PlanNode *build_node = build_left ? left_node : right_node;
+                if (i == 1 && left_scan && right_scan && left_scan->GetDegree() > 1 && right_scan->GetDegree() > 1 &&
+                    catalog_->HasTable(build_node->table_name))
+                {
+                    const size_t page_size = storage_engine_->GetPageSize();
+                    size_t build_pages = ChainPageCount(storage_engine_.get(),
+                                                        catalog_->GetTable(build_node->table_name).first_page_id,
+                                                        budget / (page_size * kJoinRowExpansion) + 1);
+                    if (build_pages * page_size * kJoinRowExpansion <= budget)
+                    {
+                        std::unique_ptr<ParallelSeqScanOperator> ls(static_cast<ParallelSeqScanOperator *>(op.release()));
+                        std::unique_ptr<ParallelSeqScanOperator> rs(static_cast<ParallelSeqScanOperator *>(right.release()));
+                        op = std::make_unique<ParallelHashJoinOperator>(std::move(ls), node->from_tables[0], std::move(rs),
+                                                                        node->from_tables[i], key, build_left, build_pages);
+                        continue;
+                    }
+                }
+
+                if (i == 1)
+                    op = std::make_unique<QualifyOperator>(std::move(op), node->from_tables[0]);
+                right = std::make_unique<QualifyOperator>(std::move(right), node->from_tables[i]);
+                op = std::make_unique<HashJoinOperator>(std::move(op), std::move(right), key, build_left,
+                                                        storage_engine_.get(), budget);
+            }
+            return op;
         }
 
-        if (found_idx && usable_idx.root_page_id != INVALID_PAGE_ID)
+        case PlanType::OrderBy:
         {
-            global_log_debug("[Executor] 找到一个单列 B+ 树索引，尝试扫描...");
-            BPlusTree bpt(storage_engine_.get());
-            bpt.SetRoot(usable_idx.root_page_id);
+            if (node->children.empty())
+            {
+                global_log_error(std::string("[OrderBy] 缺少子节点"));
+                return std::make_unique<MaterializedOperator>(nullptr);
+            }
+            PlanNode *child = node->children[0].get();
+            if (node->order_by_cols.empty())
+                return BuildOperator(child);
 
-            auto rids = bpt.Range(INT32_MIN, INT32_MAX);
-            all_rows.reserve(rids.size());
+            TableSchema schema = catalog_->GetTable(child->table_name);
 
-            for (const RID &rid : rids)
+            // 单列索引优化：子节点是表扫描时，直接按索引顺序回表，省去排序
+            if (node->order_by_cols.size() == 1 && child->type == PlanType::SeqScan)
             {
-                auto maybe_row = FetchRowByRID(storage_engine_.get(), rid, schema);
-                if (maybe_row.has_value())
-                    all_rows.push_back(std::move(maybe_row.value()));
+                std::string index_name = catalog_->FindIndexByColumn(schema.table_name, node->order_by_cols[0]);
+                if (!index_name.empty() && schema.getColumnIndex(node->order_by_cols[0]) != -1)
+                {
+                    logger.log("[OrderBy] 使用 B+ 树索引");
+                    CheckSelectPermission(child->table_name);
+
+                    BPlusTree tree(storage_engine_.get());
+                    tree.SetRoot(catalog_->GetIndex(index_name).root_page_id);
+                    std::vector<RID> rids = tree.Range(INT32_MIN, INT32_MAX);
+                    if (node->order_by_desc)
+                        std::reverse(rids.begin(), rids.end());
+
+                    std::unique_ptr<PhysicalOperator> scan =
+                        std::make_unique<SeqScanOperator>(storage_engine_.get(), std::move(schema), std::move(rids));
+                    if (child->predicate_expr || !child->predicate.empty())
+                        scan = MakeFilter(std::move(scan), child->predicate_expr, child->predicate);
+                    return scan;
+                }
             }
 
-            std::cout << "[Executor] 使用单列索引完成扫描，返回 " << all_rows.size() << " 行。" << std::endl;
-            return all_rows;
+            // 外部归并排序：排序键按列类型预先解析，超出内存预算时分段溢写到临时页
+            std::vector<SortKeySpec> sort_keys;
+            for (auto &col : node->order_by_cols)
+            {
+                int idx = schema.getColumnIndex(col);
+                if (idx == -1)
+                {
+                    global_log_error(std::string("[OrderBy] 列不存在: ") + col);
+                    return std::make_unique<MaterializedOperator>(nullptr);
+                }
+                sort_keys.push_back({col, ValueTypeFromSchema(schema.columns[idx].type), node->order_by_desc});
+            }
+            // Top-N：优化器的 Limit 下推给出提示（只需前 limit 行），堆在排序内存预算内时用有界堆，
+            // 不做全量排序；否则照常外部排序，上层 Limit 截取
+            const size_t sort_budget = GetRuntimeConfig().exec_sort_memory_bytes;
+            if (node->limit >= 0 &&
+                static_cast<unsigned long long>(node->limit) <= TopNRowBound(schema, sort_keys.size(), sort_budget))
+                return std::make_unique<TopNOperator>(BuildOperator(child), std::move(sort_keys),
+                                                      static_cast<size_t>(node->limit));
+            return std::make_unique<ExternalSortOperator>(BuildOperator(child), std::move(sort_keys),
+                                                          storage_engine_.get(), sort_budget);
+        }
+
+        case PlanType::Limit:
+        {
+            if (node->children.empty())
+                return std::make_unique<MaterializedOperator>(nullptr);
+            PlanNode *child = node->children[0].get();
+
+            // 流水线执行：取够行数后 LimitOperator 关闭子算子，扫描不再读取后续页
+            return std::make_unique<LimitOperator>(BuildOperator(child), node->limit, node->offset);
         }
 
-        // ------------------------
-        // 3) 原有页链扫描回退
-        // ------------------------
-        global_log_debug("[Executor] 阶段3: 没有索引可用，回退到页链扫描...");
-        page_id_t first_page_id = schema.first_page_id;
-        auto pages = storage_engine_->GetPageChain(first_page_id);
+        default:
+            // 尚未改为流式的节点：Open 时再调用旧的物化执行路径
+            return std::make_unique<MaterializedOperator>([this, node]()
+                                                          { return execute(node); });
+        }
+    }
 
-        for (auto p : pages)
+    // 以流式方式执行查询：每产出一行调用一次 sink，sink 返回 false 时提前结束
+    void Executor::ExecuteQuery(PlanNode *node, const std::function<bool(const Row &)> &sink)
+    {
+        auto root = BuildOperator(node);
+        root->Open();
+        Row row;
+        while (root->Next(row))
         {
-            auto rows = SeqScan(p, schema);
-            all_rows.insert(all_rows.end(), rows.begin(), rows.end());
-            storage_engine_->PutPage(p->GetPageId(), false);
+            if (!sink(row))
+                break;
         }
+        root->Close();
+    }
 
-        global_log_debug(std::string("[Executor] 页链扫描完成，返回 ") + std::to_string(all_rows.size()) + " 行。");
-        return all_rows;
+    std::vector<Row> Executor::DrainOperator(std::unique_ptr<PhysicalOperator> op)
+    {
+        std::vector<Row> rows;
+        op->Open();
+        Row row;
+        while (op->Next(row))
+            rows.push_back(std::move(row));
+        op->Close();
+        global_log_debug(std::string("[Executor] 输出 ") + std::to_string(rows.size()) + " 行");
+        return rows;
     }
 
     void Executor::Update(const PlanNode &plan)
@@ -1726,6 +1503,8 @@ namespace minidb
         }
 
         const auto &schema = catalog_->GetTable(plan.table_name);
+        RowPredicate row_matches = CompilePlanPredicate(plan.predicate_expr, plan.predicate, SchemaColumnNames(schema),
+                                                        SchemaColumnTypes(schema));
         size_t num_pages = storage_engine_->GetNumPages();
         int updated_count = 0;
 
@@ -1773,7 +1552,7 @@ namespace minidb
                         auto row = Row::Deserialize(reinterpret_cast<const unsigned char *>(rec.first),
                                                     rec.second, schema);
 
-                        if (matchesPredicate(row, plan.predicate))
+                        if (row_matches(row))
                         {
                             int32_t old_key = key;
                             int32_t new_key = old_key;
@@ -1815,9 +1594,7 @@ namespace minidb
                     // 写回页
                     if (page_modified)
                     {
-                        p->InitializePage(PageType::DATA_PAGE);
-                        for (auto &rec : new_records)
-                            storage_engine_->AppendRecordToPage(p, rec.data(), rec.size());
+                        storage_engine_->RewriteDataPage(p, new_records);
                         storage_engine_->PutPage(rid.page_id, true);
                     }
                     else
@@ -1851,7 +1628,7 @@ namespace minidb
                     auto row = Row::Deserialize(reinterpret_cast<const unsigned char *>(rec.first),
                                                 rec.second, schema);
 
-                    if (matchesPredicate(row, plan.predicate))
+                    if (row_matches(row))
                     {
                         for (const auto &kv : plan.set_values)
                             row.setValue(kv.first, kv.second);
@@ -1873,9 +1650,7 @@ namespace minidb
 
                 if (page_modified)
                 {
-                    p->InitializePage(PageType::DATA_PAGE);
-                    for (auto &rec : new_records)
-                        storage_engine_->AppendRecordToPage(p, rec.data(), rec.size());
+                    storage_engine_->RewriteDataPage(p, new_records);
                     storage_engine_->PutPage(pid, true);
                 }
                 else
@@ -1902,6 +1677,8 @@ namespace minidb
         }
 
         const auto &schema = catalog_->GetTable(plan.table_name);
+        RowPredicate row_matches = CompilePlanPredicate(plan.predicate_expr, plan.predicate, SchemaColumnNames(schema),
+                                                        SchemaColumnTypes(schema));
         if (!storage_engine_)
         {
             std::cerr << "[Select] StorageEngine 未初始化！" << std::endl;
@@ -1939,7 +1716,7 @@ namespace minidb
                             {
                                 auto row = Row::Deserialize(reinterpret_cast<const unsigned char *>(rec.first),
                                                             rec.second, schema);
-                                if (matchesPredicate(row, plan.predicate))
+                                if (row_matches(row))
                                     results.push_back(row);
                             }
                         }
@@ -1963,7 +1740,7 @@ namespace minidb
                 {
                     auto row = Row::Deserialize(reinterpret_cast<const unsigned char *>(rec.first),
                                                 rec.second, schema);
-                    if (matchesPredicate(row, plan.predicate))
+                    if (row_matches(row))
                         results.push_back(row);
                 }
             }
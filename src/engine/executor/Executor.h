@@ -8,11 +8,13 @@
 #include "../../storage/storage_engine.h" // ✅ 改这里
 #include "../../storage/page/page.h"      // Page
 #include "../operators/row.h"             // Row, ColumnValue
+#include "../operators/physical_operators.h" // 火山模型算子
 #include "../../util/logger.h"
 #include "../../optimizer/index_optimizer.h" // 新增：索引优化器
 #include "../../auth/permission_checker.h"
 #include "../../auth/auth_service.h" // AuthService
 
+#include <functional>
 #include <iostream>
 
 namespace minidb
@@ -35,6 +37,11 @@ namespace minidb
         std::vector<Row> SeqScanAll(const std::string &table_name);
         std::vector<Row> SeqScan(Page *page, const minidb::TableSchema &schema);
 
+        // 火山模型：把查询计划翻译成 Open/Next/Close 算子树
+        std::unique_ptr<PhysicalOperator> BuildOperator(PlanNode *node);
+        // 流式执行查询，逐行交给 sink；sink 返回 false 时提前结束
+        void ExecuteQuery(PlanNode *node, const std::function<bool(const Row &)> &sink);
+
         // 其他算子
         std::vector<Row> Filter(const std::vector<Row> &rows, const std::string &predicate);
         std::vector<Row> Project(const std::vector<Row> &rows, const std::vector<std::string> &cols);
@@ -81,6 +88,10 @@ namespace minidb
               permissionChecker_(checker) {}
 
     private:
+        std::unique_ptr<PhysicalOperator> MakeTableScan(const std::string &table_name);
+        void CheckSelectPermission(const std::string &table_name);
+        std::vector<Row> DrainOperator(std::unique_ptr<PhysicalOperator> op);
+
         std::shared_ptr<StorageEngine> storage_engine_;
         static Logger logger;
         std::shared_ptr<Catalog> catalog_; // 新增
@@ -0,0 +1,294 @@
+// src/engine/operators/data_chunk.cpp
+#include "data_chunk.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace minidb
+{
+
+    namespace
+    {
+        // 与 Row::Serialize 一致：字符列未声明长度时按 64 字节存储
+        constexpr uint32_t kDefaultCharWidth = 64;
+
+        uint32_t FixedWidth(const Column &col)
+        {
+            switch (VectorTypeFromSchema(col.type))
+            {
+            case VectorType::Int32:
+                return sizeof(int32_t);
+            case VectorType::Double:
+                return sizeof(double);
+            case VectorType::Char:
+                break;
+            }
+            return col.length > 0 ? static_cast<uint32_t>(col.length) : kDefaultCharWidth;
+        }
+
+        bool ToVectorCmp(const std::string &op, VectorCmp &out)
+        {
+            if (op == "=" || op == "==")
+                out = VectorCmp::EQ;
+            else if (op == "!=" || op == "<>")
+                out = VectorCmp::NE;
+            else if (op == "<")
+                out = VectorCmp::LT;
+            else if (op == ">")
+                out = VectorCmp::GT;
+            else if (op == "<=")
+                out = VectorCmp::LE;
+            else if (op == ">=")
+                out = VectorCmp::GE;
+            else
+                return false;
+            return true;
+        }
+
+        // 常量在左侧时交换比较方向
+        VectorCmp Flip(VectorCmp op)
+        {
+            switch (op)
+            {
+            case VectorCmp::LT:
+                return VectorCmp::GT;
+            case VectorCmp::GT:
+                return VectorCmp::LT;
+            case VectorCmp::LE:
+                return VectorCmp::GE;
+            case VectorCmp::GE:
+                return VectorCmp::LE;
+            default:
+                return op;
+            }
+        }
+
+        // 与逐行求值的数值识别一致：允许前导 '+'，整串都须是数字
+        bool ParseInt(const std::string &s, int64_t &out)
+        {
+            const char *b = s.data(), *e = s.data() + s.size();
+            if (b != e && *b == '+')
+                ++b;
+            auto r = std::from_chars(b, e, out);
+            return b != e && r.ec == std::errc() && r.ptr == e;
+        }
+
+        bool ParseDouble(const std::string &s, double &out)
+        {
+            const char *b = s.data(), *e = s.data() + s.size();
+            if (b != e && *b == '+')
+                ++b;
+            auto r = std::from_chars(b, e, out);
+            return b != e && r.ec == std::errc() && r.ptr == e;
+        }
+    } // namespace
+
+    VectorType VectorTypeFromSchema(const std::string &type)
+    {
+        // 与 Row::Serialize / Deserialize 的判断保持一致（区分大小写）
+        if (type == "INT")
+            return VectorType::Int32;
+        if (type == "DOUBLE")
+            return VectorType::Double;
+        return VectorType::Char;
+    }
+
+    int SchemaColumnIndex(const TableSchema &schema, const std::string &name)
+    {
+        int idx = schema.getColumnIndex(name);
+        if (idx != -1)
+            return idx;
+        auto dot = name.find('.');
+        if (dot == std::string::npos)
+            return -1;
+        if (!schema.table_name.empty() && name.compare(0, dot, schema.table_name) != 0)
+            return -1;
+        return schema.getColumnIndex(name.substr(dot + 1));
+    }
+
+    // ===== DataChunk =====
+
+    const ColumnVector *DataChunk::Find(int schema_index) const
+    {
+        for (const auto &col : columns)
+            if (col.schema_index == schema_index)
+                return &col;
+        return nullptr;
+    }
+
+    void DataChunk::Clear()
+    {
+        for (auto &col : columns)
+        {
+            col.i32.clear();
+            col.f64.clear();
+            col.chars.clear();
+        }
+        count = 0;
+        has_sel = false;
+        sel_count = 0;
+    }
+
+    // ===== ChunkDecoder =====
+
+    ChunkDecoder::ChunkDecoder(const TableSchema &schema, std::vector<int> columns)
+        : columns_(std::move(columns))
+    {
+        uint32_t offset = sizeof(int32_t); // 记录开头的列数
+        for (const auto &col : schema.columns)
+        {
+            Slot slot{VectorTypeFromSchema(col.type), offset, FixedWidth(col)};
+            offset += slot.width;
+            slots_.push_back(slot);
+        }
+        for (int c : columns_)
+            min_length_ = std::max(min_length_, slots_.at(c).offset + slots_.at(c).width);
+    }
+
+    void ChunkDecoder::Init(DataChunk &chunk) const
+    {
+        chunk.columns.assign(columns_.size(), ColumnVector{});
+        for (size_t i = 0; i < columns_.size(); ++i)
+        {
+            const Slot &slot = slots_[columns_[i]];
+            ColumnVector &col = chunk.columns[i];
+            col.schema_index = columns_[i];
+            col.type = slot.type;
+            col.width = slot.width;
+            switch (slot.type)
+            {
+            case VectorType::Int32:
+                col.i32.reserve(kVectorSize);
+                break;
+            case VectorType::Double:
+                col.f64.reserve(kVectorSize);
+                break;
+            case VectorType::Char:
+                col.chars.reserve(kVectorSize * slot.width);
+                break;
+            }
+        }
+        chunk.sel.resize(kVectorSize);
+        chunk.Clear();
+    }
+
+    bool ChunkDecoder::Append(DataChunk &chunk, const unsigned char *data, uint16_t len) const
+    {
+        if (!data || len < min_length_)
+            return false;
+        for (size_t i = 0; i < columns_.size(); ++i)
+        {
+            const Slot &slot = slots_[columns_[i]];
+            ColumnVector &col = chunk.columns[i];
+            const unsigned char *p = data + slot.offset;
+            switch (slot.type)
+            {
+            case VectorType::Int32:
+            {
+                int32_t v;
+                std::memcpy(&v, p, sizeof(v));
+                col.i32.push_back(v);
+                break;
+            }
+            case VectorType::Double:
+            {
+                double v;
+                std::memcpy(&v, p, sizeof(v));
+                col.f64.push_back(v);
+                break;
+            }
+            case VectorType::Char:
+                col.chars.insert(col.chars.end(), p, p + slot.width);
+                break;
+            }
+        }
+        ++chunk.count;
+        return true;
+    }
+
+    // ===== VectorPredicate =====
+
+    bool CompileVectorPredicate(const PlanExpr *expr, const TableSchema &schema, VectorPredicate &out)
+    {
+        VectorCmp op;
+        if (!expr || expr->kind != PlanExpr::Kind::Binary || !expr->left || !expr->right || !ToVectorCmp(expr->op, op))
+            return false;
+
+        const PlanExpr *col = expr->left.get();
+        const PlanExpr *lit = expr->right.get();
+        if (col->kind == PlanExpr::Kind::Literal && lit->kind == PlanExpr::Kind::Column)
+        {
+            std::swap(col, lit);
+            op = Flip(op);
+        }
+        if (col->kind != PlanExpr::Kind::Column || lit->kind != PlanExpr::Kind::Literal)
+            return false;
+
+        int idx = SchemaColumnIndex(schema, col->name);
+        if (idx < 0)
+            return false;
+
+        VectorPredicate pred;
+        pred.column = idx;
+        pred.op = op;
+        pred.type = VectorTypeFromSchema(schema.columns[idx].type);
+        switch (pred.type)
+        {
+        case VectorType::Int32:
+        {
+            // 非整数常量在逐行求值时按浮点比较，这里不改写，交回逐行谓词
+            int64_t v;
+            if (lit->is_string || !ParseInt(lit->value, v) || v < std::numeric_limits<int32_t>::min() ||
+                v > std::numeric_limits<int32_t>::max())
+                return false;
+            pred.i = static_cast<int32_t>(v);
+            break;
+        }
+        case VectorType::Double:
+            if (lit->is_string || !ParseDouble(lit->value, pred.d))
+                return false;
+            break;
+        case VectorType::Char:
+        {
+            // 字符列只与字符串常量按字节序比较；常量超出列宽或含 '\0' 时无法用定长比较表达
+            const uint32_t width = FixedWidth(schema.columns[idx]);
+            if (!lit->is_string || lit->value.size() > width || lit->value.find('\0') != std::string::npos)
+                return false;
+            pred.s = lit->value;
+            pred.s.resize(width, '\0');
+            break;
+        }
+        }
+        out = std::move(pred);
+        return true;
+    }
+
+    void ApplyVectorPredicate(const VectorPredicate &pred, DataChunk &chunk)
+    {
+        const ColumnVector *col = chunk.Find(pred.column);
+        chunk.sel.resize(std::max(chunk.sel.size(), chunk.count));
+        chunk.has_sel = true;
+        if (!col)
+        {
+            chunk.sel_count = 0;
+            return;
+        }
+        switch (col->type)
+        {
+        case VectorType::Int32:
+            chunk.sel_count = SelectInt32(col->i32.data(), chunk.count, pred.op, pred.i, chunk.sel.data());
+            break;
+        case VectorType::Double:
+            chunk.sel_count = SelectDouble(col->f64.data(), chunk.count, pred.op, pred.d, chunk.sel.data());
+            break;
+        case VectorType::Char:
+            chunk.sel_count = SelectChar(col->chars.data(), chunk.count, col->width, pred.op, pred.s.data(),
+                                         chunk.sel.data());
+            break;
+        }
+    }
+
+} // namespace minidb
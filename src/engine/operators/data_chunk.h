@@ -0,0 +1,109 @@
+// src/engine/operators/data_chunk.h
+/**
+ * 列式批（DataChunk）：向量化执行的数据单元
+ * - 每列一个定长类型向量（int32 / double / 定长字符），一批约 kVectorSize 行
+ * - 选择向量 sel 记录过滤后仍有效的行下标，过滤不移动列数据
+ * - ChunkDecoder 按 Row::Serialize 的定长记录格式直接从页内记录取出需要的列，不经过 Row / 字符串
+ * - VectorPredicate 为 "列 op 常量" 形式的谓词，编译后在整批上用 SIMD 内核求值
+ */
+#pragma once
+
+#include "vector_kernels.h"
+#include "../../catalog/catalog.h"
+#include "plan_node.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    constexpr size_t kVectorSize = 1024;
+
+    enum class VectorType
+    {
+        Int32,
+        Double,
+        Char
+    };
+
+    struct ColumnVector
+    {
+        int schema_index{-1}; // 在表 schema 中的列序号
+        VectorType type{VectorType::Int32};
+        uint32_t width{0}; // Char：每个值的字节数（'\0' 填充）
+        std::vector<int32_t> i32;
+        std::vector<double> f64;
+        std::vector<char> chars;
+    };
+
+    struct DataChunk
+    {
+        std::vector<ColumnVector> columns;
+        size_t count{0};
+
+        // has_sel 为 false 时 [0, count) 全部有效
+        bool has_sel{false};
+        std::vector<uint32_t> sel;
+        size_t sel_count{0};
+
+        size_t ActiveCount() const { return has_sel ? sel_count : count; }
+        // 按 schema 列序号查找列，未解码时返回 nullptr
+        const ColumnVector *Find(int schema_index) const;
+        // 清空数据，保留列定义与已分配的容量
+        void Clear();
+    };
+
+    // 按 schema 计算的定长记录布局；只解码 columns 指定的列
+    class ChunkDecoder
+    {
+    public:
+        ChunkDecoder(const TableSchema &schema, std::vector<int> columns);
+
+        // 按解码列初始化 chunk 的列定义
+        void Init(DataChunk &chunk) const;
+        // 追加一条记录；记录长度不足以包含所有解码列时返回 false（与 Row::Deserialize 截断一致，视为不完整行）
+        bool Append(DataChunk &chunk, const unsigned char *data, uint16_t len) const;
+
+        const std::vector<int> &Columns() const { return columns_; }
+
+    private:
+        struct Slot
+        {
+            VectorType type;
+            uint32_t offset; // 相对记录起始的字节偏移（含开头的列数）
+            uint32_t width;
+        };
+
+        std::vector<Slot> slots_; // 按 schema 列序号
+        std::vector<int> columns_;
+        uint32_t min_length_{0};
+    };
+
+    // schema 中列的向量类型：INT / DOUBLE / 其余按定长字符
+    VectorType VectorTypeFromSchema(const std::string &type);
+    // 按列名在 schema 中定位，允许 "table.col" 形式
+    int SchemaColumnIndex(const TableSchema &schema, const std::string &name);
+
+    struct VectorPredicate
+    {
+        int column{-1}; // schema 列序号
+        VectorType type{VectorType::Int32};
+        VectorCmp op{VectorCmp::EQ};
+        int32_t i{0};
+        double d{0.0};
+        std::string s; // Char：填充到列宽
+
+        bool Valid() const { return column >= 0; }
+    };
+
+    // 把 "列 op 常量" 编译为向量谓词；只接受与逐行求值语义一致的组合：
+    // INT 列与 int32 范围内的整数常量、DOUBLE 列与数值常量、字符列与带引号的字符串常量。
+    // 其余形式（算术、列与列比较、类型不匹配等）返回 false，由调用方退回逐行谓词
+    bool CompileVectorPredicate(const PlanExpr *expr, const TableSchema &schema, VectorPredicate &out);
+
+    // 在整批上求值，结果写入 chunk 的选择向量（chunk 须包含谓词列且尚无选择向量）
+    void ApplyVectorPredicate(const VectorPredicate &pred, DataChunk &chunk);
+
+} // namespace minidb
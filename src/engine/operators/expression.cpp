@@ -0,0 +1,491 @@
+// src/engine/operators/expression.cpp
+#include "expression.h"
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+#include "../../util/logger.h"
+
+namespace minidb
+{
+
+    namespace
+    {
+
+        enum class CmpOp
+        {
+            EQ,
+            NE,
+            LT,
+            GT,
+            LE,
+            GE
+        };
+
+        // 求值中间结果；text 指向列值或常量的原始文本（算术结果没有文本）
+        struct Value
+        {
+            enum class Kind
+            {
+                Null,
+                Int,
+                Double,
+                Text
+            };
+
+            Kind kind{Kind::Null};
+            int64_t i{0};
+            double d{0.0};
+            std::string_view text;
+            bool has_text{false};
+
+            bool IsNumeric() const { return kind == Kind::Int || kind == Kind::Double; }
+            double AsDouble() const { return kind == Kind::Int ? static_cast<double>(i) : d; }
+        };
+
+        using ValueFn = std::function<Value(const Row &)>;
+
+        // 把文本归类为整数 / 浮点 / 字符串，不分配内存
+        Value Classify(std::string_view s)
+        {
+            Value v;
+            v.text = s;
+            v.has_text = true;
+            v.kind = Value::Kind::Text;
+            if (s.empty())
+                return v;
+
+            const char *b = s.data();
+            const char *e = b + s.size();
+            if (*b == '+')
+                ++b;
+
+            int64_t iv = 0;
+            auto ri = std::from_chars(b, e, iv);
+            if (ri.ec == std::errc() && ri.ptr == e)
+            {
+                v.kind = Value::Kind::Int;
+                v.i = iv;
+                return v;
+            }
+            double dv = 0.0;
+            auto rd = std::from_chars(b, e, dv);
+            if (rd.ec == std::errc() && rd.ptr == e)
+            {
+                v.kind = Value::Kind::Double;
+                v.d = dv;
+            }
+            return v;
+        }
+
+        // 已知列类型：INT / DOUBLE 列只按该类型解析一次；解析不了的值（空值、带 '+' 等）退回 Classify
+        Value ClassifyAs(std::string_view s, ValueType type)
+        {
+            const char *b = s.data();
+            const char *e = b + s.size();
+            Value v;
+            v.text = s;
+            v.has_text = true;
+            if (type == ValueType::Int)
+            {
+                auto r = std::from_chars(b, e, v.i);
+                if (r.ec == std::errc() && r.ptr == e)
+                {
+                    v.kind = Value::Kind::Int;
+                    return v;
+                }
+            }
+            else if (type == ValueType::Double)
+            {
+                auto r = std::from_chars(b, e, v.d);
+                if (r.ec == std::errc() && r.ptr == e)
+                {
+                    v.kind = Value::Kind::Double;
+                    return v;
+                }
+            }
+            return Classify(s);
+        }
+
+        // 列序号对应的 schema 类型；未知时为 Null
+        ValueType ColumnType(const std::vector<ValueType> &types, int ordinal)
+        {
+            return ordinal >= 0 && static_cast<size_t>(ordinal) < types.size() ? types[ordinal] : ValueType::Null;
+        }
+
+        template <typename T>
+        bool Compare(CmpOp op, const T &a, const T &b)
+        {
+            switch (op)
+            {
+            case CmpOp::EQ:
+                return a == b;
+            case CmpOp::NE:
+                return a != b;
+            case CmpOp::LT:
+                return a < b;
+            case CmpOp::GT:
+                return a > b;
+            case CmpOp::LE:
+                return a <= b;
+            case CmpOp::GE:
+                return a >= b;
+            }
+            return false;
+        }
+
+        // 两侧都是数值时按数值比较，否则按原始文本比较
+        bool CompareValues(CmpOp op, const Value &a, const Value &b)
+        {
+            if (a.kind == Value::Kind::Null || b.kind == Value::Kind::Null)
+                return false;
+            if (a.IsNumeric() && b.IsNumeric())
+            {
+                if (a.kind == Value::Kind::Int && b.kind == Value::Kind::Int)
+                    return Compare(op, a.i, b.i);
+                return Compare(op, a.AsDouble(), b.AsDouble());
+            }
+            if (!a.has_text || !b.has_text)
+                return false;
+            return Compare(op, a.text, b.text);
+        }
+
+        bool ParseCmpOp(const std::string &op, CmpOp &out)
+        {
+            if (op == "=" || op == "==")
+                out = CmpOp::EQ;
+            else if (op == "!=" || op == "<>")
+                out = CmpOp::NE;
+            else if (op == "<")
+                out = CmpOp::LT;
+            else if (op == ">")
+                out = CmpOp::GT;
+            else if (op == "<=")
+                out = CmpOp::LE;
+            else if (op == ">=")
+                out = CmpOp::GE;
+            else
+                return false;
+            return true;
+        }
+
+        // 取列文本：优先按绑定的序号，序号失效时按列名查找
+        inline const std::string *ColumnText(const Row &row, int ordinal, const std::string &name)
+        {
+            if (ordinal >= 0 && static_cast<size_t>(ordinal) < row.columns.size())
+                return &row.columns[ordinal].value;
+            for (const auto &c : row.columns)
+                if (c.col_name == name)
+                    return &c.value;
+            return nullptr;
+        }
+
+        ValueFn CompileValue(const PlanExpr *expr, const std::vector<std::string> &layout,
+                             const std::vector<ValueType> &types);
+
+        ValueFn CompileArithmetic(const std::string &op, ValueFn left, ValueFn right)
+        {
+            char c = op.empty() ? '?' : op[0];
+            return [c, left, right](const Row &row) -> Value
+            {
+                Value a = left(row);
+                Value b = right(row);
+                Value r;
+                if (!a.IsNumeric() || !b.IsNumeric())
+                    return r;
+                if (a.kind == Value::Kind::Int && b.kind == Value::Kind::Int)
+                {
+                    r.kind = Value::Kind::Int;
+                    switch (c)
+                    {
+                    case '+':
+                        r.i = a.i + b.i;
+                        return r;
+                    case '-':
+                        r.i = a.i - b.i;
+                        return r;
+                    case '*':
+                        r.i = a.i * b.i;
+                        return r;
+                    case '/':
+                        if (b.i == 0)
+                            return Value{};
+                        r.i = a.i / b.i;
+                        return r;
+                    }
+                    return Value{};
+                }
+                r.kind = Value::Kind::Double;
+                double x = a.AsDouble(), y = b.AsDouble();
+                switch (c)
+                {
+                case '+':
+                    r.d = x + y;
+                    return r;
+                case '-':
+                    r.d = x - y;
+                    return r;
+                case '*':
+                    r.d = x * y;
+                    return r;
+                case '/':
+                    if (y == 0.0)
+                        return Value{};
+                    r.d = x / y;
+                    return r;
+                }
+                return Value{};
+            };
+        }
+
+        ValueFn CompileValue(const PlanExpr *expr, const std::vector<std::string> &layout,
+                             const std::vector<ValueType> &types)
+        {
+            if (!expr)
+                return [](const Row &)
+                { return Value{}; };
+
+            switch (expr->kind)
+            {
+            case PlanExpr::Kind::Column:
+            {
+                int ord = ResolveColumnOrdinal(layout, expr->name);
+                std::string name = expr->name;
+                ValueType type = ColumnType(types, ord);
+                return [ord, name, type](const Row &row) -> Value
+                {
+                    const std::string *s = ColumnText(row, ord, name);
+                    return s ? ClassifyAs(*s, type) : Value{};
+                };
+            }
+            case PlanExpr::Kind::Literal:
+            {
+                // 常量文本放在堆上，lambda 被拷贝时 string_view 依然有效
+                auto text = std::make_shared<std::string>(expr->value);
+                Value v = expr->is_string ? Value{} : Classify(*text);
+                if (expr->is_string)
+                {
+                    v.kind = Value::Kind::Text;
+                    v.text = *text;
+                    v.has_text = true;
+                }
+                return [text, v](const Row &)
+                { return v; };
+            }
+            case PlanExpr::Kind::Binary:
+            {
+                CmpOp cmp;
+                if (ParseCmpOp(expr->op, cmp))
+                {
+                    ValueFn l = CompileValue(expr->left.get(), layout, types);
+                    ValueFn r = CompileValue(expr->right.get(), layout, types);
+                    return [cmp, l, r](const Row &row) -> Value
+                    {
+                        Value out;
+                        out.kind = Value::Kind::Int;
+                        out.i = CompareValues(cmp, l(row), r(row)) ? 1 : 0;
+                        return out;
+                    };
+                }
+                return CompileArithmetic(expr->op,
+                                         CompileValue(expr->left.get(), layout, types),
+                                         CompileValue(expr->right.get(), layout, types));
+            }
+            }
+            return [](const Row &)
+            { return Value{}; };
+        }
+
+        CmpOp Flip(CmpOp op)
+        {
+            switch (op)
+            {
+            case CmpOp::LT:
+                return CmpOp::GT;
+            case CmpOp::GT:
+                return CmpOp::LT;
+            case CmpOp::LE:
+                return CmpOp::GE;
+            case CmpOp::GE:
+                return CmpOp::LE;
+            default:
+                return op;
+            }
+        }
+
+        std::string Trim(const std::string &s)
+        {
+            size_t start = s.find_first_not_of(" \t\n\r");
+            size_t end = s.find_last_not_of(" \t\n\r");
+            return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
+        }
+
+    } // namespace
+
+    int ResolveColumnOrdinal(const std::vector<std::string> &layout, const std::string &name)
+    {
+        for (size_t i = 0; i < layout.size(); ++i)
+            if (layout[i] == name)
+                return static_cast<int>(i);
+
+        auto dot = name.find('.');
+        std::string bare = dot == std::string::npos ? name : name.substr(dot + 1);
+        int found = -1;
+        for (size_t i = 0; i < layout.size(); ++i)
+        {
+            const std::string &col = layout[i];
+            auto cdot = col.find('.');
+            std::string_view col_bare = cdot == std::string::npos ? std::string_view(col) : std::string_view(col).substr(cdot + 1);
+            if (col_bare == bare)
+            {
+                if (found != -1)
+                    return -1; // 有歧义，运行时按名字查找
+                found = static_cast<int>(i);
+            }
+        }
+        return found;
+    }
+
+    RowPredicate CompilePredicate(const PlanExpr *expr, const std::vector<std::string> &layout,
+                                  const std::vector<ValueType> &types)
+    {
+        if (!expr)
+            return [](const Row &)
+            { return true; };
+
+        CmpOp cmp;
+        if (expr->kind == PlanExpr::Kind::Binary && ParseCmpOp(expr->op, cmp) && expr->left && expr->right)
+        {
+            const PlanExpr *col = nullptr;
+            const PlanExpr *lit = nullptr;
+            CmpOp op = cmp;
+            if (expr->left->kind == PlanExpr::Kind::Column && expr->right->kind == PlanExpr::Kind::Literal)
+            {
+                col = expr->left.get();
+                lit = expr->right.get();
+            }
+            else if (expr->left->kind == PlanExpr::Kind::Literal && expr->right->kind == PlanExpr::Kind::Column)
+            {
+                col = expr->right.get();
+                lit = expr->left.get();
+                op = Flip(cmp);
+            }
+
+            // 快速路径：列 op 常量，直接读列文本与预解析的常量比较
+            if (col && lit)
+            {
+                int ord = ResolveColumnOrdinal(layout, col->name);
+                std::string name = col->name;
+                auto text = std::make_shared<std::string>(lit->value);
+                if (lit->is_string)
+                {
+                    return [op, ord, name, text](const Row &row)
+                    {
+                        const std::string *s = ColumnText(row, ord, name);
+                        return s && Compare(op, std::string_view(*s), std::string_view(*text));
+                    };
+                }
+                Value lv = Classify(*text);
+                ValueType type = ColumnType(types, ord);
+                return [op, ord, name, text, lv, type](const Row &row)
+                {
+                    const std::string *s = ColumnText(row, ord, name);
+                    return s && CompareValues(op, ClassifyAs(*s, type), lv);
+                };
+            }
+
+            ValueFn l = CompileValue(expr->left.get(), layout, types);
+            ValueFn r = CompileValue(expr->right.get(), layout, types);
+            return [cmp, l, r](const Row &row)
+            { return CompareValues(cmp, l(row), r(row)); };
+        }
+
+        // 非比较表达式：非零数值 / 非空文本为真
+        ValueFn v = CompileValue(expr, layout, types);
+        return [v](const Row &row)
+        {
+            Value x = v(row);
+            if (x.IsNumeric())
+                return x.AsDouble() != 0.0;
+            return x.has_text && !x.text.empty();
+        };
+    }
+
+    std::shared_ptr<PlanExpr> ParsePredicateString(const std::string &predicate, const std::vector<std::string> &layout)
+    {
+        std::string trimmed = Trim(predicate);
+        if (trimmed.empty())
+            return nullptr;
+
+        static const char *kOps[] = {">=", "<=", "!=", "<>", "==", "=", ">", "<"};
+        size_t pos = std::string::npos;
+        std::string op;
+        for (const char *candidate : kOps)
+        {
+            size_t p = trimmed.find(candidate);
+            if (p != std::string::npos && (pos == std::string::npos || p < pos))
+            {
+                pos = p;
+                op = candidate;
+            }
+        }
+        if (pos == std::string::npos)
+            return nullptr;
+
+        std::string left = Trim(trimmed.substr(0, pos));
+        std::string right = Trim(trimmed.substr(pos + op.size()));
+        if (left.empty())
+            return nullptr;
+
+        auto expr = std::make_shared<PlanExpr>();
+        expr->kind = PlanExpr::Kind::Binary;
+        expr->op = op;
+
+        expr->left = std::make_shared<PlanExpr>();
+        expr->left->kind = PlanExpr::Kind::Column;
+        expr->left->name = left;
+
+        expr->right = std::make_shared<PlanExpr>();
+        if (right.size() >= 2 && ((right.front() == '\'' && right.back() == '\'') || (right.front() == '"' && right.back() == '"')))
+        {
+            expr->right->kind = PlanExpr::Kind::Literal;
+            expr->right->value = right.substr(1, right.size() - 2);
+            expr->right->is_string = true;
+        }
+        else if (!right.empty() && ResolveColumnOrdinal(layout, right) != -1)
+        {
+            expr->right->kind = PlanExpr::Kind::Column;
+            expr->right->name = right;
+        }
+        else
+        {
+            expr->right->kind = PlanExpr::Kind::Literal;
+            expr->right->value = right;
+            expr->right->is_string = !Classify(right).IsNumeric();
+        }
+        return expr;
+    }
+
+    RowPredicate CompilePlanPredicate(const std::shared_ptr<PlanExpr> &expr,
+                                      const std::string &predicate,
+                                      const std::vector<std::string> &layout,
+                                      const std::vector<ValueType> &types)
+    {
+        if (expr)
+            return CompilePredicate(expr.get(), layout, types);
+        if (Trim(predicate).empty())
+            return [](const Row &)
+            { return true; };
+
+        auto parsed = ParsePredicateString(predicate, layout);
+        if (!parsed)
+        {
+            global_log_warn(std::string("[Predicate] 无法解析谓词，视为不匹配: ") + predicate);
+            return [](const Row &)
+            { return false; };
+        }
+        return CompilePredicate(parsed.get(), layout, types);
+    }
+
+} // namespace minidb
@@ -0,0 +1,42 @@
+// src/engine/operators/expression.h
+/**
+ * 谓词编译：把 PlanExpr 表达式树在查询开始时编译为一棵求值闭包，
+ * 列引用提前绑定到输入行的列序号，常量提前解析为整数 / 浮点数，
+ * 逐行求值时不再切分、trim 或分配字符串。
+ */
+#pragma once
+
+#include "plan_node.h"
+#include "Row.h"
+#include "typed_value.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    using RowPredicate = std::function<bool(const Row &)>;
+
+    // 列名 -> 列序号；"t.col" 与 "col" 可互相匹配，未找到或有歧义时返回 -1
+    int ResolveColumnOrdinal(const std::vector<std::string> &layout, const std::string &name);
+
+    // 编译表达式树：调用方每条语句 / 每个算子只编译一次，返回的闭包逐行求值。
+    // layout 为输入行的列名（按列序号），为空表示未知，此时按列名查找；
+    // types 与 layout 对应，给出各列的 schema 类型时数值列按该类型直接解析，为空时逐行判断文本是否为数值
+    RowPredicate CompilePredicate(const PlanExpr *expr, const std::vector<std::string> &layout,
+                                  const std::vector<ValueType> &types = {});
+
+    // 兼容仅携带字符串谓词的计划（存储过程、手工构造的 PlanNode 等），形如 "col op value"
+    // 右侧若是 layout 中的列名则视为列引用
+    std::shared_ptr<PlanExpr> ParsePredicateString(const std::string &predicate, const std::vector<std::string> &layout);
+
+    // 优先使用表达式树，其次解析字符串；二者都为空时恒为真
+    RowPredicate CompilePlanPredicate(const std::shared_ptr<PlanExpr> &expr,
+                                      const std::string &predicate,
+                                      const std::vector<std::string> &layout,
+                                      const std::vector<ValueType> &types = {});
+
+} // namespace minidb
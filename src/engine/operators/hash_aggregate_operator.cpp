@@ -0,0 +1,370 @@
+// src/engine/operators/hash_aggregate_operator.cpp
+#include "hash_aggregate_operator.h"
+
+#include "expression.h" // ResolveColumnOrdinal
+#include "../../util/logger.h"
+
+#include <algorithm>
+
+namespace minidb
+{
+
+    namespace
+    {
+        constexpr size_t kInitialSlots = 64;
+        constexpr size_t kAggSpillPartitions = 16;
+
+        inline size_t PartitionOf(size_t hash)
+        {
+            return (hash >> 40) % kAggSpillPartitions;
+        }
+
+        const std::string kEmptyValue;
+
+        // 按序号取值，序号未知时按列名查找；找不到视为空值
+        inline const std::string &ValueAt(const Row &row, int ord, const std::string &name)
+        {
+            if (ord >= 0 && static_cast<size_t>(ord) < row.columns.size())
+                return row.columns[ord].value;
+            for (const auto &c : row.columns)
+                if (c.col_name == name)
+                    return c.value;
+            return kEmptyValue;
+        }
+    } // namespace
+
+    std::string AggOutputName(const AggregateExpr &agg)
+    {
+        return agg.as_name.empty() ? agg.func + "(" + agg.column + ")" : agg.as_name;
+    }
+
+    AggFunc AggFuncFromName(const std::string &name)
+    {
+        if (name == "COUNT")
+            return AggFunc::Count;
+        if (name == "SUM")
+            return AggFunc::Sum;
+        if (name == "AVG")
+            return AggFunc::Avg;
+        if (name == "MIN")
+            return AggFunc::Min;
+        if (name == "MAX")
+            return AggFunc::Max;
+        return AggFunc::Unknown;
+    }
+
+    HashAggregateOperator::HashAggregateOperator(std::unique_ptr<PhysicalOperator> child,
+                                                 std::vector<std::string> group_keys,
+                                                 std::vector<ValueType> key_types,
+                                                 std::vector<AggregateExpr> aggregates,
+                                                 std::vector<ValueType> agg_types,
+                                                 StorageEngine *engine,
+                                                 size_t max_groups)
+        : child_(std::move(child)), group_keys_(std::move(group_keys)), key_types_(std::move(key_types)),
+          aggregates_(std::move(aggregates)), engine_(engine), max_groups_(std::max<size_t>(max_groups, 1))
+    {
+        key_types_.resize(group_keys_.size(), ValueType::String);
+        specs_ = MakeAggSpecs(aggregates_, agg_types);
+        scratch_key_.resize(group_keys_.size());
+
+        spill_layout_ = group_keys_;
+        for (const auto &agg : aggregates_)
+            spill_layout_.push_back(agg.column);
+        for (size_t i = 0; i < group_keys_.size(); ++i)
+            spill_binding_.key_ords.push_back(static_cast<int>(i));
+        for (size_t i = 0; i < aggregates_.size(); ++i)
+            spill_binding_.agg_ords.push_back(static_cast<int>(group_keys_.size() + i));
+    }
+
+    std::vector<AggSpec> MakeAggSpecs(const std::vector<AggregateExpr> &aggregates,
+                                      const std::vector<ValueType> &agg_types)
+    {
+        std::vector<AggSpec> specs;
+        for (size_t i = 0; i < aggregates.size(); ++i)
+        {
+            AggSpec spec;
+            spec.func = AggFuncFromName(aggregates[i].func);
+            spec.column = aggregates[i].column;
+            ValueType col_type = i < agg_types.size() ? agg_types[i] : ValueType::String;
+            if (spec.func == AggFunc::Sum || spec.func == AggFunc::Avg)
+                spec.type = col_type == ValueType::Int ? ValueType::Int : ValueType::Double;
+            else
+                spec.type = col_type;
+            specs.push_back(std::move(spec));
+        }
+        return specs;
+    }
+
+    void AccumulateValue(Accumulator &acc, const AggSpec &spec, const std::string &text)
+    {
+        ++acc.rows;
+        if (spec.func == AggFunc::Count || spec.func == AggFunc::Unknown)
+            return;
+
+        TypedValue v = TypedValue::Parse(text, spec.type);
+        if (v.IsNull())
+            return;
+        ++acc.count;
+        switch (spec.func)
+        {
+        case AggFunc::Sum:
+        case AggFunc::Avg:
+            if (v.type == ValueType::Int)
+                acc.isum += v.i;
+            else
+                acc.dsum += v.d;
+            break;
+        case AggFunc::Min:
+            if (acc.best.IsNull() || v.Compare(acc.best) < 0)
+                acc.best = std::move(v);
+            break;
+        case AggFunc::Max:
+            if (acc.best.IsNull() || v.Compare(acc.best) > 0)
+                acc.best = std::move(v);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void MergeAccumulator(Accumulator &dst, const Accumulator &src, const AggSpec &spec)
+    {
+        dst.rows += src.rows;
+        dst.count += src.count;
+        dst.isum += src.isum;
+        dst.dsum += src.dsum;
+        if (src.best.IsNull())
+            return;
+        if (dst.best.IsNull() ||
+            (spec.func == AggFunc::Min && src.best.Compare(dst.best) < 0) ||
+            (spec.func == AggFunc::Max && src.best.Compare(dst.best) > 0))
+            dst.best = src.best;
+    }
+
+    std::string FinalizeAccumulator(const Accumulator &acc, const AggSpec &spec)
+    {
+        switch (spec.func)
+        {
+        case AggFunc::Count:
+            return std::to_string(acc.rows);
+        case AggFunc::Sum:
+            return spec.type == ValueType::Int ? std::to_string(acc.isum) : std::to_string(acc.dsum);
+        case AggFunc::Avg:
+        {
+            double sum = spec.type == ValueType::Int ? static_cast<double>(acc.isum) : acc.dsum;
+            return std::to_string(acc.count == 0 ? 0.0 : sum / acc.count);
+        }
+        case AggFunc::Min:
+        case AggFunc::Max:
+            return acc.best.ToString(); // 组内全为空值时输出空
+        case AggFunc::Unknown:
+            break;
+        }
+        return "";
+    }
+
+    // ===== AggHashTable =====
+
+    void AggHashTable::Reset(size_t num_keys, size_t num_aggs)
+    {
+        num_keys_ = num_keys;
+        num_aggs_ = num_aggs;
+        slots_.assign(kInitialSlots, kNoGroup);
+        group_hash_.clear();
+        keys_.clear();
+        accs_.clear();
+        group_count_ = 0;
+    }
+
+    void AggHashTable::Release()
+    {
+        slots_.clear();
+        slots_.shrink_to_fit();
+        group_hash_.clear();
+        group_hash_.shrink_to_fit();
+        keys_.clear();
+        keys_.shrink_to_fit();
+        accs_.clear();
+        accs_.shrink_to_fit();
+        group_count_ = 0;
+    }
+
+    void AggHashTable::Grow()
+    {
+        std::vector<uint32_t> slots(slots_.size() * 2, kNoGroup);
+        size_t mask = slots.size() - 1;
+        for (uint32_t g = 0; g < group_count_; ++g)
+        {
+            size_t idx = group_hash_[g] & mask;
+            while (slots[idx] != kNoGroup)
+                idx = (idx + 1) & mask;
+            slots[idx] = g;
+        }
+        slots_.swap(slots);
+    }
+
+    uint32_t AggHashTable::FindOrInsert(const TypedKey &key, size_t hash, bool allow_new)
+    {
+        if (slots_.empty())
+            slots_.assign(kInitialSlots, kNoGroup);
+        size_t mask = slots_.size() - 1;
+        size_t idx = hash & mask;
+        while (slots_[idx] != kNoGroup)
+        {
+            uint32_t g = slots_[idx];
+            if (group_hash_[g] == hash && std::equal(key.begin(), key.end(), keys_.begin() + g * num_keys_))
+                return g;
+            idx = (idx + 1) & mask;
+        }
+        if (!allow_new)
+            return kNoGroup;
+
+        uint32_t g = static_cast<uint32_t>(group_count_++);
+        slots_[idx] = g;
+        group_hash_.push_back(hash);
+        keys_.insert(keys_.end(), key.begin(), key.end());
+        accs_.resize(accs_.size() + num_aggs_);
+        if (group_count_ * 2 > slots_.size()) // 负载因子保持在 1/2 以下
+            Grow();
+        return g;
+    }
+
+    // ===== HashAggregateOperator =====
+
+    void HashAggregateOperator::Consume(const Row &row, const Binding &binding, bool allow_new)
+    {
+        for (size_t k = 0; k < group_keys_.size(); ++k)
+            scratch_key_[k] = TypedValue::Parse(ValueAt(row, binding.key_ords[k], group_keys_[k]), key_types_[k]);
+        size_t hash = TypedKeyHash{}(scratch_key_);
+
+        uint32_t g = table_.FindOrInsert(scratch_key_, hash, allow_new);
+        if (g == AggHashTable::kNoGroup)
+        {
+            SpillRow(row, binding, hash);
+            return;
+        }
+        Accumulator *acc = table_.Accs(g);
+        for (size_t a = 0; a < specs_.size(); ++a)
+            AccumulateValue(acc[a], specs_[a], ValueAt(row, binding.agg_ords[a], specs_[a].column));
+    }
+
+    void HashAggregateOperator::SpillRow(const Row &row, const Binding &binding, size_t hash)
+    {
+        if (!spilled_)
+        {
+            spilled_ = true;
+            for (size_t p = 0; p < kAggSpillPartitions; ++p)
+                parts_.push_back(std::make_unique<SpillFile>(engine_, spill_layout_));
+        }
+        Row narrow;
+        narrow.columns.reserve(spill_layout_.size());
+        for (size_t k = 0; k < group_keys_.size(); ++k)
+            narrow.columns.emplace_back(spill_layout_[k], ValueAt(row, binding.key_ords[k], group_keys_[k]));
+        for (size_t a = 0; a < specs_.size(); ++a)
+            narrow.columns.emplace_back(spill_layout_[group_keys_.size() + a],
+                                        ValueAt(row, binding.agg_ords[a], specs_[a].column));
+        parts_[PartitionOf(hash)]->Append(narrow);
+    }
+
+    void HashAggregateOperator::Open()
+    {
+        table_.Reset(group_keys_.size(), specs_.size());
+        emit_pos_ = 0;
+        spilled_ = false;
+        parts_.clear();
+        next_part_ = 0;
+
+        child_->Open();
+        std::vector<std::string> layout = child_->OutputColumns();
+        input_binding_.key_ords.clear();
+        input_binding_.agg_ords.clear();
+        for (const auto &col : group_keys_)
+            input_binding_.key_ords.push_back(ResolveColumnOrdinal(layout, col));
+        for (const auto &spec : specs_)
+            input_binding_.agg_ords.push_back(ResolveColumnOrdinal(layout, spec.column));
+
+        Row row;
+        size_t input_rows = 0;
+        while (child_->Next(row))
+        {
+            ++input_rows;
+            // 达到分组上限后不再建新组（没有存储引擎时无法溢写，只能继续在内存中聚合）
+            Consume(row, input_binding_, !engine_ || table_.GroupCount() < max_groups_);
+        }
+        child_->Close();
+
+        for (auto &part : parts_)
+            part->FinishWrite();
+        if (spilled_)
+            global_log_info(std::string("[HashAgg] 分组数超过上限 ") + std::to_string(max_groups_) +
+                            "，新分组已分 " + std::to_string(kAggSpillPartitions) + " 个分区溢写");
+        global_log_debug(std::string("[HashAgg] 输入 ") + std::to_string(input_rows) + " 行，内存分组 " +
+                         std::to_string(table_.GroupCount()) + " 个");
+    }
+
+    // 聚合下一个非空分区；没有更多分区时返回 false
+    bool HashAggregateOperator::LoadNextPartition()
+    {
+        while (next_part_ < parts_.size())
+        {
+            auto &part = parts_[next_part_++];
+            if (part->GetRowCount() == 0)
+            {
+                part.reset();
+                continue;
+            }
+            table_.Reset(group_keys_.size(), specs_.size());
+            emit_pos_ = 0;
+            part->Rewind();
+            Row row;
+            while (part->Next(row))
+                Consume(row, spill_binding_, true);
+            part.reset(); // 分区已聚合，归还临时页
+            if (table_.GroupCount() > max_groups_)
+                global_log_warn(std::string("[HashAgg] 分区 ") + std::to_string(next_part_ - 1) +
+                                " 分组数仍超过上限（数据倾斜），整体在内存中聚合");
+            return true;
+        }
+        return false;
+    }
+
+    void HashAggregateOperator::EmitGroup(uint32_t g, Row &out) const
+    {
+        const size_t nk = group_keys_.size();
+        out.columns.clear();
+        out.columns.reserve(nk + specs_.size());
+        const TypedValue *key = table_.Key(g);
+        for (size_t k = 0; k < nk; ++k)
+            out.columns.emplace_back(group_keys_[k], key[k].ToString());
+
+        const Accumulator *acc = table_.Accs(g);
+        for (size_t a = 0; a < specs_.size(); ++a)
+            out.columns.emplace_back(AggOutputName(aggregates_[a]), FinalizeAccumulator(acc[a], specs_[a]));
+    }
+
+    bool HashAggregateOperator::Next(Row &out)
+    {
+        while (emit_pos_ >= table_.GroupCount())
+        {
+            if (!LoadNextPartition())
+                return false;
+        }
+        EmitGroup(static_cast<uint32_t>(emit_pos_++), out);
+        return true;
+    }
+
+    void HashAggregateOperator::Close()
+    {
+        table_.Release();
+        parts_.clear();
+    }
+
+    std::vector<std::string> HashAggregateOperator::OutputColumns() const
+    {
+        std::vector<std::string> names = group_keys_;
+        for (const auto &agg : aggregates_)
+            names.push_back(AggOutputName(agg));
+        return names;
+    }
+
+} // namespace minidb
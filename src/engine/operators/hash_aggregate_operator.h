@@ -0,0 +1,149 @@
+// src/engine/operators/hash_aggregate_operator.h
+/**
+ * 哈希聚合（GROUP BY）
+ * - 开放寻址（线性探测）哈希表，键为类型化分组键，每组只保存聚合累加器，
+ *   内存占用与分组数成正比，与输入行数无关
+ * - 分组数超过上限后，已有分组继续在内存中累加，新分组的输入行按键哈希分区溢写到临时页，
+ *   内存分组输出完后再逐个分区聚合
+ * - 输出列顺序：分组列 + 聚合列（别名或 FUNC(col)），输出顺序不保证
+ */
+#pragma once
+
+#include "physical_operators.h"
+#include "spill_file.h"
+#include "typed_value.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    enum class AggFunc
+    {
+        Count,
+        Sum,
+        Avg,
+        Min,
+        Max,
+        Unknown
+    };
+
+    AggFunc AggFuncFromName(const std::string &name);
+
+    struct AggSpec
+    {
+        AggFunc func;
+        std::string column;
+        ValueType type; // 累加类型：SUM/AVG 为 Int 或 Double，MIN/MAX 为列类型
+    };
+
+    // 由聚合表达式与列声明类型得到累加规格
+    std::vector<AggSpec> MakeAggSpecs(const std::vector<AggregateExpr> &aggregates,
+                                      const std::vector<ValueType> &agg_types);
+    // 输出列名：别名或 FUNC(col)
+    std::string AggOutputName(const AggregateExpr &agg);
+
+    struct Accumulator
+    {
+        int64_t rows{0};  // COUNT：组内行数
+        int64_t count{0}; // 非空值个数（AVG 分母）
+        int64_t isum{0};
+        double dsum{0.0};
+        TypedValue best; // MIN / MAX
+    };
+
+    // 累加一个输入值 / 合并两个部分聚合结果 / 输出最终值
+    void AccumulateValue(Accumulator &acc, const AggSpec &spec, const std::string &text);
+    void MergeAccumulator(Accumulator &dst, const Accumulator &src, const AggSpec &spec);
+    std::string FinalizeAccumulator(const Accumulator &acc, const AggSpec &spec);
+
+    // 开放寻址（线性探测）分组表：第 g 组的键为 Key(g)[0..nk)，累加器为 Accs(g)[0..na)
+    class AggHashTable
+    {
+    public:
+        static constexpr uint32_t kNoGroup = UINT32_MAX;
+
+        AggHashTable(size_t num_keys = 0, size_t num_aggs = 0) { Reset(num_keys, num_aggs); }
+
+        void Reset(size_t num_keys, size_t num_aggs);
+        void Release();
+
+        // 查找 key 对应的组；不存在且允许时新建，否则返回 kNoGroup
+        uint32_t FindOrInsert(const TypedKey &key, size_t hash, bool allow_new);
+
+        size_t GroupCount() const { return group_count_; }
+        size_t HashOf(uint32_t g) const { return group_hash_[g]; }
+        const TypedValue *Key(uint32_t g) const { return &keys_[g * num_keys_]; }
+        Accumulator *Accs(uint32_t g) { return &accs_[g * num_aggs_]; }
+        const Accumulator *Accs(uint32_t g) const { return &accs_[g * num_aggs_]; }
+
+    private:
+        void Grow();
+
+        size_t num_keys_{0};
+        size_t num_aggs_{0};
+        std::vector<uint32_t> slots_; // 开放寻址槽，存组号
+        std::vector<size_t> group_hash_;
+        std::vector<TypedValue> keys_;
+        std::vector<Accumulator> accs_;
+        size_t group_count_{0};
+    };
+
+    class HashAggregateOperator : public PhysicalOperator
+    {
+    public:
+        // key_types / agg_types 为分组列 / 聚合列的声明类型，缺省按字符串处理
+        HashAggregateOperator(std::unique_ptr<PhysicalOperator> child,
+                              std::vector<std::string> group_keys,
+                              std::vector<ValueType> key_types,
+                              std::vector<AggregateExpr> aggregates,
+                              std::vector<ValueType> agg_types,
+                              StorageEngine *engine,
+                              size_t max_groups);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+        bool IsSpilled() const { return spilled_; }
+
+    private:
+        // 输入行中各列的定位方式：序号（>= 0）或按列名查找（-1）
+        struct Binding
+        {
+            std::vector<int> key_ords;
+            std::vector<int> agg_ords;
+        };
+
+        void Consume(const Row &row, const Binding &binding, bool allow_new);
+        void SpillRow(const Row &row, const Binding &binding, size_t hash);
+        bool LoadNextPartition();
+        void EmitGroup(uint32_t g, Row &out) const;
+
+        std::unique_ptr<PhysicalOperator> child_;
+        std::vector<std::string> group_keys_;
+        std::vector<ValueType> key_types_;
+        std::vector<AggregateExpr> aggregates_;
+        std::vector<AggSpec> specs_;
+        StorageEngine *engine_;
+        size_t max_groups_;
+
+        AggHashTable table_;
+        TypedKey scratch_key_;
+
+        // 溢写：分区行只保留分组列与聚合列（spill_layout_）
+        std::vector<std::string> spill_layout_;
+        Binding input_binding_, spill_binding_;
+        bool spilled_{false};
+        std::vector<std::unique_ptr<SpillFile>> parts_;
+        size_t next_part_{0};
+
+        size_t emit_pos_{0};
+    };
+
+} // namespace minidb
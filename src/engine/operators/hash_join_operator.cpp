@@ -0,0 +1,340 @@
+// src/engine/operators/hash_join_operator.cpp
+#include "hash_join_operator.h"
+
+#include "expression.h" // ResolveColumnOrdinal
+#include "../../util/logger.h"
+
+#include <algorithm>
+
+namespace minidb
+{
+
+    namespace
+    {
+        constexpr size_t kJoinSpillPartitions = 16;
+        constexpr size_t kSpillRadixBits = 4; // log2(kJoinSpillPartitions)
+        // 第 0 层用哈希的 40..43 位，每深一层右移 4 位；层数用尽后改用块嵌套循环
+        constexpr size_t kSpillTopShift = 40;
+        constexpr size_t kMaxSpillDepth = 8;
+        // 每个哈希表条目的额外开销估计（桶、节点、vector 头）
+        constexpr size_t kHashEntryOverhead = 64;
+
+        inline size_t PartitionOf(const TypedValue &key, size_t depth)
+        {
+            // 用哈希高位分区，避免与哈希表取模使用的低位相关
+            return (key.Hash() >> (kSpillTopShift - kSpillRadixBits * depth)) & (kJoinSpillPartitions - 1);
+        }
+
+        inline size_t EntryBytes(const Row &row, const TypedValue &key)
+        {
+            return EstimateRowBytes(row) + kHashEntryOverhead + key.s.size();
+        }
+    } // namespace
+
+    HashJoinOperator::HashJoinOperator(std::unique_ptr<PhysicalOperator> left,
+                                       std::unique_ptr<PhysicalOperator> right,
+                                       JoinKeySpec key,
+                                       bool build_left,
+                                       StorageEngine *engine,
+                                       size_t memory_budget_bytes)
+        : left_(std::move(left)), right_(std::move(right)), key_(std::move(key)),
+          build_left_(build_left), engine_(engine), budget_(memory_budget_bytes) {}
+
+    TypedValue HashJoinOperator::ExtractKey(const Row &row, int ordinal, const std::string &column) const
+    {
+        if (ordinal >= 0 && static_cast<size_t>(ordinal) < row.columns.size())
+            return TypedValue::Parse(row.columns[ordinal].value, key_.type);
+        for (const auto &c : row.columns)
+            if (c.col_name == column)
+                return TypedValue::Parse(c.value, key_.type);
+        return TypedValue{};
+    }
+
+    void HashJoinOperator::Open()
+    {
+        table_.clear();
+        table_bytes_ = 0;
+        spilled_ = false;
+        spill_parts_.clear();
+        pending_.clear();
+        cur_ = SpillPartition{};
+        block_mode_ = false;
+        spill_depth_ = 0;
+        nested_loop_ = false;
+        peak_table_bytes_ = 0;
+        matches_ = nullptr;
+        match_pos_ = 0;
+        output_rows_ = 0;
+
+        build_col_ = build_left_ ? key_.left_column : key_.right_column;
+        probe_col_ = build_left_ ? key_.right_column : key_.left_column;
+
+        left_->Open();
+        right_->Open();
+        build_layout_ = BuildChild()->OutputColumns();
+        probe_layout_ = ProbeChild()->OutputColumns();
+        build_ord_ = ResolveColumnOrdinal(build_layout_, build_col_);
+        probe_ord_ = ResolveColumnOrdinal(probe_layout_, probe_col_);
+
+        BuildPhase();
+    }
+
+    void HashJoinOperator::BuildPhase()
+    {
+        Row row;
+        size_t build_rows = 0;
+        while (BuildChild()->Next(row))
+        {
+            TypedValue key = ExtractKey(row, build_ord_, build_col_);
+            if (key.IsNull())
+                continue; // NULL 键不参与等值连接
+            ++build_rows;
+
+            if (spilled_)
+            {
+                AppendBuild(spill_parts_[PartitionOf(key, 0)], row, key);
+                continue;
+            }
+
+            table_bytes_ += EntryBytes(row, key);
+            peak_table_bytes_ = std::max(peak_table_bytes_, table_bytes_);
+            table_[std::move(key)].push_back(std::move(row));
+            if (engine_ && table_bytes_ > budget_)
+                SpillTableToPartitions();
+        }
+
+        if (!spilled_)
+        {
+            global_log_debug(std::string("[HashJoin] 构建侧 ") + std::to_string(build_rows) + " 行，内存哈希表 " +
+                             std::to_string(table_.size()) + " 个键");
+            return;
+        }
+
+        for (auto &part : spill_parts_)
+            part.build->FinishWrite();
+        PartitionProbeSide();
+        global_log_info(std::string("[HashJoin] 构建侧超出内存预算 ") + std::to_string(budget_) + " 字节，已分 " +
+                        std::to_string(kJoinSpillPartitions) + " 个分区溢写，构建侧 " + std::to_string(build_rows) + " 行");
+
+        // 逆序入栈，按分区号顺序处理
+        for (auto it = spill_parts_.rbegin(); it != spill_parts_.rend(); ++it)
+            pending_.push_back(std::move(*it));
+        spill_parts_.clear();
+        NextPartition();
+    }
+
+    std::vector<HashJoinOperator::SpillPartition> HashJoinOperator::MakePartitions(size_t depth) const
+    {
+        std::vector<SpillPartition> parts(kJoinSpillPartitions);
+        for (auto &part : parts)
+        {
+            part.build = std::make_unique<SpillFile>(engine_, build_layout_);
+            part.probe = std::make_unique<SpillFile>(engine_, probe_layout_);
+            part.depth = depth;
+        }
+        return parts;
+    }
+
+    void HashJoinOperator::AppendBuild(SpillPartition &part, const Row &row, const TypedValue &key)
+    {
+        if (part.build->GetRowCount() == 0)
+            part.first_key = key;
+        else if (part.single_key && !(key == part.first_key))
+            part.single_key = false;
+        part.build->Append(row);
+        part.build_bytes += EntryBytes(row, key);
+    }
+
+    // 切换到分区模式：把已在内存中的构建行按分区写出
+    void HashJoinOperator::SpillTableToPartitions()
+    {
+        spilled_ = true;
+        spill_parts_ = MakePartitions(0);
+        for (auto &entry : table_)
+        {
+            auto &part = spill_parts_[PartitionOf(entry.first, 0)];
+            for (const auto &r : entry.second)
+                AppendBuild(part, r, entry.first);
+        }
+        table_.clear();
+        table_bytes_ = 0;
+    }
+
+    void HashJoinOperator::PartitionProbeSide()
+    {
+        Row row;
+        while (ProbeChild()->Next(row))
+        {
+            TypedValue key = ExtractKey(row, probe_ord_, probe_col_);
+            if (key.IsNull())
+                continue;
+            spill_parts_[PartitionOf(key, 0)].probe->Append(row);
+        }
+        for (auto &part : spill_parts_)
+            part.probe->FinishWrite();
+    }
+
+    // 按哈希的下一段位把一个分区的两侧再分一次，子分区入栈；父分区的临时页随即归还
+    void HashJoinOperator::Repartition(SpillPartition &part)
+    {
+        std::vector<SpillPartition> children = MakePartitions(part.depth + 1);
+        spill_depth_ = std::max(spill_depth_, part.depth + 1);
+
+        Row row;
+        part.build->Rewind();
+        while (part.build->Next(row))
+        {
+            TypedValue key = ExtractKey(row, build_ord_, build_col_);
+            AppendBuild(children[PartitionOf(key, part.depth + 1)], row, key);
+        }
+        part.build.reset();
+        part.probe->Rewind();
+        while (part.probe->Next(row))
+            children[PartitionOf(ExtractKey(row, probe_ord_, probe_col_), part.depth + 1)].probe->Append(row);
+        part.probe.reset();
+
+        for (auto it = children.rbegin(); it != children.rend(); ++it)
+        {
+            it->build->FinishWrite();
+            it->probe->FinishWrite();
+            pending_.push_back(std::move(*it));
+        }
+    }
+
+    // 取下一个可在预算内处理的分区并载入其构建侧（或第一块）
+    bool HashJoinOperator::NextPartition()
+    {
+        table_.clear();
+        table_bytes_ = 0;
+        while (!pending_.empty())
+        {
+            SpillPartition part = std::move(pending_.back());
+            pending_.pop_back();
+            if (part.build->GetRowCount() == 0 || part.probe->GetRowCount() == 0)
+                continue; // 一侧为空的分区不会产生结果
+            if (part.build_bytes > budget_ && !part.single_key && part.depth < kMaxSpillDepth)
+            {
+                Repartition(part);
+                continue;
+            }
+
+            cur_ = std::move(part);
+            block_mode_ = cur_.build_bytes > budget_;
+            if (block_mode_)
+            {
+                nested_loop_ = true;
+                global_log_warn(std::string("[HashJoin] 分区（第 ") + std::to_string(cur_.depth) + " 层）" +
+                                (cur_.single_key ? "只含单个键" : "分区层数用尽") + "，仍超出内存预算，按块嵌套循环连接");
+            }
+            cur_.build->Rewind();
+            LoadBuildBlock();
+            cur_.probe->Rewind();
+            return true;
+        }
+        return false;
+    }
+
+    // 载入当前分区构建侧的下一块（非分块模式下为整个分区）；构建侧读完时返回 false
+    bool HashJoinOperator::LoadBuildBlock()
+    {
+        table_.clear();
+        table_bytes_ = 0;
+        if (!cur_.build)
+            return false;
+
+        Row row;
+        bool loaded = false;
+        while ((!block_mode_ || table_bytes_ < budget_) && cur_.build->Next(row))
+        {
+            TypedValue key = ExtractKey(row, build_ord_, build_col_);
+            table_bytes_ += EntryBytes(row, key);
+            table_[std::move(key)].push_back(std::move(row));
+            loaded = true;
+        }
+        peak_table_bytes_ = std::max(peak_table_bytes_, table_bytes_);
+        if (!block_mode_ || !loaded)
+            cur_.build.reset(); // 构建侧已全部载入，归还临时页
+        return loaded;
+    }
+
+    bool HashJoinOperator::NextProbeRow(Row &out)
+    {
+        if (!spilled_)
+            return ProbeChild()->Next(out);
+
+        while (cur_.probe)
+        {
+            if (cur_.probe->Next(out))
+                return true;
+            // 分块模式：载入构建侧下一块，探测分区从头再扫一遍
+            if (block_mode_ && LoadBuildBlock())
+            {
+                cur_.probe->Rewind();
+                continue;
+            }
+            cur_ = SpillPartition{};
+            if (!NextPartition())
+                break;
+        }
+        table_.clear();
+        return false;
+    }
+
+    Row HashJoinOperator::Combine(const Row &probe, const Row &build) const
+    {
+        const Row &l = build_left_ ? build : probe;
+        const Row &r = build_left_ ? probe : build;
+        Row out;
+        out.columns.reserve(l.columns.size() + r.columns.size());
+        out.columns.insert(out.columns.end(), l.columns.begin(), l.columns.end());
+        out.columns.insert(out.columns.end(), r.columns.begin(), r.columns.end());
+        return out;
+    }
+
+    bool HashJoinOperator::Next(Row &out)
+    {
+        while (true)
+        {
+            if (matches_ && match_pos_ < matches_->size())
+            {
+                out = Combine(probe_row_, (*matches_)[match_pos_++]);
+                ++output_rows_;
+                return true;
+            }
+            matches_ = nullptr;
+            match_pos_ = 0;
+
+            if (!NextProbeRow(probe_row_))
+                return false;
+            TypedValue key = ExtractKey(probe_row_, probe_ord_, probe_col_);
+            if (key.IsNull())
+                continue;
+            auto it = table_.find(key);
+            if (it != table_.end())
+                matches_ = &it->second;
+        }
+    }
+
+    void HashJoinOperator::Close()
+    {
+        left_->Close();
+        right_->Close();
+        table_.clear();
+        spill_parts_.clear();
+        pending_.clear();
+        cur_ = SpillPartition{};
+        matches_ = nullptr;
+        global_log_debug(std::string("[HashJoin] 输出 ") + std::to_string(output_rows_) + " 行" + (spilled_ ? "（分区溢写）" : ""));
+    }
+
+    std::vector<std::string> HashJoinOperator::OutputColumns() const
+    {
+        std::vector<std::string> names = left_->OutputColumns();
+        std::vector<std::string> right = right_->OutputColumns();
+        if (names.empty() || right.empty())
+            return {}; // 任一侧布局未知，整体视为未知
+        names.insert(names.end(), right.begin(), right.end());
+        return names;
+    }
+
+} // namespace minidb
@@ -0,0 +1,112 @@
+// src/engine/operators/hash_join_operator.h
+/**
+ * 等值哈希连接（build / probe）
+ * - 构建侧按类型化连接键建哈希表，探测侧逐行流式探测
+ * - 构建侧超出内存预算时转为分区模式（Grace Hash Join）：
+ *   两侧按键哈希分区溢写到临时页，再逐个分区构建 / 探测；
+ *   仍超出预算的分区按哈希的下一段位递归再分区，
+ *   只剩单个键（或分区层数用尽）时按预算大小分块载入构建侧，每块各扫一遍探测分区（块嵌套循环）
+ * - 输出列顺序固定为 左表列 + 右表列，与构建侧选择无关
+ */
+#pragma once
+
+#include "physical_operators.h"
+#include "spill_file.h"
+#include "typed_value.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace minidb
+{
+
+    struct JoinKeySpec
+    {
+        std::string left_column;  // 左输入中的连接列
+        std::string right_column; // 右输入中的连接列
+        ValueType type{ValueType::String};
+    };
+
+    class HashJoinOperator : public PhysicalOperator
+    {
+    public:
+        HashJoinOperator(std::unique_ptr<PhysicalOperator> left,
+                         std::unique_ptr<PhysicalOperator> right,
+                         JoinKeySpec key,
+                         bool build_left,
+                         StorageEngine *engine,
+                         size_t memory_budget_bytes);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+        bool IsSpilled() const { return spilled_; }
+        size_t GetSpillDepth() const { return spill_depth_; }
+        bool UsedNestedLoop() const { return nested_loop_; }
+        size_t GetPeakTableBytes() const { return peak_table_bytes_; }
+
+    private:
+        using HashTable = std::unordered_map<TypedValue, std::vector<Row>, TypedValueHash>;
+
+        // 一对溢写分区；depth 决定用哈希的哪一段位分区
+        struct SpillPartition
+        {
+            std::unique_ptr<SpillFile> build;
+            std::unique_ptr<SpillFile> probe;
+            size_t depth{0};
+            size_t build_bytes{0}; // 构建行载入内存的估计大小
+            bool single_key{true};
+            TypedValue first_key;
+        };
+
+        PhysicalOperator *BuildChild() const { return build_left_ ? left_.get() : right_.get(); }
+        PhysicalOperator *ProbeChild() const { return build_left_ ? right_.get() : left_.get(); }
+
+        TypedValue ExtractKey(const Row &row, int ordinal, const std::string &column) const;
+        void BuildPhase();
+        std::vector<SpillPartition> MakePartitions(size_t depth) const;
+        void AppendBuild(SpillPartition &part, const Row &row, const TypedValue &key);
+        void SpillTableToPartitions();
+        void PartitionProbeSide();
+        void Repartition(SpillPartition &part);
+        bool NextPartition();
+        bool LoadBuildBlock();
+        bool NextProbeRow(Row &out);
+        Row Combine(const Row &probe, const Row &build) const;
+
+        std::unique_ptr<PhysicalOperator> left_;
+        std::unique_ptr<PhysicalOperator> right_;
+        JoinKeySpec key_;
+        bool build_left_;
+        StorageEngine *engine_;
+        size_t budget_;
+
+        std::string build_col_, probe_col_;
+        int build_ord_{-1}, probe_ord_{-1};
+        std::vector<std::string> build_layout_, probe_layout_;
+
+        HashTable table_;
+        size_t table_bytes_{0};
+
+        // 分区模式
+        bool spilled_{false};
+        std::vector<SpillPartition> spill_parts_; // 第一层分区（构建 / 探测侧写入中）
+        std::vector<SpillPartition> pending_;     // 待处理的分区（栈）
+        SpillPartition cur_;
+        bool block_mode_{false};                  // cur_ 的构建侧按块载入
+        size_t spill_depth_{0};
+        bool nested_loop_{false};
+        size_t peak_table_bytes_{0};
+
+        // 探测状态
+        Row probe_row_;
+        const std::vector<Row> *matches_{nullptr};
+        size_t match_pos_{0};
+        size_t output_rows_{0};
+    };
+
+} // namespace minidb
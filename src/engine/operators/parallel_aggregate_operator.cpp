@@ -0,0 +1,236 @@
+// src/engine/operators/parallel_aggregate_operator.cpp
+#include "parallel_aggregate_operator.h"
+
+#include "expression.h" // ResolveColumnOrdinal
+#include "../../util/logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace minidb
+{
+
+    namespace
+    {
+        const std::string kEmptyValue;
+
+        inline const std::string &ValueAt(const Row &row, int ord, const std::string &name)
+        {
+            if (ord >= 0 && static_cast<size_t>(ord) < row.columns.size())
+                return row.columns[ord].value;
+            for (const auto &c : row.columns)
+                if (c.col_name == name)
+                    return c.value;
+            return kEmptyValue;
+        }
+
+        // 分区数取不小于 4 倍线程数的 2 的幂，合并阶段各线程负载更均衡
+        size_t PartitionCountFor(size_t degree)
+        {
+            size_t n = 16;
+            while (n < degree * 4)
+                n <<= 1;
+            return n;
+        }
+
+        // 用哈希高位分区，低位留给分区内的开放寻址表
+        inline size_t PartitionOf(size_t hash, size_t parts)
+        {
+            return (hash >> 48) & (parts - 1);
+        }
+    } // namespace
+
+    ParallelHashAggregateOperator::ParallelHashAggregateOperator(std::unique_ptr<ParallelSeqScanOperator> scan,
+                                                                 std::vector<std::string> group_keys,
+                                                                 std::vector<ValueType> key_types,
+                                                                 std::vector<AggregateExpr> aggregates,
+                                                                 std::vector<ValueType> agg_types,
+                                                                 size_t max_groups)
+        : scan_(std::move(scan)), group_keys_(std::move(group_keys)), key_types_(std::move(key_types)),
+          aggregates_(std::move(aggregates)), agg_types_(std::move(agg_types)), max_groups_(max_groups)
+    {
+        key_types_.resize(group_keys_.size(), ValueType::String);
+        specs_ = MakeAggSpecs(aggregates_, agg_types_);
+    }
+
+    void ParallelHashAggregateOperator::Open()
+    {
+        if (fallback_)
+        {
+            fallback_->Open();
+            return;
+        }
+        const size_t degree = scan_->GetDegree();
+        const size_t parts = PartitionCountFor(degree);
+        const size_t nk = group_keys_.size(), na = specs_.size();
+        locals_.assign(degree, std::vector<AggHashTable>(parts, AggHashTable(nk, na)));
+        partitions_.assign(parts, AggHashTable(nk, na));
+        emit_part_ = 0;
+        emit_group_ = 0;
+
+        std::vector<std::string> layout = scan_->OutputColumns();
+        std::vector<int> key_ords, agg_ords;
+        for (const auto &col : group_keys_)
+            key_ords.push_back(ResolveColumnOrdinal(layout, col));
+        for (const auto &spec : specs_)
+            agg_ords.push_back(ResolveColumnOrdinal(layout, spec.column));
+
+        // 阶段一：线程本地预聚合；本地分组总数即常驻内存的分组数，超出上限时停止扫描
+        std::vector<TypedKey> scratch(degree, TypedKey(nk));
+        std::vector<size_t> input_rows(degree, 0);
+        std::atomic<size_t> local_groups{0};
+        std::atomic<bool> over_budget{false};
+        scan_->ParallelForEach([&](size_t w, std::vector<Row> &rows)
+                               {
+            TypedKey &key = scratch[w];
+            size_t added = 0;
+            for (const Row &row : rows)
+            {
+                for (size_t k = 0; k < nk; ++k)
+                    key[k] = TypedValue::Parse(ValueAt(row, key_ords[k], group_keys_[k]), key_types_[k]);
+                size_t hash = TypedKeyHash{}(key);
+                AggHashTable &table = locals_[w][PartitionOf(hash, parts)];
+                const size_t before = table.GroupCount();
+                Accumulator *acc = table.Accs(table.FindOrInsert(key, hash, true));
+                added += table.GroupCount() - before;
+                for (size_t a = 0; a < na; ++a)
+                    AccumulateValue(acc[a], specs_[a], ValueAt(row, agg_ords[a], specs_[a].column));
+            }
+            input_rows[w] += rows.size();
+            if (added > 0 && local_groups.fetch_add(added) + added > max_groups_)
+            {
+                over_budget.store(true);
+                scan_->RequestStop();
+            } });
+        if (over_budget.load())
+        {
+            FallBack();
+            return;
+        }
+
+        // 阶段二：按分区并行合并
+        std::atomic<size_t> next_part{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto merge = [&]()
+        {
+            try
+            {
+                for (size_t p = next_part++; p < parts; p = next_part++)
+                    MergePartition(p);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lk(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < degree; ++t)
+            threads.emplace_back(merge);
+        merge();
+        for (auto &t : threads)
+            t.join();
+        locals_.clear();
+        if (error)
+            std::rethrow_exception(error);
+
+        size_t groups = 0, rows = 0;
+        for (const auto &part : partitions_)
+            groups += part.GroupCount();
+        for (size_t n : input_rows)
+            rows += n;
+        global_log_debug(std::string("[ParallelHashAgg] ") + std::to_string(degree) + " 个线程聚合 " +
+                         std::to_string(rows) + " 行，" + std::to_string(parts) + " 个分区共 " +
+                         std::to_string(groups) + " 个分组");
+    }
+
+    // 放弃已有的部分聚合，在同一扫描上用可溢写的 HashAggregateOperator 重新聚合
+    void ParallelHashAggregateOperator::FallBack()
+    {
+        locals_.clear();
+        partitions_.clear();
+        global_log_info(std::string("[ParallelHashAgg] 表 ") + scan_->GetSchema().table_name + " 分组数超过上限 " +
+                        std::to_string(max_groups_) + "，改用可溢写的哈希聚合");
+        StorageEngine *engine = scan_->GetEngine();
+        fallback_ = std::make_unique<HashAggregateOperator>(std::move(scan_), group_keys_, key_types_, aggregates_,
+                                                            agg_types_, engine, max_groups_);
+        fallback_->Open();
+    }
+
+    // 把各线程的第 p 个分区合并进 partitions_[p]；第一个非空的本地分区直接接管
+    void ParallelHashAggregateOperator::MergePartition(size_t p)
+    {
+        AggHashTable &dst = partitions_[p];
+        const size_t nk = group_keys_.size(), na = specs_.size();
+        TypedKey key(nk);
+        for (auto &local : locals_)
+        {
+            AggHashTable &src = local[p];
+            if (src.GroupCount() == 0)
+                continue;
+            if (dst.GroupCount() == 0)
+            {
+                std::swap(dst, src);
+                continue;
+            }
+            for (uint32_t g = 0; g < src.GroupCount(); ++g)
+            {
+                std::copy(src.Key(g), src.Key(g) + nk, key.begin());
+                Accumulator *acc = dst.Accs(dst.FindOrInsert(key, src.HashOf(g), true));
+                const Accumulator *part = src.Accs(g);
+                for (size_t a = 0; a < na; ++a)
+                    MergeAccumulator(acc[a], part[a], specs_[a]);
+            }
+            src.Release();
+        }
+    }
+
+    bool ParallelHashAggregateOperator::Next(Row &out)
+    {
+        if (fallback_)
+            return fallback_->Next(out);
+        while (emit_part_ < partitions_.size() && emit_group_ >= partitions_[emit_part_].GroupCount())
+        {
+            partitions_[emit_part_++].Release();
+            emit_group_ = 0;
+        }
+        if (emit_part_ >= partitions_.size())
+            return false;
+
+        const AggHashTable &table = partitions_[emit_part_];
+        const uint32_t g = emit_group_++;
+        const TypedValue *key = table.Key(g);
+        const Accumulator *acc = table.Accs(g);
+        out.columns.clear();
+        out.columns.reserve(group_keys_.size() + specs_.size());
+        for (size_t k = 0; k < group_keys_.size(); ++k)
+            out.columns.emplace_back(group_keys_[k], key[k].ToString());
+        for (size_t a = 0; a < specs_.size(); ++a)
+            out.columns.emplace_back(AggOutputName(aggregates_[a]), FinalizeAccumulator(acc[a], specs_[a]));
+        return true;
+    }
+
+    void ParallelHashAggregateOperator::Close()
+    {
+        if (fallback_)
+            fallback_->Close();
+        locals_.clear();
+        partitions_.clear();
+        emit_part_ = 0;
+        emit_group_ = 0;
+    }
+
+    std::vector<std::string> ParallelHashAggregateOperator::OutputColumns() const
+    {
+        std::vector<std::string> names = group_keys_;
+        for (const auto &agg : aggregates_)
+            names.push_back(AggOutputName(agg));
+        return names;
+    }
+
+} // namespace minidb
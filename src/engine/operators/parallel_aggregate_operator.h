@@ -0,0 +1,63 @@
+// src/engine/operators/parallel_aggregate_operator.h
+/**
+ * 并行哈希聚合（GROUP BY 直接建在并行顺序扫描之上）
+ * - 扫描线程各自维护线程本地的部分聚合表，按分组键哈希分成若干分区，无锁累加
+ * - 扫描结束后按分区并行合并：每个线程领取一个分区，把所有线程的同号分区合并成最终分组
+ * - 与 HashAggregateOperator 共用累加器与分组表（AggHashTable），输出列相同，输出顺序不保证
+ * - 线程本地分组总数超过 max_groups 时停止扫描、丢弃部分结果，改由可溢写的 HashAggregateOperator
+ *   在同一扫描上重新聚合，内存仍受 exec_agg_max_groups 约束
+ */
+#pragma once
+
+#include "hash_aggregate_operator.h"
+#include "parallel_scan_operator.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    class ParallelHashAggregateOperator : public PhysicalOperator
+    {
+    public:
+        ParallelHashAggregateOperator(std::unique_ptr<ParallelSeqScanOperator> scan,
+                                      std::vector<std::string> group_keys,
+                                      std::vector<ValueType> key_types,
+                                      std::vector<AggregateExpr> aggregates,
+                                      std::vector<ValueType> agg_types,
+                                      size_t max_groups);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+        size_t GetPartitionCount() const { return partitions_.size(); }
+        // 是否因分组数超出上限改用了可溢写的哈希聚合
+        bool UsedFallback() const { return fallback_ != nullptr; }
+        bool IsSpilled() const { return fallback_ && fallback_->IsSpilled(); }
+
+    private:
+        void MergePartition(size_t p);
+        void FallBack();
+
+        std::unique_ptr<ParallelSeqScanOperator> scan_;
+        std::vector<std::string> group_keys_;
+        std::vector<ValueType> key_types_;
+        std::vector<AggregateExpr> aggregates_;
+        std::vector<ValueType> agg_types_;
+        std::vector<AggSpec> specs_;
+        size_t max_groups_;
+        std::unique_ptr<HashAggregateOperator> fallback_;
+
+        // locals_[w][p]：线程 w 的第 p 个分区；合并后 partitions_[p] 为最终分组
+        std::vector<std::vector<AggHashTable>> locals_;
+        std::vector<AggHashTable> partitions_;
+
+        size_t emit_part_{0};
+        uint32_t emit_group_{0};
+    };
+
+} // namespace minidb
@@ -0,0 +1,309 @@
+// src/engine/operators/parallel_join_operator.cpp
+#include "parallel_join_operator.h"
+
+#include "expression.h" // ResolveColumnOrdinal
+#include "../../util/config.h"
+#include "../../util/logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <utility>
+
+namespace minidb
+{
+
+    namespace
+    {
+        // 每个分区的目标大小：构建行与哈希表大致落在一个核的 L2 缓存内
+        constexpr size_t kPartitionTargetBytes = 256 * 1024;
+        constexpr size_t kMaxPartitions = 4096;
+
+        inline size_t NextPowerOfTwo(size_t n)
+        {
+            size_t p = 1;
+            while (p < n)
+                p <<= 1;
+            return p;
+        }
+
+        inline void QualifyRow(Row &row, const std::string &table)
+        {
+            if (table.empty())
+                return;
+            for (auto &col : row.columns)
+                if (col.col_name.find('.') == std::string::npos)
+                    col.col_name.insert(0, table + ".");
+        }
+
+        std::vector<std::string> QualifiedColumns(const ParallelSeqScanOperator &scan, const std::string &table)
+        {
+            std::vector<std::string> names = scan.OutputColumns();
+            if (!table.empty())
+                for (auto &n : names)
+                    if (n.find('.') == std::string::npos)
+                        n.insert(0, table + ".");
+            return names;
+        }
+
+        TypedValue ExtractKey(const Row &row, int ordinal, const std::string &column, ValueType type)
+        {
+            if (ordinal >= 0 && static_cast<size_t>(ordinal) < row.columns.size())
+                return TypedValue::Parse(row.columns[ordinal].value, type);
+            for (const auto &c : row.columns)
+                if (c.col_name == column)
+                    return TypedValue::Parse(c.value, type);
+            return TypedValue{};
+        }
+    } // namespace
+
+    ParallelHashJoinOperator::ParallelHashJoinOperator(std::unique_ptr<ParallelSeqScanOperator> left, std::string left_table,
+                                                       std::unique_ptr<ParallelSeqScanOperator> right, std::string right_table,
+                                                       JoinKeySpec key, bool build_left, size_t build_pages)
+        : left_(std::move(left)), right_(std::move(right)), left_table_(std::move(left_table)),
+          right_table_(std::move(right_table)), key_(std::move(key)), build_left_(build_left), build_pages_(build_pages) {}
+
+    ParallelHashJoinOperator::~ParallelHashJoinOperator()
+    {
+        StopProbe();
+    }
+
+    void ParallelHashJoinOperator::Open()
+    {
+        StopProbe();
+        results_.clear();
+        batch_.clear();
+        batch_pos_ = 0;
+        probe_done_ = false;
+        stop_ = false;
+        error_ = nullptr;
+
+        build_col_ = build_left_ ? key_.left_column : key_.right_column;
+        probe_col_ = build_left_ ? key_.right_column : key_.left_column;
+        build_ord_ = ResolveColumnOrdinal(QualifiedColumns(*BuildScan(), BuildTable()), build_col_);
+        probe_ord_ = ResolveColumnOrdinal(QualifiedColumns(*ProbeScan(), ProbeTable()), probe_col_);
+
+        const size_t degree = std::max(BuildScan()->GetDegree(), ProbeScan()->GetDegree());
+        size_t parts = NextPowerOfTwo(std::max<size_t>(build_pages_ * BuildScan()->GetEngine()->GetPageSize() / kPartitionTargetBytes, 1));
+        parts = std::min(std::max(parts, NextPowerOfTwo(degree * 4)), kMaxPartitions);
+        partitions_.assign(parts, Partition{});
+
+        BuildPartitions();
+
+        max_pending_ = degree * 2;
+        prober_ = std::thread(&ParallelHashJoinOperator::ProbeMain, this);
+    }
+
+    void ParallelHashJoinOperator::BuildPartitions()
+    {
+        ParallelSeqScanOperator *scan = BuildScan();
+        const size_t degree = scan->GetDegree();
+        const size_t parts = partitions_.size();
+
+        // 阶段一：扫描线程把构建行分到线程本地的基数分区
+        std::vector<std::vector<std::vector<Entry>>> locals(degree, std::vector<std::vector<Entry>>(parts));
+        scan->ParallelForEach([&](size_t w, std::vector<Row> &rows)
+                              {
+            auto &local = locals[w];
+            for (Row &row : rows)
+            {
+                QualifyRow(row, BuildTable());
+                TypedValue key = ExtractKey(row, build_ord_, build_col_, key_.type);
+                if (key.IsNull())
+                    continue; // NULL 键不参与等值连接
+                size_t hash = key.Hash();
+                local[PartitionOf(hash)].push_back({hash, std::move(key), std::move(row)});
+            }
+        });
+
+        // 阶段二：按分区并行建表
+        std::atomic<size_t> next_part{0};
+        std::atomic<size_t> build_rows{0};
+        auto build = [&]()
+        {
+            for (size_t p = next_part++; p < parts; p = next_part++)
+            {
+                Partition &part = partitions_[p];
+                size_t n = 0;
+                for (auto &local : locals)
+                    n += local[p].size();
+                part.entries.reserve(n);
+                for (auto &local : locals)
+                {
+                    std::move(local[p].begin(), local[p].end(), std::back_inserter(part.entries));
+                    std::vector<Entry>().swap(local[p]);
+                }
+                part.heads.assign(NextPowerOfTwo(std::max<size_t>(n, 1) * 2), UINT32_MAX);
+                part.next.assign(n, UINT32_MAX);
+                const size_t mask = part.heads.size() - 1;
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    size_t b = part.entries[i].hash & mask;
+                    part.next[i] = part.heads[b];
+                    part.heads[b] = i;
+                }
+                build_rows += n;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < degree; ++t)
+            threads.emplace_back(build);
+        build();
+        for (auto &t : threads)
+            t.join();
+
+        global_log_debug(std::string("[ParallelHashJoin] 构建侧 ") + std::to_string(build_rows.load()) + " 行，" +
+                         std::to_string(parts) + " 个基数分区，" + std::to_string(degree) + " 个线程");
+    }
+
+    // 一个 morsel 的探测行先按构建侧相同的基数位分区（计数 + 散列两遍，分区内保持行序），
+    // 再逐分区探测，同一时刻只访问一个分区的哈希表
+    void ParallelHashJoinOperator::ProbeBatch(std::vector<Row> &rows, std::vector<Row> &out)
+    {
+        struct Probe
+        {
+            size_t hash;
+            uint32_t row;
+            TypedValue key;
+        };
+        const size_t parts = partitions_.size();
+        std::vector<Probe> keyed;
+        keyed.reserve(rows.size());
+        std::vector<uint32_t> offsets(parts + 1, 0);
+        for (uint32_t i = 0; i < rows.size(); ++i)
+        {
+            QualifyRow(rows[i], ProbeTable());
+            TypedValue key = ExtractKey(rows[i], probe_ord_, probe_col_, key_.type);
+            if (key.IsNull())
+                continue;
+            size_t hash = key.Hash();
+            ++offsets[PartitionOf(hash) + 1];
+            keyed.push_back({hash, i, std::move(key)});
+        }
+        for (size_t p = 0; p < parts; ++p)
+            offsets[p + 1] += offsets[p];
+
+        std::vector<Probe> probes(keyed.size());
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (Probe &pr : keyed)
+            probes[cursor[PartitionOf(pr.hash)]++] = std::move(pr);
+
+        for (size_t p = 0; p < parts; ++p)
+        {
+            const Partition &part = partitions_[p];
+            if (offsets[p] == offsets[p + 1] || part.entries.empty())
+                continue;
+            const size_t mask = part.heads.size() - 1;
+            for (uint32_t k = offsets[p]; k < offsets[p + 1]; ++k)
+            {
+                const Probe &pr = probes[k];
+                const Row &probe_row = rows[pr.row];
+                for (uint32_t i = part.heads[pr.hash & mask]; i != UINT32_MAX; i = part.next[i])
+                {
+                    const Entry &e = part.entries[i];
+                    if (e.hash != pr.hash || !(e.key == pr.key))
+                        continue;
+                    const Row &l = build_left_ ? e.row : probe_row;
+                    const Row &r = build_left_ ? probe_row : e.row;
+                    Row joined;
+                    joined.columns.reserve(l.columns.size() + r.columns.size());
+                    joined.columns.insert(joined.columns.end(), l.columns.begin(), l.columns.end());
+                    joined.columns.insert(joined.columns.end(), r.columns.begin(), r.columns.end());
+                    out.push_back(std::move(joined));
+                }
+            }
+        }
+    }
+
+    void ParallelHashJoinOperator::PushOutput(std::vector<Row> &batch)
+    {
+        if (batch.empty())
+            return;
+        std::unique_lock<std::mutex> lk(queue_mutex_);
+        space_cv_.wait(lk, [&] { return stop_ || results_.size() < max_pending_; });
+        if (stop_)
+            return;
+        results_.push_back(std::move(batch));
+        ready_cv_.notify_one();
+    }
+
+    // 探测协调线程：探测侧的扫描线程各自探测并把结果批放入队列
+    void ParallelHashJoinOperator::ProbeMain()
+    {
+        try
+        {
+            ProbeScan()->ParallelForEach([this](size_t, std::vector<Row> &rows)
+                                         {
+                {
+                    std::lock_guard<std::mutex> lk(queue_mutex_);
+                    if (stop_)
+                    {
+                        ProbeScan()->RequestStop();
+                        return;
+                    }
+                }
+                std::vector<Row> out;
+                ProbeBatch(rows, out);
+                PushOutput(out); });
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lk(queue_mutex_);
+            error_ = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lk(queue_mutex_);
+        probe_done_ = true;
+        ready_cv_.notify_one();
+    }
+
+    bool ParallelHashJoinOperator::Next(Row &out)
+    {
+        while (batch_pos_ >= batch_.size())
+        {
+            std::unique_lock<std::mutex> lk(queue_mutex_);
+            ready_cv_.wait(lk, [&] { return error_ || !results_.empty() || probe_done_; });
+            if (error_)
+                std::rethrow_exception(error_);
+            if (results_.empty())
+                return false;
+            batch_ = std::move(results_.front());
+            results_.pop_front();
+            batch_pos_ = 0;
+            space_cv_.notify_one();
+        }
+        out = std::move(batch_[batch_pos_++]);
+        return true;
+    }
+
+    void ParallelHashJoinOperator::StopProbe()
+    {
+        if (!prober_.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lk(queue_mutex_);
+            stop_ = true;
+        }
+        ProbeScan()->RequestStop();
+        space_cv_.notify_all();
+        prober_.join();
+    }
+
+    void ParallelHashJoinOperator::Close()
+    {
+        StopProbe();
+        partitions_.clear();
+        partitions_.shrink_to_fit();
+        results_.clear();
+        batch_.clear();
+        batch_.shrink_to_fit();
+    }
+
+    std::vector<std::string> ParallelHashJoinOperator::OutputColumns() const
+    {
+        std::vector<std::string> names = QualifiedColumns(*left_, left_table_);
+        std::vector<std::string> right = QualifiedColumns(*right_, right_table_);
+        names.insert(names.end(), right.begin(), right.end());
+        return names;
+    }
+
+} // namespace minidb
@@ -0,0 +1,101 @@
+// src/engine/operators/parallel_join_operator.h
+/**
+ * 并行基数分区哈希连接（两侧均为并行顺序扫描的等值连接）
+ * - 构建：扫描线程把构建侧行按键哈希的高位分到 2^k 个分区（线程本地，无锁），
+ *   分区数按构建侧大小选取，使每个分区的哈希表约为 L2 缓存大小；随后各线程按分区并行建表
+ * - 探测：扫描线程每解码一个 morsel，先把其中的行按同样的基数分区归类，再逐分区探测，
+ *   同一时刻只访问一个分区的哈希表；探测侧不物化
+ * - 结果经有界队列交给消费线程，Close 可提前结束探测；输出列为 左表列 + 右表列（带表名前缀），
+ *   输出顺序不保证
+ * - 构建侧整体常驻内存，不溢写；执行器只在构建侧估计不超过 exec_join_memory_bytes 时选用
+ */
+#pragma once
+
+#include "hash_join_operator.h" // JoinKeySpec
+#include "parallel_scan_operator.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace minidb
+{
+
+    class ParallelHashJoinOperator : public PhysicalOperator
+    {
+    public:
+        // left_table / right_table：输出列名前缀（与 QualifyOperator 相同规则）
+        // build_pages：构建侧页数估计，用于选择分区数
+        ParallelHashJoinOperator(std::unique_ptr<ParallelSeqScanOperator> left, std::string left_table,
+                                 std::unique_ptr<ParallelSeqScanOperator> right, std::string right_table,
+                                 JoinKeySpec key, bool build_left, size_t build_pages);
+        ~ParallelHashJoinOperator() override;
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+        size_t GetPartitionCount() const { return partitions_.size(); }
+
+    private:
+        struct Entry
+        {
+            size_t hash;
+            TypedValue key;
+            Row row;
+        };
+
+        // 一个基数分区：entries 上的链式哈希表（heads / next 存条目下标）
+        struct Partition
+        {
+            std::vector<Entry> entries;
+            std::vector<uint32_t> heads;
+            std::vector<uint32_t> next;
+        };
+
+        ParallelSeqScanOperator *BuildScan() const { return build_left_ ? left_.get() : right_.get(); }
+        ParallelSeqScanOperator *ProbeScan() const { return build_left_ ? right_.get() : left_.get(); }
+        const std::string &BuildTable() const { return build_left_ ? left_table_ : right_table_; }
+        const std::string &ProbeTable() const { return build_left_ ? right_table_ : left_table_; }
+
+        size_t PartitionOf(size_t hash) const { return (hash >> 40) & (partitions_.size() - 1); }
+        void BuildPartitions();
+        void ProbeBatch(std::vector<Row> &rows, std::vector<Row> &out);
+        void PushOutput(std::vector<Row> &batch);
+        void ProbeMain();
+        void StopProbe();
+
+        std::unique_ptr<ParallelSeqScanOperator> left_;
+        std::unique_ptr<ParallelSeqScanOperator> right_;
+        std::string left_table_, right_table_;
+        JoinKeySpec key_;
+        bool build_left_;
+        size_t build_pages_;
+
+        std::string build_col_, probe_col_;
+        int build_ord_{-1}, probe_ord_{-1};
+        std::vector<Partition> partitions_;
+
+        // 探测线程产出的结果批（queue_mutex_ 保护）
+        std::thread prober_;
+        std::mutex queue_mutex_;
+        std::condition_variable ready_cv_;
+        std::condition_variable space_cv_;
+        std::deque<std::vector<Row>> results_;
+        size_t max_pending_{0};
+        bool probe_done_{false};
+        bool stop_{false};
+        std::exception_ptr error_;
+
+        std::vector<Row> batch_;
+        size_t batch_pos_{0};
+    };
+
+} // namespace minidb
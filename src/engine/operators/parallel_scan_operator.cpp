@@ -0,0 +1,396 @@
+// src/engine/operators/parallel_scan_operator.cpp
+#include "parallel_scan_operator.h"
+
+#include "../../storage/page/page_utils.h"
+#include "../../util/logger.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace minidb
+{
+
+    namespace
+    {
+        // 离开作用域时 unpin 已取到的页；解码、谓词或 sink 抛出异常时页也不会一直被 pin 住
+        class PagePin
+        {
+        public:
+            PagePin(StorageEngine *engine, page_id_t pid) : engine_(engine), pid_(pid) {}
+            ~PagePin() { engine_->PutPage(pid_, false); }
+            PagePin(const PagePin &) = delete;
+            PagePin &operator=(const PagePin &) = delete;
+
+        private:
+            StorageEngine *engine_;
+            page_id_t pid_;
+        };
+    } // namespace
+
+    ParallelSeqScanOperator::ParallelSeqScanOperator(StorageEngine *engine, TableSchema schema,
+                                                     size_t degree, size_t morsel_pages)
+        : engine_(engine), schema_(std::move(schema)), degree_(std::max<size_t>(degree, 1)),
+          morsel_pages_(std::max<size_t>(morsel_pages, 1)) {}
+
+    ParallelSeqScanOperator::~ParallelSeqScanOperator()
+    {
+        StopWorkers();
+    }
+
+    // 沿页链切出下一个 morsel：只读页头取后继页号，随即 unpin，解码留给领取者在锁外完成。
+    // 相邻页已由缓冲池预读，锁内的页头读取多半命中缓存
+    bool ParallelSeqScanOperator::TakeMorsel(std::vector<page_id_t> &pages, uint64_t &seq)
+    {
+        std::lock_guard<std::mutex> lk(dispatch_mutex_);
+        pages.clear();
+        while (pages.size() < morsel_pages_ && next_page_id_ != INVALID_PAGE_ID)
+        {
+            page_id_t pid = next_page_id_;
+            if (!visited_.insert(pid).second)
+            {
+                next_page_id_ = INVALID_PAGE_ID;
+                break;
+            }
+            Page *page = engine_->GetPage(pid);
+            if (!page)
+            {
+                next_page_id_ = INVALID_PAGE_ID;
+                break;
+            }
+            next_page_id_ = page->GetNextPageId();
+            engine_->PutPage(pid, false);
+            pages.push_back(pid);
+        }
+        if (pages.empty())
+            return false;
+        seq = next_seq_++;
+        return true;
+    }
+
+    bool ParallelSeqScanOperator::ChainExhausted()
+    {
+        std::lock_guard<std::mutex> lk(dispatch_mutex_);
+        return next_page_id_ == INVALID_PAGE_ID;
+    }
+
+    void ParallelSeqScanOperator::SetVectorPredicate(VectorPredicate predicate)
+    {
+        vector_predicate_ = std::move(predicate);
+        filter_decoder_.reset();
+        if (vector_predicate_.Valid())
+            filter_decoder_ = std::make_unique<ChunkDecoder>(schema_, std::vector<int>{vector_predicate_.column});
+    }
+
+    Page *ParallelSeqScanOperator::FetchPage(page_id_t pid)
+    {
+        Page *page = engine_->GetPage(pid);
+        if (!page)
+            throw std::runtime_error("[ParallelSeqScan] 无法读取页 " + std::to_string(pid));
+        return page;
+    }
+
+    void ParallelSeqScanOperator::ScanMorsel(const std::vector<page_id_t> &pages, std::vector<Row> &out)
+    {
+        auto emit = [&](const unsigned char *data, uint16_t len)
+        {
+            Row row = Row::Deserialize(data, len, schema_);
+            if (row.columns.empty())
+                return;
+            if (predicate_ && !predicate_(row))
+                return;
+            out.push_back(std::move(row));
+        };
+
+        DataChunk chunk;
+        std::vector<std::pair<const unsigned char *, uint16_t>> records;
+        if (filter_decoder_)
+            filter_decoder_->Init(chunk);
+
+        for (page_id_t pid : pages)
+        {
+            if (stop_.load(std::memory_order_relaxed))
+                return;
+            Page *page = FetchPage(pid);
+            PagePin pin(engine_, pid);
+            if (filter_decoder_)
+            {
+                // 先按列批量过滤，只把选中的记录解码成 Row
+                chunk.Clear();
+                records.clear();
+                ForEachRow(page, [&](const unsigned char *data, uint16_t len) {
+                    if (filter_decoder_->Append(chunk, data, len))
+                        records.emplace_back(data, len);
+                });
+                ApplyVectorPredicate(vector_predicate_, chunk);
+                for (size_t k = 0; k < chunk.sel_count; ++k)
+                    emit(records[chunk.sel[k]].first, records[chunk.sel[k]].second);
+            }
+            else
+            {
+                ForEachRow(page, emit);
+            }
+            pages_read_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void ParallelSeqScanOperator::ScanMorselChunks(const std::vector<page_id_t> &pages, const ChunkDecoder &decoder,
+                                                   DataChunk &chunk, size_t worker, const ChunkSink &sink)
+    {
+        auto flush = [&]()
+        {
+            if (chunk.count == 0)
+                return;
+            if (vector_predicate_.Valid())
+                ApplyVectorPredicate(vector_predicate_, chunk);
+            if (chunk.ActiveCount() > 0)
+                sink(worker, chunk);
+            chunk.Clear();
+        };
+
+        for (page_id_t pid : pages)
+        {
+            if (stop_.load(std::memory_order_relaxed))
+                break;
+            Page *page = FetchPage(pid);
+            PagePin pin(engine_, pid);
+            ForEachRow(page, [&](const unsigned char *data, uint16_t len) {
+                if (decoder.Append(chunk, data, len) && chunk.count >= kVectorSize)
+                    flush();
+            });
+            pages_read_.fetch_add(1, std::memory_order_relaxed);
+        }
+        flush();
+    }
+
+    void ParallelSeqScanOperator::WorkerLoop()
+    {
+        try
+        {
+            std::vector<page_id_t> pages;
+            uint64_t seq = 0;
+            while (!stop_.load() && TakeMorsel(pages, seq))
+            {
+                std::vector<Row> rows;
+                ScanMorsel(pages, rows);
+
+                std::unique_lock<std::mutex> lk(queue_mutex_);
+                // 领先消费进度太多时等待，限制已解码未交付的行数
+                space_cv_.wait(lk, [&] { return stop_.load() || seq < emit_seq_ + max_pending_; });
+                if (stop_.load())
+                    break;
+                done_.emplace(seq, std::move(rows));
+                if (seq == emit_seq_)
+                    ready_cv_.notify_one();
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lk(queue_mutex_);
+            if (!error_)
+                error_ = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lk(queue_mutex_);
+        --running_;
+        ready_cv_.notify_one();
+    }
+
+    void ParallelSeqScanOperator::ResetScan()
+    {
+        next_page_id_ = schema_.first_page_id;
+        visited_.clear();
+        next_seq_ = 0;
+        done_.clear();
+        emit_seq_ = 0;
+        error_ = nullptr;
+        stop_.store(false);
+        batch_.clear();
+        batch_pos_ = 0;
+        pages_read_.store(0);
+        workers_started_ = 0;
+    }
+
+    void ParallelSeqScanOperator::Open()
+    {
+        StopWorkers();
+        ResetScan();
+        if (!engine_)
+            return;
+        // 不在这里读页：第一个 morsel 留给首次 Next，LIMIT 等提前结束的消费方只读到它需要的页
+        engine_->AdviseSequentialScan(schema_.first_page_id);
+    }
+
+    void ParallelSeqScanOperator::StartWorkers()
+    {
+        max_pending_ = degree_ * 2;
+        running_ = degree_;
+        workers_.reserve(degree_);
+        for (size_t i = 0; i < degree_; ++i)
+            workers_.emplace_back(&ParallelSeqScanOperator::WorkerLoop, this);
+        workers_started_ = degree_;
+        global_log_debug(std::string("[ParallelSeqScan] 表 ") + schema_.table_name + " 启动 " +
+                         std::to_string(degree_) + " 个扫描线程，morsel 大小 " + std::to_string(morsel_pages_) + " 页");
+    }
+
+    void ParallelSeqScanOperator::ForEachMorsel(const MorselFn &fn)
+    {
+        StopWorkers();
+        ResetScan();
+        if (!engine_)
+            return;
+
+        auto run = [&](size_t worker)
+        {
+            std::vector<page_id_t> pages;
+            uint64_t seq = 0;
+            while (!stop_.load() && TakeMorsel(pages, seq))
+                fn(worker, pages);
+        };
+
+        // 与 Open 相同：只有一个 morsel 的小表在调用线程完成
+        std::vector<page_id_t> first;
+        uint64_t seq = 0;
+        if (!TakeMorsel(first, seq))
+            return;
+        fn(0, first);
+        if (ChainExhausted() || stop_.load())
+            return;
+        if (degree_ == 1)
+        {
+            run(0);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(degree_);
+        for (size_t w = 0; w < degree_; ++w)
+        {
+            threads.emplace_back([&, w]()
+                                 {
+                try
+                {
+                    run(w);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lk(queue_mutex_);
+                    if (!error_)
+                        error_ = std::current_exception();
+                    stop_.store(true);
+                } });
+        }
+        for (auto &t : threads)
+            t.join();
+        workers_started_ = degree_;
+        if (error_)
+            std::rethrow_exception(error_);
+    }
+
+    void ParallelSeqScanOperator::ParallelForEach(const BatchSink &sink)
+    {
+        std::vector<std::vector<Row>> scratch(degree_);
+        ForEachMorsel([&](size_t worker, const std::vector<page_id_t> &pages)
+                      {
+            std::vector<Row> &rows = scratch[worker];
+            rows.clear();
+            ScanMorsel(pages, rows);
+            if (!rows.empty())
+                sink(worker, rows); });
+    }
+
+    void ParallelSeqScanOperator::ParallelForEachChunk(const std::vector<int> &columns, const ChunkSink &sink)
+    {
+        if (predicate_)
+            throw std::runtime_error("[ParallelSeqScan] 列式扫描不支持逐行谓词");
+        std::vector<int> decode = columns;
+        if (vector_predicate_.Valid() &&
+            std::find(decode.begin(), decode.end(), vector_predicate_.column) == decode.end())
+            decode.push_back(vector_predicate_.column);
+        ChunkDecoder decoder(schema_, std::move(decode));
+
+        std::vector<DataChunk> chunks(degree_);
+        for (auto &chunk : chunks)
+            decoder.Init(chunk);
+        ForEachMorsel([&](size_t worker, const std::vector<page_id_t> &pages)
+                      { ScanMorselChunks(pages, decoder, chunks[worker], worker, sink); });
+    }
+
+    bool ParallelSeqScanOperator::Next(Row &out)
+    {
+        while (batch_pos_ >= batch_.size())
+        {
+            if (workers_.empty())
+            {
+                // 第一个 morsel 在调用线程完成；之后还要行且页链未结束时才启动工作线程，
+                // degree 为 1 时其余 morsel 也在调用线程上逐个扫描
+                if (!engine_)
+                    return false;
+                if (degree_ > 1 && emit_seq_ > 0)
+                {
+                    if (ChainExhausted())
+                        return false;
+                    StartWorkers();
+                    continue;
+                }
+                std::vector<page_id_t> pages;
+                uint64_t seq = 0;
+                if (!TakeMorsel(pages, seq))
+                    return false;
+                batch_.clear();
+                batch_pos_ = 0;
+                ScanMorsel(pages, batch_);
+                emit_seq_ = seq + 1;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lk(queue_mutex_);
+            ready_cv_.wait(lk, [&] { return error_ || done_.count(emit_seq_) || running_ == 0; });
+            if (error_)
+                std::rethrow_exception(error_);
+            auto it = done_.find(emit_seq_);
+            if (it == done_.end())
+                return false; // 所有线程已退出且没有更多 morsel
+            batch_ = std::move(it->second);
+            batch_pos_ = 0;
+            done_.erase(it);
+            ++emit_seq_;
+            space_cv_.notify_all();
+        }
+        out = std::move(batch_[batch_pos_++]);
+        return true;
+    }
+
+    void ParallelSeqScanOperator::StopWorkers()
+    {
+        if (workers_.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> lk(queue_mutex_);
+            stop_.store(true);
+        }
+        space_cv_.notify_all();
+        for (auto &t : workers_)
+            t.join();
+        workers_.clear();
+        done_.clear();
+    }
+
+    void ParallelSeqScanOperator::Close()
+    {
+        StopWorkers();
+        batch_.clear();
+        batch_.shrink_to_fit();
+        visited_.clear();
+        global_log_debug(std::string("[ParallelSeqScan] 表 ") + schema_.table_name + " 扫描结束，" +
+                         std::to_string(workers_started_) + " 个线程共读取 " + std::to_string(pages_read_.load()) + " 页");
+    }
+
+    std::vector<std::string> ParallelSeqScanOperator::OutputColumns() const
+    {
+        std::vector<std::string> names;
+        names.reserve(schema_.columns.size());
+        for (const auto &col : schema_.columns)
+            names.push_back(col.name);
+        return names;
+    }
+
+} // namespace minidb
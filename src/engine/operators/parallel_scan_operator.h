@@ -0,0 +1,121 @@
+// src/engine/operators/parallel_scan_operator.h
+/**
+ * 并行顺序扫描（morsel 驱动）
+ * - 共享游标在锁内沿页链前进，每次领取时读出 morsel_pages 个后继页号作为一个 morsel（只读页头，不解码）；
+ *   页链不预先走完，只有真正被消费的部分才读页
+ * - N 个工作线程各自领取 morsel，在锁外解码并执行下推的过滤谓词
+ * - 每个 morsel 带序号，消费侧按序号合并，输出顺序与串行页链扫描一致
+ * - Open 不读页：第一个 morsel 由首次 Next 在调用线程解码，消费方还要更多行且页链未结束时才启动线程
+ * - 已完成但尚未被消费的 morsel 数有上限，Close（如 LIMIT 提前结束）会停止并回收工作线程
+ * - ParallelForEach 供并行聚合 / 连接使用：各线程直接在本线程内消费自己解码出的批，不经合并队列
+ * - 向量谓词（VectorPredicate）先把每页记录的谓词列解码成列式批，用 SIMD 内核过滤，
+ *   只有选中的记录才解码成 Row；ParallelForEachChunk 直接交付列式批，供向量化聚合使用
+ * - degree 为 1 时不启动线程，所有 morsel 都在调用线程上按序扫描
+ */
+#pragma once
+
+#include "physical_operators.h"
+#include "data_chunk.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace minidb
+{
+
+    class ParallelSeqScanOperator : public PhysicalOperator
+    {
+    public:
+        // degree: 工作线程数；morsel_pages: 每个 morsel 的页数
+        ParallelSeqScanOperator(StorageEngine *engine, TableSchema schema, size_t degree, size_t morsel_pages);
+        ~ParallelSeqScanOperator() override;
+
+        // 下推的过滤谓词，在工作线程中执行；须按 OutputColumns() 的布局编译且无共享可变状态
+        void SetPredicate(RowPredicate predicate) { predicate_ = std::move(predicate); }
+        // 向量谓词：按页批量求值，可与逐行谓词同时存在（先向量、后逐行）
+        void SetVectorPredicate(VectorPredicate predicate);
+        bool HasPredicate() const { return static_cast<bool>(predicate_) || vector_predicate_.Valid(); }
+        bool HasRowPredicate() const { return static_cast<bool>(predicate_); }
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+        // 用 degree 个线程扫描整张表，每个 morsel 解码（并过滤）出的一批行在解码它的线程上交给
+        // sink(worker, rows)；与 Open/Next/Close 互斥使用。任一线程抛出的异常在所有线程结束后重新抛出
+        using BatchSink = std::function<void(size_t worker, std::vector<Row> &rows)>;
+        void ParallelForEach(const BatchSink &sink);
+        // 让进行中的 ParallelForEach 尽快结束（不再领取新 morsel），可从 sink 或其他线程调用
+        void RequestStop() { stop_.store(true); }
+
+        // 与 ParallelForEach 相同，但交付的是列式批：只解码 columns（schema 列序号）与向量谓词列，
+        // 过滤结果在 chunk 的选择向量中。要求没有逐行谓词
+        using ChunkSink = std::function<void(size_t worker, DataChunk &chunk)>;
+        void ParallelForEachChunk(const std::vector<int> &columns, const ChunkSink &sink);
+
+        const TableSchema &GetSchema() const { return schema_; }
+        StorageEngine *GetEngine() const { return engine_; }
+        size_t GetDegree() const { return degree_; }
+        size_t GetPagesRead() const { return pages_read_.load(); }
+        // 本次扫描实际启动的工作线程数（0 表示在调用线程串行完成）
+        size_t GetWorkerCount() const { return workers_started_; }
+
+    private:
+        // 领取下一个 morsel：返回其序号，页链结束时返回 false
+        bool TakeMorsel(std::vector<page_id_t> &pages, uint64_t &seq);
+        bool ChainExhausted();
+        void ScanMorsel(const std::vector<page_id_t> &pages, std::vector<Row> &out);
+        void ScanMorselChunks(const std::vector<page_id_t> &pages, const ChunkDecoder &decoder, DataChunk &chunk,
+                              size_t worker, const ChunkSink &sink);
+        // 把 morsel 分给 degree 个线程（degree 为 1 时在调用线程），fn(worker, pages) 在领取线程上执行
+        using MorselFn = std::function<void(size_t worker, const std::vector<page_id_t> &pages)>;
+        void ForEachMorsel(const MorselFn &fn);
+        Page *FetchPage(page_id_t pid);
+        void ResetScan();
+        void StartWorkers();
+        void WorkerLoop();
+        void StopWorkers();
+
+        StorageEngine *engine_;
+        TableSchema schema_;
+        size_t degree_;
+        size_t morsel_pages_;
+        RowPredicate predicate_;
+        VectorPredicate vector_predicate_;
+        std::unique_ptr<ChunkDecoder> filter_decoder_; // 只解码向量谓词列
+
+        // 页链切分状态（dispatch_mutex_ 保护）
+        std::mutex dispatch_mutex_;
+        page_id_t next_page_id_{INVALID_PAGE_ID};
+        std::unordered_set<page_id_t> visited_; // 防止页链成环
+        uint64_t next_seq_{0};
+
+        // 完成的 morsel（queue_mutex_ 保护），按序号交付
+        std::mutex queue_mutex_;
+        std::condition_variable ready_cv_;
+        std::condition_variable space_cv_;
+        std::map<uint64_t, std::vector<Row>> done_;
+        uint64_t emit_seq_{0};
+        size_t running_{0};
+        size_t max_pending_{0};
+        std::exception_ptr error_;
+        std::atomic<bool> stop_{false};
+        std::vector<std::thread> workers_;
+        size_t workers_started_{0};
+
+        std::vector<Row> batch_;
+        size_t batch_pos_{0};
+        std::atomic<size_t> pages_read_{0};
+    };
+
+} // namespace minidb
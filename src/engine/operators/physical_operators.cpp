@@ -0,0 +1,336 @@
+// src/engine/operators/physical_operators.cpp
+#include "physical_operators.h"
+
+#include <algorithm>
+#include <optional>
+
+#include "../../storage/page/page_utils.h"
+#include "../../util/logger.h"
+
+namespace minidb
+{
+
+    // Helper: 从 RID 定位并反序列化一行（返回 optional）
+    static std::optional<Row> FetchRowByRID(StorageEngine *storage_engine,
+                                            const RID &rid,
+                                            const TableSchema &schema)
+    {
+        if (!storage_engine)
+            return std::nullopt;
+        Page *page = storage_engine->GetDataPage(rid.page_id);
+        if (!page)
+            return std::nullopt;
+
+        // 检查 slot 合法性
+        uint16_t slot_count = page->GetSlotCount();
+        if (rid.slot >= slot_count)
+        {
+            storage_engine->PutPage(page->GetPageId(), false);
+            return std::nullopt;
+        }
+
+        // 通过 page_utils 提取记录指针与长度
+        uint16_t rec_len = 0;
+        const unsigned char *rec_ptr = GetRow(page, rid.slot, &rec_len);
+        if (!rec_ptr || rec_len == 0)
+        {
+            storage_engine->PutPage(page->GetPageId(), false);
+            return std::nullopt;
+        }
+
+        Row row = Row::Deserialize(rec_ptr, rec_len, schema);
+        storage_engine->PutPage(page->GetPageId(), false);
+        return row;
+    }
+
+    // ===== SeqScanOperator =====
+
+    SeqScanOperator::SeqScanOperator(StorageEngine *engine, TableSchema schema)
+        : engine_(engine), schema_(std::move(schema)) {}
+
+    SeqScanOperator::SeqScanOperator(StorageEngine *engine, TableSchema schema, std::vector<RID> rids)
+        : engine_(engine), schema_(std::move(schema)), use_rids_(true), rids_(std::move(rids)) {}
+
+    void SeqScanOperator::Open()
+    {
+        rid_pos_ = 0;
+        next_page_id_ = schema_.first_page_id;
+        visited_.clear();
+        page_rows_.clear();
+        row_pos_ = 0;
+        pages_read_ = 0;
+        if (engine_ && !use_rids_)
+            engine_->AdviseSequentialScan(next_page_id_);
+    }
+
+    // 读入页链上的下一页，并一次性把该页所有记录解码为行后立即 unpin
+    bool SeqScanOperator::LoadNextPage()
+    {
+        page_rows_.clear();
+        row_pos_ = 0;
+        while (next_page_id_ != INVALID_PAGE_ID)
+        {
+            page_id_t pid = next_page_id_;
+            if (!visited_.insert(pid).second)
+            {
+                next_page_id_ = INVALID_PAGE_ID;
+                return false;
+            }
+            Page *page = engine_->GetPage(pid);
+            if (!page)
+            {
+                next_page_id_ = INVALID_PAGE_ID;
+                return false;
+            }
+            next_page_id_ = page->GetNextPageId();
+            ForEachRow(page, [&](const unsigned char *data, uint16_t len) {
+                Row row = Row::Deserialize(data, len, schema_);
+                if (!row.columns.empty())
+                    page_rows_.push_back(std::move(row));
+            });
+            engine_->PutPage(pid, false);
+            ++pages_read_;
+            if (!page_rows_.empty())
+                return true;
+        }
+        return false;
+    }
+
+    bool SeqScanOperator::Next(Row &out)
+    {
+        if (!engine_)
+            return false;
+
+        if (use_rids_)
+        {
+            while (rid_pos_ < rids_.size())
+            {
+                auto maybe_row = FetchRowByRID(engine_, rids_[rid_pos_++], schema_);
+                if (maybe_row.has_value())
+                {
+                    out = std::move(maybe_row.value());
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        if (row_pos_ >= page_rows_.size() && !LoadNextPage())
+            return false;
+        out = std::move(page_rows_[row_pos_++]);
+        return true;
+    }
+
+    void SeqScanOperator::Close()
+    {
+        page_rows_.clear();
+        page_rows_.shrink_to_fit();
+        visited_.clear();
+        global_log_debug(std::string("[SeqScanOperator] 表 ") + schema_.table_name + " 扫描结束，读取 " + std::to_string(pages_read_) + " 页");
+    }
+
+    std::vector<std::string> SeqScanOperator::OutputColumns() const
+    {
+        std::vector<std::string> names;
+        names.reserve(schema_.columns.size());
+        for (const auto &col : schema_.columns)
+            names.push_back(col.name);
+        return names;
+    }
+
+    // ===== FilterOperator =====
+
+    FilterOperator::FilterOperator(std::unique_ptr<PhysicalOperator> child, RowPredicate predicate)
+        : child_(std::move(child)), predicate_(std::move(predicate)) {}
+
+    void FilterOperator::Open()
+    {
+        child_->Open();
+    }
+
+    bool FilterOperator::Next(Row &out)
+    {
+        while (child_->Next(out))
+        {
+            if (!predicate_ || predicate_(out))
+                return true;
+        }
+        return false;
+    }
+
+    void FilterOperator::Close()
+    {
+        child_->Close();
+    }
+
+    // ===== ProjectOperator =====
+
+    ProjectOperator::ProjectOperator(std::unique_ptr<PhysicalOperator> child, std::vector<std::string> columns)
+        : child_(std::move(child)), columns_(std::move(columns)) {}
+
+    void ProjectOperator::Open()
+    {
+        child_->Open();
+    }
+
+    bool ProjectOperator::Next(Row &out)
+    {
+        Row input;
+        if (!child_->Next(input))
+            return false;
+
+        if (columns_.empty())
+        {
+            out = std::move(input);
+            return true;
+        }
+
+        Row projected;
+        projected.columns.reserve(columns_.size());
+        for (const auto &col_name : columns_)
+        {
+            bool found = false;
+            for (auto &input_col : input.columns)
+            {
+                if (input_col.col_name == col_name)
+                {
+                    projected.columns.push_back(std::move(input_col));
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                projected.columns.emplace_back(col_name, "");
+        }
+        out = std::move(projected);
+        return true;
+    }
+
+    void ProjectOperator::Close()
+    {
+        child_->Close();
+    }
+
+    // ===== QualifyOperator =====
+
+    QualifyOperator::QualifyOperator(std::unique_ptr<PhysicalOperator> child, std::string table_name)
+        : child_(std::move(child)), prefix_(std::move(table_name) + ".") {}
+
+    std::string QualifyOperator::Qualify(const std::string &col) const
+    {
+        return col.find('.') == std::string::npos ? prefix_ + col : col;
+    }
+
+    void QualifyOperator::Open()
+    {
+        child_->Open();
+    }
+
+    bool QualifyOperator::Next(Row &out)
+    {
+        if (!child_->Next(out))
+            return false;
+        for (auto &col : out.columns)
+            if (col.col_name.find('.') == std::string::npos)
+                col.col_name.insert(0, prefix_);
+        return true;
+    }
+
+    void QualifyOperator::Close()
+    {
+        child_->Close();
+    }
+
+    std::vector<std::string> QualifyOperator::OutputColumns() const
+    {
+        std::vector<std::string> names = child_->OutputColumns();
+        for (auto &n : names)
+            n = Qualify(n);
+        return names;
+    }
+
+    // ===== LimitOperator =====
+
+    LimitOperator::LimitOperator(std::unique_ptr<PhysicalOperator> child, long long limit, long long offset)
+        : child_(std::move(child)), limit_(limit), offset_(offset < 0 ? 0 : offset) {}
+
+    void LimitOperator::Open()
+    {
+        skipped_ = 0;
+        emitted_ = 0;
+        child_open_ = false;
+        if (limit_ == 0)
+            return; // LIMIT 0：子算子不必打开
+        child_->Open();
+        child_open_ = true;
+    }
+
+    void LimitOperator::CloseChild()
+    {
+        if (child_open_)
+        {
+            child_->Close();
+            child_open_ = false;
+        }
+    }
+
+    bool LimitOperator::Next(Row &out)
+    {
+        if (!child_open_)
+            return false;
+        if (limit_ >= 0 && emitted_ >= limit_)
+        {
+            CloseChild();
+            return false;
+        }
+        while (skipped_ < offset_)
+        {
+            if (!child_->Next(out))
+            {
+                CloseChild();
+                return false;
+            }
+            ++skipped_;
+        }
+        if (!child_->Next(out))
+        {
+            CloseChild();
+            return false;
+        }
+        ++emitted_;
+        if (limit_ >= 0 && emitted_ >= limit_)
+            CloseChild(); // 已取够：提前释放子算子持有的页和缓冲
+        return true;
+    }
+
+    void LimitOperator::Close()
+    {
+        CloseChild();
+    }
+
+    // ===== MaterializedOperator =====
+
+    MaterializedOperator::MaterializedOperator(RowProducer producer)
+        : producer_(std::move(producer)) {}
+
+    void MaterializedOperator::Open()
+    {
+        pos_ = 0;
+        rows_ = producer_ ? producer_() : std::vector<Row>{};
+    }
+
+    bool MaterializedOperator::Next(Row &out)
+    {
+        if (pos_ >= rows_.size())
+            return false;
+        out = std::move(rows_[pos_++]);
+        return true;
+    }
+
+    void MaterializedOperator::Close()
+    {
+        rows_.clear();
+        rows_.shrink_to_fit();
+    }
+
+} // namespace minidb
@@ -0,0 +1,180 @@
+// src/engine/operators/physical_operators.h
+/**
+ * 火山模型（Open/Next/Close）物理算子
+ * 每个算子一次向父算子交付一行，流水线阻断算子（排序 / 聚合 / 连接构建侧）按内存预算物化输入，
+ * 见 sort_operator.h / hash_aggregate_operator.h / hash_join_operator.h。
+ */
+#pragma once
+
+#include "plan_node.h"
+#include "Row.h"
+#include "expression.h" // RowPredicate
+#include "../../catalog/catalog.h"
+#include "../../storage/storage_engine.h"
+#include "../../storage/index/bplus_tree.h" // RID
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace minidb
+{
+
+    using RowProducer = std::function<std::vector<Row>()>;
+
+    // 物理算子基类
+    class PhysicalOperator
+    {
+    public:
+        virtual ~PhysicalOperator() = default;
+
+        // 初始化算子状态（可重复 Open，前提是已 Close）
+        virtual void Open() = 0;
+        // 取下一行；没有更多行时返回 false
+        virtual bool Next(Row &out) = 0;
+        // 释放算子占用的资源（页 pin、缓冲行等）
+        virtual void Close() = 0;
+        // 输出行的列名（按列序号）；为空表示布局未知，谓词按列名查找
+        virtual std::vector<std::string> OutputColumns() const { return {}; }
+    };
+
+    // ----------------------
+    // 顺序扫描：按页链逐页解码，或按索引 RID 顺序逐行回表
+    // 任意时刻只持有一页解码出的行
+    // ----------------------
+    class SeqScanOperator : public PhysicalOperator
+    {
+    public:
+        // 页链扫描
+        SeqScanOperator(StorageEngine *engine, TableSchema schema);
+        // 索引顺序扫描（rids 由调用方从 B+ 树取出）
+        SeqScanOperator(StorageEngine *engine, TableSchema schema, std::vector<RID> rids);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+
+        std::vector<std::string> OutputColumns() const override;
+
+        size_t GetPagesRead() const { return pages_read_; }
+        const TableSchema &GetSchema() const { return schema_; }
+
+    private:
+        bool LoadNextPage();
+
+        StorageEngine *engine_;
+        TableSchema schema_;
+
+        bool use_rids_{false};
+        std::vector<RID> rids_;
+        size_t rid_pos_{0};
+
+        page_id_t next_page_id_{INVALID_PAGE_ID};
+        std::unordered_set<page_id_t> visited_; // 防止页链成环
+        std::vector<Row> page_rows_;            // 当前页解码出的一批行
+        size_t row_pos_{0};
+        size_t pages_read_{0};
+    };
+
+    // ----------------------
+    // 过滤
+    // ----------------------
+    class FilterOperator : public PhysicalOperator
+    {
+    public:
+        FilterOperator(std::unique_ptr<PhysicalOperator> child, RowPredicate predicate);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override { return child_->OutputColumns(); }
+
+    private:
+        std::unique_ptr<PhysicalOperator> child_;
+        RowPredicate predicate_;
+    };
+
+    // ----------------------
+    // 投影（列名未命中时补空值，与旧实现保持一致）
+    // ----------------------
+    class ProjectOperator : public PhysicalOperator
+    {
+    public:
+        ProjectOperator(std::unique_ptr<PhysicalOperator> child, std::vector<std::string> columns);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override { return columns_.empty() ? child_->OutputColumns() : columns_; }
+
+    private:
+        std::unique_ptr<PhysicalOperator> child_;
+        std::vector<std::string> columns_;
+    };
+
+    // ----------------------
+    // 列名加表前缀（Join 输入）："col" -> "table.col"，已带前缀的列保持不变
+    // ----------------------
+    class QualifyOperator : public PhysicalOperator
+    {
+    public:
+        QualifyOperator(std::unique_ptr<PhysicalOperator> child, std::string table_name);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+    private:
+        std::string Qualify(const std::string &col) const;
+
+        std::unique_ptr<PhysicalOperator> child_;
+        std::string prefix_;
+    };
+
+    // ----------------------
+    // LIMIT / OFFSET：取够行数后立即关闭子算子，上游扫描不再读取后续页
+    // ----------------------
+    class LimitOperator : public PhysicalOperator
+    {
+    public:
+        // limit < 0 表示不限行数
+        LimitOperator(std::unique_ptr<PhysicalOperator> child, long long limit, long long offset);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override { return child_->OutputColumns(); }
+
+    private:
+        void CloseChild();
+
+        std::unique_ptr<PhysicalOperator> child_;
+        long long limit_;
+        long long offset_;
+        long long skipped_{0};
+        long long emitted_{0};
+        bool child_open_{false};
+    };
+
+    // ----------------------
+    // 物化数据源：包装尚未改为流式的执行路径（如 SHOW TABLES），在 Open 时才求值
+    // ----------------------
+    class MaterializedOperator : public PhysicalOperator
+    {
+    public:
+        explicit MaterializedOperator(RowProducer producer);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+
+    private:
+        RowProducer producer_;
+        std::vector<Row> rows_;
+        size_t pos_{0};
+    };
+
+} // namespace minidb
@@ -28,7 +28,8 @@ enum class PlanType
     Drop,
     CreateProcedure, // 新增：定义存储过程
     CallProcedure,
-    CreateIndex // ✅ 新增：创建索引
+    CreateIndex, // ✅ 新增：创建索引
+    Limit        // LIMIT n OFFSET m
 };
 
 struct AggregateExpr
@@ -38,6 +39,25 @@ struct AggregateExpr
     std::string as_name; // 聚合结果的别名
 };
 
+// 表达式树：WHERE / HAVING 的结构化形式（由 AST 经 JSON 传入），执行器据此一次性编译谓词
+struct PlanExpr
+{
+    enum class Kind
+    {
+        Column,  // 列引用
+        Literal, // 常量
+        Binary   // 二元运算：= != < > <= >= + - * /
+    };
+
+    Kind kind{Kind::Literal};
+    std::string name;      // Column: 列名（可带表名前缀）
+    std::string value;     // Literal: 字面值
+    bool is_string{false}; // Literal: 是否为字符串常量
+    std::string op;        // Binary: 运算符
+    std::shared_ptr<PlanExpr> left;
+    std::shared_ptr<PlanExpr> right;
+};
+
 struct PlanNode
 {
     PlanType type;
@@ -48,17 +68,24 @@ struct PlanNode
     std::vector<minidb::Column> table_columns;
 
     std::string predicate;
+    std::shared_ptr<PlanExpr> predicate_expr; // predicate 的表达式树（可为空，此时回退解析字符串）
     std::vector<std::vector<std::string>> values;
     std::map<std::string, std::string> set_values;
 
     std::vector<std::string> group_keys;
     std::vector<AggregateExpr> aggregates;
     std::string having_predicate;
+    std::shared_ptr<PlanExpr> having_expr;
 
     // 新增字段：OrderBy
     std::vector<std::string> order_by_cols; // 按哪些列排序
     bool order_by_desc{false};              // 是否降序
 
+    // Limit：跳过 offset 行后最多输出 limit 行；
+    // OrderBy 上 limit >= 0 为 Top-N 提示（只需排序结果的前 limit 行）
+    long long limit{-1};
+    long long offset{0};
+
     PlanNode() : type(PlanType::SeqScan) {} // 默认类型，构造时可改
 
     // === 存储过程相关 ===
@@ -0,0 +1,341 @@
+// src/engine/operators/sort_operator.cpp
+#include "sort_operator.h"
+
+#include "expression.h" // ResolveColumnOrdinal
+#include "../../util/logger.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace minidb
+{
+
+    namespace
+    {
+        // 每行排序键与行号的额外开销估计
+        constexpr size_t kSortEntryOverhead = sizeof(TypedKey) + sizeof(TypedValue) + sizeof(uint32_t);
+
+        const std::string kEmptyValue;
+
+        inline const std::string &ValueAt(const Row &row, int ord, const std::string &name)
+        {
+            if (ord >= 0 && static_cast<size_t>(ord) < row.columns.size())
+                return row.columns[ord].value;
+            for (const auto &c : row.columns)
+                if (c.col_name == name)
+                    return c.value;
+            return kEmptyValue;
+        }
+    } // namespace
+
+    ExternalSortOperator::ExternalSortOperator(std::unique_ptr<PhysicalOperator> child,
+                                               std::vector<SortKeySpec> keys,
+                                               StorageEngine *engine,
+                                               size_t memory_budget_bytes,
+                                               size_t merge_fan_in)
+        : child_(std::move(child)), keys_(std::move(keys)), engine_(engine), budget_(memory_budget_bytes),
+          fan_in_(std::max<size_t>(merge_fan_in, 2)) {}
+
+    void ExternalSortOperator::DecodeKey(const Row &row, TypedKey &key) const
+    {
+        key.resize(keys_.size());
+        for (size_t i = 0; i < keys_.size(); ++i)
+            key[i] = TypedValue::Parse(ValueAt(row, key_ords_[i], keys_[i].column), keys_[i].type);
+    }
+
+    bool ExternalSortOperator::KeyLess(const TypedKey &a, const TypedKey &b) const
+    {
+        for (size_t i = 0; i < keys_.size(); ++i)
+        {
+            int c = a[i].Compare(b[i]);
+            if (c != 0)
+                return keys_[i].desc ? c > 0 : c < 0;
+        }
+        return false;
+    }
+
+    void ExternalSortOperator::SortBuffer()
+    {
+        order_.resize(buf_rows_.size());
+        std::iota(order_.begin(), order_.end(), 0u);
+        std::stable_sort(order_.begin(), order_.end(), [this](uint32_t a, uint32_t b)
+                         { return KeyLess(buf_keys_[a], buf_keys_[b]); });
+    }
+
+    // 把当前缓冲排序后写成一个段
+    void ExternalSortOperator::SpillRun()
+    {
+        SortBuffer();
+        auto run = std::make_unique<SpillFile>(engine_, layout_);
+        for (uint32_t i : order_)
+            run->Append(buf_rows_[i]);
+        run->FinishWrite();
+        runs_.push_back(std::move(run));
+        ++run_count_;
+
+        buf_rows_.clear();
+        buf_keys_.clear();
+        order_.clear();
+        buf_bytes_ = 0;
+    }
+
+    void ExternalSortOperator::Open()
+    {
+        buf_rows_.clear();
+        buf_keys_.clear();
+        order_.clear();
+        buf_bytes_ = 0;
+        emit_pos_ = 0;
+        runs_.clear();
+        cursors_.clear();
+        heap_.clear();
+        merging_ = false;
+        run_count_ = 0;
+
+        child_->Open();
+        layout_ = child_->OutputColumns();
+        key_ords_.clear();
+        for (const auto &k : keys_)
+            key_ords_.push_back(ResolveColumnOrdinal(layout_, k.column));
+
+        Row row;
+        TypedKey key;
+        while (child_->Next(row))
+        {
+            DecodeKey(row, key);
+            buf_bytes_ += EstimateRowBytes(row) + kSortEntryOverhead * keys_.size();
+            for (const auto &v : key)
+                buf_bytes_ += v.s.capacity();
+            buf_rows_.push_back(std::move(row));
+            buf_keys_.push_back(std::move(key));
+            if (engine_ && buf_bytes_ > budget_ && buf_rows_.size() > 1)
+                SpillRun();
+        }
+        child_->Close();
+
+        if (runs_.empty())
+        {
+            SortBuffer();
+            global_log_debug(std::string("[Sort] 内存排序 ") + std::to_string(buf_rows_.size()) + " 行");
+            return;
+        }
+
+        if (!buf_rows_.empty())
+            SpillRun();
+        global_log_info(std::string("[Sort] 超出内存预算 ") + std::to_string(budget_) + " 字节，生成 " +
+                        std::to_string(runs_.size()) + " 个有序段，开始归并");
+
+        // 段数过多时先把最前面的 fan_in_ 个段归并成一个，放回最前以保持稳定性
+        while (runs_.size() > fan_in_)
+        {
+            std::vector<std::unique_ptr<SpillFile>> batch;
+            for (size_t i = 0; i < fan_in_; ++i)
+                batch.push_back(std::move(runs_[i]));
+            runs_.erase(runs_.begin(), runs_.begin() + fan_in_);
+
+            auto merged = std::make_unique<SpillFile>(engine_, layout_);
+            StartMerge(std::move(batch));
+            Row out;
+            while (PopMerged(out))
+                merged->Append(out);
+            merged->FinishWrite();
+            cursors_.clear(); // 归还被归并段的临时页
+            runs_.insert(runs_.begin(), std::move(merged));
+        }
+
+        StartMerge(std::move(runs_));
+        runs_.clear();
+        merging_ = true;
+    }
+
+    // 段 run 前进一行；段读完时返回 false
+    bool ExternalSortOperator::Advance(size_t run)
+    {
+        RunCursor &c = cursors_[run];
+        if (!c.file->Next(c.row))
+            return false;
+        DecodeKey(c.row, c.key);
+        return true;
+    }
+
+    bool ExternalSortOperator::HeapLess(size_t a, size_t b) const
+    {
+        if (KeyLess(cursors_[a].key, cursors_[b].key))
+            return true;
+        if (KeyLess(cursors_[b].key, cursors_[a].key))
+            return false;
+        return a < b;
+    }
+
+    void ExternalSortOperator::SiftDown(size_t pos)
+    {
+        const size_t n = heap_.size();
+        while (true)
+        {
+            size_t smallest = pos;
+            size_t l = pos * 2 + 1, r = l + 1;
+            if (l < n && HeapLess(heap_[l], heap_[smallest]))
+                smallest = l;
+            if (r < n && HeapLess(heap_[r], heap_[smallest]))
+                smallest = r;
+            if (smallest == pos)
+                return;
+            std::swap(heap_[pos], heap_[smallest]);
+            pos = smallest;
+        }
+    }
+
+    void ExternalSortOperator::StartMerge(std::vector<std::unique_ptr<SpillFile>> runs)
+    {
+        cursors_.clear();
+        cursors_.resize(runs.size());
+        heap_.clear();
+        for (size_t i = 0; i < runs.size(); ++i)
+        {
+            cursors_[i].file = std::move(runs[i]);
+            cursors_[i].file->Rewind();
+            if (Advance(i))
+                heap_.push_back(i);
+        }
+        for (size_t i = heap_.size() / 2; i-- > 0;)
+            SiftDown(i);
+    }
+
+    bool ExternalSortOperator::PopMerged(Row &out)
+    {
+        if (heap_.empty())
+            return false;
+        size_t run = heap_[0];
+        out = std::move(cursors_[run].row);
+        if (Advance(run))
+        {
+            SiftDown(0);
+        }
+        else
+        {
+            cursors_[run].file.reset(); // 段已读完，归还临时页
+            heap_[0] = heap_.back();
+            heap_.pop_back();
+            if (!heap_.empty())
+                SiftDown(0);
+        }
+        return true;
+    }
+
+    bool ExternalSortOperator::Next(Row &out)
+    {
+        if (merging_)
+            return PopMerged(out);
+        if (emit_pos_ >= order_.size())
+            return false;
+        out = std::move(buf_rows_[order_[emit_pos_++]]);
+        return true;
+    }
+
+    void ExternalSortOperator::Close()
+    {
+        buf_rows_.clear();
+        buf_rows_.shrink_to_fit();
+        buf_keys_.clear();
+        buf_keys_.shrink_to_fit();
+        order_.clear();
+        order_.shrink_to_fit();
+        runs_.clear();
+        cursors_.clear();
+        heap_.clear();
+        merging_ = false;
+    }
+
+    std::vector<std::string> ExternalSortOperator::OutputColumns() const
+    {
+        return child_->OutputColumns();
+    }
+
+    // ===== TopNOperator =====
+
+    size_t TopNRowBound(const TableSchema &schema, size_t key_count, size_t memory_budget_bytes)
+    {
+        constexpr size_t kShortValueBytes = 16;
+        size_t bytes = sizeof(Row) + sizeof(uint64_t) + kSortEntryOverhead * key_count;
+        for (const auto &col : schema.columns)
+            bytes += sizeof(ColumnValue) + col.name.size() +
+                     (col.length > 0 ? static_cast<size_t>(col.length) : kShortValueBytes);
+        return memory_budget_bytes / bytes;
+    }
+
+    TopNOperator::TopNOperator(std::unique_ptr<PhysicalOperator> child, std::vector<SortKeySpec> keys, size_t n)
+        : child_(std::move(child)), keys_(std::move(keys)), n_(n) {}
+
+    bool TopNOperator::Before(const TypedKey &ka, uint64_t sa, const TypedKey &kb, uint64_t sb) const
+    {
+        for (size_t i = 0; i < keys_.size(); ++i)
+        {
+            int c = ka[i].Compare(kb[i]);
+            if (c != 0)
+                return keys_[i].desc ? c > 0 : c < 0;
+        }
+        return sa < sb;
+    }
+
+    void TopNOperator::Open()
+    {
+        heap_.clear();
+        emit_pos_ = 0;
+        if (n_ == 0)
+            return;
+
+        child_->Open();
+        std::vector<std::string> layout = child_->OutputColumns();
+        std::vector<int> ords;
+        for (const auto &k : keys_)
+            ords.push_back(ResolveColumnOrdinal(layout, k.column));
+
+        auto heap_less = [this](const Entry &a, const Entry &b)
+        { return Before(a.key, a.seq, b.key, b.seq); };
+
+        heap_.reserve(std::min<size_t>(n_, 4096));
+        Row row;
+        TypedKey key(keys_.size());
+        uint64_t seq = 0;
+        while (child_->Next(row))
+        {
+            for (size_t i = 0; i < keys_.size(); ++i)
+                key[i] = TypedValue::Parse(ValueAt(row, ords[i], keys_[i].column), keys_[i].type);
+
+            if (heap_.size() < n_)
+            {
+                heap_.push_back({key, seq++, std::move(row)});
+                std::push_heap(heap_.begin(), heap_.end(), heap_less);
+                continue;
+            }
+            // 不比当前第 n 名靠前的行直接丢弃，不拷贝
+            if (!Before(key, seq, heap_.front().key, heap_.front().seq))
+            {
+                ++seq;
+                continue;
+            }
+            std::pop_heap(heap_.begin(), heap_.end(), heap_less);
+            heap_.back() = {key, seq++, std::move(row)};
+            std::push_heap(heap_.begin(), heap_.end(), heap_less);
+        }
+        child_->Close();
+
+        std::sort_heap(heap_.begin(), heap_.end(), heap_less);
+        global_log_debug(std::string("[TopN] 输入 ") + std::to_string(seq) + " 行，保留前 " + std::to_string(heap_.size()) + " 行");
+    }
+
+    bool TopNOperator::Next(Row &out)
+    {
+        if (emit_pos_ >= heap_.size())
+            return false;
+        out = std::move(heap_[emit_pos_++].row);
+        return true;
+    }
+
+    void TopNOperator::Close()
+    {
+        heap_.clear();
+        heap_.shrink_to_fit();
+    }
+
+} // namespace minidb
@@ -0,0 +1,124 @@
+// src/engine/operators/sort_operator.h
+/**
+ * 外部归并排序（ORDER BY）
+ * - 排序键在读入时按列类型解析一次（TypedKey），比较时不再解析字符串
+ * - 输入在内存预算内时直接内存排序；超出预算时把已排好序的段（run）写入临时页，
+ *   最后 k 路归并；段数超过归并路数时先多趟归并成更少的段
+ * - 相等键保持输入顺序（稳定排序）
+ *
+ * ORDER BY ... LIMIT n 使用 TopNOperator：只维护大小为 n 的有界堆，内存 O(n)，不溢写；
+ * n 超过排序内存预算能容纳的行数（TopNRowBound）时仍走外部排序，再由 Limit 截取
+ */
+#pragma once
+
+#include "physical_operators.h"
+#include "spill_file.h"
+#include "typed_value.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    struct SortKeySpec
+    {
+        std::string column;
+        ValueType type{ValueType::String};
+        bool desc{false};
+    };
+
+    class ExternalSortOperator : public PhysicalOperator
+    {
+    public:
+        ExternalSortOperator(std::unique_ptr<PhysicalOperator> child,
+                             std::vector<SortKeySpec> keys,
+                             StorageEngine *engine,
+                             size_t memory_budget_bytes,
+                             size_t merge_fan_in = 64);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+        size_t GetRunCount() const { return run_count_; }
+
+    private:
+        // 归并时每个段的当前行
+        struct RunCursor
+        {
+            std::unique_ptr<SpillFile> file;
+            Row row;
+            TypedKey key;
+        };
+
+        void DecodeKey(const Row &row, TypedKey &key) const;
+        bool KeyLess(const TypedKey &a, const TypedKey &b) const;
+        void SortBuffer();
+        void SpillRun();
+        bool Advance(size_t run);
+        bool HeapLess(size_t a, size_t b) const;
+        void SiftDown(size_t pos);
+        void StartMerge(std::vector<std::unique_ptr<SpillFile>> runs);
+        bool PopMerged(Row &out);
+
+        std::unique_ptr<PhysicalOperator> child_;
+        std::vector<SortKeySpec> keys_;
+        StorageEngine *engine_;
+        size_t budget_;
+        size_t fan_in_; // 单趟归并路数上限：每路同时只载入一页
+
+        std::vector<std::string> layout_;
+        std::vector<int> key_ords_;
+
+        // 内存缓冲：第 i 行的键为 buf_keys_[i]，order_ 为排序后的行号
+        std::vector<Row> buf_rows_;
+        std::vector<TypedKey> buf_keys_;
+        std::vector<uint32_t> order_;
+        size_t buf_bytes_{0};
+        size_t emit_pos_{0};
+
+        // 归并状态：heap_ 中存段号，堆顶为当前最小行；段号小者在键相等时优先（保持稳定）
+        std::vector<std::unique_ptr<SpillFile>> runs_;
+        std::vector<RunCursor> cursors_;
+        std::vector<size_t> heap_;
+        bool merging_{false};
+        size_t run_count_{0};
+    };
+
+    // 内存预算内 Top-N 堆能容纳的行数：按表结构估计每行字节，VARCHAR 取声明长度，其余列按短值估计
+    size_t TopNRowBound(const TableSchema &schema, size_t key_count, size_t memory_budget_bytes);
+
+    class TopNOperator : public PhysicalOperator
+    {
+    public:
+        TopNOperator(std::unique_ptr<PhysicalOperator> child, std::vector<SortKeySpec> keys, size_t n);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override { return child_->OutputColumns(); }
+
+    private:
+        struct Entry
+        {
+            TypedKey key;
+            uint64_t seq; // 输入序号：键相等时先到者优先
+            Row row;
+        };
+
+        // a 排在 b 之前
+        bool Before(const TypedKey &ka, uint64_t sa, const TypedKey &kb, uint64_t sb) const;
+
+        std::unique_ptr<PhysicalOperator> child_;
+        std::vector<SortKeySpec> keys_;
+        size_t n_;
+
+        std::vector<Entry> heap_; // 最大堆：堆顶为当前保留行中排在最后的一行
+        size_t emit_pos_{0};
+    };
+
+} // namespace minidb
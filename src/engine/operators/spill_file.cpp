@@ -0,0 +1,173 @@
+// src/engine/operators/spill_file.cpp
+#include "spill_file.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "../../storage/page/page_utils.h"
+#include "../../util/logger.h"
+
+namespace minidb
+{
+
+    size_t EstimateRowBytes(const Row &row)
+    {
+        size_t bytes = sizeof(Row);
+        for (const auto &c : row.columns)
+            bytes += sizeof(ColumnValue) + c.col_name.capacity() + c.value.capacity();
+        return bytes;
+    }
+
+    namespace
+    {
+        inline void PutU16(std::vector<char> &buf, uint16_t v)
+        {
+            char b[2];
+            std::memcpy(b, &v, 2);
+            buf.insert(buf.end(), b, b + 2);
+        }
+
+        inline void PutString(std::vector<char> &buf, const std::string &s)
+        {
+            if (s.size() > UINT16_MAX)
+                throw std::runtime_error("[SpillFile] 字段过长，无法溢写");
+            PutU16(buf, static_cast<uint16_t>(s.size()));
+            buf.insert(buf.end(), s.begin(), s.end());
+        }
+
+        inline bool GetU16(const unsigned char *data, uint16_t len, size_t &off, uint16_t &v)
+        {
+            if (off + 2 > len)
+                return false;
+            std::memcpy(&v, data + off, 2);
+            off += 2;
+            return true;
+        }
+
+        inline bool GetString(const unsigned char *data, uint16_t len, size_t &off, std::string &s)
+        {
+            uint16_t n = 0;
+            if (!GetU16(data, len, off, n) || off + n > len)
+                return false;
+            s.assign(reinterpret_cast<const char *>(data + off), n);
+            off += n;
+            return true;
+        }
+    } // namespace
+
+    SpillFile::SpillFile(StorageEngine *engine, std::vector<std::string> layout)
+        : engine_(engine), layout_(std::move(layout)), write_buf_(std::make_unique<Page>(INVALID_PAGE_ID, engine ? engine->GetPageSize() : PAGE_SIZE))
+    {
+        write_buf_->InitializePage(PageType::TEMP_PAGE);
+    }
+
+    SpillFile::~SpillFile()
+    {
+        if (!engine_)
+            return;
+        for (page_id_t pid : pages_)
+            engine_->RemovePage(pid);
+    }
+
+    void SpillFile::Append(const Row &row)
+    {
+        buf_.clear();
+        bool with_names = row.columns.size() != layout_.size();
+        PutU16(buf_, static_cast<uint16_t>(row.columns.size()));
+        buf_.push_back(with_names ? 1 : 0);
+        for (const auto &c : row.columns)
+        {
+            if (with_names)
+                PutString(buf_, c.col_name);
+            PutString(buf_, c.value);
+        }
+
+        if (buf_.size() + SLOT_ENTRY_SIZE > write_buf_->GetPageSize() - PAGE_HEADER_SIZE)
+            throw std::runtime_error("[SpillFile] 单行超过一页，无法溢写");
+
+        if (!AppendRow(write_buf_.get(), buf_.data(), static_cast<uint16_t>(buf_.size())))
+        {
+            FlushWriteBuffer();
+            AppendRow(write_buf_.get(), buf_.data(), static_cast<uint16_t>(buf_.size()));
+        }
+        ++row_count_;
+    }
+
+    void SpillFile::FlushWriteBuffer()
+    {
+        if (write_buf_->GetSlotCount() == 0)
+            return;
+
+        page_id_t pid = INVALID_PAGE_ID;
+        Page *page = engine_->CreatePage(&pid);
+        if (!page)
+            throw std::runtime_error("[SpillFile] 无法分配临时页");
+        std::memcpy(page->GetData(), write_buf_->GetData(), write_buf_->GetPageSize());
+        engine_->PutPage(pid, true);
+        pages_.push_back(pid);
+
+        write_buf_->InitializePage(PageType::TEMP_PAGE);
+    }
+
+    void SpillFile::FinishWrite()
+    {
+        FlushWriteBuffer();
+        global_log_debug(std::string("[SpillFile] 溢写 ") + std::to_string(row_count_) + " 行，" + std::to_string(pages_.size()) + " 页");
+    }
+
+    void SpillFile::Rewind()
+    {
+        read_page_ = 0;
+        read_rows_.clear();
+        read_pos_ = 0;
+    }
+
+    bool SpillFile::LoadPage(size_t index)
+    {
+        read_rows_.clear();
+        read_pos_ = 0;
+        Page *page = engine_->GetPage(pages_[index]);
+        if (!page)
+            throw std::runtime_error("[SpillFile] 无法读取临时页 " + std::to_string(pages_[index]));
+
+        ForEachRow(page, [&](const unsigned char *data, uint16_t len)
+                   {
+            size_t off = 0;
+            uint16_t ncols = 0;
+            if (!GetU16(data, len, off, ncols) || off + 1 > len)
+                return;
+            bool with_names = data[off++] != 0;
+            Row row;
+            row.columns.resize(ncols);
+            for (uint16_t i = 0; i < ncols; ++i)
+            {
+                auto &c = row.columns[i];
+                if (with_names)
+                {
+                    if (!GetString(data, len, off, c.col_name))
+                        return;
+                }
+                else
+                    c.col_name = layout_[i];
+                if (!GetString(data, len, off, c.value))
+                    return;
+            }
+            read_rows_.push_back(std::move(row)); });
+
+        engine_->PutPage(pages_[index], false);
+        return true;
+    }
+
+    bool SpillFile::Next(Row &out)
+    {
+        while (read_pos_ >= read_rows_.size())
+        {
+            if (read_page_ >= pages_.size())
+                return false;
+            LoadPage(read_page_++);
+        }
+        out = std::move(read_rows_[read_pos_++]);
+        return true;
+    }
+
+} // namespace minidb
@@ -0,0 +1,62 @@
+// src/engine/operators/spill_file.h
+/**
+ * 算子溢写文件：内存预算不足时，Join / Aggregate / Sort 把行写入临时页（TEMP_PAGE），
+ * 页通过 StorageEngine（BufferPoolManager -> DiskManager）分配和读写，析构时归还。
+ *
+ * 行编码：[uint16 列数][uint8 是否带列名]{[uint16 名长][名]}[uint16 值长][值]...
+ * 与 layout 列数一致的行只写值，读回时用 layout 补列名。
+ */
+#pragma once
+
+#include "Row.h"
+#include "../../storage/storage_engine.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    // 估算一行在内存中的占用（用于算子内存预算）
+    size_t EstimateRowBytes(const Row &row);
+
+    class SpillFile
+    {
+    public:
+        SpillFile(StorageEngine *engine, std::vector<std::string> layout);
+        ~SpillFile();
+
+        SpillFile(const SpillFile &) = delete;
+        SpillFile &operator=(const SpillFile &) = delete;
+
+        // 追加一行；单行超过一页时抛出 std::runtime_error
+        void Append(const Row &row);
+        // 结束写入（把本地页缓冲落到临时页），之后才能读取
+        void FinishWrite();
+
+        // 从头顺序读取
+        void Rewind();
+        bool Next(Row &out);
+
+        size_t GetRowCount() const { return row_count_; }
+        size_t GetPageCount() const { return pages_.size(); }
+
+    private:
+        void FlushWriteBuffer();
+        bool LoadPage(size_t index);
+
+        StorageEngine *engine_;
+        std::vector<std::string> layout_;
+        std::vector<page_id_t> pages_;
+
+        std::unique_ptr<Page> write_buf_; // 本地页缓冲，写满后一次性拷入新分配的临时页
+        std::vector<char> buf_;
+        size_t row_count_{0};
+
+        size_t read_page_{0};
+        std::vector<Row> read_rows_;
+        size_t read_pos_{0};
+    };
+
+} // namespace minidb
@@ -0,0 +1,169 @@
+// src/engine/operators/typed_value.cpp
+#include "typed_value.h"
+
+#include <charconv>
+#include <cstring>
+#include <functional>
+
+namespace minidb
+{
+
+    ValueType ValueTypeFromSchema(const std::string &type)
+    {
+        if (type == "INT")
+            return ValueType::Int;
+        if (type == "DOUBLE")
+            return ValueType::Double;
+        return ValueType::String;
+    }
+
+    TypedValue TypedValue::Parse(const std::string &text, ValueType type)
+    {
+        TypedValue v;
+        switch (type)
+        {
+        case ValueType::Int:
+        {
+            if (text.empty())
+                return v;
+            const char *b = text.data();
+            const char *e = b + text.size();
+            if (*b == '+')
+                ++b;
+            int64_t x = 0;
+            auto r = std::from_chars(b, e, x);
+            if (r.ec == std::errc() && r.ptr == e)
+            {
+                v.type = ValueType::Int;
+                v.i = x;
+                return v;
+            }
+            // 形如 "3.000000" 的整数值按浮点解析
+            double dx = 0.0;
+            auto rd = std::from_chars(b, e, dx);
+            if (rd.ec == std::errc() && rd.ptr == e)
+            {
+                v.type = ValueType::Int;
+                v.i = static_cast<int64_t>(dx);
+            }
+            return v;
+        }
+        case ValueType::Double:
+        {
+            if (text.empty())
+                return v;
+            const char *b = text.data();
+            const char *e = b + text.size();
+            if (*b == '+')
+                ++b;
+            double x = 0.0;
+            auto r = std::from_chars(b, e, x);
+            if (r.ec == std::errc() && r.ptr == e)
+            {
+                v.type = ValueType::Double;
+                v.d = x;
+            }
+            return v;
+        }
+        case ValueType::String:
+            v.type = ValueType::String;
+            v.s = text;
+            return v;
+        case ValueType::Null:
+            break;
+        }
+        return v;
+    }
+
+    int TypedValue::Compare(const TypedValue &other) const
+    {
+        if (IsNull() || other.IsNull())
+            return (IsNull() ? 0 : 1) - (other.IsNull() ? 0 : 1);
+
+        bool num_a = type == ValueType::Int || type == ValueType::Double;
+        bool num_b = other.type == ValueType::Int || other.type == ValueType::Double;
+        if (num_a && num_b)
+        {
+            if (type == ValueType::Int && other.type == ValueType::Int)
+                return (i < other.i) ? -1 : (i > other.i ? 1 : 0);
+            double a = AsDouble(), b = other.AsDouble();
+            return (a < b) ? -1 : (a > b ? 1 : 0);
+        }
+        int c = (type == ValueType::String && other.type == ValueType::String)
+                    ? s.compare(other.s)
+                    : ToString().compare(other.ToString());
+        return (c < 0) ? -1 : (c > 0 ? 1 : 0);
+    }
+
+    bool TypedValue::operator==(const TypedValue &other) const
+    {
+        if (type != other.type)
+            return false;
+        switch (type)
+        {
+        case ValueType::Null:
+            return true;
+        case ValueType::Int:
+            return i == other.i;
+        case ValueType::Double:
+            return d == other.d;
+        case ValueType::String:
+            return s == other.s;
+        }
+        return false;
+    }
+
+    size_t TypedValue::Hash() const
+    {
+        switch (type)
+        {
+        case ValueType::Null:
+            return 0x9e3779b97f4a7c15ULL;
+        case ValueType::Int:
+        {
+            // splitmix64 终结器：整数键的低位分布更均匀，便于按哈希分区
+            uint64_t x = static_cast<uint64_t>(i) + 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(x ^ (x >> 31));
+        }
+        case ValueType::Double:
+        {
+            double v = (d == 0.0) ? 0.0 : d; // -0.0 与 0.0 同哈希
+            uint64_t bits = 0;
+            std::memcpy(&bits, &v, sizeof(bits));
+            bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(bits ^ (bits >> 31));
+        }
+        case ValueType::String:
+            return std::hash<std::string>{}(s);
+        }
+        return 0;
+    }
+
+    std::string TypedValue::ToString() const
+    {
+        switch (type)
+        {
+        case ValueType::Null:
+            return "";
+        case ValueType::Int:
+            return std::to_string(i);
+        case ValueType::Double:
+            return std::to_string(d);
+        case ValueType::String:
+            return s;
+        }
+        return "";
+    }
+
+    size_t TypedKeyHash::operator()(const TypedKey &key) const
+    {
+        size_t h = 0xcbf29ce484222325ULL;
+        for (const auto &v : key)
+            h = (h ^ v.Hash()) * 0x100000001b3ULL;
+        return h;
+    }
+
+} // namespace minidb
@@ -0,0 +1,63 @@
+// src/engine/operators/typed_value.h
+/**
+ * 类型化值：执行器内部用于 Join 键 / 分组键 / 排序键，
+ * 由 Row 中的字符串值按列类型预先解析一次，之后的比较与哈希都不再解析字符串。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    enum class ValueType
+    {
+        Null,
+        Int,
+        Double,
+        String
+    };
+
+    // 由 schema 的类型名映射（INT / DOUBLE / 其他视为字符串）
+    ValueType ValueTypeFromSchema(const std::string &type);
+
+    struct TypedValue
+    {
+        ValueType type{ValueType::Null};
+        int64_t i{0};
+        double d{0.0};
+        std::string s;
+
+        // 按目标类型解析；数值解析失败或空串得到 Null
+        static TypedValue Parse(const std::string &text, ValueType type);
+
+        bool IsNull() const { return type == ValueType::Null; }
+        double AsDouble() const { return type == ValueType::Int ? static_cast<double>(i) : d; }
+
+        // Null 排在最前；数值之间按数值比较，其余按字符串比较
+        int Compare(const TypedValue &other) const;
+        bool operator==(const TypedValue &other) const;
+        bool operator!=(const TypedValue &other) const { return !(*this == other); }
+
+        size_t Hash() const;
+        // 还原为 Row 使用的字符串表示
+        std::string ToString() const;
+    };
+
+    struct TypedValueHash
+    {
+        size_t operator()(const TypedValue &v) const { return v.Hash(); }
+    };
+
+    // 多列键（分组键 / 排序键）
+    using TypedKey = std::vector<TypedValue>;
+
+    struct TypedKeyHash
+    {
+        size_t operator()(const TypedKey &key) const;
+    };
+
+} // namespace minidb
@@ -0,0 +1,505 @@
+// src/engine/operators/vector_kernels.cpp
+#include "vector_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MINIDB_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace minidb
+{
+
+    namespace
+    {
+        // ===== 标量实现（也负责 SIMD 实现的尾部） =====
+
+        // 无分支写入：先写下标，条件成立才前进，sel 需能容纳 n 个下标
+        template <typename T, typename F>
+        inline size_t SelectWith(const T *v, size_t begin, size_t n, F pred, uint32_t *sel, size_t k)
+        {
+            for (size_t i = begin; i < n; ++i)
+            {
+                sel[k] = static_cast<uint32_t>(i);
+                k += pred(v[i]) ? 1 : 0;
+            }
+            return k;
+        }
+
+        template <typename T>
+        size_t SelectScalarFrom(const T *v, size_t begin, size_t n, VectorCmp op, T c, uint32_t *sel, size_t k)
+        {
+            switch (op)
+            {
+            case VectorCmp::EQ:
+                return SelectWith(v, begin, n, [c](T x) { return x == c; }, sel, k);
+            case VectorCmp::NE:
+                return SelectWith(v, begin, n, [c](T x) { return x != c; }, sel, k);
+            case VectorCmp::LT:
+                return SelectWith(v, begin, n, [c](T x) { return x < c; }, sel, k);
+            case VectorCmp::GT:
+                return SelectWith(v, begin, n, [c](T x) { return x > c; }, sel, k);
+            case VectorCmp::LE:
+                return SelectWith(v, begin, n, [c](T x) { return x <= c; }, sel, k);
+            case VectorCmp::GE:
+                return SelectWith(v, begin, n, [c](T x) { return x >= c; }, sel, k);
+            }
+            return k;
+        }
+
+        size_t SelectInt32Scalar(const int32_t *v, size_t n, VectorCmp op, int32_t c, uint32_t *sel)
+        {
+            return SelectScalarFrom(v, 0, n, op, c, sel, 0);
+        }
+
+        size_t SelectDoubleScalar(const double *v, size_t n, VectorCmp op, double c, uint32_t *sel)
+        {
+            return SelectScalarFrom(v, 0, n, op, c, sel, 0);
+        }
+
+        int64_t SumInt32Scalar(const int32_t *v, size_t n)
+        {
+            int64_t sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += v[i];
+            return sum;
+        }
+
+        double SumDoubleScalar(const double *v, size_t n)
+        {
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                sum += v[i];
+            return sum;
+        }
+
+        template <typename T>
+        void MinMaxScalarFrom(const T *v, size_t begin, size_t n, T &mn, T &mx)
+        {
+            for (size_t i = begin; i < n; ++i)
+            {
+                mn = std::min(mn, v[i]);
+                mx = std::max(mx, v[i]);
+            }
+        }
+
+        void MinMaxInt32Scalar(const int32_t *v, size_t n, int32_t &mn, int32_t &mx)
+        {
+            mn = mx = v[0];
+            MinMaxScalarFrom(v, 1, n, mn, mx);
+        }
+
+        void MinMaxDoubleScalar(const double *v, size_t n, double &mn, double &mx)
+        {
+            mn = mx = v[0];
+            MinMaxScalarFrom(v, 1, n, mn, mx);
+        }
+
+#ifdef MINIDB_X86_SIMD
+        // 比较结果的位掩码展开为下标
+        inline void EmitBits(unsigned bits, size_t base, uint32_t *sel, size_t &k)
+        {
+            while (bits)
+            {
+                sel[k++] = static_cast<uint32_t>(base + __builtin_ctz(bits));
+                bits &= bits - 1;
+            }
+        }
+
+        // NE / LE / GE 由 EQ / GT / LT 的掩码取反得到（整数比较只有 eq / gt 指令）
+        inline bool InvertedOp(VectorCmp op)
+        {
+            return op == VectorCmp::NE || op == VectorCmp::LE || op == VectorCmp::GE;
+        }
+
+        // ===== SSE4.2（128 位：4 x int32 / 2 x double） =====
+
+        __attribute__((target("sse4.2"))) size_t SelectInt32Sse42(const int32_t *v, size_t n, VectorCmp op, int32_t c,
+                                                                  uint32_t *sel)
+        {
+            const __m128i vc = _mm_set1_epi32(c);
+            const unsigned invert = InvertedOp(op) ? 0xFu : 0u;
+            size_t k = 0, i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + i));
+                __m128i m;
+                if (op == VectorCmp::EQ || op == VectorCmp::NE)
+                    m = _mm_cmpeq_epi32(x, vc);
+                else if (op == VectorCmp::GT || op == VectorCmp::LE)
+                    m = _mm_cmpgt_epi32(x, vc);
+                else
+                    m = _mm_cmpgt_epi32(vc, x);
+                EmitBits(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(m))) ^ invert, i, sel, k);
+            }
+            return SelectScalarFrom(v, i, n, op, c, sel, k);
+        }
+
+        __attribute__((target("sse4.2"))) size_t SelectDoubleSse42(const double *v, size_t n, VectorCmp op, double c,
+                                                                   uint32_t *sel)
+        {
+            const __m128d vc = _mm_set1_pd(c);
+            size_t k = 0, i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                __m128d x = _mm_loadu_pd(v + i);
+                __m128d m;
+                switch (op)
+                {
+                case VectorCmp::EQ:
+                    m = _mm_cmpeq_pd(x, vc);
+                    break;
+                case VectorCmp::NE:
+                    m = _mm_cmpneq_pd(x, vc);
+                    break;
+                case VectorCmp::LT:
+                    m = _mm_cmplt_pd(x, vc);
+                    break;
+                case VectorCmp::GT:
+                    m = _mm_cmpgt_pd(x, vc);
+                    break;
+                case VectorCmp::LE:
+                    m = _mm_cmple_pd(x, vc);
+                    break;
+                default:
+                    m = _mm_cmpge_pd(x, vc);
+                    break;
+                }
+                EmitBits(static_cast<unsigned>(_mm_movemask_pd(m)), i, sel, k);
+            }
+            return SelectScalarFrom(v, i, n, op, c, sel, k);
+        }
+
+        __attribute__((target("sse4.2"))) int64_t SumInt32Sse42(const int32_t *v, size_t n)
+        {
+            __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + i));
+                lo = _mm_add_epi64(lo, _mm_cvtepi32_epi64(x));
+                hi = _mm_add_epi64(hi, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+            }
+            alignas(16) int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), _mm_add_epi64(lo, hi));
+            return lanes[0] + lanes[1] + SumInt32Scalar(v + i, n - i);
+        }
+
+        __attribute__((target("sse4.2"))) double SumDoubleSse42(const double *v, size_t n)
+        {
+            __m128d a = _mm_setzero_pd(), b = _mm_setzero_pd();
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                a = _mm_add_pd(a, _mm_loadu_pd(v + i));
+                b = _mm_add_pd(b, _mm_loadu_pd(v + i + 2));
+            }
+            alignas(16) double lanes[2];
+            _mm_store_pd(lanes, _mm_add_pd(a, b));
+            return lanes[0] + lanes[1] + SumDoubleScalar(v + i, n - i);
+        }
+
+        __attribute__((target("sse4.2"))) void MinMaxInt32Sse42(const int32_t *v, size_t n, int32_t &mn, int32_t &mx)
+        {
+            __m128i lo = _mm_set1_epi32(v[0]), hi = lo;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + i));
+                lo = _mm_min_epi32(lo, x);
+                hi = _mm_max_epi32(hi, x);
+            }
+            alignas(16) int32_t l[4], h[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(l), lo);
+            _mm_store_si128(reinterpret_cast<__m128i *>(h), hi);
+            mn = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+            mx = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+            MinMaxScalarFrom(v, i, n, mn, mx);
+        }
+
+        __attribute__((target("sse4.2"))) void MinMaxDoubleSse42(const double *v, size_t n, double &mn, double &mx)
+        {
+            __m128d lo = _mm_set1_pd(v[0]), hi = lo;
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                __m128d x = _mm_loadu_pd(v + i);
+                lo = _mm_min_pd(lo, x);
+                hi = _mm_max_pd(hi, x);
+            }
+            alignas(16) double l[2], h[2];
+            _mm_store_pd(l, lo);
+            _mm_store_pd(h, hi);
+            mn = std::min(l[0], l[1]);
+            mx = std::max(h[0], h[1]);
+            MinMaxScalarFrom(v, i, n, mn, mx);
+        }
+
+        // ===== AVX2（256 位：8 x int32 / 4 x double） =====
+
+        __attribute__((target("avx2"))) size_t SelectInt32Avx2(const int32_t *v, size_t n, VectorCmp op, int32_t c,
+                                                               uint32_t *sel)
+        {
+            const __m256i vc = _mm256_set1_epi32(c);
+            const unsigned invert = InvertedOp(op) ? 0xFFu : 0u;
+            size_t k = 0, i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+                __m256i m;
+                if (op == VectorCmp::EQ || op == VectorCmp::NE)
+                    m = _mm256_cmpeq_epi32(x, vc);
+                else if (op == VectorCmp::GT || op == VectorCmp::LE)
+                    m = _mm256_cmpgt_epi32(x, vc);
+                else
+                    m = _mm256_cmpgt_epi32(vc, x);
+                EmitBits(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m))) ^ invert, i, sel, k);
+            }
+            return SelectScalarFrom(v, i, n, op, c, sel, k);
+        }
+
+        __attribute__((target("avx2"))) size_t SelectDoubleAvx2(const double *v, size_t n, VectorCmp op, double c,
+                                                                uint32_t *sel)
+        {
+            const __m256d vc = _mm256_set1_pd(c);
+            size_t k = 0, i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256d x = _mm256_loadu_pd(v + i);
+                __m256d m;
+                switch (op)
+                {
+                case VectorCmp::EQ:
+                    m = _mm256_cmp_pd(x, vc, _CMP_EQ_OQ);
+                    break;
+                case VectorCmp::NE:
+                    m = _mm256_cmp_pd(x, vc, _CMP_NEQ_UQ);
+                    break;
+                case VectorCmp::LT:
+                    m = _mm256_cmp_pd(x, vc, _CMP_LT_OQ);
+                    break;
+                case VectorCmp::GT:
+                    m = _mm256_cmp_pd(x, vc, _CMP_GT_OQ);
+                    break;
+                case VectorCmp::LE:
+                    m = _mm256_cmp_pd(x, vc, _CMP_LE_OQ);
+                    break;
+                default:
+                    m = _mm256_cmp_pd(x, vc, _CMP_GE_OQ);
+                    break;
+                }
+                EmitBits(static_cast<unsigned>(_mm256_movemask_pd(m)), i, sel, k);
+            }
+            return SelectScalarFrom(v, i, n, op, c, sel, k);
+        }
+
+        __attribute__((target("avx2"))) int64_t SumInt32Avx2(const int32_t *v, size_t n)
+        {
+            __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+                lo = _mm256_add_epi64(lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+                hi = _mm256_add_epi64(hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), _mm256_add_epi64(lo, hi));
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SumInt32Scalar(v + i, n - i);
+        }
+
+        __attribute__((target("avx2"))) double SumDoubleAvx2(const double *v, size_t n)
+        {
+            __m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                a = _mm256_add_pd(a, _mm256_loadu_pd(v + i));
+                b = _mm256_add_pd(b, _mm256_loadu_pd(v + i + 4));
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, _mm256_add_pd(a, b));
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + SumDoubleScalar(v + i, n - i);
+        }
+
+        __attribute__((target("avx2"))) void MinMaxInt32Avx2(const int32_t *v, size_t n, int32_t &mn, int32_t &mx)
+        {
+            __m256i lo = _mm256_set1_epi32(v[0]), hi = lo;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+                lo = _mm256_min_epi32(lo, x);
+                hi = _mm256_max_epi32(hi, x);
+            }
+            alignas(32) int32_t l[8], h[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(l), lo);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(h), hi);
+            mn = *std::min_element(l, l + 8);
+            mx = *std::max_element(h, h + 8);
+            MinMaxScalarFrom(v, i, n, mn, mx);
+        }
+
+        __attribute__((target("avx2"))) void MinMaxDoubleAvx2(const double *v, size_t n, double &mn, double &mx)
+        {
+            __m256d lo = _mm256_set1_pd(v[0]), hi = lo;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256d x = _mm256_loadu_pd(v + i);
+                lo = _mm256_min_pd(lo, x);
+                hi = _mm256_max_pd(hi, x);
+            }
+            alignas(32) double l[4], h[4];
+            _mm256_store_pd(l, lo);
+            _mm256_store_pd(h, hi);
+            mn = *std::min_element(l, l + 4);
+            mx = *std::max_element(h, h + 4);
+            MinMaxScalarFrom(v, i, n, mn, mx);
+        }
+#endif // MINIDB_X86_SIMD
+
+        struct KernelTable
+        {
+            size_t (*select_i32)(const int32_t *, size_t, VectorCmp, int32_t, uint32_t *);
+            size_t (*select_f64)(const double *, size_t, VectorCmp, double, uint32_t *);
+            int64_t (*sum_i32)(const int32_t *, size_t);
+            double (*sum_f64)(const double *, size_t);
+            void (*minmax_i32)(const int32_t *, size_t, int32_t &, int32_t &);
+            void (*minmax_f64)(const double *, size_t, double &, double &);
+        };
+
+        const KernelTable kScalarKernels{SelectInt32Scalar, SelectDoubleScalar, SumInt32Scalar,
+                                         SumDoubleScalar, MinMaxInt32Scalar, MinMaxDoubleScalar};
+#ifdef MINIDB_X86_SIMD
+        const KernelTable kSse42Kernels{SelectInt32Sse42, SelectDoubleSse42, SumInt32Sse42,
+                                        SumDoubleSse42, MinMaxInt32Sse42, MinMaxDoubleSse42};
+        const KernelTable kAvx2Kernels{SelectInt32Avx2, SelectDoubleAvx2, SumInt32Avx2,
+                                       SumDoubleAvx2, MinMaxInt32Avx2, MinMaxDoubleAvx2};
+#endif
+
+        std::atomic<SimdLevel> g_simd_level{DetectSimdLevel()};
+
+        const KernelTable &Kernels()
+        {
+#ifdef MINIDB_X86_SIMD
+            switch (g_simd_level.load(std::memory_order_relaxed))
+            {
+            case SimdLevel::AVX2:
+                return kAvx2Kernels;
+            case SimdLevel::SSE42:
+                return kSse42Kernels;
+            case SimdLevel::Scalar:
+                break;
+            }
+#endif
+            return kScalarKernels;
+        }
+    } // namespace
+
+    SimdLevel DetectSimdLevel()
+    {
+#ifdef MINIDB_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2"))
+            return SimdLevel::SSE42;
+#endif
+        return SimdLevel::Scalar;
+    }
+
+    SimdLevel GetSimdLevel()
+    {
+        return g_simd_level.load(std::memory_order_relaxed);
+    }
+
+    SimdLevel SetSimdLevel(SimdLevel level)
+    {
+        SimdLevel effective = std::min(level, DetectSimdLevel());
+        g_simd_level.store(effective, std::memory_order_relaxed);
+        return effective;
+    }
+
+    const char *SimdLevelName(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::SSE42:
+            return "SSE4.2";
+        case SimdLevel::Scalar:
+            break;
+        }
+        return "scalar";
+    }
+
+    size_t SelectInt32(const int32_t *v, size_t n, VectorCmp op, int32_t c, uint32_t *sel)
+    {
+        return Kernels().select_i32(v, n, op, c, sel);
+    }
+
+    size_t SelectDouble(const double *v, size_t n, VectorCmp op, double c, uint32_t *sel)
+    {
+        return Kernels().select_f64(v, n, op, c, sel);
+    }
+
+    size_t SelectChar(const char *v, size_t n, uint32_t width, VectorCmp op, const char *c, uint32_t *sel)
+    {
+        size_t k = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            int r = std::memcmp(v + i * width, c, width);
+            bool hit = false;
+            switch (op)
+            {
+            case VectorCmp::EQ:
+                hit = r == 0;
+                break;
+            case VectorCmp::NE:
+                hit = r != 0;
+                break;
+            case VectorCmp::LT:
+                hit = r < 0;
+                break;
+            case VectorCmp::GT:
+                hit = r > 0;
+                break;
+            case VectorCmp::LE:
+                hit = r <= 0;
+                break;
+            case VectorCmp::GE:
+                hit = r >= 0;
+                break;
+            }
+            sel[k] = static_cast<uint32_t>(i);
+            k += hit ? 1 : 0;
+        }
+        return k;
+    }
+
+    int64_t SumInt32(const int32_t *v, size_t n)
+    {
+        return Kernels().sum_i32(v, n);
+    }
+
+    double SumDouble(const double *v, size_t n)
+    {
+        return Kernels().sum_f64(v, n);
+    }
+
+    void MinMaxInt32(const int32_t *v, size_t n, int32_t &min, int32_t &max)
+    {
+        Kernels().minmax_i32(v, n, min, max);
+    }
+
+    void MinMaxDouble(const double *v, size_t n, double &min, double &max)
+    {
+        Kernels().minmax_f64(v, n, min, max);
+    }
+
+} // namespace minidb
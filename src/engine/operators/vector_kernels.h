@@ -0,0 +1,54 @@
+// src/engine/operators/vector_kernels.h
+/**
+ * 向量化执行的 SIMD 内核（比较选择 / SUM / MIN / MAX）
+ * - 输入为列式定长数组（int32 / double / 定长字符），一次处理一个向量（约 1024 个值）
+ * - 比较内核输出选择向量：满足条件的下标按升序写入 sel，返回个数
+ * - x86 上按 CPU 支持在运行时选择 AVX2 / SSE4.2 实现，其余平台或不支持时走标量实现；
+ *   各级别结果相同（浮点求和的累加顺序不同，可能有舍入差异）
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace minidb
+{
+
+    enum class VectorCmp
+    {
+        EQ,
+        NE,
+        LT,
+        GT,
+        LE,
+        GE
+    };
+
+    enum class SimdLevel
+    {
+        Scalar,
+        SSE42,
+        AVX2
+    };
+
+    // CPU 支持的最高级别
+    SimdLevel DetectSimdLevel();
+    // 当前使用的级别（默认为 DetectSimdLevel()）
+    SimdLevel GetSimdLevel();
+    // 指定级别（不超过 CPU 支持的级别），返回实际生效的级别；用于测试与对比
+    SimdLevel SetSimdLevel(SimdLevel level);
+    const char *SimdLevelName(SimdLevel level);
+
+    // 选择 v[i] op c 成立的 i（0 <= i < n），写入 sel，返回个数
+    size_t SelectInt32(const int32_t *v, size_t n, VectorCmp op, int32_t c, uint32_t *sel);
+    size_t SelectDouble(const double *v, size_t n, VectorCmp op, double c, uint32_t *sel);
+    // 定长字符列：v 为 n 个 width 字节的值（'\0' 填充），c 为同样填充到 width 字节的常量，按无符号字节序比较
+    size_t SelectChar(const char *v, size_t n, uint32_t width, VectorCmp op, const char *c, uint32_t *sel);
+
+    int64_t SumInt32(const int32_t *v, size_t n);
+    double SumDouble(const double *v, size_t n);
+    // n 必须大于 0
+    void MinMaxInt32(const int32_t *v, size_t n, int32_t &min, int32_t &max);
+    void MinMaxDouble(const double *v, size_t n, double &min, double &max);
+
+} // namespace minidb
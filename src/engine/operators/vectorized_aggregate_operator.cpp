@@ -0,0 +1,386 @@
+// src/engine/operators/vectorized_aggregate_operator.cpp
+#include "vectorized_aggregate_operator.h"
+
+#include "../../util/logger.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace minidb
+{
+
+    namespace
+    {
+        constexpr uint32_t kNoSlot = UINT32_MAX;
+        constexpr size_t kInitialSlots = 64;
+
+        inline size_t SlotOf(int32_t key, size_t mask)
+        {
+            return (static_cast<uint32_t>(key) * 0x9E3779B97F4A7C15ull >> 32) & mask;
+        }
+
+        // 选择向量存在时把有效值收集到连续缓冲区，供 SIMD 内核使用
+        template <typename T>
+        const T *ActiveValues(const std::vector<T> &src, const DataChunk &chunk, std::vector<T> &buf)
+        {
+            if (!chunk.has_sel)
+                return src.data();
+            buf.resize(chunk.sel_count);
+            for (size_t k = 0; k < chunk.sel_count; ++k)
+                buf[k] = src[chunk.sel[k]];
+            return buf.data();
+        }
+
+        ValueType SchemaValueType(const TableSchema &schema, int idx)
+        {
+            return idx < 0 ? ValueType::String : ValueTypeFromSchema(schema.columns[idx].type);
+        }
+    } // namespace
+
+    bool VectorizedAggregateOperator::Supports(const TableSchema &schema, const std::vector<std::string> &group_keys,
+                                               const std::vector<AggregateExpr> &aggregates)
+    {
+        if (group_keys.size() > 1 || aggregates.empty())
+            return false;
+        if (group_keys.size() == 1)
+        {
+            int idx = SchemaColumnIndex(schema, group_keys[0]);
+            if (idx < 0 || VectorTypeFromSchema(schema.columns[idx].type) != VectorType::Int32)
+                return false;
+        }
+        for (const auto &agg : aggregates)
+        {
+            AggFunc func = AggFuncFromName(agg.func);
+            if (func == AggFunc::Unknown)
+                return false;
+            if (func == AggFunc::Count)
+                continue;
+            int idx = SchemaColumnIndex(schema, agg.column);
+            if (idx < 0 || VectorTypeFromSchema(schema.columns[idx].type) == VectorType::Char)
+                return false;
+        }
+        return true;
+    }
+
+    VectorizedAggregateOperator::VectorizedAggregateOperator(std::unique_ptr<ParallelSeqScanOperator> scan,
+                                                             std::vector<std::string> group_keys,
+                                                             std::vector<AggregateExpr> aggregates,
+                                                             size_t max_groups)
+        : scan_(std::move(scan)), group_keys_(std::move(group_keys)), aggregates_(std::move(aggregates)),
+          max_groups_(max_groups)
+    {
+        const TableSchema &schema = scan_->GetSchema();
+        if (!group_keys_.empty())
+            key_column_ = SchemaColumnIndex(schema, group_keys_[0]);
+        for (const auto &agg : aggregates_)
+        {
+            int idx = AggFuncFromName(agg.func) == AggFunc::Count ? -1 : SchemaColumnIndex(schema, agg.column);
+            agg_columns_.push_back(idx);
+            agg_types_.push_back(SchemaValueType(schema, idx));
+        }
+        specs_ = MakeAggSpecs(aggregates_, agg_types_);
+    }
+
+    // ===== GroupTable =====
+
+    void VectorizedAggregateOperator::GroupTable::Reset()
+    {
+        slot_keys.assign(kInitialSlots, 0);
+        slot_groups.assign(kInitialSlots, kNoSlot);
+        keys.clear();
+        accs.clear();
+    }
+
+    uint32_t VectorizedAggregateOperator::GroupTable::FindOrInsert(int32_t key, size_t num_aggs)
+    {
+        size_t mask = slot_groups.size() - 1;
+        for (size_t s = SlotOf(key, mask);; s = (s + 1) & mask)
+        {
+            if (slot_groups[s] == kNoSlot)
+            {
+                uint32_t g = static_cast<uint32_t>(keys.size());
+                keys.push_back(key);
+                accs.resize(accs.size() + num_aggs);
+                slot_keys[s] = key;
+                slot_groups[s] = g;
+                // 负载超过一半时翻倍重建
+                if (keys.size() * 2 > slot_groups.size())
+                {
+                    slot_keys.assign(slot_groups.size() * 2, 0);
+                    slot_groups.assign(slot_groups.size() * 2, kNoSlot);
+                    mask = slot_groups.size() - 1;
+                    for (uint32_t i = 0; i < keys.size(); ++i)
+                    {
+                        size_t t = SlotOf(keys[i], mask);
+                        while (slot_groups[t] != kNoSlot)
+                            t = (t + 1) & mask;
+                        slot_keys[t] = keys[i];
+                        slot_groups[t] = i;
+                    }
+                }
+                return g;
+            }
+            if (slot_keys[s] == key)
+                return slot_groups[s];
+        }
+    }
+
+    // ===== 批处理 =====
+
+    void VectorizedAggregateOperator::ConsumeUngrouped(const DataChunk &chunk, GroupTable &table,
+                                                       Scratch &scratch) const
+    {
+        const size_t na = specs_.size();
+        const size_t n = chunk.ActiveCount();
+        if (table.keys.empty())
+            table.FindOrInsert(0, na);
+        VecAcc *accs = table.accs.data();
+        for (size_t a = 0; a < na; ++a)
+        {
+            VecAcc &acc = accs[a];
+            const bool first = acc.rows == 0;
+            acc.rows += static_cast<int64_t>(n);
+            const AggFunc func = specs_[a].func;
+            if (func == AggFunc::Count)
+                continue;
+            const ColumnVector *col = chunk.Find(agg_columns_[a]);
+            if (col->type == VectorType::Int32)
+            {
+                const int32_t *v = ActiveValues(col->i32, chunk, scratch.i32);
+                if (func == AggFunc::Sum || func == AggFunc::Avg)
+                {
+                    acc.isum += SumInt32(v, n);
+                    continue;
+                }
+                int32_t mn, mx;
+                MinMaxInt32(v, n, mn, mx);
+                acc.imin = first ? mn : std::min(acc.imin, mn);
+                acc.imax = first ? mx : std::max(acc.imax, mx);
+            }
+            else
+            {
+                const double *v = ActiveValues(col->f64, chunk, scratch.f64);
+                if (func == AggFunc::Sum || func == AggFunc::Avg)
+                {
+                    acc.dsum += SumDouble(v, n);
+                    continue;
+                }
+                double mn, mx;
+                MinMaxDouble(v, n, mn, mx);
+                acc.dmin = first ? mn : std::min(acc.dmin, mn);
+                acc.dmax = first ? mx : std::max(acc.dmax, mx);
+            }
+        }
+    }
+
+    void VectorizedAggregateOperator::ConsumeChunk(const DataChunk &chunk, GroupTable &table, Scratch &scratch) const
+    {
+        if (key_column_ < 0)
+        {
+            ConsumeUngrouped(chunk, table, scratch);
+            return;
+        }
+
+        // 先求出每个有效行的组号，再逐个聚合列批量更新
+        const size_t na = specs_.size();
+        const size_t n = chunk.ActiveCount();
+        const int32_t *keys = ActiveValues(chunk.Find(key_column_)->i32, chunk, scratch.i32);
+        scratch.groups.resize(n);
+        for (size_t k = 0; k < n; ++k)
+            scratch.groups[k] = table.FindOrInsert(keys[k], na);
+        const uint32_t *groups = scratch.groups.data();
+
+        for (size_t a = 0; a < na; ++a)
+        {
+            VecAcc *accs = table.accs.data() + a;
+            const AggFunc func = specs_[a].func;
+            if (func == AggFunc::Count)
+            {
+                for (size_t k = 0; k < n; ++k)
+                    ++accs[groups[k] * na].rows;
+                continue;
+            }
+            const ColumnVector *col = chunk.Find(agg_columns_[a]);
+            const bool sum = func == AggFunc::Sum || func == AggFunc::Avg;
+            if (col->type == VectorType::Int32)
+            {
+                const int32_t *v = ActiveValues(col->i32, chunk, scratch.i32);
+                for (size_t k = 0; k < n; ++k)
+                {
+                    VecAcc &acc = accs[groups[k] * na];
+                    if (sum)
+                        acc.isum += v[k];
+                    else if (acc.rows == 0)
+                        acc.imin = acc.imax = v[k];
+                    else
+                    {
+                        acc.imin = std::min(acc.imin, v[k]);
+                        acc.imax = std::max(acc.imax, v[k]);
+                    }
+                    ++acc.rows;
+                }
+            }
+            else
+            {
+                const double *v = ActiveValues(col->f64, chunk, scratch.f64);
+                for (size_t k = 0; k < n; ++k)
+                {
+                    VecAcc &acc = accs[groups[k] * na];
+                    if (sum)
+                        acc.dsum += v[k];
+                    else if (acc.rows == 0)
+                        acc.dmin = acc.dmax = v[k];
+                    else
+                    {
+                        acc.dmin = std::min(acc.dmin, v[k]);
+                        acc.dmax = std::max(acc.dmax, v[k]);
+                    }
+                    ++acc.rows;
+                }
+            }
+        }
+    }
+
+    void VectorizedAggregateOperator::MergeInto(const VecAcc &src, VecAcc &dst, size_t a) const
+    {
+        if (src.rows == 0)
+            return;
+        const bool first = dst.rows == 0;
+        dst.rows += src.rows;
+        dst.isum += src.isum;
+        dst.dsum += src.dsum;
+        if (specs_[a].func != AggFunc::Min && specs_[a].func != AggFunc::Max)
+            return;
+        dst.imin = first ? src.imin : std::min(dst.imin, src.imin);
+        dst.imax = first ? src.imax : std::max(dst.imax, src.imax);
+        dst.dmin = first ? src.dmin : std::min(dst.dmin, src.dmin);
+        dst.dmax = first ? src.dmax : std::max(dst.dmax, src.dmax);
+    }
+
+    void VectorizedAggregateOperator::Open()
+    {
+        if (fallback_)
+        {
+            fallback_->Open();
+            return;
+        }
+        const size_t degree = scan_->GetDegree();
+        const size_t na = specs_.size();
+        std::vector<GroupTable> locals(degree);
+        std::vector<Scratch> scratch(degree);
+        for (auto &t : locals)
+            t.Reset();
+
+        std::vector<int> columns;
+        if (key_column_ >= 0)
+            columns.push_back(key_column_);
+        for (int c : agg_columns_)
+            if (c >= 0 && std::find(columns.begin(), columns.end(), c) == columns.end())
+                columns.push_back(c);
+
+        // 本地分组总数即常驻内存的分组数，超出上限时停止扫描
+        std::atomic<size_t> local_groups{0};
+        std::atomic<bool> over_budget{false};
+        scan_->ParallelForEachChunk(columns, [&](size_t w, DataChunk &chunk)
+                                    {
+            const size_t before = locals[w].keys.size();
+            ConsumeChunk(chunk, locals[w], scratch[w]);
+            const size_t added = locals[w].keys.size() - before;
+            if (added > 0 && local_groups.fetch_add(added) + added > max_groups_)
+            {
+                over_budget.store(true);
+                scan_->RequestStop();
+            } });
+        if (over_budget.load())
+        {
+            locals.clear();
+            FallBack();
+            return;
+        }
+
+        // 合并线程本地分组（分组数通常远小于行数，串行合并）
+        result_ = std::move(locals[0]);
+        for (size_t w = 1; w < degree; ++w)
+        {
+            const GroupTable &src = locals[w];
+            for (uint32_t g = 0; g < src.keys.size(); ++g)
+            {
+                uint32_t dst = result_.FindOrInsert(src.keys[g], na);
+                for (size_t a = 0; a < na; ++a)
+                    MergeInto(src.accs[g * na + a], result_.accs[dst * na + a], a);
+            }
+        }
+        emit_pos_ = 0;
+
+        global_log_debug(std::string("[VectorizedAgg] 表 ") + scan_->GetSchema().table_name + " 向量化聚合完成，" +
+                         std::to_string(result_.keys.size()) + " 个分组，SIMD 级别 " + SimdLevelName(GetSimdLevel()));
+    }
+
+    // 放弃已有的部分聚合，在同一扫描上用可溢写的 HashAggregateOperator 重新聚合（逐行解码，扫描的向量谓词照常生效）
+    void VectorizedAggregateOperator::FallBack()
+    {
+        const TableSchema &schema = scan_->GetSchema();
+        global_log_info(std::string("[VectorizedAgg] 表 ") + schema.table_name + " 分组数超过上限 " +
+                        std::to_string(max_groups_) + "，改用可溢写的哈希聚合");
+        std::vector<ValueType> key_types;
+        if (key_column_ >= 0)
+            key_types.push_back(SchemaValueType(schema, key_column_));
+        StorageEngine *engine = scan_->GetEngine();
+        fallback_ = std::make_unique<HashAggregateOperator>(std::move(scan_), group_keys_, std::move(key_types),
+                                                            aggregates_, agg_types_, engine, max_groups_);
+        fallback_->Open();
+    }
+
+    bool VectorizedAggregateOperator::Next(Row &out)
+    {
+        if (fallback_)
+            return fallback_->Next(out);
+        const size_t na = specs_.size();
+        if (emit_pos_ >= result_.keys.size())
+            return false;
+        const size_t g = emit_pos_++;
+        out.columns.clear();
+        out.columns.reserve(group_keys_.size() + na);
+        if (key_column_ >= 0)
+            out.columns.emplace_back(group_keys_[0], std::to_string(result_.keys[g]));
+        for (size_t a = 0; a < na; ++a)
+        {
+            // 转成 Accumulator，输出格式与逐行聚合一致
+            const VecAcc &v = result_.accs[g * na + a];
+            const AggSpec &spec = specs_[a];
+            Accumulator acc;
+            acc.rows = v.rows;
+            acc.count = v.rows;
+            acc.isum = v.isum;
+            acc.dsum = v.dsum;
+            if (spec.func == AggFunc::Min || spec.func == AggFunc::Max)
+            {
+                const bool is_min = spec.func == AggFunc::Min;
+                acc.best.type = spec.type;
+                if (spec.type == ValueType::Int)
+                    acc.best.i = is_min ? v.imin : v.imax;
+                else
+                    acc.best.d = is_min ? v.dmin : v.dmax;
+            }
+            out.columns.emplace_back(AggOutputName(aggregates_[a]), FinalizeAccumulator(acc, spec));
+        }
+        return true;
+    }
+
+    void VectorizedAggregateOperator::Close()
+    {
+        if (fallback_)
+            fallback_->Close();
+        result_ = GroupTable{};
+        emit_pos_ = 0;
+    }
+
+    std::vector<std::string> VectorizedAggregateOperator::OutputColumns() const
+    {
+        std::vector<std::string> names = group_keys_;
+        for (const auto &agg : aggregates_)
+            names.push_back(AggOutputName(agg));
+        return names;
+    }
+
+} // namespace minidb
@@ -0,0 +1,94 @@
+// src/engine/operators/vectorized_aggregate_operator.h
+/**
+ * 向量化聚合：建在并行顺序扫描的列式批（DataChunk）之上
+ * - 只解码分组列与聚合列，不构造 Row；扫描的向量谓词在同一批上先行过滤
+ * - 无分组时每批用 SIMD 内核（SumInt32 / MinMaxDouble 等）直接求 SUM / MIN / MAX
+ * - 单个 INT 分组列时按批求出每行的组号，再逐聚合列批量更新累加器
+ * - 各扫描线程维护线程本地的分组表，扫描结束后合并；输出列与 HashAggregateOperator 相同，顺序不保证
+ * - 线程本地分组总数超过 max_groups 时停止扫描，改由可溢写的 HashAggregateOperator 在同一扫描上重新聚合
+ * - 适用范围见 Supports()，其余形式仍走逐行的 (Parallel)HashAggregateOperator
+ */
+#pragma once
+
+#include "hash_aggregate_operator.h"
+#include "parallel_scan_operator.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace minidb
+{
+
+    class VectorizedAggregateOperator : public PhysicalOperator
+    {
+    public:
+        // 至多一个 INT 分组列；聚合为 COUNT，或作用于 INT / DOUBLE 列的 SUM / AVG / MIN / MAX
+        static bool Supports(const TableSchema &schema, const std::vector<std::string> &group_keys,
+                             const std::vector<AggregateExpr> &aggregates);
+
+        VectorizedAggregateOperator(std::unique_ptr<ParallelSeqScanOperator> scan,
+                                    std::vector<std::string> group_keys,
+                                    std::vector<AggregateExpr> aggregates,
+                                    size_t max_groups);
+
+        void Open() override;
+        bool Next(Row &out) override;
+        void Close() override;
+        std::vector<std::string> OutputColumns() const override;
+
+        // 是否因分组数超出上限改用了可溢写的哈希聚合
+        bool UsedFallback() const { return fallback_ != nullptr; }
+        bool IsSpilled() const { return fallback_ && fallback_->IsSpilled(); }
+
+    private:
+        // 一个分组上一个聚合的部分结果（输入没有空值，计数即行数）
+        struct VecAcc
+        {
+            int64_t rows{0};
+            int64_t isum{0};
+            double dsum{0.0};
+            int32_t imin{0}, imax{0};
+            double dmin{0.0}, dmax{0.0};
+        };
+
+        // int32 分组键 -> 组号（开放寻址）；无分组时只有键为 0 的一组
+        struct GroupTable
+        {
+            std::vector<int32_t> slot_keys;
+            std::vector<uint32_t> slot_groups;
+            std::vector<int32_t> keys;
+            std::vector<VecAcc> accs; // 第 g 组第 a 个聚合为 accs[g * na + a]
+
+            void Reset();
+            uint32_t FindOrInsert(int32_t key, size_t num_aggs);
+        };
+
+        // 线程本地的暂存区
+        struct Scratch
+        {
+            std::vector<int32_t> i32;
+            std::vector<double> f64;
+            std::vector<uint32_t> groups;
+        };
+
+        void ConsumeChunk(const DataChunk &chunk, GroupTable &table, Scratch &scratch) const;
+        void ConsumeUngrouped(const DataChunk &chunk, GroupTable &table, Scratch &scratch) const;
+        void MergeInto(const VecAcc &src, VecAcc &dst, size_t a) const;
+        void FallBack();
+
+        std::unique_ptr<ParallelSeqScanOperator> scan_;
+        std::vector<std::string> group_keys_;
+        std::vector<AggregateExpr> aggregates_;
+        std::vector<AggSpec> specs_;
+        std::vector<ValueType> agg_types_;
+        int key_column_{-1};           // 分组列的 schema 序号，无分组为 -1
+        std::vector<int> agg_columns_; // 聚合列的 schema 序号，COUNT 为 -1
+        size_t max_groups_;
+        std::unique_ptr<HashAggregateOperator> fallback_;
+
+        GroupTable result_;
+        size_t emit_pos_{0};
+    };
+
+} // namespace minidb
@@ -6,6 +6,39 @@
 
 using json = nlohmann::json;
 
+// 解析结构化表达式树；遇到不支持的节点返回 nullptr（执行器回退到字符串谓词）
+static std::shared_ptr<PlanExpr> exprFromJson(const json &j)
+{
+    if (!j.is_object() || !j.contains("kind"))
+        return nullptr;
+
+    auto expr = std::make_shared<PlanExpr>();
+    std::string kind = j["kind"].get<std::string>();
+    if (kind == "column")
+    {
+        expr->kind = PlanExpr::Kind::Column;
+        expr->name = j.value("name", "");
+    }
+    else if (kind == "literal")
+    {
+        expr->kind = PlanExpr::Kind::Literal;
+        expr->value = j.value("value", "");
+        expr->is_string = (j.value("literal_type", "") == "STRING");
+    }
+    else if (kind == "binary")
+    {
+        expr->kind = PlanExpr::Kind::Binary;
+        expr->op = j.value("op", "");
+        expr->left = j.contains("left") ? exprFromJson(j["left"]) : nullptr;
+        expr->right = j.contains("right") ? exprFromJson(j["right"]) : nullptr;
+        if (!expr->left || !expr->right || expr->op.empty())
+            return nullptr;
+    }
+    else
+        return nullptr;
+    return expr;
+}
+
 std::unique_ptr<PlanNode> JsonToPlan::translate(const json &j)
 {
     auto node = std::make_unique<PlanNode>();
@@ -65,6 +98,8 @@ std::unique_ptr<PlanNode> JsonToPlan::translate(const json &j)
             filter->type = PlanType::Filter;
             filter->table_name = project->table_name;
             filter->predicate = j.at("predicate").get<std::string>();
+            if (j.contains("predicate_expr"))
+                filter->predicate_expr = exprFromJson(j["predicate_expr"]);
             filter->children.push_back(std::move(scan));
             project->children.push_back(std::move(filter));
         }
@@ -97,6 +132,8 @@ std::unique_ptr<PlanNode> JsonToPlan::translate(const json &j)
         // 添加 having_predicate 支持
         if (j.contains("having_predicate"))
             node->having_predicate = j["having_predicate"].get<std::string>();
+        if (j.contains("having_expr"))
+            node->having_expr = exprFromJson(j["having_expr"]);
     }
     else if (type == "Having")
     {
@@ -164,6 +201,15 @@ std::unique_ptr<PlanNode> JsonToPlan::translate(const json &j)
         if (j.contains("child"))
             node->children.push_back(translate(j["child"]));
     }
+    else if (type == "Limit")
+    {
+        node->type = PlanType::Limit;
+        node->limit = j.value("limit", -1LL);
+        node->offset = j.value("offset", 0LL);
+        if (!j.contains("child"))
+            throw std::runtime_error("Limit plan must have child");
+        node->children.push_back(translate(j["child"]));
+    }
     else if (type == "ShowTables")
     {
         node->type = PlanType::ShowTables;
@@ -322,6 +368,8 @@ std::unique_ptr<PlanNode> JsonToPlan::translate(const json &j)
 
     if (j.contains("predicate"))
         node->predicate = j["predicate"].get<std::string>();
+    if (j.contains("predicate_expr"))
+        node->predicate_expr = exprFromJson(j["predicate_expr"]);
 
     // ----------- 子节点 -----------
     if (j.contains("child"))
@@ -1,6 +1,7 @@
 #include "plan_optimizer.h"
 #include "../util/logger.h"
 #include <algorithm>
+#include <climits>
 
 namespace minidb {
 
@@ -36,6 +37,44 @@ static bool looksPushableToScan(const std::string &c) {
     return (c.find('=') != std::string::npos) || (c.find('<') != std::string::npos) || (c.find('>') != std::string::npos);
 }
 
+// 两个非负行数相加，超出 long long 时取 LLONG_MAX（跳过的行数再多也是跳过全部）
+static long long addRowCounts(long long a, long long b) {
+    return a > LLONG_MAX - b ? LLONG_MAX : a + b;
+}
+
+// Limit 下推：
+//  - Limit(Limit(X))   -> 合并为一个 Limit
+//  - Limit(Project(X)) -> Project(Limit(X))：投影不改变行数，Limit 贴近数据源，取够即停止扫描
+//  - Limit(OrderBy(X)) -> OrderBy 带 Top-N 提示（只保留前 offset + limit 行），不做全量排序
+static std::unique_ptr<PlanNode> pushDownLimit(std::unique_ptr<PlanNode> node) {
+    if (node->children.empty() || !node->children.front()) return node;
+    auto &child = node->children.front();
+
+    if (child->type == PlanType::Limit) {
+        // 外层 LIMIT a OFFSET b 作用在内层 LIMIT c OFFSET d 的结果上
+        long long inner_left = child->limit < 0 ? -1 : std::max(0LL, child->limit - node->offset);
+        long long merged = node->limit < 0 ? inner_left
+                         : (inner_left < 0 ? node->limit : std::min(node->limit, inner_left));
+        child->offset = addRowCounts(child->offset, node->offset);
+        child->limit = merged;
+        return pushDownLimit(std::move(child));
+    }
+    if (node->limit < 0) return node;
+
+    if (child->type == PlanType::Project && !child->children.empty()) {
+        auto project = std::move(child);
+        node->children.front() = std::move(project->children.front());
+        project->children.front() = pushDownLimit(std::move(node));
+        return project;
+    }
+    // offset + limit 超出 long long 时不加 Top-N 提示
+    if (child->type == PlanType::OrderBy && node->offset <= LLONG_MAX - node->limit) {
+        long long n = node->offset + node->limit;
+        if (child->limit < 0 || child->limit > n) child->limit = n;
+    }
+    return node;
+}
+
 static std::unique_ptr<PlanNode> rewrite(std::unique_ptr<PlanNode> node) {
     if (!node) return node;
     for (auto &ch : node->children) {
@@ -57,6 +96,7 @@ static std::unique_ptr<PlanNode> rewrite(std::unique_ptr<PlanNode> node) {
             newFilter->type = PlanType::Filter;
             newFilter->table_name = node->table_name;
             newFilter->predicate = node->predicate;
+            newFilter->predicate_expr = node->predicate_expr;
             newFilter->children.push_back(std::move(grand));
 
             // 将新 Filter 作为 Project 的子节点，并递归重写
@@ -64,6 +104,14 @@ static std::unique_ptr<PlanNode> rewrite(std::unique_ptr<PlanNode> node) {
             return std::move(child);
         }
 
+        // Filter over SeqScan 且带表达式树：执行器优先使用表达式树，只能整体下推
+        if (child->type == PlanType::SeqScan && node->predicate_expr) {
+            if (!child->predicate.empty() || child->predicate_expr) return node;
+            child->predicate = node->predicate;
+            child->predicate_expr = node->predicate_expr;
+            return std::move(child); // Filter 消除
+        }
+
         // Filter over SeqScan: 拆分合取项，下推可下推部分
         if (child->type == PlanType::SeqScan) {
             std::vector<std::string> parts = splitConjuncts(node->predicate);
@@ -84,13 +132,26 @@ static std::unique_ptr<PlanNode> rewrite(std::unique_ptr<PlanNode> node) {
         }
     }
 
+    if (node->type == PlanType::Limit) {
+        return pushDownLimit(std::move(node));
+    }
+
     // 投影剪枝占位：暂不变更 schema，仅为将来扩展保留结构
     return node;
 }
 
+std::unique_ptr<PlanNode> PushDownLimits(std::unique_ptr<PlanNode> plan) {
+    if (!plan) return plan;
+    for (auto &ch : plan->children) {
+        ch = PushDownLimits(std::move(ch));
+    }
+    if (plan->type == PlanType::Limit) return pushDownLimit(std::move(plan));
+    return plan;
+}
+
 std::unique_ptr<PlanNode> OptimizePlan(std::unique_ptr<PlanNode> plan) {
     Logger logger("logs/planner.log");
-    logger.log("[Optimizer] run lightweight rules: predicate pushdown / projection placeholder");
+    logger.log("[Optimizer] run lightweight rules: predicate pushdown / limit pushdown / projection placeholder");
     return rewrite(std::move(plan));
 }
 
@@ -7,9 +7,12 @@
 
 namespace minidb {
 
-// 轻量规则优化入口：对计划树做局部重写（谓词下推、投影剪枝、Limit 下推占位）
+// 轻量规则优化入口：对计划树做局部重写（谓词下推、Limit 下推、投影剪枝占位）
 std::unique_ptr<PlanNode> OptimizePlan(std::unique_ptr<PlanNode> plan);
 
+// 只做 Limit 下推（含 OrderBy 的 Top-N 提示）；未启用完整规则集的入口用它，执行器只读取提示
+std::unique_ptr<PlanNode> PushDownLimits(std::unique_ptr<PlanNode> plan);
+
 } // namespace minidb
 
 
@@ -46,6 +46,10 @@ inline constexpr const char* EXPECT_BY_AFTER_GROUP = "在 'GROUP' 之后缺少
 inline constexpr const char* EXPECT_IDENTIFIER = "缺少标识符";
 inline constexpr const char* EXPECT_COMMA_OR_FROM = "缺少逗号或关键字 'FROM'";
 inline constexpr const char* EXPECT_BY_AFTER_ORDER = "在 'ORDER' 之后缺少关键字 'BY'";
+inline constexpr const char* EXPECT_COUNT_AFTER_LIMIT = "在 'LIMIT' 之后缺少非负整数";
+inline constexpr const char* EXPECT_COUNT_AFTER_OFFSET = "在 'OFFSET' 之后缺少非负整数";
+inline constexpr const char* LIMIT_COUNT_OUT_OF_RANGE = "'LIMIT' 的行数超出范围";
+inline constexpr const char* OFFSET_COUNT_OUT_OF_RANGE = "'OFFSET' 的行数超出范围";
 
 inline constexpr const char* EXPECT_JOIN_AFTER_TYPE = "在 'JOIN' 之后缺少连接类型";
 inline constexpr const char* EXPECT_ON_AFTER_JOIN = "在 'JOIN' 之后缺少 'ON' 子句";
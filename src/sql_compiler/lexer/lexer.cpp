@@ -23,6 +23,8 @@ Lexer::Lexer(const std::string& source)
     keywords["ORDER"] = TokenType::KEYWORD_ORDER;
     keywords["ASC"] = TokenType::KEYWORD_ASC;
     keywords["DESC"] = TokenType::KEYWORD_DESC;
+    keywords["LIMIT"] = TokenType::KEYWORD_LIMIT;
+    keywords["OFFSET"] = TokenType::KEYWORD_OFFSET;
 
     keywords["JOIN"] = TokenType::KEYWORD_JOIN;
     keywords["ON"] = TokenType::KEYWORD_ON;
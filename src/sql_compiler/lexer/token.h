@@ -27,6 +27,10 @@ enum class TokenType {
     KEYWORD_ASC,
     KEYWORD_DESC,  
 
+    //LIMIT / OFFSET
+    KEYWORD_LIMIT,
+    KEYWORD_OFFSET,
+
     //Join
     KEYWORD_JOIN,
     KEYWORD_ON,
@@ -225,7 +225,9 @@ public:
                    std::vector<std::string> groupBy = {},
                    std::unique_ptr<Expression> having = nullptr,
                    std::vector<std::string> orderBy = {},
-                   bool orderDesc = false)
+                   bool orderDesc = false,
+                   long long limitCount = -1,
+                   long long offsetCount = 0)
         : columns(std::move(cols)), 
           aggregates(std::move(aggs)), 
           mainTableName(mainTable),
@@ -234,7 +236,9 @@ public:
           groupByColumns(std::move(groupBy)), 
           havingClause(std::move(having)),
           orderByColumns(std::move(orderBy)),
-          orderByDesc(orderDesc) 
+          orderByDesc(orderDesc),
+          limit(limitCount),
+          offset(offsetCount)
     {
         // 构建完整的表列表
         fromTables.push_back(mainTableName);
@@ -257,6 +261,11 @@ public:
     const std::vector<std::string>& getOrderByColumns() const { return orderByColumns; }
     bool isOrderByDesc() const { return orderByDesc; }
 
+    // LIMIT / OFFSET（limit 为 -1 表示没有 LIMIT）
+    bool hasLimit() const { return limit >= 0; }
+    long long getLimit() const { return limit; }
+    long long getOffset() const { return offset; }
+
     //JOIN
     const std::vector<std::string>& getFromTables() const { return fromTables; }
     const std::vector<JoinClause>& getJoins() const { return joins; }
@@ -284,6 +293,10 @@ private:
     std::string mainTableName;                    // 主表名，等同于tableName
     std::vector<std::string> fromTables;          // 所有涉及的表（包括主表和 JOIN 表）
     std::vector<JoinClause> joins;                // JOIN 子句列表
+
+    // LIMIT / OFFSET
+    long long limit;
+    long long offset;
     
 };
 
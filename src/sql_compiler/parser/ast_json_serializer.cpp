@@ -8,6 +8,7 @@
 using json = nlohmann::json;
 
 static json exprToJson(const Expression* e);
+static json exprToTree(const Expression* e);
 
 json ASTJson::toJson(const Statement* stmt)
 {
@@ -60,6 +61,16 @@ json ASTJson::toJson(const Statement* stmt)
     }
     // SELECT
     if (auto sel = dynamic_cast<const SelectStatement*>(stmt)) {
+        // LIMIT / OFFSET：在整个 SELECT 计划之上再包一层 Limit
+        auto withLimit = [sel](json body) {
+            if (!sel->hasLimit()) return body;
+            json limit;
+            limit["type"] = "Limit";
+            limit["limit"] = sel->getLimit();
+            limit["offset"] = sel->getOffset();
+            limit["child"] = body;
+            return limit;
+        };
         json j;
         // 检查是否有 JOIN
         if (sel->hasJoins()) {
@@ -87,7 +98,7 @@ json ASTJson::toJson(const Statement* stmt)
             }
             j["children"] = children;
             
-            return j;
+            return withLimit(j);
         }
 
         // 检查是否有 ORDER BY
@@ -124,6 +135,7 @@ json ASTJson::toJson(const Statement* stmt)
                     try {
                         auto havingJson = exprToJson(sel->getHavingClause());
                         child["having_predicate"] = havingJson.is_string() ? havingJson.get<std::string>() : havingJson.dump();
+                        child["having_expr"] = exprToTree(sel->getHavingClause());
                     } catch (const std::exception &e) {
                         child["having_predicate"] = "HAVING_CLAUSE_ERROR";
                     }
@@ -139,6 +151,7 @@ json ASTJson::toJson(const Statement* stmt)
                     try {
                         auto whereJson = exprToJson(sel->getWhereClause());
                         child["predicate"] = whereJson.is_string() ? whereJson.get<std::string>() : whereJson.dump();
+                        child["predicate_expr"] = exprToTree(sel->getWhereClause());
                     } catch (const std::exception &e) {
                         child["predicate"] = "WHERE_CLAUSE_ERROR";
                     }
@@ -146,7 +159,7 @@ json ASTJson::toJson(const Statement* stmt)
             }
             
             j["child"] = child;
-            return j;
+            return withLimit(j);
         }
         // 如果没有 ORDER BY，使用原有的逻辑
         //先处理聚合函数group by
@@ -173,6 +186,7 @@ json ASTJson::toJson(const Statement* stmt)
                 try {
                     auto havingJson = exprToJson(sel->getHavingClause());
                     j["having_predicate"] = havingJson.is_string() ? havingJson.get<std::string>() : havingJson.dump();
+                    j["having_expr"] = exprToTree(sel->getHavingClause());
                 } catch (const std::exception &e) {
                     std::cerr << "[ASTJson][ERROR] 序列化 HAVING 子句失败: " << e.what() << std::endl;
                     j["having_predicate"] = "HAVING_CLAUSE_ERROR";
@@ -199,6 +213,7 @@ json ASTJson::toJson(const Statement* stmt)
                 try{
                 auto p = exprToJson(sel->getWhereClause());
                 j["predicate"] = p.is_string() ? p.get<std::string>() : p.dump();
+                j["predicate_expr"] = exprToTree(sel->getWhereClause());
                 }  
                 catch (const std::exception &e) {
                     global_log_error(std::string("[ASTJson][ERROR] 序列化 WHERE 子句失败: ") + e.what());
@@ -207,7 +222,7 @@ json ASTJson::toJson(const Statement* stmt)
             }
         
         }
-    return j;
+    return withLimit(j);
     }
 
     //Delete
@@ -218,6 +233,7 @@ json ASTJson::toJson(const Statement* stmt)
         if (del->getWhereClause()) {
             auto p = exprToJson(del->getWhereClause());
             j["predicate"] = p.is_string() ? p.get<std::string>() : p.dump();
+            j["predicate_expr"] = exprToTree(del->getWhereClause());
         }
         return j;
     }
@@ -239,6 +255,7 @@ json ASTJson::toJson(const Statement* stmt)
         if (upd->getWhereClause()) {
             auto p = exprToJson(upd->getWhereClause());
             j["predicate"] = p.is_string() ? p.get<std::string>() : p.dump();
+            j["predicate_expr"] = exprToTree(upd->getWhereClause());
         }
         return j;
     }
@@ -339,3 +356,49 @@ static json exprToJson(const Expression* e)
 
     return json();
 }
+
+// 结构化表达式树：{kind: column|literal|binary, ...}，供执行器编译谓词
+static json exprToTree(const Expression* e)
+{
+    json j;
+    if (!e) return j;
+    if (auto lit = dynamic_cast<const LiteralExpression*>(e)) {
+        j["kind"] = "literal";
+        j["literal_type"] = (lit->getType() == LiteralExpression::LiteralType::INTEGER) ? "INT" : "STRING";
+        j["value"] = lit->getValue();
+        return j;
+    }
+    if (auto id = dynamic_cast<const IdentifierExpression*>(e)) {
+        j["kind"] = "column";
+        j["name"] = id->getName();
+        return j;
+    }
+    if (auto ae = dynamic_cast<const AggregateExpression*>(e)) {
+        // 聚合结果按 GroupBy 输出列名引用
+        j["kind"] = "column";
+        j["name"] = ae->getAlias().empty() ? ae->getFunction() + "(" + ae->getColumn() + ")" : ae->getAlias();
+        return j;
+    }
+    if (auto be = dynamic_cast<const BinaryExpression*>(e)) {
+        std::string op;
+        switch (be->getOperator()) {
+            case BinaryExpression::Operator::EQUALS: op = "="; break;
+            case BinaryExpression::Operator::LESS_THAN: op = "<"; break;
+            case BinaryExpression::Operator::GREATER_THAN: op = ">"; break;
+            case BinaryExpression::Operator::LESS_EQUAL: op = "<="; break;
+            case BinaryExpression::Operator::GREATER_EQUAL: op = ">="; break;
+            case BinaryExpression::Operator::NOT_EQUAL: op = "!="; break;
+            case BinaryExpression::Operator::PLUS: op = "+"; break;
+            case BinaryExpression::Operator::MINUS: op = "-"; break;
+            case BinaryExpression::Operator::MULTIPLY: op = "*"; break;
+            case BinaryExpression::Operator::DIVIDE: op = "/"; break;
+        }
+        j["kind"] = "binary";
+        j["op"] = op;
+        j["left"] = exprToTree(be->getLeft());
+        j["right"] = exprToTree(be->getRight());
+        return j;
+    }
+    // 子查询等暂不支持结构化表示，执行器回退到字符串谓词
+    return json();
+}
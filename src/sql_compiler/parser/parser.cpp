@@ -4,6 +4,15 @@
 #include "../common/error_messages.h"
 #include <unordered_map>
 
+// LIMIT / OFFSET 的行数：超出 long long 的整数按语法错误报告
+static long long parseRowCount(const Token& token, const char* message) {
+    try {
+        return std::stoll(token.lexeme);
+    } catch (const std::exception&) {
+        throw ParseError(message, token.line, token.column);
+    }
+}
+
 // ===== 智能提示辅助：将期望的 TokenType 映射为人类可读的关键词或符号 =====
 static inline const char* expectedKeywordForToken(TokenType type) {
     switch (type) {
@@ -15,6 +24,8 @@ static inline const char* expectedKeywordForToken(TokenType type) {
         case TokenType::KEYWORD_ORDER: return "ORDER";
         case TokenType::KEYWORD_ASC: return "ASC";
         case TokenType::KEYWORD_DESC: return "DESC";
+        case TokenType::KEYWORD_LIMIT: return "LIMIT";
+        case TokenType::KEYWORD_OFFSET: return "OFFSET";
         case TokenType::KEYWORD_CREATE: return "CREATE";
         case TokenType::KEYWORD_TABLE: return "TABLE";
         case TokenType::KEYWORD_INSERT: return "INSERT";
@@ -517,6 +528,18 @@ std::unique_ptr<SelectStatement> Parser::selectStatement() {
         joins.emplace_back(joinType, joinTableName, joinCondition);
     }
 
+    // 可选的 LIMIT n [OFFSET m]
+    long long limitCount = -1;
+    long long offsetCount = 0;
+    if (match(TokenType::KEYWORD_LIMIT)) {
+        Token countToken = consume(TokenType::CONST_INT, SqlErrors::EXPECT_COUNT_AFTER_LIMIT);
+        limitCount = parseRowCount(countToken, SqlErrors::LIMIT_COUNT_OUT_OF_RANGE);
+        if (match(TokenType::KEYWORD_OFFSET)) {
+            Token offsetToken = consume(TokenType::CONST_INT, SqlErrors::EXPECT_COUNT_AFTER_OFFSET);
+            offsetCount = parseRowCount(offsetToken, SqlErrors::OFFSET_COUNT_OUT_OF_RANGE);
+        }
+    }
+
     /* -------在上方增加功能----------*/
     consume(TokenType::DELIMITER_SEMICOLON, SqlErrors::EXPECT_SEMI_AFTER_SELECT);
     return std::make_unique<SelectStatement>(
@@ -528,7 +551,9 @@ std::unique_ptr<SelectStatement> Parser::selectStatement() {
         std::move(groupByColumns), 
         std::move(havingClause),
         std::move(orderByColumns), 
-        orderByDesc);
+        orderByDesc,
+        limitCount,
+        offsetCount);
 }
 std::string Parser::parseJoinCondition() {
     // 解析 table1.column = table2.column 格式
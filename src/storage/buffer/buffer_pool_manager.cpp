@@ -2,6 +2,7 @@
 #include "util/logger.h"
 #include <cassert>
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 
 namespace minidb {
@@ -13,8 +14,9 @@ static Logger g_storage_logger_bpm("storage.log");
 #endif
 
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager* disk_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager) {
-    pages_ = new Page[pool_size_];
+    : pool_size_(pool_size), disk_manager_(disk_manager),
+      page_size_(disk_manager ? disk_manager->GetPageSize() : PAGE_SIZE) {
+    AllocateFramePool(pool_size_);
     lru_replacer_ = std::make_unique<LRUReplacer>(pool_size_);
     fifo_replacer_ = std::make_unique<FIFOReplacer>(pool_size_);
     frame_page_ids_.assign(pool_size_, INVALID_PAGE_ID);
@@ -26,7 +28,20 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager* disk_manager
 BufferPoolManager::~BufferPoolManager() {
     StopBackgroundFlusher();
     FlushAllPages();
-    delete[] pages_;
+    if (disk_manager_) disk_manager_->UnregisterFrameBuffers();
+}
+
+void BufferPoolManager::AllocateFramePool(size_t n) {
+    if (disk_manager_) disk_manager_->UnregisterFrameBuffers();
+    pages_.clear();
+    frames_ = AllocateFrames(n, page_size_);
+    WalManager* wal = disk_manager_ ? disk_manager_->GetWal() : nullptr;
+    for (size_t i = 0; i < n; ++i) {
+        pages_.emplace_back(frames_.get() + i * page_size_, page_size_);
+        pages_.back().SetWal(wal); // 挂上 WAL 的帧：页内修改记逻辑日志
+    }
+    // 帧数组整体注册为 io_uring 固定缓冲区
+    if (disk_manager_) disk_manager_->RegisterFrameBuffers(frames_.get(), n * page_size_);
 }
 
 frame_id_t BufferPoolManager::FindVictimFrame() {
@@ -53,9 +68,10 @@ bool BufferPoolManager::FlushFrameToPages(frame_id_t frame_id) {
     Page& page = pages_[frame_id];
     if (frame_page_ids_[frame_id] == INVALID_PAGE_ID) return true;
     if (!page.IsDirty()) return true;
+    const lsn_t written = page.BeginWriteback();
     Status s = disk_manager_->WritePageAsync(frame_page_ids_[frame_id], page.GetData()).get();
     if (s != Status::OK) return false;
-    page.SetDirty(false);
+    page.MarkWritten(written);
     num_writebacks_.fetch_add(1);
     if constexpr (ENABLE_STORAGE_LOG) {
         g_storage_logger_bpm.log(
@@ -126,6 +142,14 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
 }
 //申请新页 向DiskManager申请新页号,找一个槽位，清空页内容，pin 并返回
 Page* BufferPoolManager::NewPage(page_id_t* page_id) {
+    return NewPageImpl(page_id, false, INVALID_PAGE_ID);
+}
+
+Page* BufferPoolManager::NewExtentPage(page_id_t* page_id, page_id_t near) {
+    return NewPageImpl(page_id, true, near);
+}
+
+Page* BufferPoolManager::NewPageImpl(page_id_t* page_id, bool in_extent, page_id_t near) {
     if (page_id == nullptr) return nullptr;
     std::unique_lock<std::shared_mutex> lock(latch_);
     frame_id_t fid = FindVictimFrame();
@@ -146,7 +170,7 @@ Page* BufferPoolManager::NewPage(page_id_t* page_id) {
     }
 
     // 分配新页并清零（磁盘满时返回 INVALID_PAGE_ID）
-    *page_id = disk_manager_->AllocatePage();
+    *page_id = in_extent ? disk_manager_->AllocateExtentPage(near) : disk_manager_->AllocatePage();
     if (*page_id == INVALID_PAGE_ID) {
         // 回收该帧到空闲列表并返回失败
         page_table_.erase(frame_page_ids_[fid]);
@@ -156,7 +180,18 @@ Page* BufferPoolManager::NewPage(page_id_t* page_id) {
         free_list_.push_front(fid);
         return nullptr;
     }
-    std::memset(frame_page.GetData(), 0, PAGE_SIZE);
+    // 复用的页号可能仍有预读留下的旧帧，丢弃它，避免两个帧映射同一页
+    auto stale = page_table_.find(*page_id);
+    if (stale != page_table_.end() && stale->second != fid) {
+        frame_id_t old_fid = stale->second;
+        if (policy_ == ReplacementPolicy::LRU) lru_replacer_->Pin(old_fid); else fifo_replacer_->Pin(old_fid);
+        pages_[old_fid].Reset();
+        frame_page_ids_[old_fid] = INVALID_PAGE_ID;
+        page_table_.erase(stale);
+        std::lock_guard<std::mutex> guard(free_list_mutex_);
+        free_list_.push_back(old_fid);
+    }
+    std::memset(frame_page.GetData(), 0, page_size_);
     frame_page.SetPageId(*page_id);
     page_table_[*page_id] = fid;
     frame_page_ids_[fid] = *page_id;
@@ -172,7 +207,11 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
     if (it == page_table_.end()) return false;
     frame_id_t fid = it->second;
     Page& page = pages_[fid];
-    if (is_dirty) page.SetDirty(true);
+    if (is_dirty) {
+        // 没有逻辑记录覆盖的改动在这里补一张整页镜像，保证写回前日志里有它
+        page.LogUnloggedChanges();
+        page.SetDirty(true);
+    }
     if (page.GetPinCount() <= 0) return false;
     page.DecPinCount();
     if (page.GetPinCount() == 0) {
@@ -188,9 +227,10 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
     frame_id_t fid = it->second;
     Page& page = pages_[fid];
     if (frame_page_ids_[fid] == INVALID_PAGE_ID) return false;
+    const lsn_t written = page.BeginWriteback();
     Status s = disk_manager_->WritePageAsync(page_id, page.GetData()).get();
     if (s != Status::OK) return false;
-    page.SetDirty(false);
+    page.MarkWritten(written);
     return true;
 }
 //只有当页未被使用（pin=0）时才删；若脏则先写回
@@ -210,24 +250,48 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
         page_table_.erase(it);
         page.Reset();
         frame_page_ids_[fid] = INVALID_PAGE_ID;
+        // 帧转入空闲列表前先移出替换器，否则同一帧可能被重复分配
+        if (policy_ == ReplacementPolicy::LRU) lru_replacer_->Pin(fid); else fifo_replacer_->Pin(fid);
         std::lock_guard<std::mutex> guard(free_list_mutex_);
         free_list_.push_front(fid);
     }
     disk_manager_->DeallocatePage(page_id);
     return true;
 }
+std::vector<DirtyPageEntry> BufferPoolManager::GetDirtyPageTable() const {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    std::vector<DirtyPageEntry> dpt;
+    for (const auto& kv : page_table_) {
+        const Page& page = pages_[kv.second];
+        const lsn_t rec = page.GetRecLsn();
+        if (rec != INVALID_LSN) dpt.push_back(DirtyPageEntry{static_cast<uint32_t>(kv.first), 0, rec});
+    }
+    return dpt;
+}
+
 //把所有脏页写回，并调用 disk_manager_->FlushAllPages()
 void BufferPoolManager::FlushAllPages() {
     std::shared_lock<std::shared_mutex> lock(latch_);
+    // 先收集所有脏页，一次批量提交写回，再统一等待完成
+    std::vector<page_id_t> ids;
+    std::vector<const char*> bufs;
+    std::vector<Page*> dirty;
+    std::vector<lsn_t> written;
     for (auto& kv : page_table_) {
         frame_id_t fid = kv.second;
         Page& page = pages_[fid];
         if (frame_page_ids_[fid] == INVALID_PAGE_ID) continue;
         if (page.IsDirty()) {
-            disk_manager_->WritePageAsync(kv.first, page.GetData()).get();
-            page.SetDirty(false);
+            ids.push_back(kv.first);
+            bufs.push_back(page.GetData());
+            dirty.push_back(&page);
+            written.push_back(page.BeginWriteback());
         }
     }
+    auto futs = disk_manager_->WritePagesAsync(ids, bufs);
+    for (size_t i = 0; i < futs.size(); ++i) {
+        if (futs[i].get() == Status::OK) dirty[i]->MarkWritten(written[i]);
+    }
     disk_manager_->FlushAllPages();
 }
 
@@ -250,19 +314,41 @@ void BufferPoolManager::FlusherMainLoop() {
         size_t flushed = 0;
         {
             std::shared_lock<std::shared_mutex> lock(latch_);
+            std::vector<page_id_t> ids;
+            std::vector<const char*> bufs;
+            std::vector<Page*> dirty;
+            std::vector<lsn_t> written;
             for (auto& kv : page_table_) {
-                if (flushed >= max_flush_per_cycle_.load()) break;
                 frame_id_t fid = kv.second;
                 if (fid == INVALID_FRAME_ID) continue;
                 Page& page = pages_[fid];
                 // 仅 flush 未被pin的脏页
                 if (page.GetPinCount() == 0 && page.IsDirty() && frame_page_ids_[fid] != INVALID_PAGE_ID) {
-                    Status s = disk_manager_->WritePageAsync(frame_page_ids_[fid], page.GetData()).get();
-                    if (s == Status::OK) {
-                        page.SetDirty(false);
-                        num_writebacks_.fetch_add(1);
-                        ++flushed;
-                    }
+                    dirty.push_back(&page);
+                }
+            }
+            // 每轮只写 max_flush_per_cycle_ 页，recLSN 最早的先写，检查点能截断的日志随之前移；
+            // 没有记过日志的脏页（recLSN 为 0）排在最后
+            const size_t limit = std::min(dirty.size(), max_flush_per_cycle_.load());
+            auto rec_key = [](const Page* p) {
+                const lsn_t rec = p->GetRecLsn();
+                return rec == INVALID_LSN ? ~static_cast<lsn_t>(0) : rec;
+            };
+            std::partial_sort(dirty.begin(), dirty.begin() + limit, dirty.end(),
+                              [&](const Page* a, const Page* b) { return rec_key(a) < rec_key(b); });
+            dirty.resize(limit);
+            for (Page* page : dirty) {
+                ids.push_back(page->GetPageId());
+                bufs.push_back(page->GetData());
+                written.push_back(page->BeginWriteback());
+            }
+            // 本轮的脏页一次批量提交
+            auto futs = disk_manager_->WritePagesAsync(ids, bufs);
+            for (size_t i = 0; i < futs.size(); ++i) {
+                if (futs[i].get() == Status::OK) {
+                    dirty[i]->MarkWritten(written[i]);
+                    num_writebacks_.fetch_add(1);
+                    ++flushed;
                 }
             }
         }
@@ -316,49 +402,50 @@ void BufferPoolManager::MaybeAutoResize() {
     // 缩小条件（保守）：命中率高且队列很短且空闲帧很多时，暂不实现（避免抖动）
 }
 
-void BufferPoolManager::TryPrefetch(page_id_t page_id) {
-    // 非阻塞预取：如果该页不在缓存，且有空闲帧则同步读入一页（简化版）
-    if (!readahead_enabled_.load()) return;
-    if (page_id == INVALID_PAGE_ID) return;
-    if (static_cast<size_t>(page_id) > disk_manager_->GetNumPages()) return;
-    if (page_table_.find(page_id) != page_table_.end()) return;
-    frame_id_t fid = FindVictimFrame();
-    if (fid == INVALID_FRAME_ID) return;
-    Page& frame_page = pages_[fid];
-    if (frame_page_ids_[fid] != INVALID_PAGE_ID) {
-        if (!FlushFrameToPages(fid)) {
-            // 放回空闲
-            std::lock_guard<std::mutex> guard(free_list_mutex_);
-            free_list_.push_front(fid);
-            return;
-        }
-        page_table_.erase(frame_page_ids_[fid]);
-        frame_page.Reset();
-        frame_page_ids_[fid] = INVALID_PAGE_ID;
-    }
-    if (disk_manager_->ReadPageAsync(page_id, frame_page.GetData()).get() != Status::OK) {
-        std::lock_guard<std::mutex> guard(free_list_mutex_);
-        free_list_.push_front(fid);
-        return;
-    }
-    frame_page.SetDirty(false);
-    frame_page.SetPageId(page_id);
-    page_table_[page_id] = fid;
-    frame_page_ids_[fid] = page_id;
-    // 不提升 pin，作为冷启动页，进入替换器候选
-    if (policy_ == ReplacementPolicy::LRU) lru_replacer_->Unpin(fid); else fifo_replacer_->Unpin(fid);
-}
-
 void BufferPoolManager::MaybeReadahead(page_id_t just_fetched) {
     if (!readahead_enabled_.load()) return;
     page_id_t prev = last_seq_page_id_.load();
     last_seq_page_id_.store(just_fetched);
     if (prev == INVALID_PAGE_ID) return;
     if (just_fetched != prev + 1) return; // 仅在线性递增时预读
+    // 页链按区分配后后继页在文件中连续：把紧随其后、未缓存的一段页取到空闲帧中，一次 preadv 读入
     uint32_t win = readahead_window_.load();
+    const page_id_t limit = static_cast<page_id_t>(disk_manager_->GetNumPages());
+    std::vector<frame_id_t> fids;
+    std::vector<char*> bufs;
     for (uint32_t i = 1; i <= win; ++i) {
         page_id_t pid = just_fetched + i;
-        TryPrefetch(pid);
+        if (pid >= limit || page_table_.find(pid) != page_table_.end()) break;
+        frame_id_t fid = FindVictimFrame();
+        if (fid == INVALID_FRAME_ID) break;
+        if (frame_page_ids_[fid] != INVALID_PAGE_ID) {
+            if (!FlushFrameToPages(fid)) {
+                // 旧页仍映射在该帧上，放回替换器
+                if (policy_ == ReplacementPolicy::LRU) lru_replacer_->Unpin(fid); else fifo_replacer_->Unpin(fid);
+                break;
+            }
+            page_table_.erase(frame_page_ids_[fid]);
+            pages_[fid].Reset();
+            frame_page_ids_[fid] = INVALID_PAGE_ID;
+        }
+        fids.push_back(fid);
+        bufs.push_back(pages_[fid].GetData());
+    }
+    if (fids.empty()) return;
+    if (disk_manager_->ReadPages(just_fetched + 1, bufs.data(), bufs.size()) != Status::OK) {
+        std::lock_guard<std::mutex> guard(free_list_mutex_);
+        for (frame_id_t fid : fids) free_list_.push_front(fid);
+        return;
+    }
+    for (size_t i = 0; i < fids.size(); ++i) {
+        frame_id_t fid = fids[i];
+        page_id_t pid = just_fetched + 1 + static_cast<page_id_t>(i);
+        pages_[fid].SetDirty(false);
+        pages_[fid].SetPageId(pid);
+        page_table_[pid] = fid;
+        frame_page_ids_[fid] = pid;
+        // 不提升 pin，作为冷启动页，进入替换器候选
+        if (policy_ == ReplacementPolicy::LRU) lru_replacer_->Unpin(fid); else fifo_replacer_->Unpin(fid);
     }
 }
 
@@ -381,15 +468,15 @@ bool BufferPoolManager::GrowPool(size_t new_size) {
         frame_id_t fid = kv.second;
         Page& page = pages_[fid];
         if (frame_page_ids_[fid] != INVALID_PAGE_ID && page.IsDirty()) {
-            disk_manager_->WritePageAsync(frame_page_ids_[fid], page.GetData()).get();
-            page.SetDirty(false);
+            const lsn_t written = page.BeginWriteback();
+            if (disk_manager_->WritePageAsync(frame_page_ids_[fid], page.GetData()).get() == Status::OK)
+                page.MarkWritten(written);
         }
     }
     disk_manager_->FlushAllPages();
 
-    // 释放旧数组并创建新数组
-    delete[] pages_;
-    pages_ = new Page[new_size];
+    // 释放旧数组并创建新数组（固定缓冲区随之重新注册）
+    AllocateFramePool(new_size);
     pool_size_ = new_size;
 
     // 重置元数据结构
@@ -12,6 +12,7 @@
 #include <atomic>
 #include <vector>
 #include <array>
+#include <deque>
 
 namespace minidb {
 
@@ -28,18 +29,25 @@ public:
     //  
     Page* FetchPage(page_id_t page_id);
     Page* NewPage(page_id_t* page_id);
+    // 与 NewPage 相同，但页号按区分配（见 DiskManager::AllocateExtentPage）
+    Page* NewExtentPage(page_id_t* page_id, page_id_t near);
     bool UnpinPage(page_id_t page_id, bool is_dirty);
     bool FlushPage(page_id_t page_id);
     bool DeletePage(page_id_t page_id);
     
     // 批量操作
     void FlushAllPages();
+    // 模糊检查点用的脏页表：已记过日志的脏页及其 recLSN
+    std::vector<DirtyPageEntry> GetDirtyPageTable() const;
     
     // 性能统计
     double GetHitRate() const;
     size_t GetPoolSize() const { return pool_size_; }
+    // 每帧字节数，取自 DiskManager（数据库的页大小）
+    size_t GetPageSize() const { return page_size_; }
     size_t GetFreeFramesCount() const;
     size_t GetNumReplacements() const { return num_replacements_.load(); }
+    size_t GetNumAccesses() const { return num_accesses_.load(); }
     size_t GetNumWritebacks() const { return num_writebacks_.load(); }
     void SetPolicy(ReplacementPolicy p) { policy_ = p; }
     
@@ -58,15 +66,19 @@ public:
 private:
     // 辅助方法
     frame_id_t FindVictimFrame();
+    // 重建 n 帧的页帧数组与页面池（原有内容丢弃）
+    void AllocateFramePool(size_t n);
     bool FlushFrameToPages(frame_id_t frame_id);
     void FlusherMainLoop();
     void MaybeAutoResize();
+    Page* NewPageImpl(page_id_t* page_id, bool in_extent, page_id_t near);
     void MaybeReadahead(page_id_t just_fetched);
-    void TryPrefetch(page_id_t page_id);
     
     size_t pool_size_;
-    Page* pages_;  // 页面池数组
+    FrameBuffer frames_;     // 连续的页帧数组（每帧 page_size_ 字节，按 PAGE_SIZE 对齐，整体注册为 io_uring 固定缓冲区）
+    std::deque<Page> pages_; // 页面池，pages_[i] 指向 frames_ 中的第 i 帧
     DiskManager* disk_manager_;
+    size_t page_size_;
     
     // 页表：page_id -> frame_id 映射 某页在缓存的哪个“槽位”,即帧frame
     std::unordered_map<page_id_t, frame_id_t> page_table_;
@@ -8,10 +8,7 @@ LRUReplacer::LRUReplacer(size_t num_pages) : capacity_(num_pages) {}
 
 bool LRUReplacer::Victim(frame_id_t* frame_id) {
     std::lock_guard<std::mutex> lock(mutex_);
-    // 仅当达到容量上限时才允许淘汰
-    if (lru_list_.size() < capacity_) {
-        return false;
-    }
+    // 任一未被 pin 的帧都可淘汰；只要有一页被 pin 就拒绝淘汰会让并发扫描在缓冲池满时取页失败
     if (lru_list_.empty()) {
         return false;
     }
@@ -41,7 +41,6 @@ public:
     bool Victim(frame_id_t* frame_id) {
         std::lock_guard<std::mutex> lock(mutex_);
         if (queue_.empty()) return false;
-        if (queue_.size() < capacity_) return false;
         frame_id_t fid = queue_.front();
         queue_.pop_front();
         in_queue_.erase(fid);
@@ -1,5 +1,6 @@
 #include "storage/index/bplus_tree.h"
 #include "storage/page/page_header.h"
+#include "storage/page/page_utils.h"
 #include <cstring>
 #include <algorithm>
 // B+树的实现
@@ -16,7 +17,7 @@ namespace minidb
     page_id_t BPlusTree::CreateNew()
     {
         page_id_t pid = INVALID_PAGE_ID;
-        Page *p = engine_->CreatePage(&pid);
+        Page *p = engine_->CreateExtentPage(&pid, INVALID_PAGE_ID); // 新索引单独成段
         if (!p)
             return INVALID_PAGE_ID;
         p->InitializePage(PageType::INDEX_PAGE);
@@ -65,9 +66,9 @@ namespace minidb
         return reinterpret_cast<const LeafEntry *>(page->GetData() + PAGE_HEADER_SIZE + NodeHeaderSize);
     }
 
-    uint16_t BPlusTree::GetLeafMaxEntries()
+    uint16_t BPlusTree::GetLeafMaxEntries() const
     {
-        size_t payload = PAGE_SIZE - PAGE_HEADER_SIZE;
+        size_t payload = engine_->GetPageSize() - PAGE_HEADER_SIZE;
         if (payload < NodeHeaderSize)
             return 0;
         return static_cast<uint16_t>((payload - NodeHeaderSize) / LeafEntrySize);
@@ -98,7 +99,7 @@ namespace minidb
         char *base = PagePayload(page) + NodeHeaderSize;
         // 简单分割：前半是 children（key_count+1），后半是 keys（key_count）
         // 为避免动态计算，这里用最大容量切片视图
-        size_t payload = PAGE_SIZE - PAGE_HEADER_SIZE - NodeHeaderSize;
+        size_t payload = page->GetPageSize() - PAGE_HEADER_SIZE - NodeHeaderSize;
         // 预留一半给 children，一半给 keys（教学简化，真实实现需紧凑布局）
         size_t half = payload / 2;
         InternalArrays ia{};
@@ -110,7 +111,7 @@ namespace minidb
     const BPlusTree::InternalArrays BPlusTree::GetInternalArraysConst(const Page *page)
     {
         char *base = const_cast<char *>(page->GetData()) + PAGE_HEADER_SIZE + NodeHeaderSize;
-        size_t payload = PAGE_SIZE - PAGE_HEADER_SIZE - NodeHeaderSize;
+        size_t payload = page->GetPageSize() - PAGE_HEADER_SIZE - NodeHeaderSize;
         size_t half = payload / 2;
         InternalArrays ia{};
         ia.children = reinterpret_cast<page_id_t *>(base);
@@ -118,9 +119,9 @@ namespace minidb
         return ia;
     }
 
-    uint16_t BPlusTree::GetInternalMaxKeys()
+    uint16_t BPlusTree::GetInternalMaxKeys() const
     {
-        size_t payload = PAGE_SIZE - PAGE_HEADER_SIZE - NodeHeaderSize;
+        size_t payload = engine_->GetPageSize() - PAGE_HEADER_SIZE - NodeHeaderSize;
         size_t half = payload / 2;
         // half / sizeof(page_id_t) 给 children 个数≈max_keys+1；另一半给 keys
         size_t max_keys = std::min((half / sizeof(int32_t)), (half / sizeof(page_id_t)) - 1);
@@ -157,7 +158,7 @@ namespace minidb
     {
         // root 可能是旧叶子，创建新根（internal）
         page_id_t new_root_id = INVALID_PAGE_ID;
-        Page *root = engine_->CreatePage(&new_root_id);
+        Page *root = engine_->CreateExtentPage(&new_root_id, root_page_id_);
         if (!root)
             return;
         root->InitializePage(PageType::INDEX_PAGE);
@@ -263,7 +264,7 @@ namespace minidb
 
         // 创建右内节点
         page_id_t right_id = INVALID_PAGE_ID;
-        Page *right_node = engine_->CreatePage(&right_id);
+        Page *right_node = engine_->CreateExtentPage(&right_id, root_page_id_);
         if (!right_node)
         {
             engine_->PutPage(parent->GetPageId(), true);
@@ -370,19 +371,15 @@ namespace minidb
         }
         if (n < cap)
         {
-            for (uint16_t i = n; i > pos; --i)
-                arr[i] = arr[i - 1];
-            arr[pos].key = key;
-            arr[pos].rid_page = rid.page_id;
-            arr[pos].rid_slot = rid.slot;
-            arr[pos].pad = 0;
-            nh->key_count = static_cast<uint16_t>(n + 1);
+            // 不分裂的插入记一条条目级日志，而不是整页镜像
+            LeafEntry e{key, rid.page_id, rid.slot, 0};
+            InsertArrayEntry(leaf, LeafCountOffset, LeafArrayOffset, LeafEntrySize, pos, &e);
             engine_->PutPage(leaf->GetPageId(), true);
             return true;
         }
         // 分裂：一半移动到新叶
         page_id_t new_leaf_id = INVALID_PAGE_ID;
-        Page *new_leaf = engine_->CreatePage(&new_leaf_id);
+        Page *new_leaf = engine_->CreateExtentPage(&new_leaf_id, root_page_id_);
         if (!new_leaf)
         {
             engine_->PutPage(leaf->GetPageId(), false);
@@ -573,11 +570,7 @@ namespace minidb
         }
 
         // 移动后续元素
-        for (uint16_t i = index; i < n - 1; ++i)
-        {
-            arr[i] = arr[i + 1];
-        }
-        nh->key_count--;
+        RemoveArrayEntry(leaf, LeafCountOffset, LeafArrayOffset, LeafEntrySize, static_cast<uint16_t>(index));
 
         engine_->PutPage(leaf->GetPageId(), true);
         return true;
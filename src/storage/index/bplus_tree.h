@@ -1,5 +1,6 @@
 #pragma once
 #include "storage/storage_engine.h"
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <optional>
@@ -71,6 +72,9 @@ namespace minidb
 
         static constexpr size_t NodeHeaderSize = sizeof(NodeHeader);
         static constexpr size_t LeafEntrySize = sizeof(LeafEntry);
+        // 叶子的键数量与条目数组在页内的偏移（条目级日志记录用）
+        static constexpr uint16_t LeafCountOffset = PAGE_HEADER_SIZE + offsetof(NodeHeader, key_count);
+        static constexpr uint16_t LeafArrayOffset = PAGE_HEADER_SIZE + NodeHeaderSize;
         struct InternalArrays
         {
             int32_t *keys;       // 大小 = key_count
@@ -82,13 +86,14 @@ namespace minidb
         static const NodeHeader *GetNodeHeaderConst(const Page *page);
         static LeafEntry *GetLeafEntries(Page *page);
         static const LeafEntry *GetLeafEntriesConst(const Page *page);
-        static uint16_t GetLeafMaxEntries();
-        static uint16_t GetLeafMinEntries() { return static_cast<uint16_t>(GetLeafMaxEntries() / 2); }
+        // 节点容量随数据库的页大小变化（页越大扇出越高）
+        uint16_t GetLeafMaxEntries() const;
+        uint16_t GetLeafMinEntries() const { return static_cast<uint16_t>(GetLeafMaxEntries() / 2); }
         // 内节点数组视图与容量
         static InternalArrays GetInternalArrays(Page *page);
         static const InternalArrays GetInternalArraysConst(const Page *page);
-        static uint16_t GetInternalMaxKeys();
-        static uint16_t GetInternalMinKeys() { return static_cast<uint16_t>(GetInternalMaxKeys() / 2); }
+        uint16_t GetInternalMaxKeys() const;
+        uint16_t GetInternalMinKeys() const { return static_cast<uint16_t>(GetInternalMaxKeys() / 2); }
 
         static void InitializeLeaf(Page *page);
         static void InitializeInternal(Page *page);
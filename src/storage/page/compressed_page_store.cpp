@@ -0,0 +1,361 @@
+#include "storage/page/compressed_page_store.h"
+#include "util/checksum.h"
+#include "util/lz_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace minidb
+{
+
+    namespace
+    {
+        constexpr uint32_t SLOT_MAGIC = 0x4D435350; // "PSCM"
+        constexpr uint32_t SLOT_RAW = 1;            // 负载是未压缩的原页
+        constexpr uint32_t SLOT_MAP = 2;            // 负载是映射块
+
+        struct SlotHeader
+        {
+            uint32_t magic;
+            page_id_t page_id;
+            uint64_t seq;
+            uint32_t stored_len;
+            uint32_t capacity;
+            uint32_t flags;
+            uint32_t checksum;
+        };
+        static_assert(sizeof(SlotHeader) == 32, "SlotHeader must be 32 bytes");
+
+        // 映射块中的一条记录；page_id 为 INVALID_PAGE_ID 表示空闲槽
+        struct MapRecord
+        {
+            page_id_t page_id;
+            uint32_t capacity;
+            uint64_t offset;
+        };
+        static_assert(sizeof(MapRecord) == 16, "MapRecord must be 16 bytes");
+
+        // 覆盖槽头各字段与负载，可发现撕裂的写
+        uint32_t SlotChecksum(const SlotHeader &h, const char *payload)
+        {
+            uint32_t crc = 0;
+            crc = checksum::MixField(crc, h.page_id);
+            crc = checksum::MixField(crc, h.seq);
+            crc = checksum::MixField(crc, h.stored_len);
+            crc = checksum::MixField(crc, h.flags);
+            return checksum::Mix(crc, payload, h.stored_len);
+        }
+    } // namespace
+
+    uint32_t CompressedPageStore::SlotBytes(size_t payload) const
+    {
+        size_t n = sizeof(SlotHeader) + payload;
+        return static_cast<uint32_t>((n + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN);
+    }
+
+    void CompressedPageStore::Reset(size_t page_size, uint64_t data_start)
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        page_size_ = page_size;
+        slots_.clear();
+        free_slots_.clear();
+        quarantined_.clear();
+        pending_release_.clear();
+        slot_end_ = data_start;
+        write_seq_ = 0;
+        checkpoint_ = Checkpoint{};
+        checkpoint_.slot_end = data_start;
+        map_capacity_ = 0;
+    }
+
+    CompressedPageStore::SlotRef CompressedPageStore::AllocateLocked(uint32_t need)
+    {
+        auto it = free_slots_.lower_bound(need);
+        if (it != free_slots_.end() && it->first <= need * 2)
+        {
+            SlotRef s{it->second, it->first};
+            free_slots_.erase(it);
+            return s;
+        }
+        SlotRef s{slot_end_, need};
+        slot_end_ += need;
+        return s;
+    }
+
+    bool CompressedPageStore::WritePage(page_id_t page_id, const char *data)
+    {
+        if (page_id == INVALID_PAGE_ID)
+            return false;
+        // 压缩在锁外完成；压不到一页以内（含槽头）就存原页
+        std::unique_ptr<char[]> buf(new char[sizeof(SlotHeader) + lz::MaxCompressedSize(page_size_)]);
+        char *payload = buf.get() + sizeof(SlotHeader);
+        const size_t room = page_size_ > sizeof(SlotHeader) ? page_size_ - sizeof(SlotHeader) : 0;
+        size_t len = lz::Compress(data, page_size_, payload, room);
+        SlotHeader h{};
+        h.magic = SLOT_MAGIC;
+        h.page_id = page_id;
+        if (len == 0)
+        {
+            std::memcpy(payload, data, page_size_);
+            len = page_size_;
+            h.flags = SLOT_RAW;
+        }
+        h.stored_len = static_cast<uint32_t>(len);
+        const uint32_t need = SlotBytes(len);
+
+        // 槽的选择与写入在同一把锁内：同一页的并发写不会交错，隔离区的槽也不会被提前复用
+        std::lock_guard<std::mutex> lk(mu_);
+        SlotRef slot;
+        auto cur = slots_.find(page_id);
+        if (cur != slots_.end() && cur->second.capacity >= need)
+        {
+            slot = cur->second; // 原地覆盖
+        }
+        else
+        {
+            slot = AllocateLocked(need);
+            if (cur != slots_.end())
+                quarantined_.push_back(cur->second);
+        }
+        h.seq = ++write_seq_;
+        h.capacity = slot.capacity;
+        h.checksum = SlotChecksum(h, payload);
+        std::memcpy(buf.get(), &h, sizeof(h));
+        if (!write_(slot.offset, buf.get(), sizeof(SlotHeader) + len))
+        {
+            if (cur == slots_.end() || cur->second.offset != slot.offset)
+                quarantined_.push_back(slot);
+            return false;
+        }
+        slots_[page_id] = slot;
+        logical_bytes_ += page_size_;
+        stored_bytes_ += sizeof(SlotHeader) + len;
+        return true;
+    }
+
+    bool CompressedPageStore::ReadPage(page_id_t page_id, char *out)
+    {
+        SlotRef slot;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            auto it = slots_.find(page_id);
+            if (it == slots_.end())
+            {
+                std::memset(out, 0, page_size_);
+                return true;
+            }
+            slot = it->second;
+        }
+        // 被重定位的旧槽在下次持久化前不复用，锁外读到的总是某个完整版本
+        std::unique_ptr<char[]> buf(new char[slot.capacity]);
+        size_t got = 0;
+        if (!read_(slot.offset, buf.get(), slot.capacity, got) || got < sizeof(SlotHeader))
+            return false;
+        SlotHeader h;
+        std::memcpy(&h, buf.get(), sizeof(h));
+        const char *payload = buf.get() + sizeof(SlotHeader);
+        if (h.magic != SLOT_MAGIC || h.page_id != page_id || (h.flags & SLOT_MAP) ||
+            sizeof(SlotHeader) + h.stored_len > got || h.checksum != SlotChecksum(h, payload))
+            return false;
+        if (h.flags & SLOT_RAW)
+        {
+            if (h.stored_len != page_size_)
+                return false;
+            std::memcpy(out, payload, page_size_);
+            return true;
+        }
+        return lz::Decompress(payload, h.stored_len, out, page_size_);
+    }
+
+    void CompressedPageStore::Free(page_id_t page_id)
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        auto it = slots_.find(page_id);
+        if (it == slots_.end())
+            return;
+        quarantined_.push_back(it->second);
+        slots_.erase(it);
+    }
+
+    bool CompressedPageStore::Persist()
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        // 上次映射块与隔离区的槽在本次元数据落盘后才可复用；写入映射块时它们已按空闲记录
+        pending_release_.insert(pending_release_.end(), quarantined_.begin(), quarantined_.end());
+        quarantined_.clear();
+        if (checkpoint_.map_offset != 0)
+        {
+            SlotRef old{checkpoint_.map_offset, map_capacity_};
+            // 映射块写失败后重试时，上次的映射块已在等待释放的列表中
+            bool dup = false;
+            for (const auto &s : pending_release_)
+                dup = dup || s.offset == old.offset;
+            if (!dup)
+                pending_release_.push_back(old);
+        }
+
+        const size_t max_records = slots_.size() + free_slots_.size() + pending_release_.size();
+        const uint32_t need = SlotBytes(max_records * sizeof(MapRecord));
+        SlotRef blob = AllocateLocked(need);
+
+        std::vector<char> buf(blob.capacity, 0);
+        MapRecord *rec = reinterpret_cast<MapRecord *>(buf.data() + sizeof(SlotHeader));
+        size_t n = 0;
+        for (const auto &kv : slots_)
+            rec[n++] = MapRecord{kv.first, kv.second.capacity, kv.second.offset};
+        for (const auto &kv : free_slots_)
+            rec[n++] = MapRecord{INVALID_PAGE_ID, kv.first, kv.second};
+        for (const auto &s : pending_release_)
+            rec[n++] = MapRecord{INVALID_PAGE_ID, s.capacity, s.offset};
+
+        SlotHeader h{};
+        h.magic = SLOT_MAGIC;
+        h.page_id = INVALID_PAGE_ID;
+        h.seq = write_seq_;
+        h.stored_len = static_cast<uint32_t>(n * sizeof(MapRecord));
+        h.capacity = blob.capacity;
+        h.flags = SLOT_MAP;
+        h.checksum = SlotChecksum(h, buf.data() + sizeof(SlotHeader));
+        std::memcpy(buf.data(), &h, sizeof(h));
+        if (!write_(blob.offset, buf.data(), sizeof(SlotHeader) + h.stored_len))
+        {
+            free_slots_.emplace(blob.capacity, blob.offset);
+            return false;
+        }
+        map_capacity_ = blob.capacity;
+        checkpoint_.map_offset = blob.offset;
+        checkpoint_.map_length = h.stored_len;
+        checkpoint_.seq = write_seq_;
+        checkpoint_.slot_end = slot_end_;
+        return true;
+    }
+
+    void CompressedPageStore::CommitPersist()
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        for (const auto &s : pending_release_)
+            free_slots_.emplace(s.capacity, s.offset);
+        pending_release_.clear();
+    }
+
+    CompressedPageStore::Checkpoint CompressedPageStore::GetCheckpoint() const
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        return checkpoint_;
+    }
+
+    size_t CompressedPageStore::GetMappedPages() const
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        return slots_.size();
+    }
+
+    page_id_t CompressedPageStore::GetMaxMappedPage() const
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        page_id_t max_pid = INVALID_PAGE_ID;
+        for (const auto &kv : slots_)
+            if (max_pid == INVALID_PAGE_ID || kv.first > max_pid)
+                max_pid = kv.first;
+        return max_pid;
+    }
+
+    // 检查点之后写入的槽：写序号更大者胜出；被取代的槽进隔离区（可能仍被磁盘上的映射块引用），无效槽直接空闲
+    void CompressedPageStore::ReplaySlot(const SlotRef &slot, uint64_t min_seq,
+                                         std::unordered_map<page_id_t, uint64_t> &seqs)
+    {
+        std::vector<char> buf(slot.capacity);
+        size_t got = 0;
+        SlotHeader h{};
+        bool valid = read_(slot.offset, buf.data(), slot.capacity, got) && got >= sizeof(SlotHeader);
+        if (valid)
+        {
+            std::memcpy(&h, buf.data(), sizeof(h));
+            valid = h.magic == SLOT_MAGIC && !(h.flags & SLOT_MAP) && h.page_id != INVALID_PAGE_ID &&
+                    h.seq > min_seq && sizeof(SlotHeader) + h.stored_len <= got &&
+                    h.checksum == SlotChecksum(h, buf.data() + sizeof(SlotHeader));
+        }
+        auto prev = seqs.find(h.page_id);
+        if (!valid || (prev != seqs.end() && prev->second >= h.seq))
+        {
+            free_slots_.emplace(slot.capacity, slot.offset);
+            return;
+        }
+        auto cur = slots_.find(h.page_id);
+        if (cur != slots_.end())
+        {
+            if (prev != seqs.end())
+                free_slots_.emplace(cur->second.capacity, cur->second.offset); // 同样来自扫描集合
+            else
+                quarantined_.push_back(cur->second);
+        }
+        slots_[h.page_id] = slot;
+        seqs[h.page_id] = h.seq;
+        write_seq_ = std::max(write_seq_, h.seq);
+    }
+
+    bool CompressedPageStore::Load(size_t page_size, uint64_t data_start, const Checkpoint &cp, uint64_t file_size)
+    {
+        Reset(page_size, data_start);
+        std::lock_guard<std::mutex> lk(mu_);
+        checkpoint_ = cp;
+        slot_end_ = std::max<uint64_t>(cp.slot_end, data_start);
+        write_seq_ = cp.seq;
+
+        std::vector<SlotRef> scan;
+        if (cp.map_offset != 0)
+        {
+            std::vector<char> buf(sizeof(SlotHeader) + cp.map_length);
+            size_t got = 0;
+            if (!read_(cp.map_offset, buf.data(), buf.size(), got) || got != buf.size())
+                return false;
+            SlotHeader h;
+            std::memcpy(&h, buf.data(), sizeof(h));
+            if (h.magic != SLOT_MAGIC || !(h.flags & SLOT_MAP) || h.stored_len != cp.map_length ||
+                h.checksum != SlotChecksum(h, buf.data() + sizeof(SlotHeader)))
+                return false;
+            map_capacity_ = h.capacity;
+            const MapRecord *rec = reinterpret_cast<const MapRecord *>(buf.data() + sizeof(SlotHeader));
+            for (size_t i = 0; i < cp.map_length / sizeof(MapRecord); ++i)
+            {
+                if (rec[i].page_id == INVALID_PAGE_ID)
+                    scan.push_back(SlotRef{rec[i].offset, rec[i].capacity});
+                else
+                    slots_[rec[i].page_id] = SlotRef{rec[i].offset, rec[i].capacity};
+            }
+        }
+
+        // 检查点时空闲的槽可能已被之后的写复用
+        std::unordered_map<page_id_t, uint64_t> seqs;
+        for (const auto &s : scan)
+            ReplaySlot(s, cp.seq, seqs);
+
+        // 之后追加的槽：沿槽头中的容量向后走，遇到未写过的区域（预分配的 0）或损坏的槽头即停
+        uint64_t off = slot_end_;
+        while (off + sizeof(SlotHeader) <= file_size)
+        {
+            SlotHeader h;
+            size_t got = 0;
+            if (!read_(off, reinterpret_cast<char *>(&h), sizeof(h), got) || got != sizeof(h))
+                break;
+            if (h.magic != SLOT_MAGIC || h.capacity == 0 || h.capacity % SLOT_ALIGN != 0 ||
+                off + h.capacity > file_size)
+                break;
+            if (h.flags & SLOT_MAP)
+            {
+                // 未能写入元数据的映射块
+                if (off != cp.map_offset)
+                    free_slots_.emplace(h.capacity, off);
+            }
+            else
+            {
+                ReplaySlot(SlotRef{off, h.capacity}, cp.seq, seqs);
+            }
+            off += h.capacity;
+        }
+        slot_end_ = off;
+        return true;
+    }
+
+} // namespace minidb
@@ -0,0 +1,98 @@
+// src/storage/page/compressed_page_store.h
+/**
+ * 压缩页存储（由 DiskManager 在压缩格式的数据库上使用）
+ * - 页 0（元数据）之后的文件区域划分为变长槽，每槽 = SlotHeader + LZ 压缩后的页（压不下时存原页），
+ *   按 SLOT_ALIGN 对齐；内存中维护页号 -> (偏移, 容量) 映射
+ * - 重写一页时放得下就原地覆盖，否则另取一槽，旧槽进入隔离区：映射落盘之前不复用，
+ *   保证已落盘的映射指向的槽在下一次持久化之前始终完好
+ * - Persist 把映射与空闲槽写成文件中的一个映射块，调用方写入元数据后再调用 CommitPersist
+ * - 打开时读入映射块，再扫描之后追加的槽与当时空闲的槽，重放写序号更大的页，检查点之后的写不会丢失
+ * 线程安全（内部加锁）；I/O 经构造时给出的读写函数完成
+ */
+#pragma once
+
+#include "util/config.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace minidb
+{
+
+    class CompressedPageStore
+    {
+    public:
+        using ReadFn = std::function<bool(uint64_t offset, char *buf, size_t len, size_t &got)>;
+        using WriteFn = std::function<bool(uint64_t offset, const char *buf, size_t len)>;
+
+        static constexpr size_t SLOT_ALIGN = 512;
+
+        // 最近一次持久化的映射块，写入元数据
+        struct Checkpoint
+        {
+            uint64_t map_offset{0}; // 0 表示还没有映射块
+            uint32_t map_length{0};
+            uint64_t seq{0};        // 映射块反映的最大写序号
+            uint64_t slot_end{0};   // 当时槽区的末尾
+        };
+
+        CompressedPageStore(ReadFn read, WriteFn write) : read_(std::move(read)), write_(std::move(write)) {}
+
+        // 新库：槽区从 data_start 开始
+        void Reset(size_t page_size, uint64_t data_start);
+        // 已有库：读入映射块并重放检查点之后写入的槽；file_size 为扫描的上界
+        bool Load(size_t page_size, uint64_t data_start, const Checkpoint &cp, uint64_t file_size);
+
+        // 未写过的页读出全 0；槽损坏时返回 false
+        bool ReadPage(page_id_t page_id, char *out);
+        bool WritePage(page_id_t page_id, const char *data);
+        // 页被释放：其槽进入隔离区
+        void Free(page_id_t page_id);
+
+        bool Persist();
+        void CommitPersist();
+        Checkpoint GetCheckpoint() const;
+
+        size_t GetMappedPages() const;
+        // 已映射的最大页号；没有时返回 INVALID_PAGE_ID
+        page_id_t GetMaxMappedPage() const;
+        // 写入的逻辑字节数与实际落盘的字节数（含槽头），用于观察压缩率
+        uint64_t GetLogicalBytesWritten() const { return logical_bytes_.load(); }
+        uint64_t GetStoredBytesWritten() const { return stored_bytes_.load(); }
+
+    private:
+        struct SlotRef
+        {
+            uint64_t offset;
+            uint32_t capacity;
+        };
+
+        uint32_t SlotBytes(size_t payload) const;
+        // 在 mu_ 下取一个至少 need 字节的槽：优先复用空闲槽（不超过 2 倍），否则追加到槽区末尾
+        SlotRef AllocateLocked(uint32_t need);
+        void ReplaySlot(const SlotRef &slot, uint64_t min_seq, std::unordered_map<page_id_t, uint64_t> &seqs);
+
+        ReadFn read_;
+        WriteFn write_;
+        size_t page_size_{PAGE_SIZE};
+
+        mutable std::mutex mu_;
+        std::unordered_map<page_id_t, SlotRef> slots_;
+        std::multimap<uint32_t, uint64_t> free_slots_; // 容量 -> 偏移，可立即复用
+        std::vector<SlotRef> quarantined_;             // 上次持久化之后释放的槽
+        std::vector<SlotRef> pending_release_;         // 已写入映射块、等待元数据落盘后释放的槽
+        uint64_t slot_end_{0};
+        uint64_t write_seq_{0};
+        Checkpoint checkpoint_;
+        uint32_t map_capacity_{0}; // checkpoint_ 所指映射块的槽容量
+
+        std::atomic<uint64_t> logical_bytes_{0};
+        std::atomic<uint64_t> stored_bytes_{0};
+    };
+
+} // namespace minidb
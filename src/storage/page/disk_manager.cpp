@@ -1,4 +1,5 @@
 #include "storage/page/disk_manager.h"
+#include "util/checksum.h"
 #include "util/logger.h"
 #include <cassert>
 #include <cstring>
@@ -9,6 +10,18 @@
 #include "storage/page/page_header.h"
 #include "util/config.h"
 
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+
+#ifdef MINIDB_POSIX_IO
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 namespace minidb {
 
 #ifdef PROJECT_ROOT_DIR
@@ -17,16 +30,160 @@ static Logger g_storage_logger(std::string(PROJECT_ROOT_DIR) + "/logs/storage.lo
 static Logger g_storage_logger("storage.log");
 #endif
 
-    // 负责把页号映射到文件偏移，并做读写。内部用互斥锁保证线程安全。
+#ifdef MINIDB_POSIX_IO
+    namespace
+    {
+        struct FreeDeleter
+        {
+            void operator()(char *p) const { std::free(p); }
+        };
+        using AlignedBuffer = std::unique_ptr<char, FreeDeleter>;
+
+        // O_DIRECT 的中转缓冲区
+        AlignedBuffer AllocAligned(size_t len)
+        {
+            void *p = nullptr;
+            if (::posix_memalign(&p, DIRECT_IO_ALIGNMENT, len) != 0)
+                return AlignedBuffer();
+            return AlignedBuffer(static_cast<char *>(p));
+        }
+
+        uint64_t AlignDown(uint64_t v) { return v & ~static_cast<uint64_t>(DIRECT_IO_ALIGNMENT - 1); }
+        uint64_t AlignUp(uint64_t v) { return AlignDown(v + DIRECT_IO_ALIGNMENT - 1); }
+    } // namespace
+#endif
+
+    // 负责把页号映射到文件偏移，并做读写。POSIX 下按偏移 pread / pwrite，页读写互不加锁；
+    // 文件大小缓存在 file_size_ 中，只在写越过末尾时推进。
 
-    DiskManager::DiskManager(const std::string &db_file) : db_file_(db_file)
+    DiskManager::DiskManager(const std::string &db_file, bool read_only) : db_file_(db_file), read_only_(read_only)
     {
         std::lock_guard<std::mutex> lock(file_mutex_);
-        bool newly_preallocated = false;
-        file_stream_.open(db_file_, std::ios::in | std::ios::out | std::ios::binary);
-        if (!file_stream_.is_open())
+        // 新建数据库按配置的页大小；已有数据库在 LoadOrRecoverMeta 中改为元数据记录的页大小
+        if (IsValidPageSize(GetRuntimeConfig().page_size))
+            page_size_ = GetRuntimeConfig().page_size;
+        else
+            global_log_warn(std::string("[DiskManager::DiskManager] 无效的页大小 ") +
+                            std::to_string(GetRuntimeConfig().page_size) + "，使用 " + std::to_string(PAGE_SIZE));
+        fsm_.SetPageSize(page_size_);
+        if (!OpenFile())
+        {
+            global_log_error(std::string("[DiskManager::DiskManager] 无法打开数据库文件: ") + db_file_);
+        }
+        size_t file_pages = static_cast<size_t>(file_size_.load() / page_size_);
+        if (file_pages > 0)
+        {
+            max_pages_ = std::max(max_pages_, file_pages);
+        }
+        // 使用超级块（page 0）加载或初始化元数据
+        if (!LoadOrRecoverMeta()) {
+            next_page_id_.store(0);
+        }
+        
+        // 确保max_pages_至少等于next_page_id_，避免无法分配新页面
+        max_pages_ = std::max(max_pages_, static_cast<size_t>(next_page_id_.load() + 100));
+        
+        global_log_info(std::string("[DiskManager::DiskManager] Initialized next_page_id_=") + std::to_string(next_page_id_.load()) + " (this=" + std::to_string(reinterpret_cast<uintptr_t>(this)) + ")");
+        // 根据配置优先使用 io_uring；不可用时启动N个I/O工作线程，并设置批量大小
+        const RuntimeConfig &cfg = GetRuntimeConfig();
+#ifdef MINIDB_POSIX_IO
+        if (cfg.io_use_uring && fd_ >= 0 && !cstore_)
+        {
+            uring_ = IoUringEngine::Create(fd_, cfg.io_uring_entries,
+                                           [this](uint64_t tag, int res) { OnUringComplete(tag, res); });
+        }
+#endif
+        if (uring_)
+        {
+            global_log_info("[DiskManager::DiskManager] 异步I/O使用 io_uring");
+        }
+        else
+        {
+            StartWorkers(cfg.io_worker_threads);
+        }
+        batch_max_ = cfg.io_batch_max;
+        extent_pages_ = cfg.alloc_extent_pages;
+    }
+
+    DiskManager::~DiskManager()
+    {
+        Shutdown();
+        uring_.reset();
+        StopWorkers();
+#ifdef MINIDB_POSIX_IO
+        // 工作线程 / io_uring 完成线程已退出，此时才关闭描述符，避免与进行中的 pread / pwrite 竞争
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
+    }
+
+    // 打开数据库文件；不存在时创建（POSIX 下随写入按块增长，其他平台预分配 DEFAULT_DISK_SIZE_BYTES）
+    bool DiskManager::OpenFile()
+    {
+#ifdef MINIDB_POSIX_IO
+        if (read_only_)
+        {
+            fd_ = ::open(db_file_.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st{};
+            if (fd_ < 0 || ::fstat(fd_, &st) != 0)
+                return false;
+            file_size_.store(static_cast<uint64_t>(st.st_size));
+            allocated_bytes_.store(static_cast<uint64_t>(st.st_size));
+            return true;
+        }
+        auto open_with = [this](int flags) {
+            fd_ = ::open(db_file_.c_str(), flags);
+            if (fd_ < 0 && errno == ENOENT)
+            {
+                // 新文件不在这里预分配，第一次写入时由 ReserveFileSpace 按增长策略分配
+                fd_ = ::open(db_file_.c_str(), flags | O_CREAT, 0644);
+            }
+        };
+        int flags = O_RDWR | O_CLOEXEC;
+#ifdef O_DIRECT
+        if (GetRuntimeConfig().io_direct)
+        {
+            open_with(flags | O_DIRECT);
+            if (fd_ >= 0)
+            {
+                direct_io_ = true;
+            }
+            else if (errno == EINVAL)
+            {
+                // 文件系统不支持 O_DIRECT（如 tmpfs）：退回经过页缓存的普通 I/O
+                global_log_warn(std::string("[DiskManager::OpenFile] O_DIRECT 不可用，使用页缓存: ") + db_file_);
+            }
+        }
+#endif
+        if (fd_ < 0)
+            open_with(flags);
+#ifdef __APPLE__
+        // macOS 没有 O_DIRECT，以 F_NOCACHE 关闭该文件的统一缓冲缓存（无对齐要求）
+        if (fd_ >= 0 && GetRuntimeConfig().io_direct)
+            ::fcntl(fd_, F_NOCACHE, 1);
+#endif
+        if (fd_ < 0)
+            return false;
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0)
+            return false;
+        file_size_.store(static_cast<uint64_t>(st.st_size));
+        allocated_bytes_.store(static_cast<uint64_t>(st.st_size));
+        return true;
+#else
+        if (read_only_)
+        {
+            file_stream_.open(db_file_, std::ios::in | std::ios::binary);
+        }
+        else
+        {
+            file_stream_.open(db_file_, std::ios::in | std::ios::out | std::ios::binary);
+        }
+        if (!file_stream_.is_open() && !read_only_)
         {
-            // Create if not exists and preallocate DEFAULT_DISK_SIZE_BYTES
             std::fstream create_stream(db_file_, std::ios::out | std::ios::binary);
             if (create_stream.is_open())
             {
@@ -35,42 +192,207 @@ static Logger g_storage_logger("storage.log");
                     create_stream.seekp(static_cast<std::streamoff>(DEFAULT_DISK_SIZE_BYTES - 1), std::ios::beg);
                     char zero = 0;
                     create_stream.write(&zero, 1);
-                    newly_preallocated = true;
                 }
                 create_stream.close();
             }
             file_stream_.open(db_file_, std::ios::in | std::ios::out | std::ios::binary);
         }
+        if (!file_stream_.is_open())
+            return false;
         file_stream_.seekg(0, std::ios::end);
         std::streamoff size = file_stream_.tellg();
-        size_t file_pages = 0;
-        if (size > 0)
+        file_size_.store(size > 0 ? static_cast<uint64_t>(size) : 0);
+        allocated_bytes_.store(file_size_.load());
+        return true;
+#endif
+    }
+
+    bool DiskManager::ReadAt(uint64_t offset, char *buf, size_t len, size_t &got)
+    {
+        got = 0;
+#ifdef MINIDB_POSIX_IO
+        if (!IsIoAligned(buf, offset, len))
         {
-            file_pages = static_cast<size_t>(size) / PAGE_SIZE;
-            if (file_pages > 0)
+            // 读出覆盖 [offset, offset + len) 的整块，再拷出需要的部分
+            const uint64_t start = AlignDown(offset);
+            const size_t span = static_cast<size_t>(AlignUp(offset + len) - start);
+            AlignedBuffer bounce = AllocAligned(span);
+            size_t raw = 0;
+            if (!bounce || !ReadRaw(start, bounce.get(), span, raw))
+                return false;
+            const size_t skip = static_cast<size_t>(offset - start);
+            got = raw > skip ? std::min(len, raw - skip) : 0;
+            std::memcpy(buf, bounce.get() + skip, got);
+            return true;
+        }
+        return ReadRaw(offset, buf, len, got);
+#else
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        if (!file_stream_.is_open())
+            return false;
+        file_stream_.clear();
+        file_stream_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        file_stream_.read(buf, static_cast<std::streamsize>(len));
+        got = static_cast<size_t>(file_stream_.gcount());
+        bool ok = !file_stream_.bad();
+        file_stream_.clear();
+        return ok;
+#endif
+    }
+
+#ifdef MINIDB_POSIX_IO
+    bool DiskManager::ReadRaw(uint64_t offset, char *buf, size_t len, size_t &got)
+    {
+        got = 0;
+        if (fd_ < 0)
+            return false;
+        while (got < len)
+        {
+            ssize_t n = ::pread(fd_, buf + got, len - got, static_cast<off_t>(offset + got));
+            if (n < 0)
             {
-                max_pages_ = std::max(max_pages_, file_pages);
+                if (errno == EINTR)
+                    continue;
+                return false;
             }
+            if (n == 0)
+                break; // 文件末尾
+            got += static_cast<size_t>(n);
         }
-        // 使用超级块（page 0）加载或初始化元数据
-        if (!LoadOrRecoverMeta()) {
-            next_page_id_.store(0);
+        return true;
+    }
+
+    bool DiskManager::WriteRaw(uint64_t offset, const char *buf, size_t len)
+    {
+        if (fd_ < 0)
+            return false;
+        size_t done = 0;
+        while (done < len)
+        {
+            ssize_t n = ::pwrite(fd_, buf + done, len - done, static_cast<off_t>(offset + done));
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            done += static_cast<size_t>(n);
         }
-        
-        // 确保max_pages_至少等于next_page_id_，避免无法分配新页面
-        max_pages_ = std::max(max_pages_, static_cast<size_t>(next_page_id_.load() + 100));
-        
-        global_log_info(std::string("[DiskManager::DiskManager] Initialized next_page_id_=") + std::to_string(next_page_id_.load()) + " (this=" + std::to_string(reinterpret_cast<uintptr_t>(this)) + ")");
-        // 根据配置启动N个I/O工作线程，并设置批量大小
-        StartWorkers(GetRuntimeConfig().io_worker_threads);
-        batch_max_ = GetRuntimeConfig().io_batch_max;
+        return true;
     }
+#endif
 
-    DiskManager::~DiskManager()
+    bool DiskManager::WriteAt(uint64_t offset, const char *buf, size_t len)
     {
-        Shutdown();
-        StopWorkers();
+        if (read_only_)
+            return false;
+#ifdef MINIDB_POSIX_IO
+        ReserveFileSpace(offset + len);
+        if (IsIoAligned(buf, offset, len))
+        {
+            if (!WriteRaw(offset, buf, len))
+                return false;
+        }
+        else
+        {
+            const uint64_t start = AlignDown(offset);
+            const size_t span = static_cast<size_t>(AlignUp(offset + len) - start);
+            AlignedBuffer bounce = AllocAligned(span);
+            if (!bounce)
+                return false;
+            if (start != offset || span != len)
+            {
+                // 首尾不满一块：先读出原有内容再覆盖
+                size_t raw = 0;
+                if (!ReadRaw(start, bounce.get(), span, raw))
+                    return false;
+                std::memset(bounce.get() + raw, 0, span - raw);
+            }
+            std::memcpy(bounce.get() + (offset - start), buf, len);
+            if (!WriteRaw(start, bounce.get(), span))
+                return false;
+        }
+#else
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        if (!file_stream_.is_open())
+            return false;
+        file_stream_.seekp(static_cast<std::streamoff>(offset), std::ios::beg);
+        file_stream_.write(buf, static_cast<std::streamsize>(len));
+        file_stream_.flush();
+        if (!file_stream_)
+            return false;
+#endif
+        ExtendFileSize(offset + len);
+        return true;
     }
+
+    void DiskManager::ExtendFileSize(uint64_t end)
+    {
+        uint64_t cur = file_size_.load(std::memory_order_relaxed);
+        while (end > cur && !file_size_.compare_exchange_weak(cur, end, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void DiskManager::ReserveFileSpace(uint64_t end)
+    {
+#ifdef MINIDB_POSIX_IO
+        if (read_only_ || fd_ < 0 || end <= allocated_bytes_.load(std::memory_order_acquire))
+            return;
+        const RuntimeConfig &cfg = GetRuntimeConfig();
+        if (cfg.file_grow_max_bytes == 0)
+            return;
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        const uint64_t cur = allocated_bytes_.load(std::memory_order_relaxed);
+        if (end <= cur)
+            return;
+        // 按当前大小的百分比增长，夹在 [min, max] 之间；大文件每次多分配，小文件不至于一下子占满磁盘
+        uint64_t grow = cur / 100 * cfg.file_grow_percent;
+        grow = std::max<uint64_t>(grow, cfg.file_grow_min_bytes);
+        grow = std::min<uint64_t>(grow, cfg.file_grow_max_bytes);
+        uint64_t target = std::max<uint64_t>(end, cur + grow);
+        target = (target + page_size_ - 1) / page_size_ * page_size_;
+
+        int err = 0;
+#ifdef __linux__
+        // 模式 0：分配块并推进文件大小，之后块内的写既不分配也不改 inode 大小
+        if (!fallocate_unsupported_ &&
+            ::fallocate(fd_, 0, static_cast<off_t>(cur), static_cast<off_t>(target - cur)) != 0)
+        {
+            err = errno;
+            if (err == EOPNOTSUPP || err == ENOSYS)
+            {
+                fallocate_unsupported_ = true;
+                global_log_warn(std::string("[DiskManager::ReserveFileSpace] fallocate 不可用，改用 ftruncate: ") + db_file_);
+            }
+        }
+#else
+        fallocate_unsupported_ = true;
+#endif
+        if (fallocate_unsupported_)
+        {
+            // 退化为一次 ftruncate（稀疏文件）：不预留块，但同样省掉逐页推进文件大小
+            err = 0;
+            struct stat st{};
+            if (::fstat(fd_, &st) == 0 && static_cast<uint64_t>(st.st_size) < target &&
+                ::ftruncate(fd_, static_cast<off_t>(target)) != 0)
+                err = errno;
+        }
+        if (err != 0)
+        {
+            // 空间不足等：不预留，让这次写自己扩展文件（写失败时由调用方报告）
+            global_log_warn(std::string("[DiskManager::ReserveFileSpace] 文件增长到 ") + std::to_string(target) +
+                            " 字节失败: " + std::strerror(err));
+            return;
+        }
+        allocated_bytes_.store(target, std::memory_order_release);
+        file_grow_count_.fetch_add(1);
+        ExtendFileSize(target);
+#else
+        (void)end;
+#endif
+    }
+
     // 读，如果超出文件末尾，就返回“全 0”缓冲（对新页或空洞很友好)
     Status DiskManager::ReadPage(page_id_t page_id, char *page_data)
     {
@@ -78,31 +400,36 @@ static Logger g_storage_logger("storage.log");
         {
             return Status::INVALID_PARAM;
         }
-        std::lock_guard<std::mutex> lock(file_mutex_);
         if (is_shutdown_.load())
         {
             return Status::IO_ERROR;
         }
+        if (cstore_)
+        {
+            if (!cstore_->ReadPage(page_id, page_data))
+            {
+                global_log_error(std::string("[DiskManager::ReadPage] 压缩槽损坏: page_id=") + std::to_string(page_id));
+                return Status::IO_ERROR;
+            }
+            num_reads_.fetch_add(1);
+            return Status::OK;
+        }
         size_t offset = GetFileOffset(page_id);
-        file_stream_.seekg(0, std::ios::end);
-        std::streamoff file_size = file_stream_.tellg();
-        if (static_cast<std::streamoff>(offset) >= file_size)
+        if (offset >= file_size_.load(std::memory_order_acquire))
         {
             // Reading beyond EOF: return zero-filled page
-            std::memset(page_data, 0, PAGE_SIZE);
+            std::memset(page_data, 0, page_size_);
             return Status::OK;
         }
-        file_stream_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
-        file_stream_.read(page_data, PAGE_SIZE);
-        if (file_stream_.gcount() < static_cast<std::streamsize>(PAGE_SIZE))
+        size_t got = 0;
+        if (!ReadAt(offset, page_data, page_size_, got))
         {
-            // Short read, zero remainder
-            std::streamsize read_cnt = file_stream_.gcount();
-            std::memset(page_data + read_cnt, 0, PAGE_SIZE - static_cast<size_t>(read_cnt));
+            return Status::IO_ERROR;
         }
-        if (!file_stream_)
+        if (got < page_size_)
         {
-            return Status::IO_ERROR;
+            // Short read, zero remainder
+            std::memset(page_data + got, 0, page_size_ - got);
         }
         num_reads_.fetch_add(1);
         if constexpr (ENABLE_STORAGE_LOG) {
@@ -117,20 +444,28 @@ static Logger g_storage_logger("storage.log");
         {
             return Status::INVALID_PARAM;
         }
-        std::lock_guard<std::mutex> lock(file_mutex_);
-        if (is_shutdown_.load())
+        if (is_shutdown_.load() || read_only_)
         {
             return Status::IO_ERROR;
         }
         // WAL: 先写日志，再写数据
-        if (wal_ != nullptr) {
-            wal_->Append(page_id, page_data);
+        if (!LogBeforeWrite(page_id, &page_data, 1))
+        {
+            return Status::IO_ERROR;
+        }
+        if (cstore_)
+        {
+            if (!cstore_->WritePage(page_id, page_data))
+            {
+                global_log_warn(std::string("[DiskManager::WritePage] Write failed for page_id=") + std::to_string(page_id));
+                return Status::IO_ERROR;
+            }
+            num_writes_.fetch_add(1);
+            AdvanceNextPageId(page_id);
+            return Status::OK;
         }
         size_t offset = GetFileOffset(page_id);
-        file_stream_.seekp(static_cast<std::streamoff>(offset), std::ios::beg);
-        file_stream_.write(page_data, PAGE_SIZE);
-        file_stream_.flush();
-        if (!file_stream_)
+        if (!WriteAt(offset, page_data, page_size_))
         {
             global_log_warn(std::string("[DiskManager::WritePage] Write failed for page_id=") + std::to_string(page_id));
             return Status::IO_ERROR;
@@ -140,14 +475,243 @@ static Logger g_storage_logger("storage.log");
         if constexpr (ENABLE_STORAGE_LOG) {
             g_storage_logger.log(std::string("[DM] Write page ") + std::to_string((unsigned)page_id));
         }
-        // 依据写入的页号推进下一个可用页号（0基）：next = max(next, page_id + 1)
-        page_id_t expected_next = static_cast<page_id_t>(page_id + 1);
+        AdvanceNextPageId(page_id);
+        return Status::OK;
+    }
+
+    // 依据写入的页号推进下一个可用页号（0基）：next = max(next, page_id + 1)
+    void DiskManager::AdvanceNextPageId(page_id_t written)
+    {
+        page_id_t expected_next = static_cast<page_id_t>(written + 1);
         page_id_t cur = next_page_id_.load();
-        if (expected_next > cur)
+        while (expected_next > cur && !next_page_id_.compare_exchange_weak(cur, expected_next))
+        {
+        }
+    }
+
+    bool DiskManager::LogBeforeWrite(page_id_t first, const char *const *bufs, size_t n)
+    {
+        if (wal_ == nullptr || n == 0)
+            return true;
+        // 经缓冲池修改的页已在页头带上最后一条日志的 LSN，只需等它落盘；
+        // 页 LSN 为 0 的页没有经过页内日志（直接写页的调用方），仍追加整页镜像
+        lsn_t last = INVALID_LSN;
+        bool ok = true;
+        for (size_t i = 0; i < n && ok; ++i)
+        {
+            const PageHeader *hdr = reinterpret_cast<const PageHeader *>(bufs[i]);
+            lsn_t lsn = hdr->GetLsn();
+            if (lsn == INVALID_LSN)
+            {
+                if (hdr->page_type == static_cast<uint16_t>(PageType::TEMP_PAGE))
+                    continue;
+                lsn = wal_->Append(static_cast<page_id_t>(first + i), bufs[i]);
+                ok = lsn != INVALID_LSN;
+            }
+            last = std::max(last, lsn);
+        }
+        // 一批页只等 LSN 最大的记录；并发写页的线程在组提交线程上共享同一次 fdatasync
+        if (!ok || (last != INVALID_LSN && !wal_->WaitDurable(last)))
+        {
+            global_log_warn(std::string("[DiskManager] WAL 写入失败，放弃写页 page_id=") + std::to_string(first));
+            return false;
+        }
+        return true;
+    }
+
+    bool DiskManager::SyncData()
+    {
+#ifdef MINIDB_POSIX_IO
+        return fd_ >= 0 && !read_only_ && ::fdatasync(fd_) == 0;
+#else
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        file_stream_.flush();
+        return static_cast<bool>(file_stream_);
+#endif
+    }
+
+    bool DiskManager::ReadPageBytes(page_id_t page_id, char *buf)
+    {
+        if (cstore_)
+            return cstore_->ReadPage(page_id, buf);
+        size_t got = 0;
+        return ReadAt(GetFileOffset(page_id), buf, page_size_, got) && got == page_size_;
+    }
+
+    bool DiskManager::WritePageBytes(page_id_t page_id, const char *buf)
+    {
+        if (cstore_)
+            return cstore_->WritePage(page_id, buf);
+        return WriteAt(GetFileOffset(page_id), buf, page_size_);
+    }
+
+    void DiskManager::CreateCompressedStore()
+    {
+        cstore_ = std::make_unique<CompressedPageStore>(
+            [this](uint64_t offset, char *buf, size_t len, size_t &got) { return ReadAt(offset, buf, len, got); },
+            [this](uint64_t offset, const char *buf, size_t len) { return WriteAt(offset, buf, len); });
+    }
+
+    Status DiskManager::ReadPages(page_id_t first, char *const *bufs, size_t n)
+    {
+        if (first == INVALID_PAGE_ID || bufs == nullptr)
+        {
+            return Status::INVALID_PARAM;
+        }
+        if (is_shutdown_.load())
+        {
+            return Status::IO_ERROR;
+        }
+#ifdef MINIDB_POSIX_IO
+        for (size_t i = 0; i < n && (direct_io_ || cstore_); ++i)
+        {
+            if (cstore_ || !IsIoAligned(bufs[i], 0, page_size_))
+            {
+                // 压缩格式下页在文件中不连续，或 O_DIRECT 下有未对齐的缓冲区：逐页读
+                for (size_t j = 0; j < n; ++j)
+                {
+                    Status s = ReadPage(static_cast<page_id_t>(first + j), bufs[j]);
+                    if (s != Status::OK)
+                        return s;
+                }
+                return Status::OK;
+            }
+        }
+        // 文件末尾之后的页直接置零，其余一次 preadv（超出 IOV_MAX 时分段）
+        const uint64_t base = GetFileOffset(first);
+        const uint64_t size = file_size_.load(std::memory_order_acquire);
+        size_t in_file = 0;
+        while (in_file < n && base + in_file * page_size_ < size)
+            ++in_file;
+        for (size_t i = in_file; i < n; ++i)
+            std::memset(bufs[i], 0, page_size_);
+
+        std::vector<struct iovec> iov;
+        for (size_t start = 0; start < in_file;)
+        {
+            const size_t cnt = std::min<size_t>(in_file - start, IOV_MAX);
+            iov.resize(cnt);
+            for (size_t i = 0; i < cnt; ++i)
+                iov[i] = {bufs[start + i], page_size_};
+            size_t done = 0;
+            const size_t want = cnt * page_size_;
+            while (done < want)
+            {
+                // 跳过已读满的 iovec，调整首个未满的 iovec
+                size_t skip = done / page_size_;
+                size_t partial = done % page_size_;
+                iov[skip].iov_base = bufs[start + skip] + partial;
+                iov[skip].iov_len = page_size_ - partial;
+                ssize_t r = ::preadv(fd_, iov.data() + skip, static_cast<int>(cnt - skip),
+                                     static_cast<off_t>(base + start * page_size_ + done));
+                if (r < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return Status::IO_ERROR;
+                }
+                if (r == 0)
+                {
+                    // 并发截断等导致的短读：余下部分置零
+                    for (size_t i = skip; i < cnt; ++i)
+                    {
+                        size_t from = i == skip ? partial : 0;
+                        std::memset(bufs[start + i] + from, 0, page_size_ - from);
+                    }
+                    break;
+                }
+                done += static_cast<size_t>(r);
+            }
+            start += cnt;
+        }
+        num_reads_.fetch_add(in_file);
+        return Status::OK;
+#else
+        for (size_t i = 0; i < n; ++i)
+        {
+            Status s = ReadPage(static_cast<page_id_t>(first + i), bufs[i]);
+            if (s != Status::OK)
+                return s;
+        }
+        return Status::OK;
+#endif
+    }
+
+    Status DiskManager::WritePages(page_id_t first, const char *const *bufs, size_t n)
+    {
+        if (first == INVALID_PAGE_ID || bufs == nullptr)
+        {
+            return Status::INVALID_PARAM;
+        }
+        if (is_shutdown_.load() || read_only_)
+        {
+            return Status::IO_ERROR;
+        }
+#ifdef MINIDB_POSIX_IO
+        if (n == 0)
+            return Status::OK;
+        for (size_t i = 0; i < n && (direct_io_ || cstore_); ++i)
         {
-            next_page_id_.store(expected_next);
+            if (cstore_ || !IsIoAligned(bufs[i], 0, page_size_))
+            {
+                for (size_t j = 0; j < n; ++j)
+                {
+                    Status s = WritePage(static_cast<page_id_t>(first + j), bufs[j]);
+                    if (s != Status::OK)
+                        return s;
+                }
+                return Status::OK;
+            }
+        }
+        // WAL: 先写日志，再写数据
+        if (!LogBeforeWrite(first, bufs, n))
+        {
+            return Status::IO_ERROR;
         }
+        const uint64_t base = GetFileOffset(first);
+        ReserveFileSpace(base + n * page_size_);
+        std::vector<struct iovec> iov;
+        for (size_t start = 0; start < n;)
+        {
+            const size_t cnt = std::min<size_t>(n - start, IOV_MAX);
+            iov.resize(cnt);
+            for (size_t i = 0; i < cnt; ++i)
+                iov[i] = {const_cast<char *>(bufs[start + i]), page_size_};
+            size_t done = 0;
+            const size_t want = cnt * page_size_;
+            while (done < want)
+            {
+                size_t skip = done / page_size_;
+                size_t partial = done % page_size_;
+                iov[skip].iov_base = const_cast<char *>(bufs[start + skip]) + partial;
+                iov[skip].iov_len = page_size_ - partial;
+                ssize_t r = ::pwritev(fd_, iov.data() + skip, static_cast<int>(cnt - skip),
+                                      static_cast<off_t>(base + start * page_size_ + done));
+                if (r < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    global_log_warn(std::string("[DiskManager::WritePages] pwritev failed at page_id=") +
+                                    std::to_string(first + start + skip) + ": " + std::strerror(errno));
+                    return Status::IO_ERROR;
+                }
+                done += static_cast<size_t>(r);
+            }
+            start += cnt;
+        }
+        ExtendFileSize(base + n * page_size_);
+        num_writes_.fetch_add(n);
+        AdvanceNextPageId(static_cast<page_id_t>(first + n - 1));
         return Status::OK;
+#else
+        for (size_t i = 0; i < n; ++i)
+        {
+            Status s = WritePage(static_cast<page_id_t>(first + i), bufs[i]);
+            if (s != Status::OK)
+                return s;
+        }
+        return Status::OK;
+#endif
     }
 
     std::future<Status> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data)
@@ -178,8 +742,70 @@ static Logger g_storage_logger("storage.log");
         workers_.clear();
     }
 
+    std::vector<std::future<Status>> DiskManager::WritePagesAsync(const std::vector<page_id_t> &page_ids,
+                                                                  const std::vector<const char *> &bufs)
+    {
+        const size_t n = std::min(page_ids.size(), bufs.size());
+        std::vector<std::future<Status>> futs;
+        futs.reserve(n);
+        if (uring_)
+        {
+            // 按页号排序后，页号连续的一段合并为一个 WRITEV；futs 仍与 page_ids 一一对应
+            std::vector<size_t> order(n);
+            for (size_t i = 0; i < n; ++i)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(),
+                             [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+            futs.resize(n);
+            std::vector<const char *> run;
+            for (size_t i = 0; i < n;)
+            {
+                const page_id_t first = page_ids[order[i]];
+                size_t len = 1;
+#ifdef MINIDB_HAS_IO_URING
+                if (first != INVALID_PAGE_ID)
+                {
+                    while (i + len < n && len < IOV_MAX && page_ids[order[i + len]] == static_cast<page_id_t>(first + len))
+                        ++len;
+                }
+#endif
+                if (len == 1)
+                {
+                    futs[order[i]] = EnqueueUring(IOType::Write, first, nullptr, bufs[order[i]], false);
+                }
+                else
+                {
+                    run.clear();
+                    for (size_t k = 0; k < len; ++k)
+                        run.push_back(bufs[order[i + k]]);
+                    auto run_futs = EnqueueUringRun(first, run.data(), len);
+                    for (size_t k = 0; k < len; ++k)
+                        futs[order[i + k]] = std::move(run_futs[k]);
+                }
+                i += len;
+            }
+            uring_->Submit();
+            return futs;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            for (size_t i = 0; i < n; ++i)
+            {
+                IORequest req{IOType::Write, page_ids[i], nullptr, bufs[i], std::promise<Status>()};
+                futs.push_back(req.prom.get_future());
+                io_queue_.emplace_back(std::move(req));
+            }
+        }
+        queue_cv_.notify_all();
+        return futs;
+    }
+
     std::future<Status> DiskManager::Enqueue(IOType type, page_id_t page_id, char* rbuf, const char* wbuf)
     {
+        if (uring_)
+        {
+            return EnqueueUring(type, page_id, rbuf, wbuf, true);
+        }
         IORequest req{type, page_id, rbuf, wbuf, std::promise<Status>()};
         std::future<Status> fut = req.prom.get_future();
         {
@@ -205,41 +831,303 @@ static Logger g_storage_logger("storage.log");
                     io_queue_.pop_front();
                 }
             }
-            // 简单排序：Write 按 page_id 升序，Read 保持相对次序
+            // 写优先分组；组内按 page_id 升序（stable：同一页的多次写保持提交顺序），便于合并相邻页
             std::stable_sort(batch.begin(), batch.end(), [](const IORequest& a, const IORequest& b){
-                if (a.type != b.type) return a.type == IOType::Write; // 写优先分组
-                if (a.type == IOType::Write) return a.page_id < b.page_id; // 写按页顺序
-                return false;
+                if (a.type != b.type) return a.type == IOType::Write;
+                return a.page_id < b.page_id;
             });
-            // 逐个执行（可进一步合并相邻页写入）
-            for (auto &req : batch) {
+            // 同类型、页号连续的一段请求合并为一次 preadv / pwritev
+            std::vector<char*> rbufs;
+            std::vector<const char*> wbufs;
+            for (size_t i = 0; i < batch.size();) {
+                const IOType type = batch[i].type;
+                const page_id_t first = batch[i].page_id;
+                size_t n = 1;
+                if (first != INVALID_PAGE_ID) {
+                    while (i + n < batch.size() && batch[i + n].type == type &&
+                           batch[i + n].page_id == static_cast<page_id_t>(first + n))
+                        ++n;
+                }
                 Status s = Status::IO_ERROR;
                 auto t0 = std::chrono::high_resolution_clock::now();
-                if (req.type == IOType::Read) {
-                    s = ReadPage(req.page_id, req.read_buf);
-                    read_ops_.fetch_add(1);
+                if (n == 1) {
+                    s = type == IOType::Read ? ReadPage(first, batch[i].read_buf) : WritePage(first, batch[i].write_buf);
+                } else if (type == IOType::Read) {
+                    rbufs.clear();
+                    for (size_t k = 0; k < n; ++k) rbufs.push_back(batch[i + k].read_buf);
+                    s = ReadPages(first, rbufs.data(), n);
                 } else {
-                    s = WritePage(req.page_id, req.write_buf);
-                    write_ops_.fetch_add(1);
+                    wbufs.clear();
+                    for (size_t k = 0; k < n; ++k) wbufs.push_back(batch[i + k].write_buf);
+                    s = WritePages(first, wbufs.data(), n);
                 }
                 auto t1 = std::chrono::high_resolution_clock::now();
                 uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
-                if (req.type == IOType::Read) total_read_ns_.fetch_add(ns); else total_write_ns_.fetch_add(ns);
-                req.prom.set_value(s);
+                if (type == IOType::Read) {
+                    read_ops_.fetch_add(n);
+                    total_read_ns_.fetch_add(ns);
+                } else {
+                    write_ops_.fetch_add(n);
+                    total_write_ns_.fetch_add(ns);
+                }
+                if (n > 1) NoteMergedRun(n);
+                for (size_t k = 0; k < n; ++k) batch[i + k].prom.set_value(s);
+                i += n;
             }
         }
     }
+    std::future<Status> DiskManager::EnqueueUring(IOType type, page_id_t page_id, char* rbuf, const char* wbuf, bool submit)
+    {
+        const bool is_read = type == IOType::Read;
+        std::promise<Status> ready;
+        if (page_id == INVALID_PAGE_ID || (is_read ? rbuf == nullptr : wbuf == nullptr))
+        {
+            ready.set_value(Status::INVALID_PARAM);
+            return ready.get_future();
+        }
+        if (is_shutdown_.load() || (!is_read && read_only_))
+        {
+            ready.set_value(Status::IO_ERROR);
+            return ready.get_future();
+        }
+        const uint64_t offset = GetFileOffset(page_id);
+        if (is_read && offset >= file_size_.load(std::memory_order_acquire))
+        {
+            // 与 ReadPage 一致：文件末尾之后的页为全 0，不必进入内核
+            std::memset(rbuf, 0, page_size_);
+            ready.set_value(Status::OK);
+            return ready.get_future();
+        }
+        // WAL: 先写日志，再提交数据写
+        if (!is_read && !LogBeforeWrite(page_id, &wbuf, 1))
+        {
+            ready.set_value(Status::IO_ERROR);
+            return ready.get_future();
+        }
+        auto *req = new IORequest{type, page_id, rbuf, wbuf, std::promise<Status>()};
+        req->start = std::chrono::high_resolution_clock::now();
+        std::future<Status> fut = req->prom.get_future();
+        const uint64_t tag = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(req));
+        if (!IsIoAligned(is_read ? static_cast<const void *>(rbuf) : wbuf, offset, page_size_))
+        {
+            // O_DIRECT 下未对齐的缓冲区不交给内核，经中转缓冲区同步完成
+            int res = -EIO;
+            size_t got = 0;
+            if (is_read ? ReadAt(offset, rbuf, page_size_, got) : WriteAt(offset, wbuf, page_size_))
+                res = static_cast<int>(is_read ? got : page_size_);
+            OnUringComplete(tag, res);
+            return fut;
+        }
+        if (!is_read)
+        {
+            ReserveFileSpace(offset + page_size_);
+        }
+        bool queued = is_read ? uring_->PrepareRead(offset, rbuf, page_size_, tag)
+                              : uring_->PrepareWrite(offset, wbuf, page_size_, tag);
+        if (!queued)
+        {
+            // 引擎只在析构时停止，此时 DiskManager 已关闭，与工作线程路径一样返回 IO_ERROR
+            req->prom.set_value(Status::IO_ERROR);
+            delete req;
+            return fut;
+        }
+        if (submit)
+        {
+            uring_->Submit();
+        }
+        return fut;
+    }
+
+    void DiskManager::NoteMergedRun(size_t n)
+    {
+        merged_runs_.fetch_add(1);
+        merged_run_pages_.fetch_add(n);
+        size_t prev = max_merged_run_.load();
+        while (n > prev && !max_merged_run_.compare_exchange_weak(prev, n))
+        {
+        }
+    }
+
+    std::vector<std::future<Status>> DiskManager::EnqueueUringRun(page_id_t first, const char *const *bufs, size_t n)
+    {
+        std::vector<std::future<Status>> futs;
+        futs.reserve(n);
+#ifdef MINIDB_HAS_IO_URING
+        const uint64_t offset = GetFileOffset(first);
+        bool aligned = true;
+        for (size_t k = 0; k < n && aligned; ++k)
+            aligned = IsIoAligned(bufs[k], offset + k * page_size_, page_size_);
+        if (aligned)
+        {
+            Status early = Status::OK;
+            if (is_shutdown_.load() || read_only_)
+                early = Status::IO_ERROR;
+            // WAL: 先写日志，再提交数据写
+            else if (!LogBeforeWrite(first, bufs, n))
+                early = Status::IO_ERROR;
+            if (early != Status::OK)
+            {
+                for (size_t k = 0; k < n; ++k)
+                {
+                    std::promise<Status> ready;
+                    ready.set_value(early);
+                    futs.push_back(ready.get_future());
+                }
+                return futs;
+            }
+            auto *req = new IORequest{IOType::Write, first, nullptr, bufs[0], std::promise<Status>()};
+            req->start = std::chrono::high_resolution_clock::now();
+            req->run_iov.resize(n);
+            req->run_proms.resize(n);
+            for (size_t k = 0; k < n; ++k)
+            {
+                req->run_iov[k] = {const_cast<char *>(bufs[k]), page_size_};
+                futs.push_back(req->run_proms[k].get_future());
+            }
+            ReserveFileSpace(offset + n * page_size_);
+            const uint64_t tag = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(req));
+            if (!uring_->PrepareWritev(offset, req->run_iov.data(), static_cast<unsigned>(n), tag))
+            {
+                for (auto &p : req->run_proms)
+                    p.set_value(Status::IO_ERROR);
+                delete req;
+            }
+            return futs;
+        }
+#endif
+        // O_DIRECT 下有未对齐的缓冲区：逐页提交，由 EnqueueUring 经中转缓冲区完成
+        for (size_t k = 0; k < n; ++k)
+            futs.push_back(EnqueueUring(IOType::Write, static_cast<page_id_t>(first + k), nullptr, bufs[k], false));
+        return futs;
+    }
+
+    void DiskManager::CompleteUringRun(IORequest &req, int res)
+    {
+#ifdef MINIDB_HAS_IO_URING
+        const size_t n = req.run_proms.size();
+        const uint64_t offset = GetFileOffset(req.page_id);
+        Status s = Status::OK;
+        if (res < 0)
+        {
+            global_log_warn(std::string("[DiskManager::CompleteUringRun] WRITEV failed at page_id=") +
+                            std::to_string(req.page_id) + ": " + std::strerror(-res));
+            s = Status::IO_ERROR;
+        }
+        else
+        {
+            // 短写：从断点所在页起逐页同步补齐
+            const size_t done = static_cast<size_t>(res);
+            for (size_t k = done / page_size_; k < n && s == Status::OK; ++k)
+            {
+                const size_t from = std::max(done, k * page_size_) - k * page_size_;
+                const char *buf = static_cast<const char *>(req.run_iov[k].iov_base);
+                if (!WriteAt(offset + k * page_size_ + from, buf + from, page_size_ - from))
+                    s = Status::IO_ERROR;
+            }
+            if (s == Status::OK)
+            {
+                ExtendFileSize(offset + n * page_size_);
+                num_writes_.fetch_add(n);
+                AdvanceNextPageId(static_cast<page_id_t>(req.page_id + n - 1));
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - req.start).count());
+        write_ops_.fetch_add(n);
+        total_write_ns_.fetch_add(ns);
+        NoteMergedRun(n);
+        for (auto &p : req.run_proms)
+            p.set_value(s);
+#else
+        (void)req;
+        (void)res;
+#endif
+    }
+
+    void DiskManager::OnUringComplete(uint64_t tag, int res)
+    {
+        std::unique_ptr<IORequest> req(reinterpret_cast<IORequest *>(static_cast<uintptr_t>(tag)));
+#ifdef MINIDB_HAS_IO_URING
+        if (!req->run_proms.empty())
+        {
+            CompleteUringRun(*req, res);
+            return;
+        }
+#endif
+        Status s = Status::OK;
+        if (res < 0)
+        {
+            global_log_warn(std::string("[DiskManager::OnUringComplete] I/O failed for page_id=") +
+                            std::to_string(req->page_id) + ": " + std::strerror(-res));
+            s = Status::IO_ERROR;
+        }
+        else if (req->type == IOType::Read)
+        {
+            if (static_cast<size_t>(res) < page_size_)
+            {
+                // Short read, zero remainder
+                std::memset(req->read_buf + res, 0, page_size_ - res);
+            }
+            num_reads_.fetch_add(1);
+        }
+        else
+        {
+            const uint64_t offset = GetFileOffset(req->page_id);
+            // 短写：余下部分同步补齐
+            if (static_cast<size_t>(res) < page_size_ && !WriteAt(offset + res, req->write_buf + res, page_size_ - res))
+            {
+                s = Status::IO_ERROR;
+            }
+            else
+            {
+                ExtendFileSize(offset + page_size_);
+                num_writes_.fetch_add(1);
+                AdvanceNextPageId(req->page_id);
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - req->start).count());
+        if (req->type == IOType::Read) {
+            read_ops_.fetch_add(1);
+            total_read_ns_.fetch_add(ns);
+        } else {
+            write_ops_.fetch_add(1);
+            total_write_ns_.fetch_add(ns);
+        }
+        req->prom.set_value(s);
+    }
+
+    void DiskManager::RegisterFrameBuffers(void *base, size_t len)
+    {
+        if (uring_ && uring_->RegisterBuffers(base, len))
+        {
+            global_log_debug(std::string("[DiskManager::RegisterFrameBuffers] registered ") + std::to_string(len) + " bytes");
+        }
+    }
+
+    void DiskManager::UnregisterFrameBuffers()
+    {
+        if (uring_)
+        {
+            uring_->UnregisterBuffers();
+        }
+    }
+
     // 返回新页号（优先复用空闲队列里的)
     page_id_t DiskManager::AllocatePage()
     {
+        if (read_only_)
+            return INVALID_PAGE_ID;
         std::lock_guard<std::mutex> lock(file_mutex_);
-        // 先复用空闲页
-        if (!free_page_ids_.empty())
+        // 先复用空闲页位图里的页
         {
-            page_id_t pid = free_page_ids_.front();
-            free_page_ids_.pop();
-            global_log_debug(std::string("[DiskManager::AllocatePage] Reusing free page_id=") + std::to_string(pid));
-            return pid;
+            std::lock_guard<std::mutex> space_lock(extent_mutex_);
+            page_id_t pid = fsm_.TakeFreePage();
+            if (pid != INVALID_PAGE_ID)
+            {
+                global_log_debug(std::string("[DiskManager::AllocatePage] Reusing free page_id=") + std::to_string(pid));
+                return pid;
+            }
         }
         // 检查容量
         page_id_t next = next_page_id_.load();
@@ -258,44 +1146,323 @@ static Logger g_storage_logger("storage.log");
         global_log_debug(std::string("[DiskManager::AllocatePage] After fetch_add: allocated=") + std::to_string(allocated) + ", next_page_id_=" + std::to_string(after));
         return allocated;
     }
+    // 按区分配：同一段的页取自该段当前的区，区内页号连续；区用完后从文件末尾预留下一个区
+    page_id_t DiskManager::AllocateExtentPage(page_id_t near)
+    {
+        if (extent_pages_ <= 1)
+            return AllocatePage();
+        if (read_only_)
+            return INVALID_PAGE_ID;
+        std::lock_guard<std::mutex> file_lock(file_mutex_);
+        std::lock_guard<std::mutex> lock(extent_mutex_);
+
+        // near 所在区的属主即段号；near 不在任何区中（逐页分配的旧页链）时以 near 自身为段号
+        page_id_t owner = INVALID_PAGE_ID;
+        if (near != INVALID_PAGE_ID)
+        {
+            owner = near;
+            auto it = extents_.upper_bound(near);
+            if (it != extents_.begin())
+            {
+                --it;
+                if (near < it->first + it->second.size)
+                    owner = it->second.owner;
+            }
+            auto open = open_extents_.find(owner);
+            if (open != open_extents_.end())
+            {
+                Extent &ext = extents_[open->second];
+                if (ext.used < ext.size)
+                {
+                    page_id_t pid = open->second + ext.used++;
+                    if (ext.used == ext.size)
+                        open_extents_.erase(open);
+                    segment_last_[owner] = pid;
+                    return pid;
+                }
+                open_extents_.erase(open);
+            }
+        }
+
+        // 预留新区：区只是地址空间上的预留，放不下时容量上限随之推高一个区（至多 MAX_PAGES），
+        // 逐页分配原有的余量不受影响；到达 MAX_PAGES 时取剩余部分
+        page_id_t first = next_page_id_.load();
+        size_t size = extent_pages_;
+        if (static_cast<size_t>(first) + size > max_pages_)
+            max_pages_ = std::min(MAX_PAGES, max_pages_ + size);
+        if (static_cast<size_t>(first) >= max_pages_)
+        {
+            global_log_warn(std::string("[DiskManager::AllocateExtentPage] Disk full: next=") + std::to_string(first));
+            return INVALID_PAGE_ID;
+        }
+        size = std::min(size, max_pages_ - first);
+        while (!next_page_id_.compare_exchange_weak(first, static_cast<page_id_t>(first + size)))
+        {
+        }
+        if (owner == INVALID_PAGE_ID)
+            owner = first;
+        extents_[first] = Extent{owner, static_cast<uint32_t>(size), 1};
+        if (size > 1)
+            open_extents_[owner] = first;
+        segment_last_[owner] = first;
+        // 新区立即登记到区目录，已分配页数在 PersistMeta 时刷新
+        PersistExtentMap();
+        global_log_debug(std::string("[DiskManager::AllocateExtentPage] New extent first=") + std::to_string(first) +
+                         ", size=" + std::to_string(size) + ", owner=" + std::to_string(owner));
+        return first;
+    }
+
+    page_id_t DiskManager::GetExtentOwner(page_id_t page_id) const
+    {
+        std::lock_guard<std::mutex> lock(extent_mutex_);
+        return ExtentOwnerLocked(page_id);
+    }
+
+    page_id_t DiskManager::ExtentOwnerLocked(page_id_t page_id, bool allocated_only) const
+    {
+        auto it = extents_.upper_bound(page_id);
+        if (it == extents_.begin())
+            return INVALID_PAGE_ID;
+        --it;
+        const uint32_t limit = allocated_only ? it->second.used : it->second.size;
+        return page_id < it->first + limit ? it->second.owner : INVALID_PAGE_ID;
+    }
+
+    page_id_t DiskManager::GetSegmentLastPage(page_id_t segment_page) const
+    {
+        std::lock_guard<std::mutex> lock(extent_mutex_);
+        page_id_t owner = ExtentOwnerLocked(segment_page);
+        auto it = segment_last_.find(owner == INVALID_PAGE_ID ? segment_page : owner);
+        return it == segment_last_.end() ? INVALID_PAGE_ID : it->second;
+    }
+
+    size_t DiskManager::GetExtentCount() const
+    {
+        std::lock_guard<std::mutex> lock(extent_mutex_);
+        return extents_.size();
+    }
+
+    void DiskManager::RecordFreeSpace(page_id_t page_id, uint16_t free_bytes)
+    {
+        if (read_only_)
+            return;
+        std::lock_guard<std::mutex> lock(extent_mutex_);
+        // 区内预留而未分配的页全为 0，看起来像空数据页，不能进桶
+        fsm_.UpdateFreeSpace(page_id, ExtentOwnerLocked(page_id, true), free_bytes);
+    }
+
+    page_id_t DiskManager::FindPageWithSpace(page_id_t segment_page, uint16_t need) const
+    {
+        std::lock_guard<std::mutex> lock(extent_mutex_);
+        // 首页不在任何区中（逐页分配的旧表）时，后续区以首页为段号
+        page_id_t owner = ExtentOwnerLocked(segment_page);
+        return fsm_.FindPageWithSpace(owner == INVALID_PAGE_ID ? segment_page : owner, need);
+    }
+
+    size_t DiskManager::GetFreePageCount() const
+    {
+        std::lock_guard<std::mutex> lock(extent_mutex_);
+        return fsm_.GetFreePageCount();
+    }
+
+    bool DiskManager::PersistFreeSpaceMap()
+    {
+        if (read_only_)
+            return true;
+        bool ok = fsm_.Store([this](page_id_t pid, const char *data) { return WritePageBytes(pid, data); },
+                             [this]() { return next_page_id_.fetch_add(1); });
+        free_bitmap_root_.store(fsm_.GetBitmapRoot());
+        fsm_root_.store(fsm_.GetFsmRoot());
+        return ok;
+    }
+
+    // 区目录页布局：[PageHeader | ExtentRecord...]
+    namespace
+    {
+        struct ExtentRecord
+        {
+            uint32_t first;
+            uint32_t owner;
+            uint32_t size;
+            uint32_t used;
+        };
+        size_t ExtentsPerMapPage(size_t page_size) { return (page_size - PAGE_HEADER_SIZE) / sizeof(ExtentRecord); }
+    } // namespace
+
+    bool DiskManager::LoadExtentMap(page_id_t root)
+    {
+        extents_.clear();
+        open_extents_.clear();
+        segment_last_.clear();
+        extent_map_pages_.clear();
+        std::vector<char> buf(page_size_);
+        std::vector<ExtentRecord> records;
+        const page_id_t limit = next_page_id_.load();
+        for (page_id_t pid = root; pid != INVALID_PAGE_ID;)
+        {
+            // 旧文件的 reserved 区可能是任意值：页号越界、类型不符或成环都视为没有区目录
+            const PageHeader *hdr = reinterpret_cast<const PageHeader *>(buf.data());
+            if (pid >= limit || extent_map_pages_.size() > limit || !ReadPageBytes(pid, buf.data()) ||
+                hdr->page_type != static_cast<uint16_t>(PageType::EXTENT_MAP_PAGE) ||
+                hdr->slot_count > ExtentsPerMapPage(page_size_))
+            {
+                extent_map_pages_.clear();
+                return false;
+            }
+            extent_map_pages_.push_back(pid);
+            const ExtentRecord *rec = reinterpret_cast<const ExtentRecord *>(buf.data() + PAGE_HEADER_SIZE);
+            records.insert(records.end(), rec, rec + hdr->slot_count);
+            pid = hdr->next_page_id;
+        }
+        for (const ExtentRecord &r : records)
+        {
+            if (r.size == 0 || r.used > r.size || static_cast<uint64_t>(r.first) + r.size > limit)
+                continue;
+            extents_[r.first] = Extent{r.owner, r.size, r.used};
+            // 同一段的区按页号递增分配，页号最大的已用页即最近分配的页
+            if (r.used > 0)
+            {
+                page_id_t last = r.first + r.used - 1;
+                auto seg = segment_last_.find(r.owner);
+                if (seg == segment_last_.end() || last > seg->second)
+                    segment_last_[r.owner] = last;
+            }
+            if (r.used < r.size)
+            {
+                // 每段保留最靠后的未满区继续分配
+                auto &open = open_extents_[r.owner];
+                if (open == 0 || r.first > open)
+                    open = r.first;
+            }
+        }
+        extent_map_root_.store(root);
+        return true;
+    }
+
+    bool DiskManager::PersistExtentMap()
+    {
+        if (read_only_ || extents_.empty())
+            return true;
+        const size_t need = (extents_.size() + ExtentsPerMapPage(page_size_) - 1) / ExtentsPerMapPage(page_size_);
+        while (extent_map_pages_.size() < need)
+        {
+            // 目录页本身逐页取自文件末尾，不进入任何区
+            extent_map_pages_.push_back(next_page_id_.fetch_add(1));
+        }
+        std::vector<char> buf(page_size_);
+        auto it = extents_.begin();
+        for (size_t i = 0; i < extent_map_pages_.size(); ++i)
+        {
+            std::memset(buf.data(), 0, page_size_);
+            PageHeader *hdr = reinterpret_cast<PageHeader *>(buf.data());
+            hdr->page_type = static_cast<uint16_t>(PageType::EXTENT_MAP_PAGE);
+            hdr->next_page_id = i + 1 < extent_map_pages_.size() ? extent_map_pages_[i + 1] : INVALID_PAGE_ID;
+            ExtentRecord *rec = reinterpret_cast<ExtentRecord *>(buf.data() + PAGE_HEADER_SIZE);
+            uint16_t n = 0;
+            for (; it != extents_.end() && n < ExtentsPerMapPage(page_size_); ++it, ++n)
+                rec[n] = ExtentRecord{it->first, it->second.owner, it->second.size, it->second.used};
+            hdr->slot_count = n;
+            hdr->free_space_offset = static_cast<uint16_t>(PAGE_HEADER_SIZE + n * sizeof(ExtentRecord));
+            if (!WritePageBytes(extent_map_pages_[i], buf.data()))
+                return false;
+        }
+        extent_map_root_.store(extent_map_pages_.front());
+        return true;
+    }
+
     // 释放页号（加入空闲队列)
     void DiskManager::DeallocatePage(page_id_t page_id)
     {
         if (page_id == INVALID_PAGE_ID)
             return;
         std::lock_guard<std::mutex> lock(file_mutex_);
-        // 简单复用：加入空闲队列（不做去重，调用方需保证合法性）
-        free_page_ids_.push(page_id);
+        // 置位空闲页位图（重复释放只记一次），并撤销该页的空闲空间登记
+        std::lock_guard<std::mutex> space_lock(extent_mutex_);
+        fsm_.MarkFree(page_id);
+        // 压缩格式：页的槽在下次持久化元数据后复用
+        if (cstore_)
+            cstore_->Free(page_id);
     }
     // 强制将所有缓冲区的数据写会磁盘
     void DiskManager::FlushAllPages()
     {
-        std::lock_guard<std::mutex> lock(file_mutex_);
+#ifndef MINIDB_POSIX_IO
+        std::lock_guard<std::mutex> lock(stream_mutex_);
         file_stream_.flush();
+#endif
+        // POSIX：pwrite 不经用户态缓冲，写入返回时数据已交给内核
     }
 
-    void DiskManager::Shutdown()
+    bool DiskManager::Shutdown()
     {
         std::lock_guard<std::mutex> lock(file_mutex_);
         if (is_shutdown_.exchange(true))
         {
-            return;
+            return false;
         }
-        PersistMeta();
+        if (uring_)
+        {
+            // 等已提交的页写完成后再写元数据并落盘
+            uring_->Drain();
+        }
+        bool durable = read_only_ || PersistMeta();
+#ifdef MINIDB_POSIX_IO
+        if (fd_ >= 0 && !read_only_ && ::fdatasync(fd_) != 0)
+        {
+            global_log_warn(std::string("[DiskManager::Shutdown] fdatasync failed: ") + std::strerror(errno));
+            durable = false;
+        }
+#else
+        std::lock_guard<std::mutex> stream_lock(stream_mutex_);
         if (file_stream_.is_open())
         {
             file_stream_.flush();
+            durable = durable && static_cast<bool>(file_stream_);
             file_stream_.close();
         }
+#endif
+        return durable;
     }
 
+    namespace
+    {
+        // 元数据页校验：覆盖所有持久化字段（reserved[8..11] 存放校验值本身，不参与计算）；
+        // legacy 为旧格式，只覆盖前五个字段
+        uint32_t MetaChecksum(const MetaPageData &m, bool legacy)
+        {
+            uint32_t crc = 0;
+            crc = checksum::MixField(crc, m.magic);
+            crc = checksum::MixField(crc, m.version);
+            crc = checksum::MixField(crc, m.page_size);
+            crc = checksum::MixField(crc, m.next_page_id);
+            crc = checksum::MixField(crc, m.catalog_root);
+            if (legacy)
+                return crc;
+            crc = checksum::Mix(crc, m.reserved, 8);
+            crc = checksum::Mix(crc, m.reserved + 12, sizeof(m.reserved) - 12);
+            crc = checksum::MixField(crc, m.allocated_bytes);
+            crc = checksum::MixField(crc, m.flags);
+            crc = checksum::MixField(crc, m.cmap_length);
+            crc = checksum::MixField(crc, m.cmap_offset);
+            crc = checksum::MixField(crc, m.cmap_seq);
+            return checksum::MixField(crc, m.slot_end);
+        }
+
+        // 旧格式写出的元数据页：结构体末尾的增长/压缩字段当时还不存在，写入时为 0；
+        // 新格式写元数据前总会先增长文件，allocated_bytes 不为 0
+        bool IsLegacyMeta(const MetaPageData &m)
+        {
+            return m.allocated_bytes == 0 && m.flags == 0 && m.cmap_length == 0 && m.cmap_offset == 0 &&
+                   m.cmap_seq == 0 && m.slot_end == 0;
+        }
+    } // namespace
+
     bool DiskManager::ReadMeta(MetaPageData& out)
     {
-        if (!file_stream_.is_open()) return false;
+        // 元数据只占页 0 的开头：按最小页大小读出，页大小以其中记录的为准
         std::vector<char> buf(PAGE_SIZE);
-        file_stream_.seekg(0, std::ios::beg);
-        file_stream_.read(buf.data(), PAGE_SIZE);
-        if (!file_stream_) return false;
+        size_t got = 0;
+        if (!ReadAt(0, buf.data(), PAGE_SIZE, got) || got < PAGE_SIZE) return false;
         // Validate header
         const PageHeader* hdr = reinterpret_cast<const PageHeader*>(buf.data());
         // Accept either METADATA_PAGE or legacy zeroed header
@@ -305,55 +1472,63 @@ static Logger g_storage_logger("storage.log");
         std::memcpy(&out, buf.data() + PAGE_HEADER_SIZE, sizeof(MetaPageData));
         if (out.magic != META_MAGIC) return false;
         if (out.version != META_VERSION) return false;
-        if (out.page_size != PAGE_SIZE) return false;
+        if (!IsValidPageSize(out.page_size)) return false;
         // checksum validate (stored at reserved[8..11])
         uint32_t stored_crc = 0;
         std::memcpy(&stored_crc, out.reserved + 8, sizeof(uint32_t));
-        // compute crc over fields except reserved area (simple xor-based checksum)
-        uint32_t crc = 0;
-        auto mix = [&](const uint8_t* p, size_t n){ for (size_t i=0;i<n;++i) crc = (crc * 16777619u) ^ p[i]; };
-        mix(reinterpret_cast<const uint8_t*>(&out.magic), sizeof(out.magic));
-        mix(reinterpret_cast<const uint8_t*>(&out.version), sizeof(out.version));
-        mix(reinterpret_cast<const uint8_t*>(&out.page_size), sizeof(out.page_size));
-        mix(reinterpret_cast<const uint8_t*>(&out.next_page_id), sizeof(out.next_page_id));
-        mix(reinterpret_cast<const uint8_t*>(&out.catalog_root), sizeof(out.catalog_root));
-        if (stored_crc != 0 && stored_crc != crc) return false;
-        return true;
+        if (stored_crc == 0 || stored_crc == MetaChecksum(out, false)) return true;
+        // 旧格式只校验前五个字段；此后加入的字段在旧文件里全为 0
+        return IsLegacyMeta(out) && stored_crc == MetaChecksum(out, true);
     }
 
     bool DiskManager::WriteMeta(const MetaPageData& m)
     {
-        if (!file_stream_.is_open()) return false;
-        std::vector<char> buf(PAGE_SIZE);
+        std::vector<char> buf(page_size_);
         std::memset(buf.data(), 0, buf.size());
         // Fill header as METADATA_PAGE with zero slots
         PageHeader* hdr = reinterpret_cast<PageHeader*>(buf.data());
         hdr->slot_count = 0;
         hdr->free_space_offset = PAGE_HEADER_SIZE;
         hdr->next_page_id = INVALID_PAGE_ID;
-        hdr->page_type = static_cast<uint32_t>(PageType::METADATA_PAGE);
-        hdr->reserved = 0;
+        hdr->page_type = static_cast<uint16_t>(PageType::METADATA_PAGE);
+        hdr->SetLsn(0);
         // Copy meta payload after header, with epoch++ and checksum
         MetaPageData temp = m;
+        // 页大小在建库时确定，不随调用方传入的元数据改变
+        temp.page_size = static_cast<uint32_t>(page_size_);
         // epoch stored at reserved[0..7]
         uint64_t epoch = 0;
         std::memcpy(&epoch, temp.reserved + 0, sizeof(uint64_t));
         epoch++;
         std::memcpy(temp.reserved + 0, &epoch, sizeof(uint64_t));
-        // checksum at reserved[8..11]
-        uint32_t crc = 0;
-        auto mix = [&](const uint8_t* p, size_t n){ for (size_t i=0;i<n;++i) crc = (crc * 16777619u) ^ p[i]; };
-        mix(reinterpret_cast<const uint8_t*>(&temp.magic), sizeof(temp.magic));
-        mix(reinterpret_cast<const uint8_t*>(&temp.version), sizeof(temp.version));
-        mix(reinterpret_cast<const uint8_t*>(&temp.page_size), sizeof(temp.page_size));
-        mix(reinterpret_cast<const uint8_t*>(&temp.next_page_id), sizeof(temp.next_page_id));
-        mix(reinterpret_cast<const uint8_t*>(&temp.catalog_root), sizeof(temp.catalog_root));
+        // 区目录首页 reserved[12..15]：调用方传入的元数据可能不带它，统一以当前值为准
+        uint32_t extent_root = extent_map_root_.load();
+        std::memcpy(temp.reserved + 12, &extent_root, sizeof(uint32_t));
+        uint32_t bitmap_root = free_bitmap_root_.load();
+        uint32_t fsm_root = fsm_root_.load();
+        std::memcpy(temp.reserved + 16, &bitmap_root, sizeof(uint32_t));
+        std::memcpy(temp.reserved + 20, &fsm_root, sizeof(uint32_t));
+        // WAL 的 LSN 高水位 reserved[24..31]：页头里的页 LSN 都小于它，日志重建时从它之后继续编号
+        uint64_t wal_lsn = wal_lsn_hwm_.load();
+        if (wal_)
+            wal_lsn = std::max<uint64_t>(wal_lsn, wal_->GetNextLsn());
+        wal_lsn_hwm_.store(wal_lsn);
+        std::memcpy(temp.reserved + 24, &wal_lsn, sizeof(uint64_t));
+        // 增长高水位同样以当前值为准；新文件的第一次写会先触发增长
+        ReserveFileSpace(page_size_);
+        temp.allocated_bytes = allocated_bytes_.load();
+        // 压缩格式标志与最近持久化的页映射块
+        temp.flags = cstore_ ? META_FLAG_COMPRESSED : 0;
+        const CompressedPageStore::Checkpoint cp = cstore_ ? cstore_->GetCheckpoint() : CompressedPageStore::Checkpoint{};
+        temp.cmap_offset = cp.map_offset;
+        temp.cmap_length = cp.map_length;
+        temp.cmap_seq = cp.seq;
+        temp.slot_end = cp.slot_end;
+        // checksum at reserved[8..11]：所有字段填好之后计算
+        const uint32_t crc = MetaChecksum(temp, false);
         std::memcpy(temp.reserved + 8, &crc, sizeof(uint32_t));
         std::memcpy(buf.data() + PAGE_HEADER_SIZE, &temp, sizeof(MetaPageData));
-        file_stream_.seekp(0, std::ios::beg);
-        file_stream_.write(buf.data(), PAGE_SIZE);
-        file_stream_.flush();
-        return static_cast<bool>(file_stream_);
+        return WriteAt(0, buf.data(), page_size_);
     }
 
     bool DiskManager::InitNewMeta()
@@ -362,9 +1537,14 @@ static Logger g_storage_logger("storage.log");
         std::memset(&m, 0, sizeof(m));
         m.magic = META_MAGIC;
         m.version = META_VERSION;
-        m.page_size = static_cast<uint32_t>(PAGE_SIZE);
+        m.page_size = static_cast<uint32_t>(page_size_);
         m.next_page_id = 1; // 预留页0
         m.catalog_root = INVALID_PAGE_ID;
+        if (GetRuntimeConfig().page_compression)
+        {
+            CreateCompressedStore();
+            cstore_->Reset(page_size_, page_size_);
+        }
         if (!WriteMeta(m)) return false;
         next_page_id_.store(m.next_page_id);
         return true;
@@ -376,6 +1556,67 @@ static Logger g_storage_logger("storage.log");
         if (ReadMeta(m)) {
             global_log_info(std::string("[DiskManager::LoadOrRecoverMeta] ReadMeta success, next_page_id=") + std::to_string(m.next_page_id));
             next_page_id_.store(m.next_page_id);
+            if (m.page_size != page_size_)
+            {
+                global_log_info(std::string("[DiskManager::LoadOrRecoverMeta] 使用数据库的页大小 ") +
+                                std::to_string(m.page_size));
+                page_size_ = m.page_size;
+                fsm_.SetPageSize(page_size_);
+            }
+            if (m.allocated_bytes > file_size_.load())
+            {
+                // 记录的高水位超过实际文件大小：文件在外部被截断过，按实际大小重新增长
+                global_log_warn(std::string("[DiskManager::LoadOrRecoverMeta] 文件小于记录的分配高水位 ") +
+                                std::to_string(m.allocated_bytes));
+            }
+            if (m.flags & META_FLAG_COMPRESSED)
+            {
+                // 先恢复页映射（含检查点之后写入的槽），区目录与空闲空间映射页都经它读取
+                CreateCompressedStore();
+                CompressedPageStore::Checkpoint cp;
+                cp.map_offset = m.cmap_offset;
+                cp.map_length = m.cmap_length;
+                cp.seq = m.cmap_seq;
+                cp.slot_end = m.slot_end;
+                if (!cstore_->Load(page_size_, page_size_, cp, file_size_.load()))
+                    global_log_error("[DiskManager::LoadOrRecoverMeta] 压缩页映射块无效");
+                else
+                    global_log_info(std::string("[DiskManager::LoadOrRecoverMeta] 压缩格式，已映射页数 ") +
+                                    std::to_string(cstore_->GetMappedPages()));
+                // 检查点之后写入的新页已由重放找回，页号分配从它们之后继续
+                const page_id_t max_pid = cstore_->GetMaxMappedPage();
+                if (max_pid != INVALID_PAGE_ID)
+                    AdvanceNextPageId(max_pid);
+            }
+            uint32_t extent_root = INVALID_PAGE_ID;
+            std::memcpy(&extent_root, m.reserved + 12, sizeof(uint32_t));
+            uint32_t bitmap_root = INVALID_PAGE_ID, fsm_root = INVALID_PAGE_ID;
+            std::memcpy(&bitmap_root, m.reserved + 16, sizeof(uint32_t));
+            std::memcpy(&fsm_root, m.reserved + 20, sizeof(uint32_t));
+            uint64_t wal_lsn = 0;
+            std::memcpy(&wal_lsn, m.reserved + 24, sizeof(uint64_t));
+            wal_lsn_hwm_.store(wal_lsn);
+            std::lock_guard<std::mutex> lock(extent_mutex_);
+            if (extent_root != INVALID_PAGE_ID && extent_root != 0 && !LoadExtentMap(extent_root))
+                global_log_warn("[DiskManager::LoadOrRecoverMeta] 区目录无效，忽略");
+            // 0 是元数据页本身，旧文件里未写过的 reserved 字节按没有映射处理
+            if (bitmap_root == 0)
+                bitmap_root = INVALID_PAGE_ID;
+            if (fsm_root == 0)
+                fsm_root = INVALID_PAGE_ID;
+            if (!fsm_.Load(
+                    bitmap_root, fsm_root, next_page_id_.load(),
+                    [this](page_id_t pid, char *data) { return ReadPageBytes(pid, data); },
+                    [this](page_id_t pid) { return ExtentOwnerLocked(pid, true); }))
+                global_log_warn("[DiskManager::LoadOrRecoverMeta] 空闲空间映射无效，忽略");
+            free_bitmap_root_.store(fsm_.GetBitmapRoot());
+            fsm_root_.store(fsm_.GetFsmRoot());
+            return true;
+        }
+        if (read_only_)
+        {
+            // 只读打开不初始化元数据，页数按文件大小计
+            next_page_id_.store(static_cast<page_id_t>(file_size_.load() / page_size_));
             return true;
         }
         global_log_warn("[DiskManager::LoadOrRecoverMeta] ReadMeta failed, calling InitNewMeta");
@@ -384,42 +1625,72 @@ static Logger g_storage_logger("storage.log");
 
     bool DiskManager::PersistMeta()
     {
+        {
+            std::lock_guard<std::mutex> lock(extent_mutex_);
+            PersistExtentMap();
+            PersistFreeSpaceMap();
+        }
         MetaPageData m{};
         m.magic = META_MAGIC;
         m.version = META_VERSION;
-        m.page_size = static_cast<uint32_t>(PAGE_SIZE);
+        m.page_size = static_cast<uint32_t>(page_size_);
         m.next_page_id = next_page_id_.load();
+        // 后台刷写与前台 SetCatalogRoot 并发：读缓存与写元数据页须在同一把锁下，
+        // 否则可能把旧的 catalog_root 写到新值之后
+        std::lock_guard<std::mutex> meta_lock(meta_mutex_);
         // 保持现有的catalog_root，不要重置为INVALID_PAGE_ID
         MetaPageData current_meta;
-        if (GetMetaInfo(current_meta)) {
+        if (GetMetaInfoLocked(current_meta)) {
             m.catalog_root = current_meta.catalog_root;
         } else {
             m.catalog_root = INVALID_PAGE_ID;
         }
-        return WriteMeta(m);
+        // 压缩格式：先写出页映射块，元数据落盘后旧映射块与隔离的槽才可复用
+        if (cstore_ && !read_only_ && !cstore_->Persist())
+            return false;
+        if (!WriteMeta(m))
+            return false;
+        if (cstore_ && !read_only_)
+            cstore_->CommitPersist();
+        return true;
     }
 
     // ===== 元数据访问接口实现 =====
     
     bool DiskManager::GetMetaInfo(MetaPageData& out) const
+    {
+        std::lock_guard<std::mutex> lock(meta_mutex_);
+        return GetMetaInfoLocked(out);
+    }
+
+    bool DiskManager::GetMetaInfoLocked(MetaPageData& out) const
     {
         if (meta_cached_.load()) {
             out = cached_meta_;
+            // 缓存之后的分配只推进了 next_page_id_，以它为准，避免 Set* 写回旧值把已分配的页号退回去
+            out.next_page_id = next_page_id_.load();
             return true;
         }
         
         // 从磁盘读取
         MetaPageData temp;
         if (const_cast<DiskManager*>(this)->ReadMeta(temp)) {
-            const_cast<DiskManager*>(this)->cached_meta_ = temp;
-            const_cast<DiskManager*>(this)->meta_cached_.store(true);
+            cached_meta_ = temp;
+            meta_cached_.store(true);
             out = temp;
+            out.next_page_id = next_page_id_.load();
             return true;
         }
         return false;
     }
     
     bool DiskManager::SetMetaInfo(const MetaPageData& meta)
+    {
+        std::lock_guard<std::mutex> lock(meta_mutex_);
+        return SetMetaInfoLocked(meta);
+    }
+
+    bool DiskManager::SetMetaInfoLocked(const MetaPageData& meta)
     {
         if (!WriteMeta(meta)) return false;
         
@@ -427,8 +1698,9 @@ static Logger g_storage_logger("storage.log");
         cached_meta_ = meta;
         meta_cached_.store(true);
         
-        // 同步next_page_id
-        next_page_id_.store(meta.next_page_id);
+        // 同步next_page_id：只前移，并发分配出去的页号不能被调用方的旧值退回
+        if (meta.next_page_id > 0)
+            AdvanceNextPageId(static_cast<page_id_t>(meta.next_page_id - 1));
         
         return true;
     }
@@ -444,11 +1716,12 @@ static Logger g_storage_logger("storage.log");
     
     bool DiskManager::SetCatalogRoot(page_id_t catalog_root)
     {
+        std::lock_guard<std::mutex> lock(meta_mutex_);
         MetaPageData meta;
-        if (!GetMetaInfo(meta)) return false;
+        if (!GetMetaInfoLocked(meta)) return false;
         
         meta.catalog_root = catalog_root;
-        return SetMetaInfo(meta);
+        return SetMetaInfoLocked(meta);
     }
 
     // 为简化：把 index_root 存放到 reserved[0..3]（little-endian 32bit）
@@ -463,10 +1736,11 @@ static Logger g_storage_logger("storage.log");
 
     bool DiskManager::SetIndexRoot(page_id_t index_root)
     {
+        std::lock_guard<std::mutex> lock(meta_mutex_);
         MetaPageData meta;
-        if (!GetMetaInfo(meta)) return false;
+        if (!GetMetaInfoLocked(meta)) return false;
         uint32_t v = static_cast<uint32_t>(index_root);
         std::memcpy(meta.reserved + 0, &v, sizeof(uint32_t));
-        return SetMetaInfo(meta);
+        return SetMetaInfoLocked(meta);
     }
 } // namespace minidb
@@ -9,12 +9,27 @@
 #include <atomic>
 #include <future>
 #include <vector>
-#include <queue>
 #include <cstdint>
 #include <deque>
 #include <condition_variable>
 #include <thread>
+#include <chrono>
+#include <memory>
+#include <map>
+#include <unordered_map>
 #include "storage/page/wal_manager.h"
+#include "storage/page/io_uring_engine.h"
+#include "storage/page/free_space_map.h"
+#include "storage/page/compressed_page_store.h"
+
+// POSIX 平台用 pread / pwrite 直接按偏移读写文件描述符，读写之间不需要文件锁；
+// 其他平台退回 std::fstream + 文件锁
+#if defined(__unix__) || defined(__APPLE__)
+#define MINIDB_POSIX_IO 1
+#endif
+#ifdef MINIDB_HAS_IO_URING
+#include <sys/uio.h>
+#endif
 
 namespace minidb
 {
@@ -24,42 +39,97 @@ namespace minidb
     {
         uint64_t magic;        // identify valid database file
         uint32_t version;      // meta layout version
-        uint32_t page_size;    // sanity check
+        uint32_t page_size;    // 建库时确定的页大小（PAGE_SIZE..MAX_PAGE_SIZE 的 2 的幂）
         uint32_t next_page_id; // allocated pages count (data pages start from 1)
         uint32_t catalog_root; // reserved for future catalog root
         uint8_t reserved[64];  // small padding for future use
+        uint64_t allocated_bytes; // 文件已预分配到的字节数（增长高水位）；旧文件中为 0
+        uint32_t flags;           // META_FLAG_*；旧文件中为 0
+        // 压缩格式：最近持久化的页映射块（偏移为 0 表示没有）、它反映的写序号与当时的槽区末尾
+        uint32_t cmap_length;
+        uint64_t cmap_offset;
+        uint64_t cmap_seq;
+        uint64_t slot_end;
     };
     static_assert(PAGE_HEADER_SIZE + sizeof(MetaPageData) <= PAGE_SIZE, "Meta payload exceeds page size");
     static constexpr uint64_t META_MAGIC = 0x4D696E6944425F4DULL; // "MiniDB_M"
     static constexpr uint32_t META_VERSION = 1;
+    static constexpr uint32_t META_FLAG_COMPRESSED = 1; // 页经 CompressedPageStore 压缩存放
+    // O_DIRECT 的对齐粒度：覆盖 512 字节与 4KB 逻辑块的设备
+    static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
 
     class DiskManager
     {
     public:
-        explicit DiskManager(const std::string &db_file);
+        // read_only：只读打开已有文件，不创建文件、不写元数据，写操作返回 IO_ERROR
+        explicit DiskManager(const std::string &db_file, bool read_only = false);
         ~DiskManager();
 
         // 同步I/O
         Status ReadPage(page_id_t page_id, char *page_data);
         Status WritePage(page_id_t page_id, const char *page_data);
+        // 连续页批量读写（POSIX 下为一次 preadv / pwritev）：bufs[i] 对应页 first + i
+        Status ReadPages(page_id_t first, char *const *bufs, size_t n);
+        Status WritePages(page_id_t first, const char *const *bufs, size_t n);
 
-        // 异步I/O (高级特性)
+        // 异步I/O (高级特性)：io_uring 可用时直接提交给内核，否则交给工作线程
         std::future<Status> ReadPageAsync(page_id_t page_id, char *page_data);
         std::future<Status> WritePageAsync(page_id_t page_id, const char *page_data);
+        // 批量异步写：所有请求排队后一次提交（io_uring 下为一次 io_uring_enter）
+        std::vector<std::future<Status>> WritePagesAsync(const std::vector<page_id_t> &page_ids,
+                                                         const std::vector<const char *> &bufs);
+
+        // 把缓冲池的帧数组注册为 io_uring 固定缓冲区；未使用 io_uring 时为空操作
+        void RegisterFrameBuffers(void *base, size_t len);
+        void UnregisterFrameBuffers();
+        bool IsUsingIoUring() const { return uring_ != nullptr; }
+        // 是否以 O_DIRECT 打开（绕过内核页缓存）
+        bool IsDirectIo() const { return direct_io_; }
+        bool IsReadOnly() const { return read_only_; }
+        // 本数据库的页大小：新建时取 RuntimeConfig::page_size，已有文件以元数据为准，打开后不再改变
+        size_t GetPageSize() const { return page_size_; }
+        // 压缩格式（建库时由 RuntimeConfig::page_compression 决定）：页按映射存放在变长槽中，不走 io_uring / mmap
+        bool IsCompressed() const { return cstore_ != nullptr; }
 
         // 页面分配
         page_id_t AllocatePage();
         void DeallocatePage(page_id_t page_id);
+        // 按区分配：从 near 所在段当前的区中取下一页，区用完时再预留一个连续区；
+        // near 为 INVALID_PAGE_ID 时新建一个段（段号即新区的首页）。区目录随元数据持久化
+        page_id_t AllocateExtentPage(page_id_t near);
+        // 页所在区的属主段；不在任何区中时返回 INVALID_PAGE_ID
+        page_id_t GetExtentOwner(page_id_t page_id) const;
+        size_t GetExtentCount() const;
+        // 段内最近分配的页（表按分配顺序把新页接在它之后，它就是页链的尾页）；段不存在时返回 INVALID_PAGE_ID
+        page_id_t GetSegmentLastPage(page_id_t segment_page) const;
+
+        // 空闲空间映射：数据页的空闲字节数按段登记，插入时直接找到段内有空间的页，不必遍历页链
+        void RecordFreeSpace(page_id_t page_id, uint16_t free_bytes);
+        // segment_page 为段内任一页（通常是表的首页）；没有合适的页时返回 INVALID_PAGE_ID
+        page_id_t FindPageWithSpace(page_id_t segment_page, uint16_t need) const;
+        // 已释放、等待复用的页数（空闲页位图随元数据持久化，重启后仍可复用）
+        size_t GetFreePageCount() const;
 
         // 统计信息
         size_t GetNumPages() const { return next_page_id_.load(); } // 返回下一个可用页面ID
         size_t GetNumReads() const { return num_reads_.load(); }
         size_t GetNumWrites() const { return num_writes_.load(); }
+        uint64_t GetFileSize() const { return file_size_.load(std::memory_order_acquire); }
+        // 文件按块预分配到的字节数，及增长（fallocate / ftruncate）次数
+        uint64_t GetAllocatedBytes() const { return allocated_bytes_.load(std::memory_order_acquire); }
+        size_t GetFileGrowCount() const { return file_grow_count_.load(); }
 
         // 系统管理
         void FlushAllPages();
-        void Shutdown();
-        void AttachWAL(WalManager* wal) { wal_ = wal; }
+        // 写元数据并落盘后关闭；返回 false 表示元数据或 fdatasync 失败（或已关闭过），调用方不得据此截断 WAL
+        bool Shutdown();
+        // 挂上 WAL 后每次写页先等页 LSN 之前的日志落盘（组提交），再写数据文件；没有页 LSN 的页补记整页镜像
+        void AttachWAL(WalManager* wal) { wal_ = wal; if (wal_) wal_->SetPageSize(page_size_); }
+        WalManager* GetWal() const { return wal_; }
+        // 最近一次持久化元数据时 WAL 的下一个 LSN（页 LSN 的上界），日志文件丢失重建时据此续号
+        uint64_t GetWalLsnHighWater() const { return wal_lsn_hwm_.load(); }
+        // 数据文件落盘（fdatasync）；截断 WAL 之前调用
+        bool SyncData();
 
         // Meta superblock persistence (page 0)
         bool PersistMeta();
@@ -78,6 +148,7 @@ namespace minidb
         size_t GetMaxPageCount() const { return max_pages_; }
         double GetUsage() const { return GetMaxPageCount() == 0 ? 0.0 : static_cast<double>(next_page_id_.load()) / static_cast<double>(GetMaxPageCount()); }
         size_t GetQueueDepth() const {
+            if (uring_) return uring_->InFlight();
             std::lock_guard<std::mutex> lk(queue_mutex_);
             return io_queue_.size();
         }
@@ -95,6 +166,17 @@ namespace minidb
         }
         size_t GetReadOps() const { return read_ops_.load(); }
         size_t GetWriteOps() const { return write_ops_.load(); }
+        // 批量合并（工作线程的 preadv / pwritev 与 io_uring 的 WRITEV）：合并次数、合并覆盖的页数与最长一段
+        size_t GetMergedRuns() const { return merged_runs_.load(); }
+        size_t GetMergedRunPages() const { return merged_run_pages_.load(); }
+        size_t GetMaxMergedRun() const { return max_merged_run_.load(); }
+        // 压缩格式下写入的逻辑字节数与实际落盘字节数；未压缩时均为 0
+        uint64_t GetCompressedLogicalBytes() const { return cstore_ ? cstore_->GetLogicalBytesWritten() : 0; }
+        uint64_t GetCompressedStoredBytes() const { return cstore_ ? cstore_->GetStoredBytesWritten() : 0; }
+        double GetAvgMergedRunLength() const {
+            size_t runs = merged_runs_.load();
+            return runs == 0 ? 0.0 : static_cast<double>(merged_run_pages_.load()) / static_cast<double>(runs);
+        }
 
     private:
         enum class IOType { Read, Write };
@@ -104,29 +186,116 @@ namespace minidb
             char* read_buf;             // for Read
             const char* write_buf;      // for Write
             std::promise<Status> prom;
+            std::chrono::high_resolution_clock::time_point start{}; // io_uring 路径：提交时刻，用于延时统计
+#ifdef MINIDB_HAS_IO_URING
+            // io_uring 合并写：自 page_id 起页号连续的一段写由一个 WRITEV 承载，run_iov[k] / run_proms[k] 对应第 k 页
+            std::vector<struct iovec> run_iov{};
+            std::vector<std::promise<Status>> run_proms{};
+#endif
         };
 
         void StartWorkers(size_t n = 1);
         void StopWorkers();
         std::future<Status> Enqueue(IOType type, page_id_t page_id, char* rbuf, const char* wbuf);
         void WorkerLoop();
+        // io_uring 路径：排队一个请求（submit 为 false 时由调用方统一提交），完成时在完成线程上兑现 promise
+        std::future<Status> EnqueueUring(IOType type, page_id_t page_id, char* rbuf, const char* wbuf, bool submit);
+        void OnUringComplete(uint64_t tag, int res);
+        // io_uring 路径：页号连续的 n 页写合并为一个 WRITEV（不提交），返回逐页的 future
+        std::vector<std::future<Status>> EnqueueUringRun(page_id_t first, const char *const *bufs, size_t n);
+        void CompleteUringRun(IORequest &req, int res);
+        // 记录一次 n 页的合并读写
+        void NoteMergedRun(size_t n);
 
         bool ReadMeta(MetaPageData &out);
         bool WriteMeta(const MetaPageData &m);
+        // 调用方持有 meta_mutex_
+        bool GetMetaInfoLocked(MetaPageData &out) const;
+        bool SetMetaInfoLocked(const MetaPageData &meta);
         bool InitNewMeta();
         bool LoadOrRecoverMeta();
+        // 区目录：页头 slot_count 为本页条目数，next_page_id 串起后续目录页；调用方持有 extent_mutex_
+        bool LoadExtentMap(page_id_t root);
+        bool PersistExtentMap();
+        bool PersistFreeSpaceMap();
+        // allocated_only：只认区内已分配出去的页（预留未用的页返回 INVALID_PAGE_ID）
+        page_id_t ExtentOwnerLocked(page_id_t page_id, bool allocated_only = false) const;
+
+        // 文件访问原语：按偏移读写，读到文件末尾为止（got 为实际读到的字节数）；
+        // O_DIRECT 下缓冲区、偏移或长度未对齐时经对齐的中转缓冲区读写
+        bool OpenFile();
+        bool ReadAt(uint64_t offset, char *buf, size_t len, size_t &got);
+        bool WriteAt(uint64_t offset, const char *buf, size_t len);
+#ifdef MINIDB_POSIX_IO
+        bool ReadRaw(uint64_t offset, char *buf, size_t len, size_t &got);
+        bool WriteRaw(uint64_t offset, const char *buf, size_t len);
+#endif
+        // 非 O_DIRECT 时恒为 true
+        bool IsIoAligned(const void *buf, uint64_t offset, size_t len) const
+        {
+            return !direct_io_ ||
+                   ((reinterpret_cast<uintptr_t>(buf) | offset | len) & (DIRECT_IO_ALIGNMENT - 1)) == 0;
+        }
+        // 写入越过缓存的文件末尾时原子推进 file_size_
+        void ExtendFileSize(uint64_t end);
+        // 写入前确保 [0, end) 已分配：越过高水位时按 file_grow_* 一次增长一大块，
+        // 此后块内的写不再改变文件大小。失败时只记日志，写入照常进行
+        void ReserveFileSpace(uint64_t end);
+        void AdvanceNextPageId(page_id_t written);
+        // 区目录与空闲空间映射等内部页的整页读写：压缩格式下经 cstore_，否则按页号偏移
+        bool ReadPageBytes(page_id_t page_id, char *buf);
+        // 写页前的 WAL：追加 bufs[i]（页 first + i）并等最后一条落盘；未挂 WAL 时直接返回 true
+        bool LogBeforeWrite(page_id_t first, const char *const *bufs, size_t n);
+        bool WritePageBytes(page_id_t page_id, const char *buf);
+        // 创建压缩页存储（读写经 ReadAt / WriteAt）
+        void CreateCompressedStore();
         size_t GetFileOffset(page_id_t page_id) const
         {
-            return static_cast<size_t>(page_id) * PAGE_SIZE;
+            return static_cast<size_t>(page_id) * page_size_;
         }
 
         std::string db_file_;
+#ifdef MINIDB_POSIX_IO
+        int fd_{-1}; // 析构时关闭；Shutdown 之后的读写直接返回 IO_ERROR
+#else
         std::fstream file_stream_;
+        std::mutex stream_mutex_; // 文件流的读写位置是共享状态，读写须串行
+#endif
+        bool read_only_{false};
+        bool direct_io_{false};
+        size_t page_size_{PAGE_SIZE};
+        std::atomic<uint64_t> file_size_{0}; // 缓存的文件大小，读页时不再 seek 到末尾求长度
+        // 文件增长：allocated_bytes_ 为已预分配到的高水位，WriteMeta 写入 MetaPageData::allocated_bytes
+        std::mutex grow_mutex_;
+        std::atomic<uint64_t> allocated_bytes_{0};
+        std::atomic<size_t> file_grow_count_{0};
+        bool fallocate_unsupported_{false}; // 文件系统不支持 fallocate 时改用 ftruncate
         std::atomic<page_id_t> next_page_id_{0}; // 页面ID从0开始，值即为当前总页数/下一个可用页号
-        // 简单空闲页管理：释放的页可复用
-        std::queue<page_id_t> free_page_ids_;
+
+        // 区分配：区首页 -> 区；段号为段内第一个区的首页
+        struct Extent
+        {
+            page_id_t owner;
+            uint32_t size; // 区内页数（容量不足时可能小于 alloc_extent_pages）
+            uint32_t used; // 已分配出去的页数
+        };
+        mutable std::mutex extent_mutex_; // 保护下面的区状态与空闲空间映射；与 file_mutex_ 同时持有时先取 file_mutex_
+        std::map<page_id_t, Extent> extents_;
+        std::unordered_map<page_id_t, page_id_t> open_extents_; // 段号 -> 正在分配的区首页
+        std::unordered_map<page_id_t, page_id_t> segment_last_; // 段号 -> 最近分配的页
+        std::vector<page_id_t> extent_map_pages_;                // 区目录页链
+        std::atomic<page_id_t> extent_map_root_{INVALID_PAGE_ID}; // 目录首页，WriteMeta 写入 Meta.reserved[12..15]
+        // 空闲页位图与数据页空闲空间分级；两条页链的首页写入 Meta.reserved[16..19] / [20..23]
+        FreeSpaceMap fsm_;
+        std::atomic<page_id_t> free_bitmap_root_{INVALID_PAGE_ID};
+        std::atomic<page_id_t> fsm_root_{INVALID_PAGE_ID};
+        std::atomic<uint64_t> wal_lsn_hwm_{0}; // WriteMeta 写入 Meta.reserved[24..31]
+        // 压缩格式的页存储；页 0（元数据）始终原样存放在文件开头，槽区从 page_size_ 开始
+        std::unique_ptr<CompressedPageStore> cstore_;
+        size_t extent_pages_{64};
         
-        // 元数据缓存
+        // 元数据缓存；meta_mutex_ 保护缓存并串行化元数据页的写入（与 file_mutex_ 同时持有时先取 file_mutex_）
+        mutable std::mutex meta_mutex_;
         mutable MetaPageData cached_meta_;
         mutable std::atomic<bool> meta_cached_{false};
 
@@ -137,8 +306,11 @@ namespace minidb
         std::atomic<uint64_t> total_write_ns_{0};
         std::atomic<size_t> read_ops_{0};
         std::atomic<size_t> write_ops_{0};
+        std::atomic<size_t> merged_runs_{0};
+        std::atomic<size_t> merged_run_pages_{0};
+        std::atomic<size_t> max_merged_run_{0};
 
-        // 并发控制
+        // 并发控制：file_mutex_ 保护空闲页队列与关闭流程
         mutable std::mutex file_mutex_;
         std::atomic<bool> is_shutdown_{false};
         size_t max_pages_{DEFAULT_MAX_PAGES};
@@ -153,6 +325,9 @@ namespace minidb
         // batching knobs
         size_t batch_max_{64};
 
+        // io_uring 引擎；创建失败时为空，使用上面的工作线程
+        std::unique_ptr<IoUringEngine> uring_;
+
         // WAL
         WalManager* wal_{nullptr};
     };
@@ -0,0 +1,252 @@
+#include "storage/page/free_space_map.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace minidb
+{
+
+    // 字节数组按持久化页分块，标记 index 所在块为脏
+    void FreeSpaceMap::MarkChunkDirty(std::vector<bool> &dirty, size_t byte_index) const
+    {
+        size_t chunk = byte_index / MapPageBytes();
+        if (dirty.size() <= chunk)
+            dirty.resize(chunk + 1, true);
+        dirty[chunk] = true;
+    }
+
+    uint8_t FreeSpaceMap::LevelOf(uint16_t free_bytes) const
+    {
+        size_t bucket = std::min<size_t>(FSM_BUCKETS - 1, free_bytes / BucketBytes());
+        return static_cast<uint8_t>(bucket + 1);
+    }
+
+    void FreeSpaceMap::MarkFree(page_id_t page_id)
+    {
+        if (page_id == INVALID_PAGE_ID)
+            return;
+        size_t byte = page_id / 8;
+        if (free_bits_.size() <= byte)
+            free_bits_.resize(byte + 1, 0);
+        const char bit = static_cast<char>(1u << (page_id % 8));
+        if (free_bits_[byte] & bit)
+            return;
+        free_bits_[byte] |= bit;
+        ++free_count_;
+        free_hint_ = std::min(free_hint_, byte);
+        MarkChunkDirty(bitmap_dirty_, byte);
+        Forget(page_id);
+    }
+
+    page_id_t FreeSpaceMap::TakeFreePage()
+    {
+        if (free_count_ == 0)
+            return INVALID_PAGE_ID;
+        for (size_t byte = free_hint_; byte < free_bits_.size(); ++byte)
+        {
+            unsigned char v = static_cast<unsigned char>(free_bits_[byte]);
+            if (v == 0)
+                continue;
+            unsigned bit = 0;
+            while (!(v & (1u << bit)))
+                ++bit;
+            free_bits_[byte] = static_cast<char>(v & ~(1u << bit));
+            --free_count_;
+            free_hint_ = byte;
+            MarkChunkDirty(bitmap_dirty_, byte);
+            return static_cast<page_id_t>(byte * 8 + bit);
+        }
+        free_count_ = 0; // 计数与位图不一致时以位图为准
+        return INVALID_PAGE_ID;
+    }
+
+    bool FreeSpaceMap::IsFree(page_id_t page_id) const
+    {
+        size_t byte = page_id / 8;
+        return byte < free_bits_.size() && (free_bits_[byte] & (1u << (page_id % 8)));
+    }
+
+    void FreeSpaceMap::UpdateFreeSpace(page_id_t page_id, page_id_t owner, uint16_t free_bytes)
+    {
+        if (page_id == INVALID_PAGE_ID)
+            return;
+        const uint8_t level = LevelOf(free_bytes);
+        if (levels_.size() <= page_id)
+            levels_.resize(static_cast<size_t>(page_id) + 1, 0);
+        if (static_cast<uint8_t>(levels_[page_id]) != level)
+        {
+            levels_[page_id] = static_cast<char>(level);
+            MarkChunkDirty(fsm_dirty_, page_id);
+        }
+        const uint8_t bucket = level - 1;
+        auto it = slots_.find(page_id);
+        if (it != slots_.end() && it->second.owner == owner && it->second.bucket == bucket)
+            return;
+        Unindex(page_id);
+        // 最低一级的页放不下任何 BucketBytes() 以上的记录，不进桶
+        if (owner == INVALID_PAGE_ID || bucket == 0)
+            return;
+        auto &vec = buckets_[owner][bucket];
+        slots_[page_id] = Slot{owner, bucket, static_cast<uint32_t>(vec.size())};
+        vec.push_back(page_id);
+    }
+
+    void FreeSpaceMap::Forget(page_id_t page_id)
+    {
+        Unindex(page_id);
+        if (page_id < levels_.size() && levels_[page_id] != 0)
+        {
+            levels_[page_id] = 0;
+            MarkChunkDirty(fsm_dirty_, page_id);
+        }
+    }
+
+    void FreeSpaceMap::Unindex(page_id_t page_id)
+    {
+        auto it = slots_.find(page_id);
+        if (it == slots_.end())
+            return;
+        // 与桶尾交换后弹出，O(1)
+        auto &vec = buckets_[it->second.owner][it->second.bucket];
+        page_id_t last = vec.back();
+        vec[it->second.pos] = last;
+        slots_[last].pos = it->second.pos;
+        vec.pop_back();
+        slots_.erase(page_id);
+    }
+
+    page_id_t FreeSpaceMap::FindPageWithSpace(page_id_t owner, uint16_t need) const
+    {
+        auto it = buckets_.find(owner);
+        if (it == buckets_.end())
+            return INVALID_PAGE_ID;
+        // 第 b 级的页至少有 b * BucketBytes() 字节空闲
+        size_t first = (need + BucketBytes() - 1) / BucketBytes();
+        for (size_t b = std::max<size_t>(first, 1); b < FSM_BUCKETS; ++b)
+        {
+            if (!it->second[b].empty())
+                return it->second[b].back();
+        }
+        return INVALID_PAGE_ID;
+    }
+
+    bool FreeSpaceMap::LoadChain(page_id_t root, page_id_t num_pages, PageType type, const ReadFn &read,
+                                 std::vector<page_id_t> &pages, std::vector<char> &bytes) const
+    {
+        std::vector<char> buf(page_size_);
+        for (page_id_t pid = root; pid != INVALID_PAGE_ID;)
+        {
+            const PageHeader *hdr = reinterpret_cast<const PageHeader *>(buf.data());
+            if (pid >= num_pages || pages.size() > num_pages || !read(pid, buf.data()) ||
+                hdr->page_type != static_cast<uint16_t>(type) || hdr->slot_count > MapPageBytes())
+            {
+                pages.clear();
+                bytes.clear();
+                return false;
+            }
+            pages.push_back(pid);
+            bytes.insert(bytes.end(), buf.data() + PAGE_HEADER_SIZE, buf.data() + PAGE_HEADER_SIZE + hdr->slot_count);
+            pid = hdr->next_page_id;
+        }
+        return true;
+    }
+
+    bool FreeSpaceMap::Load(page_id_t bitmap_root, page_id_t fsm_root, page_id_t num_pages, const ReadFn &read,
+                            const OwnerFn &owner_of)
+    {
+        const size_t page_size = page_size_;
+        *this = FreeSpaceMap();
+        page_size_ = page_size;
+        bool ok = true;
+        if (bitmap_root != INVALID_PAGE_ID)
+            ok = LoadChain(bitmap_root, num_pages, PageType::FREE_BITMAP_PAGE, read, bitmap_pages_, free_bits_) && ok;
+        if (fsm_root != INVALID_PAGE_ID)
+            ok = LoadChain(fsm_root, num_pages, PageType::FSM_PAGE, read, fsm_pages_, levels_) && ok;
+        bitmap_dirty_.assign(bitmap_pages_.size(), false);
+        fsm_dirty_.assign(fsm_pages_.size(), false);
+
+        for (size_t byte = 0; byte < free_bits_.size(); ++byte)
+        {
+            unsigned char v = static_cast<unsigned char>(free_bits_[byte]);
+            for (unsigned bit = 0; bit < 8; ++bit)
+            {
+                if (!(v & (1u << bit)))
+                    continue;
+                if (byte * 8 + bit >= num_pages)
+                {
+                    // 文件末尾之后的位没有意义
+                    v &= static_cast<unsigned char>(~(1u << bit));
+                    MarkChunkDirty(bitmap_dirty_, byte);
+                    continue;
+                }
+                ++free_count_;
+            }
+            free_bits_[byte] = static_cast<char>(v);
+        }
+        for (size_t pid = 0; pid < levels_.size(); ++pid)
+        {
+            uint8_t level = static_cast<uint8_t>(levels_[pid]);
+            if (level == 0)
+                continue;
+            if (level > FSM_BUCKETS || pid >= num_pages || IsFree(static_cast<page_id_t>(pid)))
+            {
+                levels_[pid] = 0;
+                MarkChunkDirty(fsm_dirty_, pid);
+                continue;
+            }
+            page_id_t owner = owner_of(static_cast<page_id_t>(pid));
+            uint8_t bucket = level - 1;
+            if (owner == INVALID_PAGE_ID || bucket == 0)
+                continue;
+            auto &vec = buckets_[owner][bucket];
+            slots_[static_cast<page_id_t>(pid)] = Slot{owner, bucket, static_cast<uint32_t>(vec.size())};
+            vec.push_back(static_cast<page_id_t>(pid));
+        }
+        return ok;
+    }
+
+    bool FreeSpaceMap::StoreChain(PageType type, const std::vector<char> &bytes, std::vector<page_id_t> &pages,
+                                  std::vector<bool> &dirty, const WriteFn &write, const AllocFn &alloc) const
+    {
+        const size_t map_bytes = MapPageBytes();
+        const size_t chunks = (bytes.size() + map_bytes - 1) / map_bytes;
+        dirty.resize(std::max(chunks, pages.size()), true);
+        while (pages.size() < chunks)
+        {
+            page_id_t pid = alloc();
+            if (pid == INVALID_PAGE_ID)
+                return false;
+            // 链尾的 next_page_id 随之改变
+            if (!pages.empty())
+                dirty[pages.size() - 1] = true;
+            pages.push_back(pid);
+        }
+        std::vector<char> buf(page_size_);
+        for (size_t i = 0; i < pages.size(); ++i)
+        {
+            if (!dirty[i])
+                continue;
+            std::memset(buf.data(), 0, page_size_);
+            PageHeader *hdr = reinterpret_cast<PageHeader *>(buf.data());
+            hdr->page_type = static_cast<uint16_t>(type);
+            hdr->next_page_id = i + 1 < pages.size() ? pages[i + 1] : INVALID_PAGE_ID;
+            size_t from = i * map_bytes;
+            size_t n = from < bytes.size() ? std::min(map_bytes, bytes.size() - from) : 0;
+            if (n > 0)
+                std::memcpy(buf.data() + PAGE_HEADER_SIZE, bytes.data() + from, n);
+            hdr->slot_count = static_cast<uint16_t>(n);
+            hdr->free_space_offset = static_cast<uint16_t>(PAGE_HEADER_SIZE + n);
+            if (!write(pages[i], buf.data()))
+                return false;
+            dirty[i] = false;
+        }
+        return true;
+    }
+
+    bool FreeSpaceMap::Store(const WriteFn &write, const AllocFn &alloc)
+    {
+        bool ok = StoreChain(PageType::FREE_BITMAP_PAGE, free_bits_, bitmap_pages_, bitmap_dirty_, write, alloc);
+        return StoreChain(PageType::FSM_PAGE, levels_, fsm_pages_, fsm_dirty_, write, alloc) && ok;
+    }
+
+} // namespace minidb
@@ -0,0 +1,95 @@
+// src/storage/page/free_space_map.h
+/**
+ * 空闲空间映射（由 DiskManager 持有并持久化）
+ * - 空闲页位图：第 i 位为 1 表示页 i 已释放、可复用；落盘在 FREE_BITMAP_PAGE 页链中
+ * - 数据页空闲空间分级：每页 1 字节，0 表示未登记，否则为 1 + 空闲字节数 / BucketBytes()（页大小的 1/16）；
+ *   落盘在 FSM_PAGE 页链中。内存里再按段（区的属主）把各级页号放进桶，插入时 O(1) 找到有空间的页
+ * 本类不加锁，由 DiskManager 的 extent_mutex_ 串行化
+ */
+#pragma once
+
+#include "util/config.h"
+#include "storage/page/page_header.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace minidb
+{
+
+    class FreeSpaceMap
+    {
+    public:
+        static constexpr size_t FSM_BUCKETS = 16;
+
+        using ReadFn = std::function<bool(page_id_t, char *)>;
+        using WriteFn = std::function<bool(page_id_t, const char *)>;
+        using AllocFn = std::function<page_id_t()>;
+        using OwnerFn = std::function<page_id_t(page_id_t)>;
+
+        // 数据库的页大小，决定分级粒度与每个持久化页的容量；须在 Load 与登记之前设置
+        void SetPageSize(size_t page_size) { page_size_ = page_size; }
+        size_t BucketBytes() const { return page_size_ / FSM_BUCKETS; }
+        // 每个持久化页在页头之后能放下的位图字节数 / 分级字节数
+        size_t MapPageBytes() const { return page_size_ - PAGE_HEADER_SIZE; }
+
+        // ===== 空闲页位图 =====
+        void MarkFree(page_id_t page_id);
+        // 取出一个已释放的页（页号最小者优先），没有时返回 INVALID_PAGE_ID
+        page_id_t TakeFreePage();
+        bool IsFree(page_id_t page_id) const;
+        size_t GetFreePageCount() const { return free_count_; }
+
+        // ===== 数据页空闲空间 =====
+        // 登记页的空闲字节数；owner 为 INVALID_PAGE_ID 时只记分级，不进桶
+        void UpdateFreeSpace(page_id_t page_id, page_id_t owner, uint16_t free_bytes);
+        void Forget(page_id_t page_id);
+        // owner 段中保证放得下 need 字节的任一页，没有时返回 INVALID_PAGE_ID
+        page_id_t FindPageWithSpace(page_id_t owner, uint16_t need) const;
+
+        // ===== 持久化 =====
+        // 读入两条页链；页类型不符或越界时视为没有映射并返回 false
+        bool Load(page_id_t bitmap_root, page_id_t fsm_root, page_id_t num_pages, const ReadFn &read,
+                  const OwnerFn &owner_of);
+        // 只写回改动过的页；页链不够长时用 alloc 取新页
+        bool Store(const WriteFn &write, const AllocFn &alloc);
+        page_id_t GetBitmapRoot() const { return bitmap_pages_.empty() ? INVALID_PAGE_ID : bitmap_pages_.front(); }
+        page_id_t GetFsmRoot() const { return fsm_pages_.empty() ? INVALID_PAGE_ID : fsm_pages_.front(); }
+
+    private:
+        struct Slot
+        {
+            page_id_t owner;
+            uint8_t bucket;
+            uint32_t pos; // 在桶向量中的下标
+        };
+
+        void Unindex(page_id_t page_id);
+        uint8_t LevelOf(uint16_t free_bytes) const;
+        void MarkChunkDirty(std::vector<bool> &dirty, size_t byte_index) const;
+        bool LoadChain(page_id_t root, page_id_t num_pages, PageType type, const ReadFn &read,
+                       std::vector<page_id_t> &pages, std::vector<char> &bytes) const;
+        bool StoreChain(PageType type, const std::vector<char> &bytes, std::vector<page_id_t> &pages,
+                        std::vector<bool> &dirty, const WriteFn &write, const AllocFn &alloc) const;
+
+        size_t page_size_{PAGE_SIZE};
+
+        // 位图按字节存放，与落盘格式一致
+        std::vector<char> free_bits_;
+        size_t free_count_{0};
+        size_t free_hint_{0}; // 最低可能含空闲位的字节
+        std::vector<page_id_t> bitmap_pages_;
+        std::vector<bool> bitmap_dirty_; // 按持久化页计
+
+        std::vector<char> levels_; // 每页 1 字节的空闲空间分级
+        std::vector<page_id_t> fsm_pages_;
+        std::vector<bool> fsm_dirty_;
+
+        std::unordered_map<page_id_t, std::array<std::vector<page_id_t>, FSM_BUCKETS>> buckets_;
+        std::unordered_map<page_id_t, Slot> slots_;
+    };
+
+} // namespace minidb
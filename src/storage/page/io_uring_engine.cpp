@@ -0,0 +1,392 @@
+#include "storage/page/io_uring_engine.h"
+#include "util/logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef MINIDB_HAS_IO_URING
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace minidb
+{
+
+#ifdef MINIDB_HAS_IO_URING
+
+    namespace
+    {
+        // 停止完成线程用的 NOP 请求标记；DiskManager 的标记是请求对象地址，不会与之冲突
+        constexpr uint64_t kStopTag = ~0ULL;
+        constexpr unsigned kMaxEntries = 4096;
+
+        int SysSetup(unsigned entries, io_uring_params *p)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+        }
+
+        int SysEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+        }
+
+        int SysRegister(int ring_fd, unsigned opcode, const void *arg, unsigned nr_args)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+        }
+
+        // 环的 head / tail 与内核共享：读对方推进的下标用 acquire，发布自己的下标用 release
+        unsigned LoadAcquire(const unsigned *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+        void StoreRelease(unsigned *p, unsigned v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+    } // namespace
+
+    IoUringEngine::IoUringEngine(int fd, CompletionFn on_complete)
+        : fd_(fd), on_complete_(std::move(on_complete))
+    {
+    }
+
+    std::unique_ptr<IoUringEngine> IoUringEngine::Create(int fd, unsigned entries, CompletionFn on_complete)
+    {
+        if (fd < 0 || !on_complete)
+            return nullptr;
+        std::unique_ptr<IoUringEngine> engine(new IoUringEngine(fd, std::move(on_complete)));
+        if (!engine->Setup(std::clamp(entries, 1u, kMaxEntries)))
+            return nullptr;
+        engine->completion_thread_ = std::thread(&IoUringEngine::CompletionLoop, engine.get());
+        return engine;
+    }
+
+    bool IoUringEngine::Setup(unsigned entries)
+    {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        ring_fd_ = SysSetup(entries, &p);
+        if (ring_fd_ < 0)
+        {
+            global_log_warn(std::string("[IoUringEngine] io_uring_setup 失败: ") + std::strerror(errno));
+            return false;
+        }
+        // IORING_OP_READ / WRITE 需要 5.6 以上的内核；以 5.7 引入的 FAST_POLL 作为版本判断
+        if (!(p.features & IORING_FEAT_NODROP) || !(p.features & IORING_FEAT_FAST_POLL))
+        {
+            global_log_warn("[IoUringEngine] 内核的 io_uring 版本过旧");
+            return false;
+        }
+
+        sq_map_len_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_map_len_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap)
+            sq_map_len_ = cq_map_len_ = std::max(sq_map_len_, cq_map_len_);
+
+        void *sq = ::mmap(nullptr, sq_map_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                          IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED)
+            return false;
+        sq_ptr_ = sq;
+        if (single_mmap)
+        {
+            cq_ptr_ = sq_ptr_;
+        }
+        else
+        {
+            void *cq = ::mmap(nullptr, cq_map_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                              IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED)
+                return false;
+            cq_ptr_ = cq;
+        }
+        sqes_map_len_ = p.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, sqes_map_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                            IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+            return false;
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        char *sq_base = static_cast<char *>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq_base + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq_base + p.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned *>(sq_base + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq_base + p.sq_off.array);
+        sq_entries_ = p.sq_entries;
+        char *cq_base = static_cast<char *>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq_base + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq_base + p.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned *>(cq_base + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq_base + p.cq_off.cqes);
+        cq_entries_ = p.cq_entries;
+        return true;
+    }
+
+    IoUringEngine::~IoUringEngine()
+    {
+        if (completion_thread_.joinable())
+        {
+            bool stop_sent = false;
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                stopping_ = true;
+                SubmitLocked();
+                cv_.wait(lk, [&] { return in_flight_ == 0; });
+                // 在途请求已全部完成，再用一个 NOP 唤醒阻塞在 io_uring_enter 中的完成线程
+                const unsigned tail = *sq_tail_;
+                const unsigned idx = tail & *sq_mask_;
+                io_uring_sqe *sqe = &sqes_[idx];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sqe->opcode = IORING_OP_NOP;
+                sqe->user_data = kStopTag;
+                sq_array_[idx] = idx;
+                StoreRelease(sq_tail_, tail + 1);
+                int r;
+                do
+                {
+                    r = SysEnter(ring_fd_, 1, 0, 0);
+                } while (r < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+                stop_sent = r == 1;
+            }
+            if (stop_sent)
+            {
+                completion_thread_.join();
+            }
+            else
+            {
+                global_log_error("[IoUringEngine] 无法唤醒完成线程，放弃等待");
+                completion_thread_.detach();
+                return; // 完成线程可能仍在访问环，不再释放映射
+            }
+        }
+        if (sqes_)
+            ::munmap(sqes_, sqes_map_len_);
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_)
+            ::munmap(cq_ptr_, cq_map_len_);
+        if (sq_ptr_)
+            ::munmap(sq_ptr_, sq_map_len_);
+        if (ring_fd_ >= 0)
+            ::close(ring_fd_);
+    }
+
+    bool IoUringEngine::PrepareRead(uint64_t offset, char *buf, uint32_t len, uint64_t tag)
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        return PrepareLocked(lk, IORING_OP_READ, offset, buf, len, tag);
+    }
+
+    bool IoUringEngine::PrepareWrite(uint64_t offset, const char *buf, uint32_t len, uint64_t tag)
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        return PrepareLocked(lk, IORING_OP_WRITE, offset, buf, len, tag);
+    }
+
+    bool IoUringEngine::PrepareWritev(uint64_t offset, const struct iovec *iov, unsigned count, uint64_t tag)
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        return PrepareLocked(lk, IORING_OP_WRITEV, offset, reinterpret_cast<const char *>(iov), count, tag);
+    }
+
+    bool IoUringEngine::PrepareLocked(std::unique_lock<std::mutex> &lk, uint8_t opcode, uint64_t offset,
+                                      const char *buf, uint32_t len, uint64_t tag)
+    {
+        // 在途请求不超过 CQ 容量，完成队列不会溢出
+        while (!stopping_ && in_flight_ >= cq_entries_)
+        {
+            SubmitLocked();
+            cv_.wait(lk);
+        }
+        if (stopping_)
+            return false;
+        unsigned tail = *sq_tail_;
+        if (tail - LoadAcquire(sq_head_) >= sq_entries_)
+        {
+            // SQ 已满：先把排队的 SQE 交给内核（无 SQPOLL 时 io_uring_enter 返回前内核已取走）
+            SubmitLocked();
+            tail = *sq_tail_;
+        }
+
+        // WRITEV 的 buf 是 iovec 数组、len 是段数，不走固定缓冲区
+        const bool fixed = opcode != IORING_OP_WRITEV && fixed_base_ != nullptr && buf >= fixed_base_ &&
+                           buf + len <= fixed_base_ + fixed_len_;
+        if (fixed)
+        {
+            opcode = opcode == IORING_OP_READ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+            fixed_ops_.fetch_add(1);
+        }
+        const unsigned idx = tail & *sq_mask_;
+        io_uring_sqe *sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fd_;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = len;
+        sqe->buf_index = 0; // 只注册一段固定缓冲区
+        sqe->user_data = tag;
+        sq_array_[idx] = idx;
+        StoreRelease(sq_tail_, tail + 1);
+        ++pending_;
+        ++in_flight_;
+        return true;
+    }
+
+    void IoUringEngine::Submit()
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        SubmitLocked();
+    }
+
+    void IoUringEngine::SubmitLocked()
+    {
+        while (pending_ > 0)
+        {
+            int r = SysEnter(ring_fd_, pending_, 0, 0);
+            if (r >= 0)
+            {
+                pending_ -= std::min<unsigned>(pending_, static_cast<unsigned>(r));
+                submit_calls_.fetch_add(1);
+                continue;
+            }
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            // 不可恢复的错误：收回尚未被内核取走的 SQE，以 -errno 完成这些请求
+            const int err = errno;
+            global_log_error(std::string("[IoUringEngine] io_uring_enter 失败: ") + std::strerror(err));
+            const unsigned head = LoadAcquire(sq_head_);
+            const unsigned tail = *sq_tail_;
+            std::vector<uint64_t> tags;
+            for (unsigned i = head; i != tail; ++i)
+                tags.push_back(sqes_[sq_array_[i & *sq_mask_]].user_data);
+            StoreRelease(sq_tail_, head);
+            pending_ = 0;
+            in_flight_ -= tags.size();
+            for (uint64_t tag : tags)
+                on_complete_(tag, -err);
+            cv_.notify_all();
+            return;
+        }
+    }
+
+    void IoUringEngine::Drain()
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        SubmitLocked();
+        cv_.wait(lk, [&] { return in_flight_ == 0; });
+    }
+
+    void IoUringEngine::CompletionLoop()
+    {
+        for (;;)
+        {
+            unsigned head = *cq_head_; // 只有本线程推进 CQ head
+            const unsigned tail = LoadAcquire(cq_tail_);
+            if (head == tail)
+            {
+                int r = SysEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+                if (r < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                {
+                    global_log_error(std::string("[IoUringEngine] 等待完成失败: ") + std::strerror(errno));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                continue;
+            }
+            bool stop = false;
+            size_t done = 0;
+            for (; head != tail; ++head)
+            {
+                const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+                const uint64_t tag = cqe.user_data;
+                const int res = cqe.res;
+                if (tag == kStopTag)
+                {
+                    stop = true;
+                    continue;
+                }
+                on_complete_(tag, res);
+                ++done;
+            }
+            StoreRelease(cq_head_, head);
+            if (done > 0)
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                in_flight_ -= done;
+                cv_.notify_all();
+            }
+            if (stop)
+                return;
+        }
+    }
+
+    bool IoUringEngine::RegisterBuffers(void *base, size_t len)
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        SubmitLocked();
+        cv_.wait(lk, [&] { return in_flight_ == 0; });
+        if (fixed_base_ != nullptr)
+        {
+            SysRegister(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            fixed_base_ = nullptr;
+            fixed_len_ = 0;
+        }
+        if (base == nullptr || len == 0)
+            return false;
+        struct iovec iov{base, len};
+        if (SysRegister(ring_fd_, IORING_REGISTER_BUFFERS, &iov, 1) != 0)
+        {
+            // 常见原因是 RLIMIT_MEMLOCK 不足；读写仍可用普通的 READ / WRITE
+            global_log_warn(std::string("[IoUringEngine] 注册固定缓冲区失败: ") + std::strerror(errno));
+            return false;
+        }
+        fixed_base_ = static_cast<const char *>(base);
+        fixed_len_ = len;
+        return true;
+    }
+
+    void IoUringEngine::UnregisterBuffers()
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        if (fixed_base_ == nullptr)
+            return;
+        SubmitLocked();
+        cv_.wait(lk, [&] { return in_flight_ == 0; });
+        SysRegister(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        fixed_base_ = nullptr;
+        fixed_len_ = 0;
+    }
+
+    size_t IoUringEngine::InFlight() const
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        return in_flight_;
+    }
+
+#else // !MINIDB_HAS_IO_URING
+
+    // 非 Linux 平台：始终不可用，DiskManager 使用工作线程池
+    IoUringEngine::IoUringEngine(int fd, CompletionFn on_complete) : fd_(fd), on_complete_(std::move(on_complete)) {}
+    std::unique_ptr<IoUringEngine> IoUringEngine::Create(int, unsigned, CompletionFn) { return nullptr; }
+    IoUringEngine::~IoUringEngine() = default;
+    bool IoUringEngine::Setup(unsigned) { return false; }
+    bool IoUringEngine::PrepareRead(uint64_t, char *, uint32_t, uint64_t) { return false; }
+    bool IoUringEngine::PrepareWrite(uint64_t, const char *, uint32_t, uint64_t) { return false; }
+    bool IoUringEngine::PrepareWritev(uint64_t, const struct iovec *, unsigned, uint64_t) { return false; }
+    bool IoUringEngine::PrepareLocked(std::unique_lock<std::mutex> &, uint8_t, uint64_t, const char *, uint32_t,
+                                      uint64_t) { return false; }
+    void IoUringEngine::Submit() {}
+    void IoUringEngine::SubmitLocked() {}
+    void IoUringEngine::Drain() {}
+    void IoUringEngine::CompletionLoop() {}
+    bool IoUringEngine::RegisterBuffers(void *, size_t) { return false; }
+    void IoUringEngine::UnregisterBuffers() {}
+    size_t IoUringEngine::InFlight() const { return 0; }
+
+#endif
+
+} // namespace minidb
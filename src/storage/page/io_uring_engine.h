@@ -0,0 +1,114 @@
+// src/storage/page/io_uring_engine.h
+/**
+ * io_uring 异步 I/O 引擎（Linux）：直接使用 io_uring_setup / io_uring_enter / io_uring_register 系统调用，
+ * 不依赖 liburing
+ * - Prepare* 只向提交队列（SQ）追加 SQE，Submit 一次 io_uring_enter 提交所有已排队的 SQE，
+ *   因此多页写回可以批量进入内核；页号连续的多页写可以合并为一个 WRITEV
+ * - RegisterBuffers 把一段连续内存（缓冲池的帧数组）注册为固定缓冲区，落在其中的读写使用
+ *   READ_FIXED / WRITE_FIXED，内核不必每次重新固定用户页
+ * - 单独的完成线程阻塞等待完成队列（CQ），对每个 CQE 调用完成回调
+ * - 内核不支持或被禁止（ENOSYS / EPERM 等）时 Create 返回 nullptr，由调用方退回工作线程池
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define MINIDB_HAS_IO_URING 1
+#endif
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct iovec;
+
+namespace minidb
+{
+
+    class IoUringEngine
+    {
+    public:
+        // tag 为提交时给出的值，res 为传输的字节数或 -errno；在完成线程上调用
+        using CompletionFn = std::function<void(uint64_t tag, int res)>;
+
+        // entries 为提交队列深度（向上取 2 的幂）；失败返回 nullptr
+        static std::unique_ptr<IoUringEngine> Create(int fd, unsigned entries, CompletionFn on_complete);
+        // 等待进行中的请求完成后停止完成线程并释放环
+        ~IoUringEngine();
+
+        IoUringEngine(const IoUringEngine &) = delete;
+        IoUringEngine &operator=(const IoUringEngine &) = delete;
+
+        // 排队一个读 / 写请求，不进入内核；在途请求达到上限时先提交并等待完成。停止后返回 false
+        bool PrepareRead(uint64_t offset, char *buf, uint32_t len, uint64_t tag);
+        bool PrepareWrite(uint64_t offset, const char *buf, uint32_t len, uint64_t tag);
+        // 排队一个向量写（IORING_OP_WRITEV）：iov[0..count) 依次写到 offset 起的连续区间，完成前 iov 须保持有效
+        bool PrepareWritev(uint64_t offset, const struct iovec *iov, unsigned count, uint64_t tag);
+        // 提交所有已排队的 SQE；io_uring_enter 出错时这些请求以 -errno 完成
+        void Submit();
+        // 提交并等待所有在途请求完成
+        void Drain();
+
+        // 注册 / 注销固定缓冲区（只保留一段，重复注册会替换）；注销前会等待在途请求完成
+        bool RegisterBuffers(void *base, size_t len);
+        void UnregisterBuffers();
+
+        size_t InFlight() const;
+        uint64_t GetSubmitCalls() const { return submit_calls_.load(); }
+        uint64_t GetFixedOps() const { return fixed_ops_.load(); }
+
+    private:
+        IoUringEngine(int fd, CompletionFn on_complete);
+
+        bool Setup(unsigned entries);
+        bool PrepareLocked(std::unique_lock<std::mutex> &lk, uint8_t opcode, uint64_t offset, const char *buf,
+                           uint32_t len, uint64_t tag);
+        void SubmitLocked();
+        void CompletionLoop();
+
+        int fd_;           // 被读写的数据文件
+        int ring_fd_{-1};
+        CompletionFn on_complete_;
+
+        // 映射的环：SQ / CQ 的 head、tail、mask 都指向共享内存
+        void *sq_ptr_{nullptr};
+        void *cq_ptr_{nullptr};
+        size_t sq_map_len_{0};
+        size_t cq_map_len_{0};
+        io_uring_sqe *sqes_{nullptr};
+        size_t sqes_map_len_{0};
+        unsigned *sq_head_{nullptr};
+        unsigned *sq_tail_{nullptr};
+        unsigned *sq_mask_{nullptr};
+        unsigned *sq_array_{nullptr};
+        unsigned sq_entries_{0};
+        unsigned *cq_head_{nullptr};
+        unsigned *cq_tail_{nullptr};
+        unsigned *cq_mask_{nullptr};
+        io_uring_cqe *cqes_{nullptr};
+        unsigned cq_entries_{0};
+
+        // mu_ 保护 SQ 的写入、在途计数与固定缓冲区；完成线程只在更新计数时加锁
+        mutable std::mutex mu_;
+        std::condition_variable cv_;
+        unsigned pending_{0};  // 已排队未提交的 SQE
+        size_t in_flight_{0};  // 已排队或已提交、尚未完成的请求
+        bool stopping_{false};
+        const char *fixed_base_{nullptr};
+        size_t fixed_len_{0};
+
+        std::atomic<uint64_t> submit_calls_{0}; // io_uring_enter 提交次数
+        std::atomic<uint64_t> fixed_ops_{0};
+
+        std::thread completion_thread_;
+    };
+
+} // namespace minidb
@@ -2,18 +2,41 @@
 #pragma once
 #include "util/config.h"
 #include "page_header.h"
+#include "wal_manager.h"
 #include <atomic>
 #include <shared_mutex>
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include <iostream>
+#include <memory>
+#include <new>
 
 namespace minidb {
 
+// 按 PAGE_SIZE 对齐的页内存（O_DIRECT 与 io_uring 固定缓冲区都要求对齐）
+struct FrameDeleter {
+    void operator()(char* p) const { ::operator delete[](p, std::align_val_t(PAGE_SIZE)); }
+};
+using FrameBuffer = std::unique_ptr<char[], FrameDeleter>;
+
+// 分配 n 个连续的页帧（每帧 page_size 字节）并清零
+inline FrameBuffer AllocateFrames(size_t n, size_t page_size = PAGE_SIZE) {
+    char* p = static_cast<char*>(::operator new[](n * page_size, std::align_val_t(PAGE_SIZE)));
+    std::memset(p, 0, n * page_size);
+    return FrameBuffer(p);
+}
+
 class Page {
 public:
-    Page() { Reset(); }
-    explicit Page(page_id_t page_id) : page_id_(page_id) { Reset(); }
+    Page() : owned_(AllocateFrames(1)), data_(owned_.get()) { Reset(); }
+    explicit Page(page_id_t page_id, size_t page_size = PAGE_SIZE)
+        : owned_(AllocateFrames(1, page_size)), data_(owned_.get()), page_size_(page_size) {
+        Reset();
+        page_id_ = page_id;
+    }
+    // 不拥有内存的页：指向缓冲池帧数组中的一帧，或只读映射中的一页；构造时不改动内容
+    explicit Page(char* frame, size_t page_size = PAGE_SIZE) : data_(frame), page_size_(page_size) {}
     
     // 禁用拷贝，允许移动
     Page(const Page&) = delete;
@@ -23,9 +46,17 @@ public:
 
     // 基础接口
     page_id_t GetPageId() const { return page_id_; }
-    void SetPageId(page_id_t id) { page_id_ = id; }
+    void SetPageId(page_id_t id) {
+        page_id_ = id;
+        logged_.store(false);
+        rec_lsn_.store(INVALID_LSN);
+        image_lsn_.store(INVALID_LSN);
+        after_write_lsn_.store(INVALID_LSN);
+    }
     char* GetData() { return data_; }
     const char* GetData() const { return data_; }
+    // 页帧字节数，即所属数据库的页大小
+    size_t GetPageSize() const { return page_size_; }
     
     // 脏页管理
     bool IsDirty() const { return is_dirty_.load(); }
@@ -44,10 +75,13 @@ public:
     
     // 页面重置
     void Reset() {
-        std::memset(data_, 0, PAGE_SIZE);
+        std::memset(data_, 0, page_size_);
         page_id_ = INVALID_PAGE_ID;
         is_dirty_.store(false);
         pin_count_.store(0);
+        rec_lsn_.store(INVALID_LSN);
+        image_lsn_.store(INVALID_LSN);
+        after_write_lsn_.store(INVALID_LSN);
     }
     
     // 并发控制
@@ -72,6 +106,7 @@ public:
     
     void SetNextPageId(page_id_t next_id) {
         GetHeader()->next_page_id = next_id;
+        LogHeader();
     }
     
     // 页类型操作
@@ -80,7 +115,8 @@ public:
     }
     
     void SetPageType(PageType type) {
-        GetHeader()->page_type = static_cast<uint32_t>(type);
+        GetHeader()->page_type = static_cast<uint16_t>(type);
+        LogHeader();
     }
     
     // 槽管理
@@ -98,18 +134,96 @@ public:
         hdr->slot_count = 0;
         hdr->free_space_offset = PAGE_HEADER_SIZE;
         hdr->next_page_id = INVALID_PAGE_ID;
-        hdr->page_type = static_cast<uint32_t>(type);
-        hdr->reserved = 0;
+        hdr->page_type = static_cast<uint16_t>(type);
         // Header mutated: ensure the page will be flushed
         SetDirty(true);
+        LogHeader();
+    }
+
+    // ===== 页内逻辑日志 =====
+    // 缓冲池的帧挂上 WAL 后，页内修改就地记成小记录（插槽、删槽、页头、B+ 树条目）并把记录 LSN 写进页头；
+    // 其余直接改页内字节的路径不记日志，由缓冲池在脏页释放时补一张整页镜像。
+    uint64_t GetPageLsn() const { return GetHeader()->GetLsn(); }
+    void SetPageLsn(uint64_t lsn) { GetHeader()->SetLsn(lsn); }
+    void SetWal(WalManager* wal) { wal_ = wal; }
+    WalManager* GetWal() const { return wal_; }
+
+    // 记录一次已在页上完成的修改；检查点之后的首次修改由 WAL 改记整页镜像
+    void LogChange(WalRecordType type, uint16_t slot, const void* payload, uint32_t len) {
+        if (!ShouldLog()) return;
+        bool image = false;
+        lsn_t lsn = wal_->LogPageChange(page_id_, data_, image_lsn_.load(), type, slot, payload, len, &image);
+        if (lsn == INVALID_LSN) return;
+        Stamp(lsn, image);
+        // 页头记录不能代表页上其余的改动（新页初始化后常接着直接写布局），不算作已记日志
+        if (type != WalRecordType::PAGE_HEADER) logged_.store(true);
+    }
+
+    // 整页镜像
+    void LogImage() {
+        if (!ShouldLog()) return;
+        lsn_t lsn = wal_->Append(page_id_, data_);
+        if (lsn != INVALID_LSN) Stamp(lsn, true);
+    }
+
+    // 脏页释放时调用：本次持有期间没有逻辑记录覆盖的改动记一张整页镜像
+    void LogUnloggedChanges() {
+        if (!logged_.exchange(false)) LogImage();
+    }
+
+    // 脏页表：重做本页需要的最早 LSN（自上次写回后的首条记录，且不晚于本页最近的整页镜像）；干净页为 INVALID_LSN
+    lsn_t GetRecLsn() const {
+        const lsn_t rec = rec_lsn_.load();
+        const lsn_t image = image_lsn_.load();
+        if (rec == INVALID_LSN) return INVALID_LSN;
+        return image != INVALID_LSN ? std::min(rec, image) : rec;
+    }
+
+    // 开始写回：返回写出内容的页 LSN，并从此记下写出期间本页的第一条记录
+    lsn_t BeginWriteback() {
+        after_write_lsn_.store(INVALID_LSN);
+        return GetPageLsn();
+    }
+
+    // 页内容（写出时页 LSN 为 written_lsn）已写回数据文件；写出期间又被修改的页仍是脏页，
+    // recLSN 前移到写出后的第一条记录（LSN 是字节偏移，只能取记录起点，检查点才能按它截断）
+    void MarkWritten(lsn_t written_lsn) {
+        if (GetPageLsn() != written_lsn) {
+            const lsn_t after = after_write_lsn_.load();
+            if (after != INVALID_LSN) rec_lsn_.store(after);
+            return;
+        }
+        rec_lsn_.store(INVALID_LSN);
+        SetDirty(false);
     }
 
 private:
-    alignas(PAGE_SIZE) char data_[PAGE_SIZE];
+    bool ShouldLog() const {
+        return wal_ != nullptr && page_id_ != INVALID_PAGE_ID &&
+               GetHeader()->page_type != static_cast<uint16_t>(PageType::TEMP_PAGE);
+    }
+    void LogHeader() { LogChange(WalRecordType::PAGE_HEADER, 0, data_, PAGE_HEADER_SIZE); }
+    void Stamp(lsn_t lsn, bool image) {
+        SetPageLsn(lsn);
+        lsn_t clean = INVALID_LSN;
+        rec_lsn_.compare_exchange_strong(clean, lsn);
+        lsn_t none = INVALID_LSN;
+        after_write_lsn_.compare_exchange_strong(none, lsn);
+        if (image) image_lsn_.store(lsn);
+    }
+
+    FrameBuffer owned_; // 独立页自带的页帧；外部页帧时为空
+    char* data_;
+    size_t page_size_{PAGE_SIZE};
     page_id_t page_id_{INVALID_PAGE_ID};
     std::atomic<bool> is_dirty_{false};
     std::atomic<int> pin_count_{0};
     mutable std::shared_mutex rwlock_;
+    WalManager* wal_{nullptr};
+    std::atomic<bool> logged_{false}; // 本次持有期间的修改已由逻辑记录覆盖
+    std::atomic<lsn_t> rec_lsn_{INVALID_LSN};   // 自上次写回后修改本页的第一条记录
+    std::atomic<lsn_t> image_lsn_{INVALID_LSN}; // 本页最近一张整页镜像
+    std::atomic<lsn_t> after_write_lsn_{INVALID_LSN}; // 最近一次开始写回后修改本页的第一条记录
 };
 
 }
\ No newline at end of file
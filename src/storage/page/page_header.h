@@ -10,8 +10,15 @@ struct PageHeader {
     uint16_t slot_count;        // 已用槽数
     uint16_t free_space_offset; // 自页首起的可用空间偏移
     uint32_t next_page_id;      // 下一页ID（INVALID_PAGE_ID表示末尾）
-    uint32_t page_type;         // 页类型（0=数据页，1=索引页，2=元数据页等）
-    uint32_t reserved;          // 保留字段，用于对齐
+    uint16_t page_type;         // 页类型（0=数据页，1=索引页，2=元数据页等）
+    uint16_t page_lsn_high;     // 页 LSN 高 16 位
+    uint32_t page_lsn_low;      // 页 LSN 低 32 位：最后一条修改本页的 WAL 记录，重做时据此跳过已生效的记录
+
+    uint64_t GetLsn() const { return (static_cast<uint64_t>(page_lsn_high) << 32) | page_lsn_low; }
+    void SetLsn(uint64_t lsn) {
+        page_lsn_high = static_cast<uint16_t>(lsn >> 32);
+        page_lsn_low = static_cast<uint32_t>(lsn);
+    }
 };
 
 // 槽目录条目（固定4字节）：[offset(2B), length(2B)]
@@ -25,14 +32,18 @@ enum class PageType : uint32_t {
     DATA_PAGE = 0,      // 数据页
     INDEX_PAGE = 1,     // 索引页
     METADATA_PAGE = 2,  // 元数据页
-    CATALOG_PAGE = 3    // 目录页
+    CATALOG_PAGE = 3,   // 目录页
+    TEMP_PAGE = 4,      // 临时页（算子溢写，用完即释放）
+    EXTENT_MAP_PAGE = 5,  // 区目录页（记录各区的属主段与已分配页数）
+    FREE_BITMAP_PAGE = 6, // 空闲页位图
+    FSM_PAGE = 7          // 数据页空闲空间分级
 };
 
 // 页内布局常量
 constexpr uint16_t PAGE_HEADER_SIZE = sizeof(PageHeader);
 constexpr uint16_t SLOT_ENTRY_SIZE = sizeof(SlotEntry);
 
-// 页内布局（以PAGE_SIZE=4096为例）：
+// 页内布局（页大小由数据库决定，4K..64K；64K 页的偏移仍小于 65536，uint16_t 足够）：
 // [PageHeader | ...记录区向下增长... | ...空闲... | ...槽目录向上增长... ]
 // 记录写入 data + hdr.free_space_offset，槽目录写在页尾（倒序）
 
@@ -4,6 +4,7 @@
 #include "page_header.h"
 #include <functional>
 #include <cstring>
+#include <vector>
 
 namespace minidb {
 
@@ -12,13 +13,13 @@ inline SlotEntry* GetSlot(Page* page, uint16_t slot_index) {
     char* base = page->GetData();
     // 槽 i 位于：页尾起始位置 - (i+1)*sizeof(SlotEntry)
     size_t slot_bytes = SLOT_ENTRY_SIZE * (static_cast<size_t>(slot_index) + 1);
-    return reinterpret_cast<SlotEntry*>(base + PAGE_SIZE - slot_bytes);
+    return reinterpret_cast<SlotEntry*>(base + page->GetPageSize() - slot_bytes);
 }
 
 inline const SlotEntry* GetSlot(const Page* page, uint16_t slot_index) {
     const char* base = page->GetData();
     size_t slot_bytes = SLOT_ENTRY_SIZE * (static_cast<size_t>(slot_index) + 1);
-    return reinterpret_cast<const SlotEntry*>(base + PAGE_SIZE - slot_bytes);
+    return reinterpret_cast<const SlotEntry*>(base + page->GetPageSize() - slot_bytes);
 }
 
 // 计算当前剩余可用空间（不含槽目录本身）
@@ -26,7 +27,7 @@ inline uint16_t GetFreeSpace(const Page* page) {
     const PageHeader* hdr = page->GetHeader();
     uint16_t used_for_slots = hdr->slot_count * SLOT_ENTRY_SIZE;
     // 槽目录占据页尾的 used_for_slots 字节
-    return PAGE_SIZE - used_for_slots - hdr->free_space_offset;
+    return static_cast<uint16_t>(page->GetPageSize() - used_for_slots - hdr->free_space_offset);
 }
 
 // 追加一条记录；成功返回 true，并在 out_slot 返回槽序号
@@ -46,10 +47,12 @@ inline bool AppendRow(Page* page, const void* row, uint16_t len, uint16_t* out_s
     SlotEntry* slot = GetSlot(page, hdr->slot_count);
     slot->offset = write_off;
     slot->length = len;
-    if (out_slot) *out_slot = hdr->slot_count;
+    const uint16_t slot_index = hdr->slot_count;
+    if (out_slot) *out_slot = slot_index;
     hdr->slot_count++;
     // Mark page dirty after in-memory mutation
     page->SetDirty(true);
+    page->LogChange(WalRecordType::SLOT_INSERT, slot_index, row, len);
     return true;
 }
 
@@ -78,6 +81,57 @@ inline bool DeleteRow(Page* page, uint16_t slot_index) {
     
     SlotEntry* slot = GetSlot(page, slot_index);
     slot->length = 0;  // 标记为删除
+    page->LogChange(WalRecordType::SLOT_DELETE, slot_index, nullptr, 0);
+    return true;
+}
+
+// 页内定长条目数组（B+ 树叶子等）：uint16_t 计数在 count_offset，条目从 array_offset 起紧密排列。
+// 插入、删除第 index 个条目并记一条与具体节点布局无关的逻辑日志；重做走同一函数。
+struct ArrayEntryLog {
+    uint16_t count_offset;
+    uint16_t array_offset;
+    uint16_t entry_size;
+    uint16_t reserved;
+};
+
+inline bool InsertArrayEntry(Page* page, uint16_t count_offset, uint16_t array_offset, uint16_t entry_size,
+                             uint16_t index, const void* entry) {
+    char* base = page->GetData();
+    uint16_t count = 0;
+    std::memcpy(&count, base + count_offset, sizeof(count));
+    if (index > count || entry_size == 0 ||
+        array_offset + (static_cast<size_t>(count) + 1) * entry_size > page->GetPageSize())
+        return false;
+    char* at = base + array_offset + static_cast<size_t>(index) * entry_size;
+    std::memmove(at + entry_size, at, static_cast<size_t>(count - index) * entry_size);
+    std::memcpy(at, entry, entry_size);
+    ++count;
+    std::memcpy(base + count_offset, &count, sizeof(count));
+
+    if (page->GetWal()) {
+        ArrayEntryLog h{count_offset, array_offset, entry_size, 0};
+        std::vector<char> rec(sizeof(h) + entry_size);
+        std::memcpy(rec.data(), &h, sizeof(h));
+        std::memcpy(rec.data() + sizeof(h), entry, entry_size);
+        page->LogChange(WalRecordType::BTREE_INSERT, index, rec.data(), static_cast<uint32_t>(rec.size()));
+    }
+    return true;
+}
+
+inline bool RemoveArrayEntry(Page* page, uint16_t count_offset, uint16_t array_offset, uint16_t entry_size,
+                             uint16_t index) {
+    char* base = page->GetData();
+    uint16_t count = 0;
+    std::memcpy(&count, base + count_offset, sizeof(count));
+    if (index >= count || entry_size == 0 ||
+        array_offset + static_cast<size_t>(count) * entry_size > page->GetPageSize())
+        return false;
+    char* at = base + array_offset + static_cast<size_t>(index) * entry_size;
+    std::memmove(at, at + entry_size, static_cast<size_t>(count - index - 1) * entry_size);
+    --count;
+    std::memcpy(base + count_offset, &count, sizeof(count));
+    ArrayEntryLog h{count_offset, array_offset, entry_size, 0};
+    page->LogChange(WalRecordType::BTREE_REMOVE, index, &h, sizeof(h));
     return true;
 }
 
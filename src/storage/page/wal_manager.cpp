@@ -1,53 +1,959 @@
 #include "storage/page/wal_manager.h"
 #include "storage/page/disk_manager.h"
+#include "storage/page/page_utils.h"
+#include "util/checksum.h"
+#include "util/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
+#ifdef MINIDB_POSIX_IO
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace minidb {
 
-static constexpr uint64_t WAL_MAGIC = 0x4D444257414C5F31ULL; // MDBWAL_1
+static constexpr uint64_t WAL_FILE_MAGIC = 0x4D444257414C5F33ULL; // MDBWAL_3
+static constexpr uint32_t WAL_RECORD_MAGIC = 0x57414C52;          // "RLAW"
+static constexpr size_t WAL_MIN_SEGMENT_BYTES = 1024 * 1024;
+static constexpr const char* WAL_CONTROL_FILE = "control";
 
-struct WalRecordHeader {
+struct WalControl {
     uint64_t magic;
+    uint64_t start_lsn;         // 日志中第一条记录的 LSN
+    uint64_t synced_checkpoint; // 数据文件已随之落盘的最近一次检查点的开始 LSN，恢复时只信任它的脏页表
+    uint64_t segment_bytes;     // 段大小：打开已有日志时以此为准
+};
+
+struct WalRecordHeader {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t slot;   // 逻辑记录作用的槽号 / 条目下标
     uint32_t page_id;
-    uint32_t length; // always PAGE_SIZE
+    uint32_t length; // 负载字节数（整页镜像为数据库的页大小）
+    lsn_t lsn;       // 决定记录所在的段与段内偏移，可识别复用的段里上一轮留下的旧记录
+    uint32_t checksum;
+    uint32_t hole; // 整页镜像省去的空闲区长度（数据页记录区与槽目录之间），起点在 slot
 };
+static_assert(sizeof(WalControl) == 32 && sizeof(WalRecordHeader) == 32, "WAL headers must be 32 bytes");
 
-bool WalManager::Append(page_id_t page_id, const char* page_data) {
-    std::lock_guard<std::mutex> g(mtx_);
-    std::ofstream ofs(wal_file_, std::ios::binary | std::ios::app);
-    if (!ofs.is_open()) return false;
-    WalRecordHeader hdr{WAL_MAGIC, static_cast<uint32_t>(page_id), static_cast<uint32_t>(PAGE_SIZE)};
-    ofs.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
-    ofs.write(page_data, PAGE_SIZE);
-    ofs.flush();
-    return static_cast<bool>(ofs);
+namespace {
+    // 记录校验先覆盖负载（可在锁外算），再由它覆盖分配 LSN 之后才确定的头部字段
+    uint32_t FinishChecksum(uint32_t crc, const WalRecordHeader& h) {
+        crc = checksum::MixField(crc, h.type);
+        crc = checksum::MixField(crc, h.slot);
+        crc = checksum::MixField(crc, h.page_id);
+        crc = checksum::MixField(crc, h.length);
+        crc = checksum::MixField(crc, h.hole);
+        return checksum::MixField(crc, h.lsn);
+    }
+
+    // LSN 从 1 开始：段 n 存放 [n * seg + 1, (n + 1) * seg + 1) 的日志字节
+    uint64_t SegmentOf(lsn_t lsn, uint64_t seg) { return (lsn - 1) / seg; }
+    uint64_t SegmentOffset(lsn_t lsn, uint64_t seg) { return (lsn - 1) % seg; }
+    lsn_t SegmentBase(uint64_t segno, uint64_t seg) { return segno * seg + 1; }
+
+    std::string SegmentPath(const std::string& dir, uint64_t segno) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(segno));
+        return dir + "/" + name;
+    }
+
+    // 目录中的段号（文件名为 16 位十六进制），升序
+    std::vector<uint64_t> ListSegments(const std::string& dir) {
+        std::vector<uint64_t> segs;
+        std::error_code ec;
+        for (const auto& e : std::filesystem::directory_iterator(dir, ec)) {
+            const std::string name = e.path().filename().string();
+            if (name.size() != 16 || name.find_first_not_of("0123456789abcdef") != std::string::npos) continue;
+            segs.push_back(std::stoull(name, nullptr, 16));
+        }
+        std::sort(segs.begin(), segs.end());
+        return segs;
+    }
+
+    // 记录不跨段：从 lsn 开始放不下 rec 字节时要补到段尾的字节数
+    size_t PaddingBefore(lsn_t lsn, size_t rec, uint64_t seg) {
+        const size_t room = static_cast<size_t>(seg - SegmentOffset(lsn, seg));
+        return rec > room ? room : 0;
+    }
+
+#ifdef MINIDB_POSIX_IO
+    bool PReadAll(int fd, char* buf, size_t len, uint64_t off) {
+        size_t done = 0;
+        while (done < len) {
+            ssize_t n = ::pread(fd, buf + done, len - done, static_cast<off_t>(off + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool PWriteAll(int fd, const char* buf, size_t len, uint64_t off) {
+        size_t done = 0;
+        while (done < len) {
+            ssize_t n = ::pwrite(fd, buf + done, len - done, static_cast<off_t>(off + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 目录项（新建、改名、删除）落盘
+    bool SyncDir(const std::string& dir) {
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0) return false;
+        const bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    // 从 start 起顺序校验 [start, limit) 内的记录，对每条有效记录（填充记录除外）调用 fn；返回有效记录的末尾。
+    // 按块读入段文件，fn 收到的负载指针只在回调内有效
+    template <typename Fn>
+    lsn_t ScanRecords(const std::string& dir, uint64_t seg, lsn_t start, lsn_t limit, Fn&& fn) {
+        static constexpr size_t SCAN_CHUNK = 1 << 20;
+        static const char empty = 0;
+        std::vector<char> buf;
+        lsn_t buf_lsn = 0; // buf[0] 对应的 LSN
+        int fd = -1;
+        uint64_t fd_seg = std::numeric_limits<uint64_t>::max();
+        // 记录不跨段，窗口也只在一个段内
+        auto window = [&](lsn_t lsn, size_t len) -> const char* {
+            if (len == 0) return &empty;
+            if (lsn >= buf_lsn && lsn + len <= buf_lsn + buf.size()) return buf.data() + (lsn - buf_lsn);
+            if (lsn + len > limit) return nullptr;
+            const uint64_t segno = SegmentOf(lsn, seg);
+            if (segno != fd_seg) {
+                if (fd >= 0) ::close(fd);
+                fd = ::open(SegmentPath(dir, segno).c_str(), O_RDONLY);
+                fd_seg = segno;
+            }
+            if (fd < 0) return nullptr;
+            const lsn_t end = std::min(limit, SegmentBase(segno + 1, seg));
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(std::max(len, SCAN_CHUNK), end - lsn));
+            buf.resize(want);
+            buf_lsn = lsn;
+            if (!PReadAll(fd, buf.data(), want, SegmentOffset(lsn, seg))) {
+                buf.clear();
+                return nullptr;
+            }
+            return buf.data();
+        };
+        lsn_t lsn = start;
+        while (lsn < limit && limit - lsn >= sizeof(WalRecordHeader)) {
+            const lsn_t seg_end = SegmentBase(SegmentOf(lsn, seg) + 1, seg);
+            if (seg_end - lsn < sizeof(WalRecordHeader)) {
+                lsn = seg_end; // 段尾不足一个记录头的空隙
+                continue;
+            }
+            const char* hp = window(lsn, sizeof(WalRecordHeader));
+            if (!hp) break;
+            WalRecordHeader h{};
+            std::memcpy(&h, hp, sizeof(h));
+            if (h.magic != WAL_RECORD_MAGIC || h.lsn != lsn || h.length > MAX_PAGE_SIZE ||
+                lsn + sizeof(h) + h.length > seg_end)
+                break;
+            const char* payload = window(lsn + sizeof(h), h.length);
+            if (!payload) break;
+            if (FinishChecksum(checksum::Mix(0, payload, h.length), h) != h.checksum) break;
+            if (h.type != static_cast<uint16_t>(WalRecordType::SEGMENT_SWITCH)) fn(h, payload);
+            lsn += sizeof(h) + h.length;
+        }
+        if (fd >= 0) ::close(fd);
+        return lsn;
+    }
+
+    // 页号打散到重做线程
+    size_t RedoPartition(page_id_t pid, size_t parts) {
+        return static_cast<size_t>((static_cast<uint64_t>(pid) * 0x9E3779B97F4A7C15ULL) >> 32) % parts;
+    }
+
+    // 对 ids 中连续递增且满足 pred 的每一段调用 fn(起始下标, 段长)
+    template <typename Pred, typename Fn>
+    void ForEachRun(const std::vector<page_id_t>& ids, Pred&& pred, Fn&& fn) {
+        size_t i = 0;
+        while (i < ids.size()) {
+            if (!pred(i)) {
+                ++i;
+                continue;
+            }
+            size_t j = i + 1;
+            while (j < ids.size() && pred(j) && ids[j] == ids[j - 1] + 1) ++j;
+            fn(i, j - i);
+            i = j;
+        }
+    }
+#endif
+
+    // 数据页的整页镜像不记记录区与槽目录之间的空闲区；返回空闲区起点与长度（不是数据页或布局不对时为 0）
+    uint32_t FindPageHole(const char* page, size_t page_size, uint16_t* hole_off) {
+        const PageHeader* hdr = reinterpret_cast<const PageHeader*>(page);
+        if (hdr->page_type != static_cast<uint16_t>(PageType::DATA_PAGE)) return 0;
+        const size_t slots_begin = page_size - static_cast<size_t>(hdr->slot_count) * SLOT_ENTRY_SIZE;
+        if (hdr->free_space_offset < PAGE_HEADER_SIZE || hdr->free_space_offset > slots_begin) return 0;
+        *hole_off = hdr->free_space_offset;
+        return static_cast<uint32_t>(slots_begin - hdr->free_space_offset);
+    }
+
+    // 在页的当前内容上重放一条记录；记录与页对不上（页内容不是这条记录的前像）时返回 false
+    bool RedoRecord(const WalRecordHeader& h, const char* payload, Page& page) {
+        switch (static_cast<WalRecordType>(h.type)) {
+        case WalRecordType::FULL_PAGE: {
+            const size_t head = h.slot;
+            if (static_cast<size_t>(h.length) + h.hole != page.GetPageSize() || head > h.length) return false;
+            char* dst = page.GetData();
+            std::memcpy(dst, payload, head);
+            std::memset(dst + head, 0, h.hole);
+            std::memcpy(dst + head + h.hole, payload + head, h.length - head);
+            return true;
+        }
+        case WalRecordType::SLOT_INSERT: {
+            uint16_t slot = 0;
+            if (page.GetSlotCount() != h.slot || h.length > 0xFFFF) return false;
+            return AppendRow(&page, payload, static_cast<uint16_t>(h.length), &slot) && slot == h.slot;
+        }
+        case WalRecordType::SLOT_DELETE:
+            return DeleteRow(&page, h.slot);
+        case WalRecordType::PAGE_HEADER: {
+            if (h.length != sizeof(PageHeader)) return false;
+            PageHeader src{};
+            std::memcpy(&src, payload, sizeof(src));
+            PageHeader* hdr = page.GetHeader();
+            hdr->slot_count = src.slot_count;
+            hdr->free_space_offset = src.free_space_offset;
+            hdr->next_page_id = src.next_page_id;
+            hdr->page_type = src.page_type;
+            return true;
+        }
+        case WalRecordType::BTREE_INSERT:
+        case WalRecordType::BTREE_REMOVE: {
+            ArrayEntryLog a{};
+            if (h.length < sizeof(a)) return false;
+            std::memcpy(&a, payload, sizeof(a));
+            if (a.count_offset + sizeof(uint16_t) > page.GetPageSize()) return false;
+            if (static_cast<WalRecordType>(h.type) == WalRecordType::BTREE_REMOVE)
+                return RemoveArrayEntry(&page, a.count_offset, a.array_offset, a.entry_size, h.slot);
+            if (h.length != sizeof(a) + a.entry_size) return false;
+            return InsertArrayEntry(&page, a.count_offset, a.array_offset, a.entry_size, h.slot, payload + sizeof(a));
+        }
+        case WalRecordType::CHECKPOINT_BEGIN:
+        case WalRecordType::CHECKPOINT_END:
+        case WalRecordType::SEGMENT_SWITCH:
+            return false; // 不是页记录
+        }
+        return false;
+    }
+} // namespace
+
+WalManager::WalManager(const std::string& wal_file) : wal_file_(wal_file) {
+    const RuntimeConfig& cfg = GetRuntimeConfig();
+    buffer_limit_ = std::max<size_t>(cfg.wal_buffer_bytes, sizeof(WalRecordHeader) + MAX_PAGE_SIZE);
+    group_commit_us_ = cfg.wal_group_commit_us;
+    spare_segments_ = cfg.wal_spare_segments;
+    buffer_.reserve(buffer_limit_);
+    if (!OpenLog()) {
+        global_log_error(std::string("[WalManager] 无法打开 WAL: ") + wal_file_);
+#ifdef MINIDB_POSIX_IO
+        if (write_fd_ >= 0) ::close(write_fd_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+        write_fd_ = fd_ = -1;
+        return;
+    }
+    flusher_ = std::thread([this]() { FlusherLoop(); });
+    segment_thread_ = std::thread([this]() { SegmentLoop(); });
+}
+
+WalManager::~WalManager() {
+    {
+        std::lock_guard<std::mutex> g(mtx_);
+        stop_ = true;
+    }
+    flush_cv_.notify_all();
+    if (flusher_.joinable()) flusher_.join();
+    {
+        std::lock_guard<std::mutex> g(seg_mtx_);
+        seg_stop_ = true;
+    }
+    seg_cv_.notify_all();
+    if (segment_thread_.joinable()) segment_thread_.join();
+#ifdef MINIDB_POSIX_IO
+    if (write_fd_ >= 0) ::close(write_fd_);
+    if (fd_ >= 0) ::close(fd_);
+#endif
+    write_fd_ = -1;
+    fd_ = -1;
+}
+
+std::string WalManager::SegmentFile(uint64_t segno) const { return SegmentPath(wal_file_, segno); }
+
+std::string WalManager::GetSegmentPath(lsn_t lsn) const {
+    return seg_bytes_ == 0 || lsn == INVALID_LSN ? std::string() : SegmentFile(SegmentOf(lsn, seg_bytes_));
+}
+
+bool WalManager::OpenLog() {
+#ifdef MINIDB_POSIX_IO
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (fs::is_regular_file(wal_file_, ec)) {
+        // 旧版单文件日志：挪开，不再重放
+        global_log_warn(std::string("[WalManager] 旧格式 WAL 文件已改名为 .old: ") + wal_file_);
+        fs::rename(wal_file_, wal_file_ + ".old", ec);
+    }
+    fs::create_directories(wal_file_, ec);
+    for (const auto& e : fs::directory_iterator(wal_file_, ec))
+        if (e.path().extension() == ".tmp" || e.path().extension() == ".prep") fs::remove(e.path(), ec);
+
+    const std::string control = wal_file_ + "/" + WAL_CONTROL_FILE;
+    fd_ = ::open(control.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) return false;
+    WalControl wc{};
+    struct stat st {};
+    const bool valid = ::fstat(fd_, &st) == 0 && static_cast<uint64_t>(st.st_size) >= sizeof(wc) &&
+                       PReadAll(fd_, reinterpret_cast<char*>(&wc), sizeof(wc), 0) && wc.magic == WAL_FILE_MAGIC &&
+                       wc.start_lsn != INVALID_LSN && wc.segment_bytes >= WAL_MIN_SEGMENT_BYTES;
+    if (!valid) {
+        // 新日志：段文件里的旧记录可能与新的 LSN 重合，全部删除
+        const std::vector<uint64_t> stale = ListSegments(wal_file_);
+        if (st.st_size > 0 || !stale.empty())
+            global_log_warn(std::string("[WalManager] WAL 控制文件无效，重新初始化: ") + wal_file_);
+        for (uint64_t segno : stale) ::unlink(SegmentFile(segno).c_str());
+        const size_t want = std::max(GetRuntimeConfig().wal_segment_bytes, WAL_MIN_SEGMENT_BYTES);
+        seg_bytes_ = (want + 4095) / 4096 * 4096;
+        if (!WriteControl(1, INVALID_LSN) || !SyncDir(wal_file_)) return false;
+        start_lsn_ = 1;
+        next_lsn_ = 1;
+    } else {
+        seg_bytes_ = static_cast<size_t>(wc.segment_bytes);
+        start_lsn_ = wc.start_lsn;
+        synced_checkpoint_ = wc.synced_checkpoint;
+        next_lsn_ = ScanRecords(wal_file_, seg_bytes_, start_lsn_, std::numeric_limits<lsn_t>::max(),
+                                [](const WalRecordHeader&, const char*) {});
+        // 末尾之后可能还留着崩溃前最后一批里落了盘的记录（其前面的记录撕裂了），它们的 LSN 正好接得上，
+        // 新记录写在前面后会被当成有效记录：清掉最后一批可能覆盖的范围
+        const lsn_t clear_end = next_lsn_ + buffer_limit_ + 2 * (sizeof(WalRecordHeader) + MAX_PAGE_SIZE);
+        std::vector<char> chunk(1 << 20), zeros(chunk.size(), 0);
+        size_t cleared = 0;
+        for (lsn_t lsn = next_lsn_; lsn < clear_end;) {
+            const uint64_t segno = SegmentOf(lsn, seg_bytes_);
+            const uint64_t off = SegmentOffset(lsn, seg_bytes_);
+            const size_t n = static_cast<size_t>(
+                std::min<uint64_t>({chunk.size(), seg_bytes_ - off, clear_end - lsn}));
+            int sfd = ::open(SegmentFile(segno).c_str(), O_RDWR);
+            if (sfd >= 0) {
+                if (PReadAll(sfd, chunk.data(), n, off) && std::memcmp(chunk.data(), zeros.data(), n) != 0) {
+                    if (!PWriteAll(sfd, zeros.data(), n, off) || ::fdatasync(sfd) != 0) {
+                        ::close(sfd);
+                        return false;
+                    }
+                    cleared += n;
+                }
+                ::close(sfd);
+            }
+            lsn += n;
+        }
+        if (cleared > 0)
+            global_log_info("[WalManager] 清零 WAL 末尾之后的 " + std::to_string(cleared) + " 字节");
+    }
+    durable_lsn_ = next_lsn_;
+    checkpoint_lsn_ = start_lsn_;
+    // 写位置所在的段在打开时备好，之后的段由后台线程提前准备
+    write_seg_ = SegmentOf(next_lsn_, seg_bytes_);
+    write_fd_ = OpenSegment(write_seg_);
+    return write_fd_ >= 0;
+#else
+    global_log_warn("[WalManager] 当前平台不支持 WAL");
+    return false;
+#endif
+}
+
+bool WalManager::WriteControl(lsn_t start_lsn, lsn_t synced_checkpoint) {
+#ifdef MINIDB_POSIX_IO
+    // 32 字节在一个扇区内原地改写
+    WalControl wc{};
+    wc.magic = WAL_FILE_MAGIC;
+    wc.start_lsn = start_lsn;
+    wc.synced_checkpoint = synced_checkpoint;
+    wc.segment_bytes = seg_bytes_;
+    return PWriteAll(fd_, reinterpret_cast<const char*>(&wc), sizeof(wc), 0) && ::fdatasync(fd_) == 0;
+#else
+    (void)start_lsn;
+    (void)synced_checkpoint;
+    return false;
+#endif
+}
+
+lsn_t WalManager::Append(page_id_t page_id, const char* page_data) {
+    return AppendRecord(WalRecordType::FULL_PAGE, page_id, 0, page_data, static_cast<uint32_t>(page_size_), nullptr,
+                        INVALID_LSN, nullptr);
+}
+
+lsn_t WalManager::LogPageChange(page_id_t page_id, const char* page_after, lsn_t image_lsn, WalRecordType type,
+                                uint16_t slot, const void* payload, uint32_t len, bool* full_image) {
+    return AppendRecord(type, page_id, slot, payload, len, page_after, image_lsn, full_image);
+}
+
+lsn_t WalManager::AppendRecord(WalRecordType type, page_id_t page_id, uint16_t slot, const void* payload,
+                               uint32_t len, const char* page_after, lsn_t image_lsn, bool* full_image) {
+    if (fd_ < 0) return INVALID_LSN;
+    lsn_t checkpoint = GetCheckpointLsn();
+    for (;;) {
+        WalRecordHeader h{};
+        h.magic = WAL_RECORD_MAGIC;
+        h.type = static_cast<uint16_t>(type);
+        h.slot = slot;
+        h.page_id = static_cast<uint32_t>(page_id);
+        h.length = len;
+        const char* data = static_cast<const char*>(payload);
+        // 检查点开始之后首次修改的页记整页镜像：重做起点之后总有一张镜像，数据文件里的页写坏了也能恢复
+        const bool as_image = page_after != nullptr && image_lsn < checkpoint;
+        if (as_image) {
+            h.type = static_cast<uint16_t>(WalRecordType::FULL_PAGE);
+            h.length = static_cast<uint32_t>(page_size_);
+            data = page_after;
+        }
+        // 整页镜像分两段存放：空闲区之前与之后
+        size_t head = h.length;
+        if (h.type == static_cast<uint16_t>(WalRecordType::FULL_PAGE)) {
+            uint16_t hole_off = 0;
+            h.hole = FindPageHole(data, page_size_, &hole_off);
+            h.slot = h.hole > 0 ? hole_off : static_cast<uint16_t>(0);
+            h.length = static_cast<uint32_t>(page_size_ - h.hole);
+            head = h.hole > 0 ? hole_off : h.length;
+        }
+        const char* tail = data + head + h.hole;
+        const uint32_t payload_crc = checksum::Mix(checksum::Mix(0, data, head), tail, h.length - head);
+        const size_t rec = sizeof(h) + h.length;
+
+        std::unique_lock<std::mutex> lk(mtx_);
+        // 校验和在锁外算好后检查点又开始了一次：按新的检查点重新决定是否记整页
+        if (page_after != nullptr && !as_image && image_lsn < checkpoint_lsn_) {
+            checkpoint = checkpoint_lsn_;
+            continue;
+        }
+        // 缓冲区放不下：请组提交线程取走当前内容后再追加
+        size_t pad = PaddingBefore(next_lsn_, rec, seg_bytes_);
+        while (!buffer_.empty() && buffer_.size() + pad + rec > buffer_limit_ && !io_error_) {
+            flush_request_ = std::max(flush_request_, next_lsn_);
+            flush_cv_.notify_one();
+            durable_cv_.wait(lk);
+            pad = PaddingBefore(next_lsn_, rec, seg_bytes_);
+        }
+        if (io_error_ || stop_) return INVALID_LSN;
+        if (pad > 0) AppendPaddingLocked(pad);
+        h.lsn = next_lsn_;
+        next_lsn_ += rec;
+        h.checksum = FinishChecksum(payload_crc, h);
+        const char* hp = reinterpret_cast<const char*>(&h);
+        buffer_.insert(buffer_.end(), hp, hp + sizeof(h));
+        buffer_.insert(buffer_.end(), data, data + head);
+        buffer_.insert(buffer_.end(), tail, tail + (h.length - head));
+        append_count_.fetch_add(1);
+        appended_bytes_.fetch_add(rec);
+        if (h.type == static_cast<uint16_t>(WalRecordType::FULL_PAGE)) full_page_images_.fetch_add(1);
+        if (full_image) *full_image = as_image;
+        return h.lsn;
+    }
+}
+
+void WalManager::AppendPaddingLocked(size_t pad) {
+    // 放得下记录头时写一条全零负载的填充记录，否则留下不足一个记录头的空隙（扫描时按段尾跳过）
+    const size_t at = buffer_.size();
+    buffer_.resize(at + pad, 0);
+    if (pad >= sizeof(WalRecordHeader)) {
+        WalRecordHeader f{};
+        f.magic = WAL_RECORD_MAGIC;
+        f.type = static_cast<uint16_t>(WalRecordType::SEGMENT_SWITCH);
+        f.length = static_cast<uint32_t>(pad - sizeof(f));
+        f.lsn = next_lsn_;
+        f.checksum = FinishChecksum(checksum::Mix(0, buffer_.data() + at + sizeof(f), f.length), f);
+        std::memcpy(buffer_.data() + at, &f, sizeof(f));
+    }
+    next_lsn_ += pad;
+}
+
+bool WalManager::WaitDurable(lsn_t lsn) {
+    if (lsn == INVALID_LSN) return false;
+    std::unique_lock<std::mutex> lk(mtx_);
+    if (durable_lsn_ > lsn) return true;
+    flush_request_ = std::max(flush_request_, lsn + 1);
+    flush_cv_.notify_one();
+    durable_cv_.wait(lk, [&]() { return durable_lsn_ > lsn || io_error_; });
+    return durable_lsn_ > lsn;
+}
+
+bool WalManager::Commit() {
+    lsn_t last = INVALID_LSN;
+    {
+        std::lock_guard<std::mutex> g(mtx_);
+        if (fd_ < 0 || io_error_) return false;
+        if (next_lsn_ == durable_lsn_) return true;
+        last = next_lsn_ - 1;
+    }
+    return WaitDurable(last);
+}
+
+void WalManager::FlusherLoop() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    std::vector<char> batch;
+    batch.reserve(buffer_limit_);
+    for (;;) {
+        flush_cv_.wait(lk, [&]() { return stop_ || (flush_request_ > durable_lsn_ && !buffer_.empty()); });
+        if (buffer_.empty()) {
+            if (stop_) break;
+            continue;
+        }
+        if (group_commit_us_ > 0 && !stop_) {
+            // 攒批：在截止时间前加入的提交者共享这一次 fdatasync
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(group_commit_us_);
+            while (!stop_ && buffer_.size() < buffer_limit_ &&
+                   flush_cv_.wait_until(lk, deadline) != std::cv_status::timeout) {
+            }
+        }
+        batch.swap(buffer_);
+        const lsn_t from = durable_lsn_;
+        const lsn_t upto = next_lsn_;
+        flushing_ = true;
+        lk.unlock();
+        durable_cv_.notify_all(); // 等待缓冲区空间的追加者可以继续
+        const bool ok = WriteBatch(from, batch);
+        lk.lock();
+        flushing_ = false;
+        if (ok) {
+            durable_lsn_ = upto;
+            sync_count_.fetch_add(1);
+        } else {
+            io_error_ = true;
+            global_log_error(std::string("[WalManager] WAL 写出或同步失败: ") + wal_file_);
+        }
+        batch.clear();
+        durable_cv_.notify_all();
+    }
+}
+
+bool WalManager::WriteBatch(lsn_t from, const std::vector<char>& batch) {
+#ifdef MINIDB_POSIX_IO
+    size_t done = 0;
+    while (done < batch.size()) {
+        const lsn_t lsn = from + done;
+        const uint64_t segno = SegmentOf(lsn, seg_bytes_);
+        const uint64_t off = SegmentOffset(lsn, seg_bytes_);
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(batch.size() - done, seg_bytes_ - off));
+        if (write_fd_ < 0 || segno != write_seg_) {
+            // 换段：上一段的内容先落盘
+            if (write_fd_ >= 0) {
+                const bool synced = ::fdatasync(write_fd_) == 0;
+                ::close(write_fd_);
+                write_fd_ = -1;
+                if (!synced) return false;
+            }
+            write_fd_ = OpenSegment(segno);
+            write_seg_ = segno;
+            if (write_fd_ < 0) return false;
+            WakeSegmentThread(); // 补上后面的备用段
+        }
+        if (!PWriteAll(write_fd_, batch.data() + done, n, off)) return false;
+        done += n;
+    }
+    return write_fd_ >= 0 && ::fdatasync(write_fd_) == 0;
+#else
+    (void)from;
+    (void)batch;
+    return false;
+#endif
+}
+
+int WalManager::OpenSegment(uint64_t segno) {
+#ifdef MINIDB_POSIX_IO
+    const std::string path = SegmentFile(segno);
+    // 在 file_mtx_ 下打开：段改名或新建后的目录同步完成之前不会写入它
+    std::lock_guard<std::mutex> fg(file_mtx_);
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd >= 0 || errno != ENOENT) return fd;
+    // 新日志的第一段，或后台线程还没准备好这一段（日志写得比准备快）：当场创建
+    if (!CreateSegment(segno, ".tmp") || ::rename((path + ".tmp").c_str(), path.c_str()) != 0 ||
+        !SyncDir(wal_file_))
+        return -1;
+    return ::open(path.c_str(), O_RDWR);
+#else
+    (void)segno;
+    return -1;
+#endif
+}
+
+bool WalManager::CreateSegment(uint64_t segno, const char* suffix) {
+#ifdef MINIDB_POSIX_IO
+    const std::string tmp = SegmentFile(segno) + suffix;
+    int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = true;
+#ifdef __linux__
+    // 先分配块，再写零：之后写日志时既不分配块，也不必在 fdatasync 时提交未写区段的元数据
+    if (::fallocate(fd, 0, 0, static_cast<off_t>(seg_bytes_)) != 0 && errno != EOPNOTSUPP && errno != ENOSYS)
+        ok = false;
+#endif
+    std::vector<char> zeros(std::min<size_t>(seg_bytes_, 1 << 20), 0);
+    for (size_t off = 0; ok && off < seg_bytes_; off += zeros.size())
+        ok = PWriteAll(fd, zeros.data(), std::min(zeros.size(), seg_bytes_ - off), off);
+    ok = ok && ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        ::unlink(tmp.c_str());
+        global_log_warn("[WalManager] 创建 WAL 段失败: " + tmp);
+        return false;
+    }
+    created_segments_.fetch_add(1);
+    return true;
+#else
+    (void)segno;
+    (void)suffix;
+    return false;
+#endif
+}
+
+void WalManager::WakeSegmentThread() {
+    {
+        std::lock_guard<std::mutex> g(seg_mtx_);
+        seg_wake_ = true;
+    }
+    seg_cv_.notify_one();
+}
+
+void WalManager::SegmentLoop() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(seg_mtx_);
+            seg_cv_.wait(lk, [&]() { return seg_stop_ || seg_wake_; });
+            if (seg_stop_) return;
+            seg_wake_ = false;
+        }
+        MaintainSegments();
+    }
+}
+
+void WalManager::MaintainSegments() {
+#ifdef MINIDB_POSIX_IO
+    uint64_t keep_from = 0, write_seg = 0;
+    {
+        std::lock_guard<std::mutex> g(mtx_);
+        keep_from = SegmentOf(start_lsn_, seg_bytes_);
+        write_seg = SegmentOf(next_lsn_, seg_bytes_);
+    }
+    const uint64_t last = write_seg + spare_segments_;
+    std::set<uint64_t> missing;
+    {
+        // 起点之前的段不再被读写：改名为写位置之后缺的段，多出来的删除
+        std::lock_guard<std::mutex> fg(file_mtx_);
+        std::vector<uint64_t> obsolete;
+        std::set<uint64_t> have;
+        for (uint64_t segno : ListSegments(wal_file_)) {
+            if (segno < keep_from)
+                obsolete.push_back(segno);
+            else
+                have.insert(segno);
+        }
+        size_t reuse = 0;
+        for (uint64_t t = write_seg; t <= last; ++t) {
+            if (have.count(t)) continue;
+            if (reuse < obsolete.size() &&
+                ::rename(SegmentFile(obsolete[reuse]).c_str(), SegmentFile(t).c_str()) == 0) {
+                ++reuse;
+                recycled_segments_.fetch_add(1);
+                continue;
+            }
+            missing.insert(t);
+        }
+        for (size_t i = reuse; i < obsolete.size(); ++i) ::unlink(SegmentFile(obsolete[i]).c_str());
+        if (!obsolete.empty()) SyncDir(wal_file_);
+    }
+    // 新段在锁外写零，完成后再改名就位
+    for (uint64_t t : missing) {
+        if (!CreateSegment(t, ".prep")) break;
+        std::lock_guard<std::mutex> fg(file_mtx_);
+        const std::string path = SegmentFile(t);
+        if (::access(path.c_str(), F_OK) == 0 || ::rename((path + ".prep").c_str(), path.c_str()) != 0)
+            ::unlink((path + ".prep").c_str());
+        SyncDir(wal_file_);
+    }
+#endif
+}
+
+void WalManager::DrainLocked(std::unique_lock<std::mutex>& lk) {
+    flush_request_ = std::max(flush_request_, next_lsn_);
+    flush_cv_.notify_one();
+    durable_cv_.wait(lk, [&]() { return (buffer_.empty() && !flushing_) || io_error_; });
 }
 
 bool WalManager::Recover(DiskManager& dm) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    if (fd_ < 0) return true; // no wal, ok
+    DrainLocked(lk);
+    bool ok = !io_error_;
+    size_t applied = 0, skipped = 0;
+#ifdef MINIDB_POSIX_IO
+    const auto t0 = std::chrono::steady_clock::now();
+    // 分析：顺序校验整份日志，要重做的记录连同负载收进内存；
+    // 数据文件已随之落盘的检查点，其脏页表说明哪些更早的记录已经在页上
+    struct RedoRef {
+        WalRecordHeader h;
+        size_t payload; // 在 arena 中的偏移
+    };
+    std::vector<RedoRef> refs;
+    std::vector<char> arena;
+    std::unordered_map<page_id_t, lsn_t> dpt;
+    lsn_t dpt_begin = INVALID_LSN;
+    ScanRecords(wal_file_, seg_bytes_, start_lsn_, durable_lsn_, [&](const WalRecordHeader& h, const char* payload) {
+        if (h.type == static_cast<uint16_t>(WalRecordType::CHECKPOINT_BEGIN)) return;
+        if (h.type == static_cast<uint16_t>(WalRecordType::CHECKPOINT_END)) {
+            CheckpointEndLog end{};
+            if (h.length < sizeof(end)) return;
+            std::memcpy(&end, payload, sizeof(end));
+            if (synced_checkpoint_ == INVALID_LSN || end.begin_lsn != synced_checkpoint_ || !end.complete ||
+                h.length != sizeof(end) + static_cast<size_t>(end.count) * sizeof(DirtyPageEntry))
+                return;
+            dpt.clear();
+            for (uint32_t i = 0; i < end.count; ++i) {
+                DirtyPageEntry e{};
+                std::memcpy(&e, payload + sizeof(end) + i * sizeof(e), sizeof(e));
+                dpt[static_cast<page_id_t>(e.page_id)] = e.rec_lsn;
+            }
+            dpt_begin = end.begin_lsn;
+            return;
+        }
+        refs.push_back(RedoRef{h, arena.size()});
+        arena.insert(arena.end(), payload, payload + h.length);
+    });
+    const size_t analyzed = refs.size();
+    if (dpt_begin != INVALID_LSN) {
+        // 检查点开始之前的记录：页不在脏页表里，或早于该页的 recLSN，都已随检查点落盘
+        auto done = [&](const RedoRef& r) {
+            if (r.h.lsn >= dpt_begin) return false;
+            auto it = dpt.find(static_cast<page_id_t>(r.h.page_id));
+            return it == dpt.end() || r.h.lsn < it->second;
+        };
+        refs.erase(std::remove_if(refs.begin(), refs.end(), done), refs.end());
+    }
+    skipped = analyzed - refs.size();
+
+    // 重做：按页号散列分给多个线程，同一页的记录在同一线程内按 LSN 顺序重放；
+    // 每个线程按页号顺序成批读入、重放，再把改过的相邻页合并成一次写回
+    const RuntimeConfig& cfg = GetRuntimeConfig();
+    size_t threads = cfg.wal_recovery_threads;
+    if (threads == 0) threads = std::min<size_t>(8, std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::max<size_t>(1, std::min(threads, refs.size() / 64 + 1));
+    std::vector<std::vector<size_t>> parts(threads);
+    for (size_t i = 0; i < refs.size(); ++i)
+        parts[RedoPartition(static_cast<page_id_t>(refs[i].h.page_id), threads)].push_back(i);
+
+    const size_t page_size = dm.GetPageSize();
+    const page_id_t file_pages = static_cast<page_id_t>(dm.GetNumPages());
+    std::atomic<size_t> applied_n{0}, stale_n{0}, mismatched_n{0}, written_n{0};
+    std::atomic<bool> ok_all{ok};
+    auto redo = [&](const std::vector<size_t>& mine) {
+        std::map<page_id_t, std::vector<size_t>> by_page;
+        for (size_t i : mine) by_page[static_cast<page_id_t>(refs[i].h.page_id)].push_back(i);
+        FrameBuffer frames = AllocateFrames(RECOVERY_BATCH_PAGES, page_size);
+        std::vector<page_id_t> ids;
+        std::vector<const std::vector<size_t>*> recs;
+        std::vector<char*> bufs;
+        std::vector<bool> dirty;
+        auto flush_batch = [&]() {
+            const size_t n = ids.size();
+            bufs.resize(n);
+            for (size_t k = 0; k < n; ++k) bufs[k] = frames.get() + k * page_size;
+            // 数据文件末尾之后的页按全零处理，由整页镜像建立；读失败的页同样从全零开始
+            ForEachRun(ids, [&](size_t k) { return ids[k] < file_pages; }, [&](size_t first, size_t len) {
+                if (dm.ReadPages(ids[first], bufs.data() + first, len) == Status::OK) return;
+                for (size_t k = first; k < first + len; ++k)
+                    if (dm.ReadPage(ids[k], bufs[k]) != Status::OK) std::memset(bufs[k], 0, page_size);
+            });
+            dirty.assign(n, false);
+            for (size_t k = 0; k < n; ++k) {
+                Page page(bufs[k], page_size);
+                // 整页镜像不看页 LSN 总是重放：页头已是新 LSN、其余扇区没写完的页靠它复原；
+                // 最后一张镜像之前的记录都被它覆盖，不必重放
+                const std::vector<size_t>& list = *recs[k];
+                size_t from = list.size();
+                while (from > 0 && refs[list[from - 1]].h.type != static_cast<uint16_t>(WalRecordType::FULL_PAGE)) --from;
+                from = from > 0 ? from - 1 : 0;
+                stale_n.fetch_add(from);
+                for (size_t j = from; j < list.size(); ++j) {
+                    const RedoRef& r = refs[list[j]];
+                    if (r.h.type != static_cast<uint16_t>(WalRecordType::FULL_PAGE) && r.h.lsn <= page.GetPageLsn()) {
+                        stale_n.fetch_add(1);
+                        continue;
+                    }
+                    if (!RedoRecord(r.h, arena.data() + r.payload, page)) {
+                        mismatched_n.fetch_add(1);
+                        continue;
+                    }
+                    page.SetPageLsn(r.h.lsn);
+                    dirty[k] = true;
+                    applied_n.fetch_add(1);
+                }
+            }
+            ForEachRun(ids, [&](size_t k) { return dirty[k]; }, [&](size_t first, size_t len) {
+                std::vector<const char*> out(bufs.begin() + first, bufs.begin() + first + len);
+                if (dm.WritePages(ids[first], out.data(), len) != Status::OK)
+                    ok_all.store(false);
+                else
+                    written_n.fetch_add(len);
+            });
+            std::memset(frames.get(), 0, RECOVERY_BATCH_PAGES * page_size);
+            ids.clear();
+            recs.clear();
+        };
+        for (auto& [pid, list] : by_page) {
+            ids.push_back(pid);
+            recs.push_back(&list);
+            if (ids.size() == RECOVERY_BATCH_PAGES) flush_batch();
+        }
+        if (!ids.empty()) flush_batch();
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) workers.emplace_back(redo, std::cref(parts[t]));
+    redo(parts[0]);
+    for (auto& w : workers) w.join();
+
+    applied = applied_n.load();
+    skipped += stale_n.load();
+    ok = ok_all.load();
+    const double secs =
+        std::max(1e-6, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    const double log_mb = static_cast<double>(durable_lsn_ - start_lsn_) / (1024.0 * 1024.0);
+    if (analyzed > 0)
+        global_log_info("[WalManager] 恢复：日志 " + std::to_string(log_mb) + " MB，" + std::to_string(analyzed) +
+                        " 条记录，重放 " + std::to_string(applied) + " 条，已生效跳过 " + std::to_string(skipped) +
+                        " 条，与页内容不符 " + std::to_string(mismatched_n.load()) + " 条；写回 " +
+                        std::to_string(written_n.load()) + " 页，" + std::to_string(threads) + " 个线程，用时 " +
+                        std::to_string(static_cast<long long>(secs * 1000)) + " ms（" +
+                        std::to_string(static_cast<long long>(analyzed / secs)) + " 条/秒，" +
+                        std::to_string(log_mb / secs) + " MB/秒）");
+#endif
+    recovered_records_.store(applied);
+    skipped_records_.store(skipped);
+    return ok;
+}
+
+bool WalManager::Truncate() { return TruncateTo(std::numeric_limits<lsn_t>::max()); }
+
+lsn_t WalManager::BeginCheckpoint() {
+    lsn_t lsn = AppendRecord(WalRecordType::CHECKPOINT_BEGIN, INVALID_PAGE_ID, 0, nullptr, 0, nullptr, INVALID_LSN,
+                             nullptr);
+    if (lsn == INVALID_LSN) return INVALID_LSN;
     std::lock_guard<std::mutex> g(mtx_);
-    std::ifstream ifs(wal_file_, std::ios::binary);
-    if (!ifs.is_open()) return true; // no wal, ok
-    while (true) {
-        WalRecordHeader hdr{};
-        ifs.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
-        if (!ifs) break;
-        if (hdr.magic != WAL_MAGIC || hdr.length != PAGE_SIZE) {
-            break;
-        }
-        std::vector<char> buf(PAGE_SIZE);
-        ifs.read(buf.data(), PAGE_SIZE);
-        if (!ifs) break;
-        dm.WritePage(static_cast<page_id_t>(hdr.page_id), buf.data());
+    checkpoint_lsn_ = std::max(checkpoint_lsn_, lsn);
+    return lsn;
+}
+
+bool WalManager::EndCheckpoint(lsn_t begin_lsn, const std::vector<DirtyPageEntry>& dirty_pages) {
+    // 记录负载受单条记录长度限制；放不下的脏页表截断并标记为不完整
+    const size_t max_entries = (MAX_PAGE_SIZE - sizeof(CheckpointEndLog)) / sizeof(DirtyPageEntry);
+    const size_t n = std::min(dirty_pages.size(), max_entries);
+    CheckpointEndLog end{begin_lsn, static_cast<uint32_t>(n), n == dirty_pages.size() ? 1u : 0u};
+    std::vector<char> payload(sizeof(end) + n * sizeof(DirtyPageEntry));
+    std::memcpy(payload.data(), &end, sizeof(end));
+    if (n > 0) std::memcpy(payload.data() + sizeof(end), dirty_pages.data(), n * sizeof(DirtyPageEntry));
+    lsn_t lsn = AppendRecord(WalRecordType::CHECKPOINT_END, INVALID_PAGE_ID, 0, payload.data(),
+                             static_cast<uint32_t>(payload.size()), nullptr, INVALID_LSN, nullptr);
+    return lsn != INVALID_LSN && WaitDurable(lsn);
+}
+
+bool WalManager::TruncateTo(lsn_t lsn, lsn_t synced_checkpoint) {
+    lsn_t durable = INVALID_LSN;
+    {
+        std::lock_guard<std::mutex> g(mtx_);
+        if (fd_ < 0 || io_error_) return false;
+        lsn = std::min(lsn, next_lsn_);
+        // 全部截断：从这里起修改的页先记整页镜像，它们之前的镜像都在被丢弃的部分里
+        if (lsn == next_lsn_) checkpoint_lsn_ = std::max(checkpoint_lsn_, lsn);
+        durable = durable_lsn_;
+    }
+    // 新起点之前的记录须已落盘：起点之后的位置在重启时必须读得到。等待期间追加照常进行
+    if (lsn > durable && !WaitDurable(lsn - 1)) return false;
+#ifdef MINIDB_POSIX_IO
+    if (lsn < durable && seg_bytes_ - SegmentOffset(lsn, seg_bytes_) >= sizeof(WalRecordHeader)) {
+        // 新起点必须是一条记录的开头
+        WalRecordHeader h{};
+        int sfd = ::open(SegmentFile(SegmentOf(lsn, seg_bytes_)).c_str(), O_RDONLY);
+        const bool boundary = sfd >= 0 &&
+                              PReadAll(sfd, reinterpret_cast<char*>(&h), sizeof(h), SegmentOffset(lsn, seg_bytes_)) &&
+                              h.magic == WAL_RECORD_MAGIC && h.lsn == lsn;
+        if (sfd >= 0) ::close(sfd);
+        if (!boundary) {
+            global_log_warn("[WalManager] 截断位置不是记录边界: " + std::to_string(lsn));
+            return false;
+        }
+    }
+    // 只改写控制文件；起点之前的段交给后台线程回收
+    std::lock_guard<std::mutex> cg(control_mtx_);
+    lsn_t start = INVALID_LSN;
+    {
+        std::lock_guard<std::mutex> g(mtx_);
+        start = std::max(lsn, start_lsn_);
+        // 没有可丢弃的记录：只在控制文件里记下数据文件已落盘的检查点
+        if (start == start_lsn_ && (synced_checkpoint == INVALID_LSN || synced_checkpoint == synced_checkpoint_))
+            return true;
     }
+    if (!WriteControl(start, synced_checkpoint)) return false;
+    {
+        std::lock_guard<std::mutex> g(mtx_);
+        start_lsn_ = start;
+        synced_checkpoint_ = synced_checkpoint;
+    }
+    WakeSegmentThread();
     return true;
+#else
+    return false;
+#endif
 }
 
-bool WalManager::Truncate() {
+bool WalManager::AdvanceLsn(lsn_t min_next) {
+    std::lock_guard<std::mutex> cg(control_mtx_);
+    {
+        std::lock_guard<std::mutex> g(mtx_);
+        if (fd_ < 0 || io_error_) return false;
+        if (next_lsn_ >= min_next) return true;
+        if (!buffer_.empty() || flushing_ || next_lsn_ != start_lsn_) return false;
+        if (!WriteControl(min_next, INVALID_LSN)) return false;
+        start_lsn_ = checkpoint_lsn_ = next_lsn_ = durable_lsn_ = min_next;
+        synced_checkpoint_ = INVALID_LSN;
+    }
+    WakeSegmentThread();
+    return true;
+}
+
+lsn_t WalManager::GetCheckpointLsn() const {
+    std::lock_guard<std::mutex> g(mtx_);
+    return checkpoint_lsn_;
+}
+
+lsn_t WalManager::GetStartLsn() const {
     std::lock_guard<std::mutex> g(mtx_);
-    std::ofstream ofs(wal_file_, std::ios::binary | std::ios::trunc);
-    return static_cast<bool>(ofs);
+    return start_lsn_;
 }
 
+lsn_t WalManager::GetNextLsn() const {
+    std::lock_guard<std::mutex> g(mtx_);
+    return next_lsn_;
 }
 
+lsn_t WalManager::GetDurableLsn() const {
+    std::lock_guard<std::mutex> g(mtx_);
+    return durable_lsn_;
+}
 
+}
@@ -1,31 +1,182 @@
 #pragma once
 #include "util/config.h"
 #include <string>
-#include <fstream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdint>
 
 namespace minidb {
 
 class DiskManager; // forward
 
+// 日志序列号：记录在整个日志流中的字节位置，单调递增，截断 WAL 后继续累加
+using lsn_t = uint64_t;
+static constexpr lsn_t INVALID_LSN = 0;
+
+// 记录类型：整页镜像，或页内的逻辑修改（重做时在页的当前内容上重放）
+enum class WalRecordType : uint16_t {
+    FULL_PAGE = 1,    // 整页镜像
+    SLOT_INSERT = 2,  // 追加一条记录到槽 slot，负载为记录内容
+    SLOT_DELETE = 3,  // 删除槽 slot 的记录
+    PAGE_HEADER = 4,  // 页头（槽数、空闲偏移、下一页、页类型），负载为 PageHeader
+    BTREE_INSERT = 5, // 在定长条目数组的第 slot 个位置插入，负载为 ArrayEntryLog + 条目
+    BTREE_REMOVE = 6, // 删除定长条目数组的第 slot 个条目，负载为 ArrayEntryLog
+    CHECKPOINT_BEGIN = 7, // 模糊检查点开始
+    CHECKPOINT_END = 8,   // 模糊检查点结束，负载为 CheckpointEndLog + 脏页表
+    SEGMENT_SWITCH = 9,   // 段尾填充：本段剩余空间放不下下一条记录，负载全零
+};
+
+// 脏页表条目：页号与重做这一页需要的最早 LSN
+struct DirtyPageEntry {
+    uint32_t page_id;
+    uint32_t reserved;
+    uint64_t rec_lsn;
+};
+
+struct CheckpointEndLog {
+    uint64_t begin_lsn;
+    uint32_t count;    // 随后的 DirtyPageEntry 条数
+    uint32_t complete; // 脏页表是否完整（过大时截断，只作参考）
+};
+
+// WAL 目录 = 控制文件（起始 LSN、已落盘的检查点、段大小）+ 定长的段文件（按段号命名）。
+// LSN 直接映射到段号与段内偏移，记录不跨段。段文件由后台线程提前 fallocate 并写零准备好，
+// 截断只改写控制文件；起点之前的整段改名为将来的段号复用，写日志时不再扩展文件。
+// 追加只把记录拷进内存日志缓冲区并分配 LSN；组提交线程把积攒的缓冲区一次写出并 fdatasync，
+// 等待落盘的并发提交者共享这一次同步。
 class WalManager {
 public:
-    explicit WalManager(const std::string& wal_file) : wal_file_(wal_file) {}
+    // 恢复时每个重做线程一批读入、写回的页数
+    static constexpr size_t RECOVERY_BATCH_PAGES = 64;
+
+    explicit WalManager(const std::string& wal_file);
+    // 停止组提交线程；缓冲区中剩余的记录写出并落盘
+    ~WalManager();
+
+    bool IsOpen() const { return fd_ >= 0; }
 
-    // 物理页级别 WAL：写入 (page_id, PAGE_SIZE bytes)
-    bool Append(page_id_t page_id, const char* page_data);
+    // 物理页级别 WAL：追加 (page_id, 一整页)，返回记录的 LSN；WAL 不可用时返回 INVALID_LSN
+    lsn_t Append(page_id_t page_id, const char* page_data);
+    // 页内逻辑记录：page_after 为修改后的整页，image_lsn 为本页上一张整页镜像的 LSN。
+    // 上一张镜像早于最近一次检查点开始（本页在检查点后首次修改）时改记整页镜像并置 *full_image，
+    // 之后的修改只记 (type, slot, payload)
+    lsn_t LogPageChange(page_id_t page_id, const char* page_after, lsn_t image_lsn, WalRecordType type,
+                        uint16_t slot, const void* payload, uint32_t len, bool* full_image);
+    // 记录中的页长度，由 DiskManager::AttachWAL 设为数据库的页大小
+    void SetPageSize(size_t page_size) { page_size_ = page_size; }
 
-    // 恢复：顺序重放 WAL 到数据文件
+    // 等待 LSN 为 lsn 的记录（及之前的全部记录）落盘；写出或同步失败时返回 false
+    bool WaitDurable(lsn_t lsn);
+    // 提交：等待目前为止追加的全部记录落盘
+    bool Commit();
+
+    // 恢复：须在 AttachWAL 之前调用（重放的页不再写日志）。先顺序分析整份日志，再按页号散列分给
+    // wal_recovery_threads 个线程重做，各线程成批读页、合并相邻页写回；记录 LSN 不大于页 LSN 的
+    // 记录已经生效，跳过，因此重复恢复是幂等的
     bool Recover(DiskManager& dm);
 
-    // 截断 WAL（checkpoint 之后）
+    // 截断 WAL（checkpoint 之后）：等目前为止的记录落盘，把起点移到下一个 LSN，LSN 继续累加
     bool Truncate();
+    // 日志为空时把下一个 LSN 推进到至少 min_next（日志文件重建后接着数据文件里已有的页 LSN 编号）
+    bool AdvanceLsn(lsn_t min_next);
+
+    // 模糊检查点：开始标记之后修改的页都会先记一张整页镜像；结束标记带上脏页表并等待落盘
+    lsn_t BeginCheckpoint();
+    bool EndCheckpoint(lsn_t begin_lsn, const std::vector<DirtyPageEntry>& dirty_pages);
+    // 丢弃 LSN 小于 lsn 的记录（lsn 须是记录边界，如检查点开始标记或脏页的 recLSN）：只改写控制文件，
+    // 整段落在新起点之前的段由后台线程回收，不阻塞追加。lsn 不小于下一个 LSN 时等同 Truncate。
+    // synced_checkpoint 为数据文件已随之落盘的检查点开始 LSN，记入控制文件供恢复时使用其脏页表
+    bool TruncateTo(lsn_t lsn, lsn_t synced_checkpoint = INVALID_LSN);
+
+    // 统计：下一个要分配的 LSN、已落盘到的 LSN（之前的记录都已落盘）、fdatasync 次数、追加的记录数、上次恢复重放的记录数
+    lsn_t GetNextLsn() const;
+    // 最近一次检查点开始的位置：上一张整页镜像早于它的页下次修改时记整页镜像
+    lsn_t GetCheckpointLsn() const;
+    // 文件中第一条记录的 LSN（截断到的位置）
+    lsn_t GetStartLsn() const;
+    lsn_t GetDurableLsn() const;
+    size_t GetSyncCount() const { return sync_count_.load(); }
+    size_t GetAppendCount() const { return append_count_.load(); }
+    size_t GetRecoveredRecords() const { return recovered_records_.load(); }
+    // 上次恢复中因已生效（检查点脏页表或页 LSN）而跳过的记录数
+    size_t GetSkippedRecords() const { return skipped_records_.load(); }
+    // 追加的日志字节数（含记录头）与其中整页镜像的条数
+    size_t GetAppendedBytes() const { return appended_bytes_.load(); }
+    size_t GetFullPageImages() const { return full_page_images_.load(); }
+    // 段大小、lsn 所在段文件的路径；提前新建（写零）与改名复用的段数
+    size_t GetSegmentBytes() const { return seg_bytes_; }
+    std::string GetSegmentPath(lsn_t lsn) const;
+    size_t GetCreatedSegments() const { return created_segments_.load(); }
+    size_t GetRecycledSegments() const { return recycled_segments_.load(); }
 
 private:
-    std::string wal_file_;
-    std::mutex mtx_;
-};
+    // 打开时读控制文件并扫描出有效记录的末尾，末尾之后可能残留的上一批记录清零
+    bool OpenLog();
+    bool WriteControl(lsn_t start_lsn, lsn_t synced_checkpoint);
+    std::string SegmentFile(uint64_t segno) const;
+    // 组提交线程写 [from, from + batch) 并落盘，跨段时分段写
+    bool WriteBatch(lsn_t from, const std::vector<char>& batch);
+    // 打开段文件写；还没准备好时当场创建
+    int OpenSegment(uint64_t segno);
+    // 新建一个 fallocate 并写零的段文件（先写临时文件，完成后改名）
+    bool CreateSegment(uint64_t segno, const char* suffix);
+    // 后台线程：回收起点之前的段，保证写位置之后有 spare_segments_ 个段可用
+    void SegmentLoop();
+    void MaintainSegments();
+    void WakeSegmentThread();
+    // 在 mtx_ 下把 next_lsn_ 补到下一段开头
+    void AppendPaddingLocked(size_t pad);
+    // page_after 非空时为逻辑记录：image_lsn 早于 checkpoint_lsn_ 则改记 page_after 的整页镜像
+    lsn_t AppendRecord(WalRecordType type, page_id_t page_id, uint16_t slot, const void* payload, uint32_t len,
+                       const char* page_after, lsn_t image_lsn, bool* full_image);
+    void FlusherLoop();
+    // 在 mtx_ 下等到缓冲区清空、没有进行中的写出
+    void DrainLocked(std::unique_lock<std::mutex>& lk);
 
-}
+    std::string wal_file_; // WAL 目录
+    int fd_{-1};           // 控制文件
+    size_t page_size_{PAGE_SIZE};
+    size_t seg_bytes_{0};
+    size_t spare_segments_{0};
+    lsn_t start_lsn_{1};   // 日志中第一条记录的 LSN（控制文件）
+    lsn_t checkpoint_lsn_{1}; // 最近一次检查点开始标记的 LSN；全部截断后为截断位置
+    lsn_t synced_checkpoint_{INVALID_LSN}; // 控制文件中记录的、数据文件已落盘的检查点
+    uint32_t group_commit_us_{0};
+    std::mutex control_mtx_; // 串行化控制文件的改写
+    std::mutex file_mtx_;    // 段文件的创建、改名与删除
+    int write_fd_{-1};       // 组提交线程正在写的段
+    uint64_t write_seg_{0};
 
+    mutable std::mutex mtx_;
+    std::condition_variable flush_cv_;   // 唤醒组提交线程
+    std::condition_variable durable_cv_; // 唤醒等待落盘（或等待缓冲区空间）的线程
+    std::vector<char> buffer_;           // 尚未写出的记录
+    size_t buffer_limit_{0};
+    lsn_t next_lsn_{1};
+    lsn_t durable_lsn_{1};
+    lsn_t flush_request_{0}; // 有提交者在等待时为其要求落盘到的 LSN
+    bool flushing_{false};
+    bool stop_{false};
+    bool io_error_{false};
+    std::thread flusher_;
 
+    std::mutex seg_mtx_;
+    std::condition_variable seg_cv_;
+    bool seg_wake_{true};
+    bool seg_stop_{false};
+    std::thread segment_thread_;
+
+    std::atomic<size_t> sync_count_{0};
+    std::atomic<size_t> append_count_{0};
+    std::atomic<size_t> recovered_records_{0};
+    std::atomic<size_t> skipped_records_{0};
+    std::atomic<size_t> appended_bytes_{0};
+    std::atomic<size_t> full_page_images_{0};
+    std::atomic<size_t> created_segments_{0};
+    std::atomic<size_t> recycled_segments_{0};
+};
+
+}
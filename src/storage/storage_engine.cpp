@@ -8,22 +8,47 @@
 #include <chrono>
 #include <thread>
 
+#ifdef MINIDB_POSIX_IO
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace minidb
 {
 
+    namespace
+    {
+        // 映射模式下顺序扫描的预读窗口（页）
+        constexpr size_t kMmapReadaheadPages = 256;
+    } // namespace
+
 #ifdef PROJECT_ROOT_DIR
     static Logger g_storage_logger_engine(std::string(PROJECT_ROOT_DIR) + "/logs/storage_size.log");
 #else
     static Logger g_storage_logger_engine("storage_size.log");
 #endif
 
-    StorageEngine::StorageEngine(const std::string &db_file, size_t buffer_pool_size)
-        : disk_manager_(std::make_unique<DiskManager>(db_file)),
-          buffer_pool_manager_(std::make_unique<BufferPoolManager>(
-              (buffer_pool_size ? buffer_pool_size : GetRuntimeConfig().buffer_pool_pages),
-              disk_manager_.get())),
-          db_file_(db_file)
+    StorageEngine::StorageEngine(const std::string &db_file, size_t buffer_pool_size, OpenMode mode)
+        : disk_manager_(std::make_unique<DiskManager>(db_file, mode == OpenMode::ReadOnlyMmap)),
+          db_file_(db_file),
+          mode_(mode)
     {
+        if (mode_ == OpenMode::ReadOnlyMmap)
+        {
+            // 压缩格式的文件中页不在 页号 * 页大小 处，不能直接映射
+            if (!disk_manager_->IsCompressed() && MapFile())
+            {
+                global_log_info(std::string("[StorageEngine] 只读映射 ") + db_file_ + ", pages=" + std::to_string(map_pages_));
+                return;
+            }
+            global_log_warn(std::string("[StorageEngine] 无法映射 ") + db_file_ + "，退回只读缓冲池");
+        }
+        if (mode_ == OpenMode::ReadWrite && GetRuntimeConfig().wal_enabled)
+            OpenWal();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(
+            (buffer_pool_size ? buffer_pool_size : GetRuntimeConfig().buffer_pool_pages), disk_manager_.get());
         // 应用运行时配置
         buffer_pool_manager_->SetMaxPagesFlushedPerCycle(GetRuntimeConfig().bpm_max_flush_per_cycle);
         buffer_pool_manager_->SetFlushIntervalMs(GetRuntimeConfig().bpm_flush_interval_ms);
@@ -44,10 +69,111 @@ namespace minidb
     StorageEngine::~StorageEngine()
     {
         Shutdown();
+        UnmapFile();
+    }
+
+    bool StorageEngine::MapFile()
+    {
+#ifdef MINIDB_POSIX_IO
+        int fd = ::open(db_file_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(disk_manager_->GetPageSize()))
+        {
+            ::close(fd);
+            return false;
+        }
+        const size_t len = static_cast<size_t>(st.st_size);
+        void *base = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // 映射建立后不再需要描述符
+        if (base == MAP_FAILED)
+            return false;
+        map_base_ = static_cast<char *>(base);
+        map_len_ = len;
+        map_pages_ = len / GetPageSize();
+        views_.reset(new std::atomic<Page *>[map_pages_]);
+        for (size_t i = 0; i < map_pages_; ++i)
+            views_[i].store(nullptr, std::memory_order_relaxed);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void StorageEngine::UnmapFile()
+    {
+        if (!map_base_)
+            return;
+        for (size_t i = 0; i < map_pages_; ++i)
+            delete views_[i].load();
+        views_.reset();
+#ifdef MINIDB_POSIX_IO
+        ::munmap(map_base_, map_len_);
+#endif
+        map_base_ = nullptr;
+        map_len_ = 0;
+        map_pages_ = 0;
+    }
+
+    // 映射模式：页视图直接指向映射，首次访问时创建；pin 计数不维护
+    Page *StorageEngine::GetMappedPage(page_id_t page_id)
+    {
+        if (page_id == INVALID_PAGE_ID || static_cast<size_t>(page_id) >= map_pages_)
+            return nullptr;
+        if (sequential_hint_.load(std::memory_order_relaxed) && page_id % kMmapReadaheadPages == 0)
+        {
+            // 顺序扫描到达窗口边界时预读下一个窗口
+            Advise(static_cast<page_id_t>(page_id + kMmapReadaheadPages), kMmapReadaheadPages, MapAdvice::WillNeed);
+        }
+        Page *view = views_[page_id].load(std::memory_order_acquire);
+        if (view)
+            return view;
+        auto *fresh = new Page(map_base_ + static_cast<size_t>(page_id) * GetPageSize(), GetPageSize());
+        fresh->SetPageId(page_id);
+        if (!views_[page_id].compare_exchange_strong(view, fresh, std::memory_order_acq_rel))
+        {
+            delete fresh; // 其他线程已创建
+            return view;
+        }
+        return fresh;
+    }
+
+    void StorageEngine::Advise(page_id_t first_page_id, size_t num_pages, MapAdvice advice) const
+    {
+#ifdef MINIDB_POSIX_IO
+        if (!map_base_ || static_cast<size_t>(first_page_id) >= map_pages_)
+            return;
+        num_pages = std::min(num_pages, map_pages_ - first_page_id);
+        // madvise 要求起始地址按系统页对齐
+        static const size_t os_page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t begin = static_cast<size_t>(first_page_id) * GetPageSize();
+        size_t end = begin + num_pages * GetPageSize();
+        begin -= begin % os_page;
+        ::madvise(map_base_ + begin, end - begin, advice == MapAdvice::Sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+#else
+        (void)first_page_id;
+        (void)num_pages;
+        (void)advice;
+#endif
     }
+
+    void StorageEngine::AdviseSequentialScan(page_id_t first_page_id)
+    {
+        if (!map_base_ || first_page_id == INVALID_PAGE_ID)
+            return;
+        // 页链通常按分配顺序连续：从首页到映射末尾按顺序访问，先预读首页所在窗口与下一个窗口
+        Advise(first_page_id, map_pages_, MapAdvice::Sequential);
+        size_t window_end = (first_page_id / kMmapReadaheadPages + 2) * kMmapReadaheadPages;
+        Advise(first_page_id, window_end - first_page_id, MapAdvice::WillNeed);
+        sequential_hint_.store(true, std::memory_order_relaxed);
+    }
+
     // 获取一页
     Page *StorageEngine::GetPage(page_id_t page_id)
     {
+        if (map_base_)
+            return GetMappedPage(page_id);
         Page* page = buffer_pool_manager_->FetchPage(page_id);
         global_log_debug(std::string("[StorageEngine::GetPage] page_id=") + std::to_string(page_id) + (page ? " returned valid" : " returned null"));
         return page;
@@ -55,6 +181,11 @@ namespace minidb
     // 申请新页
     Page *StorageEngine::CreatePage(page_id_t *page_id)
     {
+        if (!buffer_pool_manager_)
+        {
+            global_log_warn("[StorageEngine::CreatePage] 只读映射模式不能创建页");
+            return nullptr;
+        }
         Page* page = buffer_pool_manager_->NewPage(page_id);
         if (page) {
             global_log_info(std::string("[StorageEngine::CreatePage] Allocated page_id=") + std::to_string(*page_id));
@@ -62,14 +193,30 @@ namespace minidb
         // 不设置页面类型，让调用者设置
         return page;
     }
+    Page *StorageEngine::CreateExtentPage(page_id_t *page_id, page_id_t near)
+    {
+        if (!buffer_pool_manager_)
+        {
+            global_log_warn("[StorageEngine::CreateExtentPage] 只读映射模式不能创建页");
+            return nullptr;
+        }
+        return buffer_pool_manager_->NewExtentPage(page_id, near);
+    }
     // 用完页后归还缓存，标记脏否
     bool StorageEngine::PutPage(page_id_t page_id, bool is_dirty)
     {
+        if (!buffer_pool_manager_)
+        {
+            // 映射模式：unpin 为空操作，映射页不可能被修改
+            return !is_dirty;
+        }
         return buffer_pool_manager_->UnpinPage(page_id, is_dirty);
     }
     // 删除一页
     bool StorageEngine::RemovePage(page_id_t page_id)
     {
+        if (!buffer_pool_manager_)
+            return false;
         return buffer_pool_manager_->DeletePage(page_id);
     }
     // 获取多页
@@ -79,7 +226,7 @@ namespace minidb
         result.reserve(page_ids.size());
         for (auto pid : page_ids)
         {
-            result.push_back(buffer_pool_manager_->FetchPage(pid));
+            result.push_back(GetPage(pid));
         }
         return result;
     }
@@ -91,18 +238,83 @@ namespace minidb
         StopBackgroundFlush();
         if (buffer_pool_manager_)
             buffer_pool_manager_->FlushAllPages();
-        if (disk_manager_)
-            disk_manager_->Shutdown();
+        const bool durable = disk_manager_ && disk_manager_->Shutdown();
+        // 脏页与元数据都已落盘，日志才不再需要；落盘失败时保留日志，下次打开时重放
+        if (wal_ && durable)
+            wal_->Truncate();
+        else if (wal_)
+            global_log_warn("[StorageEngine] 关闭时数据文件未能落盘，保留 WAL 待下次打开时重放");
     }
     // 只刷脏页不关闭文件
     void StorageEngine::Checkpoint()
     {
+        if (wal_ && buffer_pool_manager_)
+        {
+            FuzzyCheckpoint();
+            return;
+        }
         if (buffer_pool_manager_)
             buffer_pool_manager_->FlushAllPages();
         if (disk_manager_)
             disk_manager_->PersistMeta();
     }
 
+    void StorageEngine::FlushAllPages()
+    {
+        if (buffer_pool_manager_)
+            buffer_pool_manager_->FlushAllPages();
+    }
+
+    // 模糊检查点：不等脏页写回。开始标记 -> 取脏页表 -> 持久化元数据 -> 结束标记（带脏页表）落盘，
+    // 数据文件 fdatasync 后把日志截断到 min(开始标记, 各脏页 recLSN)；脏页由缓冲池后台线程按 recLSN 逐步写回
+    void StorageEngine::FuzzyCheckpoint()
+    {
+        std::lock_guard<std::mutex> guard(checkpoint_mutex_);
+        const auto start = std::chrono::steady_clock::now();
+        const lsn_t begin = wal_->BeginCheckpoint();
+        if (begin == INVALID_LSN)
+            return;
+        const std::vector<DirtyPageEntry> dpt = buffer_pool_manager_->GetDirtyPageTable();
+        disk_manager_->PersistMeta();
+        if (!wal_->EndCheckpoint(begin, dpt))
+            return;
+        lsn_t redo = begin;
+        for (const DirtyPageEntry &e : dpt)
+            redo = std::min<lsn_t>(redo, e.rec_lsn);
+        if (disk_manager_->SyncData())
+            wal_->TruncateTo(redo, begin);
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        global_log_debug(std::string("[StorageEngine] 模糊检查点：脏页 ") + std::to_string(dpt.size()) + "，日志保留自 LSN " +
+                         std::to_string(redo) + "，用时 " + std::to_string(us) + " us");
+    }
+
+    void StorageEngine::OpenWal()
+    {
+        wal_ = std::make_unique<WalManager>(db_file_ + ".wal");
+        if (!wal_->IsOpen())
+        {
+            wal_.reset();
+            return;
+        }
+        wal_->SetPageSize(disk_manager_->GetPageSize());
+        const auto start = std::chrono::steady_clock::now();
+        wal_->Recover(*disk_manager_);
+        if (wal_->GetRecoveredRecords() > 0)
+        {
+            // 重放的页落盘后才能截断日志
+            disk_manager_->PersistMeta();
+            if (disk_manager_->SyncData())
+                wal_->Truncate();
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            global_log_info(std::string("[StorageEngine] WAL 重放 ") + std::to_string(wal_->GetRecoveredRecords()) +
+                            " 条记录，用时 " + std::to_string(ms) + " ms");
+        }
+        // 日志文件丢失或被重建时 LSN 从 1 开始，比数据文件中的页 LSN 还小，重做会误判为已生效
+        if (!wal_->AdvanceLsn(disk_manager_->GetWalLsnHighWater()))
+            global_log_warn("[StorageEngine] WAL 的 LSN 落后于数据文件中的页 LSN");
+        disk_manager_->AttachWAL(wal_.get());
+    }
+
     void StorageEngine::StartBackgroundFlush(uint64_t interval_ms)
     {
         bg_flush_interval_ms_.store(interval_ms);
@@ -111,7 +323,9 @@ namespace minidb
             while (bg_flush_running_.load()) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(bg_flush_interval_ms_.load()));
                 if (!bg_flush_running_.load()) break;
-                if (buffer_pool_manager_) buffer_pool_manager_->FlushAllPages();
+                // 有 WAL 时脏页由缓冲池后台线程逐步写回，这里只做模糊检查点推进日志截断
+                if (wal_ && buffer_pool_manager_) FuzzyCheckpoint();
+                else if (buffer_pool_manager_) buffer_pool_manager_->FlushAllPages();
             }
         });
     }
@@ -128,7 +342,11 @@ namespace minidb
         oss << "BufferPoolSize=" << GetBufferPoolSize()
             << ", HitRate=" << GetCacheHitRate()
             << ", Replacements=" << GetNumReplacements()
-            << ", Writebacks=" << GetNumWritebacks();
+            << ", Writebacks=" << GetNumWritebacks()
+            << ", MergedIoRuns=" << disk_manager_->GetMergedRuns()
+            << ", AvgMergedRun=" << disk_manager_->GetAvgMergedRunLength();
+        if (disk_manager_->IsCompressed())
+            oss << ", CompressionRatio=" << GetCompressionRatio();
         const std::string msg = oss.str();
         std::cout << msg << std::endl;
 
@@ -141,6 +359,11 @@ namespace minidb
     {
         return buffer_pool_manager_ ? buffer_pool_manager_->GetHitRate() : 0.0;
     }
+    double StorageEngine::GetCompressionRatio() const
+    {
+        const uint64_t logical = disk_manager_->GetCompressedLogicalBytes();
+        return logical == 0 ? 1.0 : static_cast<double>(disk_manager_->GetCompressedStoredBytes()) / static_cast<double>(logical);
+    }
     // 缓存池大小
     size_t StorageEngine::GetBufferPoolSize() const
     {
@@ -156,6 +379,10 @@ namespace minidb
     {
         return buffer_pool_manager_ ? buffer_pool_manager_->GetNumReplacements() : 0;
     }
+    size_t StorageEngine::GetNumPageAccesses() const
+    {
+        return buffer_pool_manager_ ? buffer_pool_manager_->GetNumAccesses() : 0;
+    }
     // 写回次数
     size_t StorageEngine::GetNumWritebacks() const
     {
@@ -205,6 +432,7 @@ namespace minidb
     {
         std::vector<Page*> pages;
         page_id_t current_page_id = first_page_id;
+        AdviseSequentialScan(first_page_id);
         
         // Guard against cycles/self-loops to prevent infinite traversal
         std::unordered_set<page_id_t> visited;
@@ -226,6 +454,12 @@ namespace minidb
     
     void StorageEngine::PrefetchPageChain(page_id_t first_page_id, size_t max_pages)
     {
+        if (map_base_)
+        {
+            // 映射模式不经缓冲池：交给内核预读
+            Advise(first_page_id, max_pages, MapAdvice::WillNeed);
+            return;
+        }
         page_id_t current_page_id = first_page_id;
         std::unordered_set<page_id_t> visited;
         size_t count = 0;
@@ -245,7 +479,59 @@ namespace minidb
     bool StorageEngine::AppendRecordToPage(Page* page, const void* record_data, uint16_t record_size)
     {
         if (!page) return false;
-        return AppendRow(page, record_data, record_size);
+        if (!AppendRow(page, record_data, record_size)) return false;
+        UpdateFreeSpace(page);
+        return true;
+    }
+
+    void StorageEngine::UpdateFreeSpace(Page* page)
+    {
+        if (!page || !buffer_pool_manager_) return;
+        if (page->GetPageType() != PageType::DATA_PAGE) return;
+        disk_manager_->RecordFreeSpace(page->GetPageId(), GetFreeSpace(page));
+    }
+
+    bool StorageEngine::RewriteDataPage(Page* page, const std::vector<std::pair<const void*, uint16_t>>& records)
+    {
+        if (!page) return false;
+        // 记录可能就在本页里：先拷出，重建时的追加会覆盖原位置
+        std::vector<char> copy;
+        for (const auto& rec : records)
+            copy.insert(copy.end(), static_cast<const char*>(rec.first), static_cast<const char*>(rec.first) + rec.second);
+        // 保留页链后继，否则后面的页会从链上脱落
+        const page_id_t next_pid = page->GetNextPageId();
+        page->InitializePage(PageType::DATA_PAGE);
+        page->SetNextPageId(next_pid);
+        bool ok = true;
+        size_t at = 0;
+        for (const auto& rec : records)
+        {
+            ok = AppendRow(page, copy.data() + at, rec.second) && ok;
+            at += rec.second;
+        }
+        UpdateFreeSpace(page);
+        return ok;
+    }
+
+    bool StorageEngine::RewriteDataPage(Page* page, const std::vector<std::vector<char>>& records)
+    {
+        std::vector<std::pair<const void*, uint16_t>> refs;
+        refs.reserve(records.size());
+        for (const auto& rec : records)
+            refs.emplace_back(rec.data(), static_cast<uint16_t>(rec.size()));
+        return RewriteDataPage(page, refs);
+    }
+
+    page_id_t StorageEngine::FindPageWithSpace(page_id_t first_page_id, uint16_t record_size) const
+    {
+        if (first_page_id == INVALID_PAGE_ID || !buffer_pool_manager_) return INVALID_PAGE_ID;
+        return disk_manager_->FindPageWithSpace(first_page_id, static_cast<uint16_t>(record_size + SLOT_ENTRY_SIZE));
+    }
+
+    page_id_t StorageEngine::GetSegmentLastPage(page_id_t first_page_id) const
+    {
+        if (first_page_id == INVALID_PAGE_ID) return INVALID_PAGE_ID;
+        return disk_manager_->GetSegmentLastPage(first_page_id);
     }
     
     // 页内数据操作工具：获取页内所有记录
@@ -280,6 +566,18 @@ namespace minidb
         return p;
     }
 
+    Page* StorageEngine::CreateDataPage(page_id_t* page_id, page_id_t near)
+    {
+        Page* p = CreateExtentPage(page_id, near);
+        if (p) {
+            InitializeDataPage(p);
+            UpdateFreeSpace(p);
+            PutPage(*page_id, true);
+            p = GetPage(*page_id);
+        }
+        return p;
+    }
+
     // 便捷：按ID获取数据页（校验类型）
     Page* StorageEngine::GetDataPage(page_id_t page_id)
     {
@@ -337,7 +635,7 @@ namespace minidb
         MetaPageData disk_meta;
         disk_meta.magic = 0x4D696E6944425F4DULL; // "MiniDB_M"
         disk_meta.version = 1;
-        disk_meta.page_size = PAGE_SIZE;
+        disk_meta.page_size = static_cast<uint32_t>(GetPageSize());
         disk_meta.next_page_id = 1;  // 从第1页开始分配数据页
         disk_meta.catalog_root = INVALID_PAGE_ID;
         
@@ -400,7 +698,7 @@ namespace minidb
             // 说明此前还没有有效的 meta，被视为首次初始化
             meta_info.magic = META_MAGIC;
             meta_info.version = META_VERSION;
-            meta_info.page_size = PAGE_SIZE;
+            meta_info.page_size = static_cast<uint32_t>(GetPageSize());
             // next_page_id 按磁盘管理器当前统计来设置
             meta_info.next_page_id = static_cast<page_id_t>(disk_manager_->GetNumPages());
         } else {
@@ -434,7 +732,7 @@ namespace minidb
         if (!catalog_data.data.empty()) {
             char* data = catalog_page->GetData() + PAGE_HEADER_SIZE;
             size_t copy_size = std::min(catalog_data.data.size(), 
-                                      static_cast<size_t>(PAGE_SIZE - PAGE_HEADER_SIZE));
+                                      GetPageSize() - PAGE_HEADER_SIZE);
             std::memcpy(data, catalog_data.data.data(), copy_size);
         }
         
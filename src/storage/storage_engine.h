@@ -37,18 +37,29 @@ namespace minidb
         CatalogData(const std::vector<char> &d) : data(d) {}
     };
 
+    // 打开方式。ReadOnlyMmap 面向只读的分析副本：整个文件以只读方式映射，GetPage 返回直接指向映射的页视图，
+    // PutPage（pin / unpin）与淘汰都是空操作；写页会触发保护错误。无法映射时退回只读文件上的缓冲池
+    enum class OpenMode
+    {
+        ReadWrite,
+        ReadOnlyMmap
+    };
+
     class StorageEngine
     {
     public:
         // 移除TableSchema - 这应该由Catalog模块管理
 
         explicit StorageEngine(const std::string &db_file,
-                               size_t buffer_pool_size = BUFFER_POOL_SIZE);
+                               size_t buffer_pool_size = BUFFER_POOL_SIZE,
+                               OpenMode mode = OpenMode::ReadWrite);
         ~StorageEngine();
 
         // 基础页面操作
         Page *GetPage(page_id_t page_id);
         Page *CreatePage(page_id_t *page_id);
+        // 表 / 索引页：从 near 所在段的区中分配，页链在文件中连续；near 为 INVALID_PAGE_ID 时新建段
+        Page *CreateExtentPage(page_id_t *page_id, page_id_t near);
         bool PutPage(page_id_t page_id, bool is_dirty = false);
         bool RemovePage(page_id_t page_id);
 
@@ -57,7 +68,10 @@ namespace minidb
 
         // 系统管理
         void Shutdown();
+        // 有 WAL 时为模糊检查点（不等待脏页写回），否则写回全部脏页并持久化元数据
         void Checkpoint();
+        // 写回缓冲池中的全部脏页（不做检查点）
+        void FlushAllPages();
 
         // 后台刷盘控制
         void StartBackgroundFlush(uint64_t interval_ms = 1000);
@@ -69,11 +83,18 @@ namespace minidb
         size_t GetBufferPoolSize() const;
         size_t GetNumReplacements() const;
         size_t GetNumWritebacks() const;
+        // 经缓冲池取页的次数（含命中）
+        size_t GetNumPageAccesses() const;
         size_t GetIOQueueDepth() const { return disk_manager_ ? const_cast<DiskManager*>(disk_manager_.get())->GetQueueDepth() : 0; }
         double GetIOAvgReadMs() const { return disk_manager_ ? const_cast<DiskManager*>(disk_manager_.get())->GetAvgReadLatencyMs() : 0.0; }
         double GetIOAvgWriteMs() const { return disk_manager_ ? const_cast<DiskManager*>(disk_manager_.get())->GetAvgWriteLatencyMs() : 0.0; }
         size_t GetIOReadOps() const { return disk_manager_ ? const_cast<DiskManager*>(disk_manager_.get())->GetReadOps() : 0; }
         size_t GetIOWriteOps() const { return disk_manager_ ? const_cast<DiskManager*>(disk_manager_.get())->GetWriteOps() : 0; }
+        // 透明页压缩：数据库是否为压缩格式，及写入的实际落盘字节数 / 逻辑字节数（未压缩或未写过时为 1）
+        bool IsCompressed() const { return disk_manager_ && disk_manager_->IsCompressed(); }
+        // 预写日志；未启用时为空
+        WalManager *GetWal() const { return wal_.get(); }
+        double GetCompressionRatio() const;
         void SetReplacementPolicy(ReplacementPolicy policy);
         bool AdjustBufferPoolSize(size_t new_size);
 
@@ -88,15 +109,33 @@ namespace minidb
         std::vector<Page *> GetPageChain(page_id_t first_page_id);
         // 预取页链（将链上一批页加载到缓冲池，不返回指针）
         void PrefetchPageChain(page_id_t first_page_id, size_t max_pages = 8);
+        // 即将沿页链顺序扫描：映射模式下对后续页做 MADV_SEQUENTIAL 并开始按窗口 MADV_WILLNEED，缓冲池模式下为空操作
+        void AdviseSequentialScan(page_id_t first_page_id);
+
+        bool IsReadOnly() const { return mode_ == OpenMode::ReadOnlyMmap; }
+        bool IsMemoryMapped() const { return map_base_ != nullptr; }
+        // 数据库的页大小（建库时确定，记录在元数据中）
+        size_t GetPageSize() const { return disk_manager_->GetPageSize(); }
 
         // 页内数据操作工具（使用page_utils.h中的函数）
+        // 追加成功后同步登记数据页的空闲空间
         bool AppendRecordToPage(Page *page, const void *record_data, uint16_t record_size);
         std::vector<std::pair<const void *, uint16_t>> GetPageRecords(Page *page);
+        // 数据页内容被改写（如删除后重建）后登记其空闲空间
+        void UpdateFreeSpace(Page *page);
+        // 以 records 重建数据页（删除/更新后）：保留页链后继，并重新登记空闲空间。records 可以指向页内
+        bool RewriteDataPage(Page *page, const std::vector<std::pair<const void *, uint16_t>> &records);
+        bool RewriteDataPage(Page *page, const std::vector<std::vector<char>> &records);
+        // 表（以首页标识）中放得下 record_size 字节记录的页；没有时返回 INVALID_PAGE_ID
+        page_id_t FindPageWithSpace(page_id_t first_page_id, uint16_t record_size) const;
+        // 表所在段最近分配的页，新数据页接在它之后；没有时返回 INVALID_PAGE_ID
+        page_id_t GetSegmentLastPage(page_id_t first_page_id) const;
 
         // 页初始化工具
         void InitializeDataPage(Page *page);
         // 便捷：创建/获取数据页
         Page *CreateDataPage(page_id_t *page_id);
+        Page *CreateDataPage(page_id_t *page_id, page_id_t near);
         Page *GetDataPage(page_id_t page_id);
 
         // 索引页便捷接口
@@ -127,16 +166,40 @@ namespace minidb
         bool SetIndexRoot(page_id_t index_root) { return disk_manager_ ? disk_manager_->SetIndexRoot(index_root) : false; }
 
     private:
+        // 只读映射
+        bool MapFile();
+        void UnmapFile();
+        Page *GetMappedPage(page_id_t page_id);
+        enum class MapAdvice
+        {
+            Sequential, // MADV_SEQUENTIAL
+            WillNeed    // MADV_WILLNEED
+        };
+        void Advise(page_id_t first_page_id, size_t num_pages, MapAdvice advice) const;
+        // RuntimeConfig::wal_enabled 时打开 <db_file>.wal 目录，重放上次未截断的日志后挂到 DiskManager
+        void OpenWal();
+        void FuzzyCheckpoint();
+
+        // 声明在 disk_manager_ 之前：缓冲池与 DiskManager 析构时仍可能写页（经 WAL）
+        std::unique_ptr<WalManager> wal_;
         std::unique_ptr<DiskManager> disk_manager_;
-        std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+        std::unique_ptr<BufferPoolManager> buffer_pool_manager_; // 映射模式下为空
 
         std::string db_file_;
+        OpenMode mode_{OpenMode::ReadWrite};
         std::atomic<bool> is_shutdown_{false};
 
+        char *map_base_{nullptr};
+        size_t map_len_{0};
+        size_t map_pages_{0};
+        std::unique_ptr<std::atomic<Page *>[]> views_; // 按页号惰性创建的页视图，随引擎释放
+        std::atomic<bool> sequential_hint_{false};     // 有顺序扫描时按窗口预读
+
         // 后台刷盘
         std::atomic<bool> bg_flush_running_{false};
         std::thread bg_flush_thread_;
         std::atomic<uint64_t> bg_flush_interval_ms_{1000};
+        std::mutex checkpoint_mutex_; // 后台线程与调用方的检查点串行执行
 
         // 移除表schema管理 - 这应该由Catalog模块负责
     };
@@ -0,0 +1,15 @@
+#include "util/checksum.h"
+
+namespace minidb
+{
+    namespace checksum
+    {
+        uint32_t Mix(uint32_t crc, const void *p, size_t n)
+        {
+            const uint8_t *b = static_cast<const uint8_t *>(p);
+            for (size_t i = 0; i < n; ++i)
+                crc = (crc * 16777619u) ^ b[i];
+            return crc;
+        }
+    } // namespace checksum
+} // namespace minidb
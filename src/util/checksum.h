@@ -0,0 +1,23 @@
+// src/util/checksum.h
+/**
+ * 乘法-异或校验（FNV 风格）：用于元数据页、压缩页槽与 WAL 记录，发现撕裂或损坏的写
+ * - 可分段累加：Mix(Mix(0, a), b) 与一次覆盖 a、b 相同
+ * - 不是密码学校验，只用于检测意外损坏
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace minidb
+{
+    namespace checksum
+    {
+        // 把 n 字节并入已有的校验值 crc（起始值为 0）
+        uint32_t Mix(uint32_t crc, const void *p, size_t n);
+
+        // 按对象表示并入一个定长字段
+        template <typename T>
+        uint32_t MixField(uint32_t crc, const T &v) { return Mix(crc, &v, sizeof(T)); }
+    } // namespace checksum
+} // namespace minidb
@@ -7,10 +7,16 @@ namespace minidb
 {
 
     // 基础配置
+    // 默认（也是最小）页大小；每个数据库的实际页大小在建库时确定，见 RuntimeConfig::page_size
     constexpr size_t PAGE_SIZE = 4096;
+    constexpr size_t MAX_PAGE_SIZE = 64 * 1024;
+    inline constexpr bool IsValidPageSize(size_t size)
+    {
+        return size >= PAGE_SIZE && size <= MAX_PAGE_SIZE && (size & (size - 1)) == 0;
+    }
     constexpr size_t BUFFER_POOL_SIZE = 128;   //缓冲池页数（默认，可被动态覆盖）
     constexpr size_t MAX_PAGES = 1000000;
-    // 默认虚拟磁盘大小（用于新建时预分配），可按需调整
+    // 默认虚拟磁盘大小（决定初始页容量；非 POSIX 平台新建文件时按它预分配），可按需调整
     // constexpr size_t DEFAULT_DISK_SIZE_BYTES = 10 * 1024 * 1024; // 10MB
     constexpr size_t DEFAULT_DISK_SIZE_BYTES = 160 * 1024;   //160KB
     constexpr size_t DEFAULT_MAX_PAGES = DEFAULT_DISK_SIZE_BYTES / PAGE_SIZE;
@@ -21,13 +27,57 @@ namespace minidb
     // 运行时可调参数（通过环境变量或配置加载时覆盖）
     struct RuntimeConfig {
         size_t buffer_pool_pages = BUFFER_POOL_SIZE;
+        // 新建数据库的页大小（4K / 8K / 16K / 32K / 64K）；打开已有数据库时以文件元数据为准
+        size_t page_size = PAGE_SIZE;
+        // 新建数据库时启用透明页压缩：页 LZ 压缩后存入变长槽，经页号 -> 槽映射定位；打开已有数据库时以文件元数据为准
+        bool page_compression = false;
         size_t io_worker_threads = 3;
         size_t io_batch_max = 64;
+        // 异步页读写优先走 io_uring（Linux），不可用时退回 io_worker_threads 个工作线程。
+        // 两条路径都把批量写回中页号连续的一段合并为一次向量写（io_uring 为 WRITEV，工作线程为 pwritev）；
+        // io_uring 下的页读逐个提交，不做合并
+        bool io_use_uring = true;
+        // io_uring 提交队列深度
+        unsigned io_uring_entries = 256;
+        // 以 O_DIRECT 打开数据文件，页只缓存在缓冲池中；文件系统不支持时自动退回普通 I/O
+        bool io_direct = false;
+        // 预写日志（<数据库文件>.wal 目录）：页内修改记成逻辑记录，页写入数据文件前它的日志先落盘，打开时重放。
+        // 开启后后台线程每 bpm_flush_interval_ms 做一次模糊检查点，脏页由缓冲池按 recLSN 每轮写回 bpm_max_flush_per_cycle 页。
+        // 日志先进入 wal_buffer_bytes 的内存缓冲区，由组提交线程一次写出并 fdatasync；
+        // wal_group_commit_us 大于 0 时组提交线程每批多等这么久，让更多并发提交共享一次同步
+        bool wal_enabled = false;
+        size_t wal_buffer_bytes = 4 * 1024 * 1024;
+        uint32_t wal_group_commit_us = 0;
+        // 恢复时的重做线程数（按页号散列分区）；0 表示按 CPU 核数，最多 8 个
+        uint32_t wal_recovery_threads = 0;
+        // WAL 段大小（新建日志时生效，至少 1MB）；后台线程在写位置之后保留 wal_spare_segments 个写好零的段，
+        // 检查点之后不再需要的段改名复用，超出的才删除
+        size_t wal_segment_bytes = 16 * 1024 * 1024;
+        uint32_t wal_spare_segments = 2;
+        // 表与索引按区（extent）分配页：每个区为这么多个连续页，同一段的页链因此在文件中连续；不大于 1 时逐页分配
+        size_t alloc_extent_pages = 64;
+        // 数据文件按块增长（Linux 上用 fallocate 预留空间）：每次增长当前已分配大小的 file_grow_percent%，
+        // 并夹在 [file_grow_min_bytes, file_grow_max_bytes] 之间；file_grow_max_bytes 为 0 时逐次按写入扩展
+        size_t file_grow_min_bytes = 1024 * 1024;
+        size_t file_grow_max_bytes = 64 * 1024 * 1024;
+        uint32_t file_grow_percent = 25;
         uint32_t bpm_flush_interval_ms = 200;
         size_t bpm_max_flush_per_cycle = 64;
         bool bpm_autoresize = true;
         bool bpm_readahead = true;
         uint32_t bpm_readahead_window = 4;
+        // 执行器：哈希连接构建侧内存预算（字节），超出后按分区溢写到临时页
+        size_t exec_join_memory_bytes = 64 * 1024 * 1024;
+        // 执行器：哈希聚合内存中的最大分组数，超出后新分组按分区溢写到临时页
+        size_t exec_agg_max_groups = 1 << 20;
+        // 执行器：ORDER BY 排序内存预算（字节），超出后分段溢写并 k 路归并
+        size_t exec_sort_memory_bytes = 64 * 1024 * 1024;
+        // 执行器：页链扫描并行度（0 表示取硬件线程数，1 表示串行扫描）
+        size_t exec_scan_threads = 0;
+        // 执行器：并行扫描每个 morsel 的页数
+        size_t exec_scan_morsel_pages = 16;
+        // 执行器：页链扫描上的向量化执行（列式批 + SIMD 过滤 / 聚合），不支持的谓词与聚合仍逐行执行
+        bool exec_vectorized = true;
     };
 
     // 提供获取全局可写配置实例的接口
@@ -0,0 +1,181 @@
+#include "util/lz_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace minidb
+{
+    namespace lz
+    {
+        namespace
+        {
+            constexpr size_t kMinMatch = 4;
+            constexpr size_t kLastLiterals = 5; // 末尾必须是字面量的字节数
+            constexpr size_t kMfLimit = 12;     // 匹配必须在末尾这么多字节之前开始
+            constexpr int kHashLog = 12;
+            constexpr size_t kMaxOffset = 65535;
+            constexpr uint32_t kNoPos = UINT32_MAX;
+
+            uint32_t Read32(const unsigned char *p)
+            {
+                uint32_t v;
+                std::memcpy(&v, p, sizeof(v));
+                return v;
+            }
+
+            uint32_t Hash(uint32_t v) { return (v * 2654435761u) >> (32 - kHashLog); }
+
+            // 长度字段超过 15 的部分按 255 递减写扩展字节
+            size_t ExtraLengthBytes(size_t len) { return len >= 15 ? (len - 15) / 255 + 1 : 0; }
+
+            unsigned char *PutExtraLength(unsigned char *op, size_t len)
+            {
+                len -= 15;
+                while (len >= 255)
+                {
+                    *op++ = 255;
+                    len -= 255;
+                }
+                *op++ = static_cast<unsigned char>(len);
+                return op;
+            }
+
+            // 字面量段 + 可选的匹配（offset 为 0 表示最后一段，只有字面量）
+            unsigned char *PutSequence(unsigned char *op, const unsigned char *lit, size_t lit_len, size_t offset,
+                                       size_t match_len)
+            {
+                unsigned char *token = op++;
+                *token = static_cast<unsigned char>((lit_len >= 15 ? 15 : lit_len) << 4);
+                if (lit_len >= 15)
+                    op = PutExtraLength(op, lit_len);
+                std::memcpy(op, lit, lit_len);
+                op += lit_len;
+                if (offset == 0)
+                    return op;
+                *op++ = static_cast<unsigned char>(offset & 0xFF);
+                *op++ = static_cast<unsigned char>(offset >> 8);
+                *token |= static_cast<unsigned char>(match_len >= 15 ? 15 : match_len);
+                if (match_len >= 15)
+                    op = PutExtraLength(op, match_len);
+                return op;
+            }
+
+            bool ReadExtraLength(const unsigned char *&ip, const unsigned char *iend, size_t &len)
+            {
+                unsigned char b;
+                do
+                {
+                    if (ip >= iend)
+                        return false;
+                    b = *ip++;
+                    len += b;
+                } while (b == 255);
+                return true;
+            }
+        } // namespace
+
+        size_t Compress(const char *src, size_t n, char *dst, size_t cap)
+        {
+            const unsigned char *const base = reinterpret_cast<const unsigned char *>(src);
+            const unsigned char *const iend = base + n;
+            const unsigned char *ip = base;
+            const unsigned char *anchor = base;
+            unsigned char *const ostart = reinterpret_cast<unsigned char *>(dst);
+            unsigned char *const oend = ostart + cap;
+            unsigned char *op = ostart;
+
+            if (n > kMfLimit)
+            {
+                const unsigned char *const mflimit = iend - kMfLimit;
+                const unsigned char *const matchlimit = iend - kLastLiterals;
+                uint32_t table[1u << kHashLog];
+                std::fill(table, table + (1u << kHashLog), kNoPos);
+                while (ip < mflimit)
+                {
+                    const uint32_t seq = Read32(ip);
+                    const uint32_t h = Hash(seq);
+                    const uint32_t cand = table[h];
+                    const uint32_t pos = static_cast<uint32_t>(ip - base);
+                    table[h] = pos;
+                    if (cand == kNoPos || pos - cand > kMaxOffset || Read32(base + cand) != seq)
+                    {
+                        ++ip;
+                        continue;
+                    }
+                    const unsigned char *match = base + cand;
+                    while (ip > anchor && match > base && ip[-1] == match[-1])
+                    {
+                        --ip;
+                        --match;
+                    }
+                    const unsigned char *end = ip + kMinMatch;
+                    const unsigned char *m = match + kMinMatch;
+                    while (end < matchlimit && *end == *m)
+                    {
+                        ++end;
+                        ++m;
+                    }
+                    const size_t lit_len = static_cast<size_t>(ip - anchor);
+                    const size_t match_len = static_cast<size_t>(end - ip) - kMinMatch;
+                    const size_t need = 1 + ExtraLengthBytes(lit_len) + lit_len + 2 + ExtraLengthBytes(match_len);
+                    if (static_cast<size_t>(oend - op) < need)
+                        return 0;
+                    op = PutSequence(op, anchor, lit_len, static_cast<size_t>(ip - match), match_len);
+                    ip = end;
+                    anchor = ip;
+                    if (ip < mflimit)
+                        table[Hash(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - base);
+                }
+            }
+
+            const size_t lit_len = static_cast<size_t>(iend - anchor);
+            if (static_cast<size_t>(oend - op) < 1 + ExtraLengthBytes(lit_len) + lit_len)
+                return 0;
+            op = PutSequence(op, anchor, lit_len, 0, 0);
+            return static_cast<size_t>(op - ostart);
+        }
+
+        bool Decompress(const char *src, size_t n, char *dst, size_t out_len)
+        {
+            const unsigned char *ip = reinterpret_cast<const unsigned char *>(src);
+            const unsigned char *const iend = ip + n;
+            unsigned char *const ostart = reinterpret_cast<unsigned char *>(dst);
+            unsigned char *const oend = ostart + out_len;
+            unsigned char *op = ostart;
+
+            while (ip < iend)
+            {
+                const unsigned token = *ip++;
+                size_t lit_len = token >> 4;
+                if (lit_len == 15 && !ReadExtraLength(ip, iend, lit_len))
+                    return false;
+                if (static_cast<size_t>(iend - ip) < lit_len || static_cast<size_t>(oend - op) < lit_len)
+                    return false;
+                std::memcpy(op, ip, lit_len);
+                op += lit_len;
+                ip += lit_len;
+                if (ip == iend)
+                    break; // 最后一段只有字面量
+                if (iend - ip < 2)
+                    return false;
+                const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+                ip += 2;
+                if (offset == 0 || offset > static_cast<size_t>(op - ostart))
+                    return false;
+                size_t match_len = token & 15;
+                if (match_len == 15 && !ReadExtraLength(ip, iend, match_len))
+                    return false;
+                match_len += kMinMatch;
+                if (static_cast<size_t>(oend - op) < match_len)
+                    return false;
+                // 匹配可能与输出重叠（offset < match_len），逐字节复制
+                const unsigned char *m = op - offset;
+                for (size_t i = 0; i < match_len; ++i)
+                    op[i] = m[i];
+                op += match_len;
+            }
+            return op == oend;
+        }
+    } // namespace lz
+} // namespace minidb
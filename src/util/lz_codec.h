@@ -0,0 +1,25 @@
+// src/util/lz_codec.h
+/**
+ * 自包含的 LZ 压缩（LZ4 块格式）：贪心哈希匹配，无外部依赖
+ * - 序列 = token(高 4 位字面量长度，低 4 位匹配长度 - 4) + 字面量 + 2 字节小端偏移 + 长度扩展字节
+ * - 最后 5 字节总是字面量，最后一个匹配至少在末尾 12 字节之前开始（与 LZ4 解码器兼容）
+ * 用于数据页压缩：定长 VARCHAR 以 NUL 填充，页内重复很多，压缩率高
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace minidb
+{
+    namespace lz
+    {
+        // n 字节输入压缩后的最坏长度
+        constexpr size_t MaxCompressedSize(size_t n) { return n + n / 255 + 16; }
+
+        // 压缩到 dst（容量 cap）；放不下时返回 0，否则返回压缩后的字节数
+        size_t Compress(const char *src, size_t n, char *dst, size_t cap);
+
+        // 解压恰好 out_len 字节到 dst；输入损坏或长度不符时返回 false
+        bool Decompress(const char *src, size_t n, char *dst, size_t out_len);
+    } // namespace lz
+} // namespace minidb
@@ -0,0 +1,112 @@
+// tests/test_helpers.h
+// 执行器 / 存储测试共用的夹具：绕过 SQL 直接按页链建表、SQL 编译为计划并执行、拉空算子
+#pragma once
+
+#include "simple_test_framework.h"
+#include "../src/catalog/catalog.h"
+#include "../src/engine/executor/executor.h"
+#include "../src/auth/auth_service.h"
+#include "../src/storage/page/page_utils.h"
+#include "../src/sql_compiler/lexer/lexer.h"
+#include "../src/sql_compiler/parser/parser.h"
+#include "../src/sql_compiler/parser/ast_json_serializer.h"
+#include "../src/sql_compiler/semantic/semantic_analyzer.h"
+#include "../src/frontend/translator/json_to_plan.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TestHelpers {
+
+using namespace minidb;
+
+// 直接按页链写入 n 行，每页 rows_per_page 行；row_of(i) 给出第 i 行的列值（顺序同 columns）
+inline TableSchema buildTable(StorageEngine& se, const std::string& name, const std::vector<Column>& columns,
+                              int n, int rows_per_page, const std::function<std::vector<std::string>(int)>& row_of){
+    TableSchema schema;
+    schema.table_name = name;
+    schema.columns = columns;
+
+    Page* prev = nullptr;
+    page_id_t prev_id = INVALID_PAGE_ID;
+    for (int i = 0; i < n; ++i) {
+        if (i % rows_per_page == 0) {
+            page_id_t pid = INVALID_PAGE_ID;
+            Page* page = se.CreatePage(&pid);
+            ASSERT_TRUE(page != nullptr);
+            page->InitializePage(PageType::DATA_PAGE);
+            if (prev) {
+                prev->SetNextPageId(pid);
+                se.PutPage(prev_id, true);
+            } else {
+                schema.first_page_id = pid;
+            }
+            prev = page;
+            prev_id = pid;
+        }
+        const std::vector<std::string> values = row_of(i);
+        Row row;
+        for (size_t c = 0; c < columns.size(); ++c)
+            row.columns.push_back({columns[c].name, values[c]});
+        std::vector<char> buf;
+        row.Serialize(buf, schema);
+        ASSERT_TRUE(AppendRow(prev, buf.data(), static_cast<uint16_t>(buf.size())));
+    }
+    if (prev) se.PutPage(prev_id, true);
+    return schema;
+}
+
+inline std::vector<Row> drain(PhysicalOperator& op){
+    std::vector<Row> rows;
+    op.Open();
+    Row row;
+    while (op.Next(row)) rows.push_back(row);
+    op.Close();
+    return rows;
+}
+
+// 拉空算子，只取一列的值
+inline std::vector<std::string> drainColumn(PhysicalOperator& op, const std::string& column){
+    std::vector<std::string> values;
+    op.Open();
+    Row row;
+    while (op.Next(row)) values.push_back(row.getValue(column));
+    op.Close();
+    return values;
+}
+
+// 词法 / 语法 / 语义分析后翻译为计划（不经优化器）
+inline std::unique_ptr<PlanNode> planSQL(Catalog* catalog, const std::string& sql){
+    Lexer lexer(sql);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto stmt = parser.parse();
+    SemanticAnalyzer sem; sem.setCatalog(catalog);
+    sem.analyze(stmt.get());
+    auto j = ASTJson::toJson(stmt.get());
+    return JsonToPlan::translate(j);
+}
+
+// 执行器不接管 catalog / 存储引擎的所有权
+inline std::unique_ptr<Executor> makeExecutor(Catalog* catalog, StorageEngine* se, AuthService* auth,
+                                              PermissionChecker* checker){
+    auto exec = std::make_unique<Executor>(catalog, checker);
+    exec->SetAuthService(auth);
+    exec->SetStorageEngine(std::shared_ptr<StorageEngine>(se, [](StorageEngine*){}));
+    exec->SetCatalog(std::shared_ptr<Catalog>(catalog, [](Catalog*){}));
+    return exec;
+}
+
+inline std::vector<Row> runPlan(Catalog* catalog, StorageEngine* se, AuthService* auth, PlanNode* plan){
+    PermissionChecker checker(auth);
+    return makeExecutor(catalog, se, auth, &checker)->execute(plan);
+}
+
+inline std::vector<Row> runSQL(Catalog* catalog, StorageEngine* se, AuthService* auth, const std::string& sql){
+    auto plan = planSQL(catalog, sql);
+    return runPlan(catalog, se, auth, plan.get());
+}
+
+} // namespace TestHelpers
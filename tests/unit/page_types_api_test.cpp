@@ -1,6 +1,8 @@
 // tests/unit/page_types_api_test.cpp
 #include "storage/storage_engine.h"
+#include "storage/page/page_utils.h"
 #include "../simple_test_framework.h"
+#include <cstdio>
 #include <cstring>
 #include <string>
 
@@ -16,6 +18,8 @@ static std::string make_db_path(const char* fname) {
 
 void test_meta_and_catalog_pages() {
     std::string db = make_db_path("test_page_types_api.bin");
+    // 元数据初始化不会把已分配的页号退回去：从新文件开始
+    std::remove(db.c_str());
     StorageEngine engine(db, 64);
 
     // Meta init and get/set
@@ -78,6 +82,16 @@ void test_data_pages_basic_io_and_link() {
     auto chain = engine.GetPageChain(p1);
     ASSERT_EQ((size_t)2, chain.size());
 
+    // Rewrite the first page keeping only the second record (records point into the page)
+    const size_t free_before = GetFreeSpace(d1);
+    ASSERT_TRUE(engine.RewriteDataPage(d1, {recs1[1]}));
+    auto rewritten = engine.GetPageRecords(d1);
+    ASSERT_EQ((size_t)1, rewritten.size());
+    ASSERT_EQ(0, std::memcmp(rewritten[0].first, r2, std::strlen(r2)));
+    ASSERT_EQ(p2, d1->GetNextPageId());
+    ASSERT_TRUE(GetFreeSpace(d1) > free_before);
+    ASSERT_EQ((size_t)2, engine.GetPageChain(p1).size());
+
     engine.PutPage(p1, true);
     engine.PutPage(p2, true);
     engine.Shutdown();
@@ -0,0 +1,481 @@
+#include "../simple_test_framework.h"
+#include "../../src/storage/page/disk_manager.h"
+#include "../../src/util/checksum.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace minidb;
+using namespace SimpleTest;
+
+// 第 pid 页的内容：每个字节都是 pid 的低 8 位，便于校验
+static std::vector<char> pageOf(page_id_t pid){
+    return std::vector<char>(PAGE_SIZE, static_cast<char>(pid & 0xFF));
+}
+
+static bool pageIs(const char* data, page_id_t pid){
+    for (size_t i = 0; i < PAGE_SIZE; ++i)
+        if (data[i] != static_cast<char>(pid & 0xFF)) return false;
+    return true;
+}
+
+// 直接读改写文件里的元数据区（页头之后）
+static MetaPageData loadMeta(const char* path){
+    MetaPageData m{};
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(PAGE_HEADER_SIZE);
+    in.read(reinterpret_cast<char*>(&m), sizeof(m));
+    return m;
+}
+
+static void storeMeta(const char* path, const MetaPageData& m){
+    std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+    out.seekp(PAGE_HEADER_SIZE);
+    out.write(reinterpret_cast<const char*>(&m), sizeof(m));
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("vectored read/write of contiguous pages", [](){
+        const char* path = "data/test_disk_io.db";
+        std::remove(path);
+        {
+            DiskManager dm(path);
+            std::vector<std::vector<char>> pages;
+            std::vector<const char*> wbufs;
+            for (page_id_t pid = 40; pid < 72; ++pid) pages.push_back(pageOf(pid));
+            for (auto& p : pages) wbufs.push_back(p.data());
+            ASSERT_TRUE(dm.WritePages(40, wbufs.data(), wbufs.size()) == Status::OK);
+            ASSERT_TRUE(dm.GetFileSize() >= 72ull * PAGE_SIZE);
+            ASSERT_TRUE(dm.GetNumPages() >= 72);
+
+            // 跨越文件末尾的批量读：末尾之后的页为全 0
+            std::vector<std::vector<char>> out(40, std::vector<char>(PAGE_SIZE, 'x'));
+            std::vector<char*> rbufs;
+            for (auto& p : out) rbufs.push_back(p.data());
+            ASSERT_TRUE(dm.ReadPages(50, rbufs.data(), rbufs.size()) == Status::OK);
+            for (page_id_t i = 0; i < 22; ++i) ASSERT_TRUE(pageIs(out[i].data(), 50 + i));
+            for (size_t i = 22; i < out.size(); ++i) ASSERT_TRUE(pageIs(out[i].data(), 0));
+
+            std::vector<char> one(PAGE_SIZE);
+            ASSERT_TRUE(dm.ReadPage(41, one.data()) == Status::OK);
+            ASSERT_TRUE(pageIs(one.data(), 41));
+        }
+        // 重新打开：文件大小与内容都保留
+        DiskManager dm(path);
+        ASSERT_TRUE(dm.GetFileSize() >= 72ull * PAGE_SIZE);
+        std::vector<char> one(PAGE_SIZE);
+        ASSERT_TRUE(dm.ReadPage(71, one.data()) == Status::OK);
+        ASSERT_TRUE(pageIs(one.data(), 71));
+    });
+
+    suite.addTest("concurrent page reads and writes", [](){
+        const char* path = "data/test_disk_io_concurrent.db";
+        std::remove(path);
+        DiskManager dm(path);
+        for (page_id_t pid = 1; pid <= 64; ++pid) {
+            auto p = pageOf(pid);
+            ASSERT_TRUE(dm.WritePage(pid, p.data()) == Status::OK);
+        }
+
+        // 读线程与写线程同时进行：读的页与写的页不重叠
+        std::vector<int> bad(5, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t](){
+                std::vector<char> buf(PAGE_SIZE);
+                for (int i = 0; i < 2000; ++i) {
+                    page_id_t pid = 1 + static_cast<page_id_t>((i * 7 + t * 13) % 64);
+                    if (dm.ReadPage(pid, buf.data()) != Status::OK || !pageIs(buf.data(), pid)) ++bad[t];
+                }
+            });
+        }
+        threads.emplace_back([&](){
+            for (page_id_t pid = 65; pid <= 128; ++pid) {
+                auto p = pageOf(pid);
+                if (dm.WritePageAsync(pid, p.data()).get() != Status::OK) ++bad[4];
+            }
+        });
+        for (auto& th : threads) th.join();
+        for (int b : bad) ASSERT_EQ(0, b);
+
+        std::vector<char> buf(PAGE_SIZE);
+        ASSERT_TRUE(dm.ReadPageAsync(128, buf.data()).get() == Status::OK);
+        ASSERT_TRUE(pageIs(buf.data(), 128));
+    });
+
+    suite.addTest("async page I/O via io_uring and the worker-thread fallback", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const bool saved = cfg.io_use_uring;
+        for (bool use_uring : {true, false}) {
+            cfg.io_use_uring = use_uring;
+            const char* path = "data/test_disk_io_async.db";
+            std::remove(path);
+            DiskManager dm(path);
+            if (use_uring && !dm.IsUsingIoUring()) {
+                std::cout << "  (io_uring unavailable, only the fallback path is checked)" << std::endl;
+                continue;
+            }
+            ASSERT_TRUE(dm.IsUsingIoUring() == use_uring);
+
+            // 模拟缓冲池帧数组：注册为固定缓冲区，批量写回
+            const page_id_t n = 64;
+            std::vector<char> frames(n * PAGE_SIZE);
+            dm.RegisterFrameBuffers(frames.data(), frames.size());
+            std::vector<page_id_t> ids;
+            std::vector<const char*> bufs;
+            for (page_id_t i = 0; i < n; ++i) {
+                auto p = pageOf(i + 1);
+                std::copy(p.begin(), p.end(), frames.begin() + i * PAGE_SIZE);
+                ids.push_back(i + 1);
+                bufs.push_back(frames.data() + i * PAGE_SIZE);
+            }
+            for (auto& f : dm.WritePagesAsync(ids, bufs)) ASSERT_TRUE(f.get() == Status::OK);
+            ASSERT_TRUE(dm.GetFileSize() >= (n + 1ull) * PAGE_SIZE);
+
+            // 读回：帧数组内（固定缓冲区）与普通缓冲区并发提交
+            std::fill(frames.begin(), frames.end(), 'x');
+            std::vector<int> bad(4, 0);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([&, t](){
+                    std::vector<char> own(PAGE_SIZE);
+                    for (page_id_t i = t; i < n; i += 4) {
+                        char* dst = (i % 2) ? own.data() : frames.data() + i * PAGE_SIZE;
+                        if (dm.ReadPageAsync(i + 1, dst).get() != Status::OK || !pageIs(dst, i + 1)) ++bad[t];
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+            for (int b : bad) ASSERT_EQ(0, b);
+
+            // 文件末尾之后的页为全 0
+            std::vector<char> beyond(PAGE_SIZE, 'x');
+            page_id_t past = static_cast<page_id_t>(dm.GetFileSize() / PAGE_SIZE + 8);
+            ASSERT_TRUE(dm.ReadPageAsync(past, beyond.data()).get() == Status::OK);
+            ASSERT_TRUE(pageIs(beyond.data(), 0));
+            ASSERT_TRUE(dm.ReadPageAsync(INVALID_PAGE_ID, beyond.data()).get() == Status::INVALID_PARAM);
+            dm.UnregisterFrameBuffers();
+        }
+        cfg.io_use_uring = saved;
+    });
+
+    suite.addTest("O_DIRECT: aligned frames direct, unaligned buffers bounced", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const bool saved = cfg.io_direct;
+        cfg.io_direct = true;
+        const char* path = "data/test_disk_io_direct.db";
+        std::remove(path);
+        {
+            DiskManager dm(path);
+            if (!dm.IsDirectIo()) {
+                std::cout << "  (O_DIRECT unsupported on this filesystem)" << std::endl;
+                cfg.io_direct = saved;
+                return;
+            }
+            ASSERT_TRUE(dm.SetCatalogRoot(7));
+            // 对齐的帧（与 Page::data_ 一样按 PAGE_SIZE 对齐）
+            struct alignas(PAGE_SIZE) Frame { char data[PAGE_SIZE]; };
+            std::vector<Frame> frames(8);
+            std::vector<const char*> wbufs;
+            for (page_id_t i = 0; i < 8; ++i) {
+                auto p = pageOf(10 + i);
+                std::copy(p.begin(), p.end(), frames[i].data);
+                wbufs.push_back(frames[i].data);
+            }
+            ASSERT_TRUE(dm.WritePages(10, wbufs.data(), wbufs.size()) == Status::OK);
+            ASSERT_TRUE(dm.WritePageAsync(20, frames[0].data).get() == Status::OK);
+
+            // 未对齐的缓冲区：读写都经中转缓冲区
+            std::vector<char> raw(PAGE_SIZE + 1);
+            char* odd = raw.data() + 1;
+            auto p = pageOf(30);
+            std::copy(p.begin(), p.end(), odd);
+            ASSERT_TRUE(dm.WritePage(30, odd) == Status::OK);
+            ASSERT_TRUE(dm.WritePageAsync(31, odd).get() == Status::OK);
+            std::fill(raw.begin(), raw.end(), 'x');
+            ASSERT_TRUE(dm.ReadPageAsync(30, odd).get() == Status::OK);
+            ASSERT_TRUE(pageIs(odd, 30));
+
+            std::vector<char*> rbufs = {odd};
+            ASSERT_TRUE(dm.ReadPages(12, rbufs.data(), 1) == Status::OK);
+            ASSERT_TRUE(pageIs(odd, 12));
+            for (auto& f : frames) std::fill(f.data, f.data + PAGE_SIZE, 'x');
+            std::vector<char*> abufs;
+            for (auto& f : frames) abufs.push_back(f.data);
+            ASSERT_TRUE(dm.ReadPages(10, abufs.data(), abufs.size()) == Status::OK);
+            for (page_id_t i = 0; i < 8; ++i) ASSERT_TRUE(pageIs(frames[i].data, 10 + i));
+        }
+        // 元数据页（中转缓冲区写入）在重新打开后可读
+        DiskManager dm(path);
+        ASSERT_EQ(7, (int)dm.GetCatalogRoot());
+        ASSERT_TRUE(dm.GetNumPages() >= 32);
+        std::vector<char> one(PAGE_SIZE);
+        ASSERT_TRUE(dm.ReadPage(31, one.data()) == Status::OK);
+        ASSERT_TRUE(pageIs(one.data(), 30));
+        cfg.io_direct = saved;
+    });
+
+    suite.addTest("extent allocation: contiguous per-segment runs survive reopen", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const size_t saved = cfg.alloc_extent_pages;
+        cfg.alloc_extent_pages = 64;
+        const char* path = "data/test_disk_io_extent.db";
+        std::remove(path);
+        page_id_t a, b, c;
+        {
+            DiskManager dm(path);
+            a = dm.AllocateExtentPage(INVALID_PAGE_ID);
+            b = dm.AllocateExtentPage(INVALID_PAGE_ID);
+            ASSERT_TRUE(a != INVALID_PAGE_ID);
+            ASSERT_TRUE(b >= a + 64);
+            // 两个段交替增长，各自的页仍然连续
+            page_id_t last_a = a, last_b = b;
+            for (int i = 1; i < 64; ++i) {
+                page_id_t pa = dm.AllocateExtentPage(last_a);
+                page_id_t pb = dm.AllocateExtentPage(last_b);
+                ASSERT_EQ(last_a + 1, pa);
+                ASSERT_EQ(last_b + 1, pb);
+                last_a = pa;
+                last_b = pb;
+            }
+            // 区用完后预留下一个区，仍归属段 a；逐页分配的页不在任何区中
+            c = dm.AllocateExtentPage(last_a);
+            ASSERT_TRUE(c >= b + 64);
+            ASSERT_EQ(c + 1, dm.AllocateExtentPage(a + 3));
+            ASSERT_EQ(a, dm.GetExtentOwner(c));
+            ASSERT_EQ(b, dm.GetExtentOwner(b + 63));
+            ASSERT_EQ(3, (int)dm.GetExtentCount());
+            page_id_t single = dm.AllocatePage();
+            ASSERT_TRUE(single >= c + 64);
+            ASSERT_TRUE(dm.GetExtentOwner(single) == INVALID_PAGE_ID);
+        }
+        // 重新打开：区目录随元数据恢复，段 a 从未用完的区里接着分配
+        DiskManager dm(path);
+        ASSERT_EQ(3, (int)dm.GetExtentCount());
+        ASSERT_EQ(a, dm.GetExtentOwner(c + 1));
+        ASSERT_EQ(c + 2, dm.AllocateExtentPage(c));
+        page_id_t d = dm.AllocateExtentPage(INVALID_PAGE_ID);
+        ASSERT_TRUE(d >= c + 64);
+        ASSERT_EQ(d, dm.GetExtentOwner(d));
+        cfg.alloc_extent_pages = saved;
+    });
+
+    suite.addTest("free-space map and free-page bitmap survive reopen", [](){
+        const char* path = "data/test_disk_io_fsm.db";
+        std::remove(path);
+        page_id_t seg, p2, x;
+        {
+            DiskManager dm(path);
+            seg = dm.AllocateExtentPage(INVALID_PAGE_ID);
+            p2 = dm.AllocateExtentPage(seg);
+            dm.RecordFreeSpace(seg, 100);
+            dm.RecordFreeSpace(p2, 3000);
+            ASSERT_EQ(p2, dm.FindPageWithSpace(seg, 2000));
+            ASSERT_TRUE(dm.FindPageWithSpace(seg, 3900) == INVALID_PAGE_ID);
+            ASSERT_TRUE(dm.FindPageWithSpace(dm.AllocateExtentPage(INVALID_PAGE_ID), 10) == INVALID_PAGE_ID);
+
+            x = dm.AllocatePage();
+            dm.AllocatePage();
+            dm.DeallocatePage(x);
+            dm.DeallocatePage(x);
+            ASSERT_EQ(1, (int)dm.GetFreePageCount());
+        }
+        {
+            DiskManager dm(path);
+            ASSERT_EQ(1, (int)dm.GetFreePageCount());
+            ASSERT_EQ(p2, dm.FindPageWithSpace(p2, 2000));
+            ASSERT_EQ(x, dm.AllocatePage());
+            ASSERT_EQ(0, (int)dm.GetFreePageCount());
+            dm.RecordFreeSpace(p2, 10);
+            ASSERT_TRUE(dm.FindPageWithSpace(seg, 2000) == INVALID_PAGE_ID);
+        }
+        DiskManager dm(path);
+        ASSERT_EQ(0, (int)dm.GetFreePageCount());
+        ASSERT_TRUE(dm.AllocatePage() != x);
+        ASSERT_TRUE(dm.FindPageWithSpace(seg, 2000) == INVALID_PAGE_ID);
+    });
+
+    suite.addTest("worker batch: adjacent page ids coalesce into vectored I/O", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const bool saved = cfg.io_use_uring;
+        cfg.io_use_uring = false;
+        const char* path = "data/test_disk_io_merge.db";
+        std::remove(path);
+        {
+            DiskManager dm(path);
+            ASSERT_TRUE(!dm.IsUsingIoUring());
+            // 倒序提交 10..49，再夹两个不相邻的页：排序后 10..49 合并为一次 pwritev
+            std::vector<std::vector<char>> pages;
+            std::vector<page_id_t> ids;
+            for (page_id_t pid = 49; pid >= 10; --pid) ids.push_back(pid);
+            ids.push_back(100);
+            ids.push_back(102);
+            for (page_id_t pid : ids) pages.push_back(pageOf(pid));
+            std::vector<const char*> bufs;
+            for (auto& p : pages) bufs.push_back(p.data());
+            for (auto& f : dm.WritePagesAsync(ids, bufs)) ASSERT_TRUE(f.get() == Status::OK);
+            ASSERT_EQ(1, (int)dm.GetMergedRuns());
+            ASSERT_EQ(40, (int)dm.GetMaxMergedRun());
+            ASSERT_EQ(42, (int)dm.GetWriteOps());
+
+            std::vector<std::vector<char>> out(40, std::vector<char>(PAGE_SIZE));
+            std::vector<char*> rbufs;
+            for (auto& o : out) rbufs.push_back(o.data());
+            ASSERT_TRUE(dm.ReadPages(10, rbufs.data(), rbufs.size()) == Status::OK);
+            for (page_id_t i = 0; i < 40; ++i) ASSERT_TRUE(pageIs(out[i].data(), 10 + i));
+            std::vector<char> one(PAGE_SIZE);
+            ASSERT_TRUE(dm.ReadPageAsync(102, one.data()).get() == Status::OK);
+            ASSERT_TRUE(pageIs(one.data(), 102));
+        }
+        cfg.io_use_uring = saved;
+    });
+
+    suite.addTest("default config: adjacent page ids coalesce on the io_uring path", [](){
+        const char* path = "data/test_disk_io_merge_uring.db";
+        std::remove(path);
+        DiskManager dm(path);
+        if (!dm.IsUsingIoUring())
+            std::cout << "  (io_uring unavailable, the worker-thread path is checked instead)" << std::endl;
+        // 与上例相同的批：倒序 10..49 合并为一段，100 与 102 各自单独写
+        std::vector<std::vector<char>> pages;
+        std::vector<page_id_t> ids;
+        for (page_id_t pid = 49; pid >= 10; --pid) ids.push_back(pid);
+        ids.push_back(100);
+        ids.push_back(102);
+        for (page_id_t pid : ids) pages.push_back(pageOf(pid));
+        std::vector<const char*> bufs;
+        for (auto& p : pages) bufs.push_back(p.data());
+        for (auto& f : dm.WritePagesAsync(ids, bufs)) ASSERT_TRUE(f.get() == Status::OK);
+        ASSERT_EQ(1, (int)dm.GetMergedRuns());
+        ASSERT_EQ(40, (int)dm.GetMaxMergedRun());
+        ASSERT_EQ(42, (int)dm.GetWriteOps());
+        ASSERT_TRUE(dm.GetFileSize() >= 103ull * PAGE_SIZE);
+
+        std::vector<char> one(PAGE_SIZE);
+        for (page_id_t pid : ids) {
+            ASSERT_TRUE(dm.ReadPageAsync(pid, one.data()).get() == Status::OK);
+            ASSERT_TRUE(pageIs(one.data(), pid));
+        }
+    });
+
+    suite.addTest("file growth: chunked preallocation with persisted high-water mark", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const RuntimeConfig saved = cfg;
+        cfg.file_grow_min_bytes = 64 * PAGE_SIZE;
+        cfg.file_grow_max_bytes = 256 * PAGE_SIZE;
+        cfg.file_grow_percent = 50;
+        const char* path = "data/test_disk_io_grow.db";
+        std::remove(path);
+        uint64_t hwm = 0;
+        {
+            DiskManager dm(path);
+            // 新文件第一次写入（元数据页）即分配一整块
+            ASSERT_EQ(64ull * PAGE_SIZE, dm.GetAllocatedBytes());
+            for (page_id_t i = 1; i <= 300; ++i)
+                ASSERT_TRUE(dm.WritePage(i, pageOf(i).data()) == Status::OK);
+            // 64 -> 128 -> 192 -> 288 -> 432 页：写满 300 页共增长 5 次（含第一块）
+            ASSERT_EQ(5, (int)dm.GetFileGrowCount());
+            hwm = dm.GetAllocatedBytes();
+            ASSERT_EQ(432ull * PAGE_SIZE, hwm);
+            ASSERT_EQ(hwm, dm.GetFileSize());
+            // 高水位以内、未写过的页为全 0
+            std::vector<char> buf(PAGE_SIZE, 'x');
+            ASSERT_TRUE(dm.ReadPage(400, buf.data()) == Status::OK);
+            ASSERT_TRUE(pageIs(buf.data(), 0));
+        }
+        DiskManager dm(path);
+        MetaPageData meta{};
+        ASSERT_TRUE(dm.GetMetaInfo(meta));
+        ASSERT_EQ(hwm, meta.allocated_bytes);
+        ASSERT_EQ(hwm, dm.GetAllocatedBytes());
+        ASSERT_EQ(0, (int)dm.GetFileGrowCount());
+        cfg = saved;
+    });
+
+    suite.addTest("meta: background persist races foreground catalog root updates", [](){
+        const char* path = "data/test_disk_io_meta.db";
+        std::remove(path);
+        {
+            DiskManager dm(path);
+            std::atomic<bool> done{false};
+            std::thread flusher([&](){
+                while (!done.load()) dm.PersistMeta();
+            });
+            for (page_id_t root = 1; root <= 200; ++root)
+                ASSERT_TRUE(dm.SetCatalogRoot(root));
+            done.store(true);
+            flusher.join();
+            ASSERT_TRUE(dm.PersistMeta());
+
+            // 调用方带着旧的 next_page_id 写回元数据，不能把已分配的页号退回去
+            for (int i = 0; i < 10; ++i) dm.AllocatePage();
+            const page_id_t next = static_cast<page_id_t>(dm.GetNumPages());
+            MetaPageData meta{};
+            ASSERT_TRUE(dm.GetMetaInfo(meta));
+            meta.next_page_id = 1;
+            ASSERT_TRUE(dm.SetMetaInfo(meta));
+            ASSERT_EQ((int)next, (int)dm.GetNumPages());
+        }
+        DiskManager dm(path);
+        ASSERT_EQ(200, (int)dm.GetCatalogRoot());
+    });
+
+    suite.addTest("meta: checksum covers every persisted field, legacy pages still load", [](){
+        const char* path = "data/test_disk_io_meta_crc.db";
+        std::remove(path);
+        {
+            DiskManager dm(path);
+            ASSERT_TRUE(dm.SetCatalogRoot(7));
+        }
+        const MetaPageData good = loadMeta(path);
+        ASSERT_TRUE(good.allocated_bytes > 0);
+
+        // 撕裂的写改掉了空闲空间映射首页：整页被拒绝，按新库重新初始化
+        MetaPageData bad = good;
+        bad.reserved[20] ^= 0x5A;
+        storeMeta(path, bad);
+        {
+            DiskManager dm(path);
+            ASSERT_EQ((int)INVALID_PAGE_ID, (int)dm.GetCatalogRoot());
+        }
+
+        // 旧格式：只校验前五个字段，后加的字段全为 0
+        MetaPageData legacy{};
+        legacy.magic = META_MAGIC;
+        legacy.version = META_VERSION;
+        legacy.page_size = PAGE_SIZE;
+        legacy.next_page_id = 5;
+        legacy.catalog_root = 3;
+        uint32_t crc = 0;
+        crc = checksum::MixField(crc, legacy.magic);
+        crc = checksum::MixField(crc, legacy.version);
+        crc = checksum::MixField(crc, legacy.page_size);
+        crc = checksum::MixField(crc, legacy.next_page_id);
+        crc = checksum::MixField(crc, legacy.catalog_root);
+        std::memcpy(legacy.reserved + 8, &crc, sizeof(crc));
+        storeMeta(path, legacy);
+        {
+            DiskManager dm(path);
+            ASSERT_EQ(3, (int)dm.GetCatalogRoot());
+        }
+
+        // 旧格式的校验放在新格式的页上不被接受
+        MetaPageData mixed = good;
+        std::memcpy(mixed.reserved + 8, &crc, sizeof(crc));
+        storeMeta(path, mixed);
+        DiskManager dm(path);
+        ASSERT_EQ((int)INVALID_PAGE_ID, (int)dm.GetCatalogRoot());
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,68 @@
+#include "../test_helpers.h"
+#include "../../src/engine/operators/sort_operator.h"
+
+using namespace minidb;
+using namespace SimpleTest;
+using namespace TestHelpers;
+
+// t(k INT, d DOUBLE, seq INT)：k 有大量重复，seq 为输入顺序，用于检查稳定性
+static std::unique_ptr<PhysicalOperator> input(int n){
+    return std::make_unique<MaterializedOperator>([n](){
+        std::vector<Row> rows;
+        for (int i = 0; i < n; ++i) {
+            Row r;
+            r.columns.push_back({"k", std::to_string((i * 7919) % 97)});
+            r.columns.push_back({"d", std::to_string(((i * 31) % 13) * 0.25)});
+            r.columns.push_back({"seq", std::to_string(i)});
+            rows.push_back(std::move(r));
+        }
+        return rows;
+    });
+}
+
+// 按 (k ASC 或 DESC, d 同向) 检查有序且相等键保持输入顺序
+static void checkSorted(const std::vector<Row>& rows, int n, bool desc){
+    ASSERT_EQ(n, (int)rows.size());
+    for (size_t i = 1; i < rows.size(); ++i) {
+        int ka = std::stoi(rows[i - 1].getValue("k")), kb = std::stoi(rows[i].getValue("k"));
+        double da = std::stod(rows[i - 1].getValue("d")), db = std::stod(rows[i].getValue("d"));
+        if (ka == kb && da == db)
+            ASSERT_TRUE(std::stoi(rows[i - 1].getValue("seq")) < std::stoi(rows[i].getValue("seq")));
+        else if (ka == kb)
+            ASSERT_TRUE(desc ? da > db : da < db);
+        else
+            ASSERT_TRUE(desc ? ka > kb : ka < kb);
+    }
+}
+
+static std::vector<SortKeySpec> keys(bool desc){
+    return {{"k", ValueType::Int, desc}, {"d", ValueType::Double, desc}};
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("external sort: in-memory, typed multi-key, stable", [](){
+        ExternalSortOperator asc(input(2000), keys(false), nullptr, 64 * 1024 * 1024);
+        checkSorted(drain(asc), 2000, false);
+        ASSERT_EQ(0, (int)asc.GetRunCount());
+
+        ExternalSortOperator desc(input(2000), keys(true), nullptr, 64 * 1024 * 1024);
+        checkSorted(drain(desc), 2000, true);
+    });
+
+    suite.addTest("external sort: spilled runs, multi-pass merge", [](){
+        StorageEngine se("data/test_external_sort.db", 32);
+        // 小预算产生数十个段，归并路数设为 4 以触发多趟归并
+        ExternalSortOperator op(input(3000), keys(false), &se, 32 * 1024, 4);
+        checkSorted(drain(op), 3000, false);
+        ASSERT_TRUE(op.GetRunCount() > 16);
+
+        ExternalSortOperator desc(input(3000), keys(true), &se, 128 * 1024);
+        checkSorted(drain(desc), 3000, true);
+        ASSERT_TRUE(desc.GetRunCount() > 1);
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,92 @@
+#include "../simple_test_framework.h"
+#include "../../src/engine/operators/hash_aggregate_operator.h"
+
+#include <cmath>
+#include <map>
+
+using namespace minidb;
+using namespace SimpleTest;
+
+// t(g INT, v INT, d DOUBLE, s VARCHAR)：1000 行，g = i % 100，每隔 10 行 v 为空
+static std::unique_ptr<PhysicalOperator> input(){
+    return std::make_unique<MaterializedOperator>([](){
+        std::vector<Row> rows;
+        for (int i = 0; i < 1000; ++i) {
+            Row r;
+            r.columns.push_back({"g", std::to_string(i % 100)});
+            r.columns.push_back({"v", i % 10 == 9 ? "" : std::to_string(i)});
+            r.columns.push_back({"d", std::to_string(i * 0.5)});
+            r.columns.push_back({"s", "s" + std::to_string(i)});
+            rows.push_back(std::move(r));
+        }
+        return rows;
+    });
+}
+
+static std::unique_ptr<HashAggregateOperator> makeAgg(StorageEngine* se, size_t max_groups){
+    std::vector<AggregateExpr> aggs = {
+        {"COUNT", "v", ""}, {"SUM", "v", "total"}, {"AVG", "d", ""},
+        {"MIN", "v", ""}, {"MAX", "s", ""}};
+    std::vector<ValueType> agg_types = {ValueType::Int, ValueType::Int, ValueType::Double,
+                                        ValueType::Int, ValueType::String};
+    return std::make_unique<HashAggregateOperator>(input(), std::vector<std::string>{"g"},
+        std::vector<ValueType>{ValueType::Int}, aggs, agg_types, se, max_groups);
+}
+
+static void checkGroups(HashAggregateOperator& op){
+    std::map<int, Row> groups;
+    op.Open();
+    Row row;
+    while (op.Next(row)) {
+        int g = std::stoi(row.getValue("g"));
+        ASSERT_TRUE(groups.find(g) == groups.end()); // 每组只输出一次
+        groups[g] = row;
+    }
+    op.Close();
+    ASSERT_EQ(100, (int)groups.size());
+
+    for (auto& [g, r] : groups) {
+        long long sum = 0, min_v = -1;
+        double dsum = 0;
+        std::string max_s;
+        for (int i = g; i < 1000; i += 100) {
+            if (i % 10 != 9) {
+                sum += i;
+                if (min_v < 0) min_v = i;
+            }
+            dsum += i * 0.5;
+            std::string s = "s" + std::to_string(i);
+            if (s > max_s) max_s = s;
+        }
+        ASSERT_EQ(10, std::stoi(r.getValue("COUNT(v)")));
+        ASSERT_EQ(sum, std::stoll(r.getValue("total")));
+        ASSERT_TRUE(std::abs(std::stod(r.getValue("AVG(d)")) - dsum / 10) < 1e-6);
+        ASSERT_TRUE(r.getValue("MIN(v)") == (min_v < 0 ? "" : std::to_string(min_v)));
+        ASSERT_TRUE(r.getValue("MAX(s)") == max_s);
+    }
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("hash aggregate: in-memory groups", [](){
+        auto op = makeAgg(nullptr, 1 << 20);
+        checkGroups(*op);
+        ASSERT_FALSE(op->IsSpilled());
+        auto cols = op->OutputColumns();
+        ASSERT_EQ(6, (int)cols.size());
+        ASSERT_TRUE(cols[2] == "total");
+    });
+
+    suite.addTest("hash aggregate: spills new groups past the group budget", [](){
+        StorageEngine se("data/test_hash_aggregate_spill.db", 16);
+        auto op = makeAgg(&se, 8);
+        checkGroups(*op);
+        ASSERT_TRUE(op->IsSpilled());
+        // 重复 Open 结果一致
+        checkGroups(*op);
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
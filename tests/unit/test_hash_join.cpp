@@ -0,0 +1,157 @@
+#include "../test_helpers.h"
+#include "../../src/engine/operators/hash_join_operator.h"
+#include "../../src/util/config.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+using namespace minidb;
+using namespace SimpleTest;
+using namespace TestHelpers;
+
+static Row makeRow(const std::vector<std::pair<std::string, std::string>>& cols){
+    Row r;
+    for (auto& c : cols) r.columns.push_back({c.first, c.second});
+    return r;
+}
+
+// 左表 l(k, lv) 200 行，k = i % 50；右表 r(k, rv) 50 行加一行空键
+static std::unique_ptr<PhysicalOperator> leftInput(){
+    return std::make_unique<MaterializedOperator>([](){
+        std::vector<Row> rows;
+        for (int i = 0; i < 200; ++i)
+            rows.push_back(makeRow({{"l.k", std::to_string(i % 50)}, {"l.lv", "left" + std::to_string(i)}}));
+        return rows;
+    });
+}
+
+static std::unique_ptr<PhysicalOperator> rightInput(){
+    return std::make_unique<MaterializedOperator>([](){
+        std::vector<Row> rows;
+        for (int i = 0; i < 50; ++i)
+            rows.push_back(makeRow({{"r.k", std::to_string(i)}, {"r.rv", "right" + std::to_string(i)}}));
+        rows.push_back(makeRow({{"r.k", ""}, {"r.rv", "null-key"}}));
+        return rows;
+    });
+}
+
+static void checkJoined(const std::vector<Row>& rows){
+    ASSERT_EQ(200, (int)rows.size());
+    for (auto& r : rows) {
+        ASSERT_EQ(4, (int)r.columns.size());
+        ASSERT_TRUE(r.columns[0].col_name == "l.k"); // 左列在前
+        ASSERT_TRUE(r.getValue("l.k") == r.getValue("r.k"));
+        ASSERT_TRUE("right" + r.getValue("r.k") == r.getValue("r.rv"));
+    }
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("hash join: in-memory, either build side", [](){
+        JoinKeySpec key{"l.k", "r.k", ValueType::Int};
+        HashJoinOperator build_right(leftInput(), rightInput(), key, false, nullptr, 64 * 1024 * 1024);
+        checkJoined(drain(build_right));
+        ASSERT_FALSE(build_right.IsSpilled());
+
+        HashJoinOperator build_left(leftInput(), rightInput(), key, true, nullptr, 64 * 1024 * 1024);
+        checkJoined(drain(build_left));
+    });
+
+    suite.addTest("hash join: spills partitions to temp pages", [](){
+        StorageEngine se("data/test_hash_join_spill.db", 16);
+        JoinKeySpec key{"l.k", "r.k", ValueType::Int};
+        HashJoinOperator op(leftInput(), rightInput(), key, true, &se, 1024);
+        checkJoined(drain(op));
+        ASSERT_TRUE(op.IsSpilled());
+    });
+
+    suite.addTest("hash join: recursive re-partitioning keeps the table within budget", [](){
+        std::remove("data/test_hash_join_recursive.db");
+        StorageEngine se("data/test_hash_join_recursive.db", 16);
+        JoinKeySpec key{"l.k", "r.k", ValueType::Int};
+        // 左表 1200 个不同键外加 200 行同键（-1）；右表 600 个键各两行，-1 也有两行
+        auto left = [](){
+            return std::make_unique<MaterializedOperator>([](){
+                std::vector<Row> rows;
+                for (int i = 0; i < 1400; ++i)
+                    rows.push_back(makeRow({{"l.k", std::to_string(i < 1200 ? i : -1)}, {"l.lv", "left" + std::to_string(i)}}));
+                return rows;
+            });
+        };
+        auto right = [](){
+            return std::make_unique<MaterializedOperator>([](){
+                std::vector<Row> rows;
+                for (int i = 0; i < 1200; ++i)
+                    rows.push_back(makeRow({{"r.k", std::to_string(i % 600)}, {"r.rv", "right" + std::to_string(i)}}));
+                for (int i = 0; i < 2; ++i)
+                    rows.push_back(makeRow({{"r.k", "-1"}, {"r.rv", "heavy" + std::to_string(i)}}));
+                return rows;
+            });
+        };
+        auto pairs = [](PhysicalOperator& op){
+            std::vector<std::pair<std::string, std::string>> out;
+            for (auto& r : drain(op)) out.emplace_back(r.getValue("l.lv"), r.getValue("r.rv"));
+            std::sort(out.begin(), out.end());
+            return out;
+        };
+
+        HashJoinOperator in_memory(left(), right(), key, true, nullptr, 64 * 1024 * 1024);
+        auto expected = pairs(in_memory);
+        ASSERT_EQ(1200 + 200 * 2, (int)expected.size());
+
+        size_t saved = GetRuntimeConfig().exec_join_memory_bytes;
+        GetRuntimeConfig().exec_join_memory_bytes = 4096;
+        const size_t budget = GetRuntimeConfig().exec_join_memory_bytes;
+        HashJoinOperator op(left(), right(), key, true, &se, budget);
+        ASSERT_TRUE(pairs(op) == expected);
+        ASSERT_TRUE(op.IsSpilled());
+        ASSERT_TRUE(op.GetSpillDepth() >= 1);  // 16 个第一层分区仍超出预算
+        ASSERT_TRUE(op.UsedNestedLoop());      // 单个键的 200 行无法再分
+        ASSERT_TRUE(op.GetPeakTableBytes() <= budget + 256); // 至多超出一行
+        // 重复 Open 结果一致
+        ASSERT_TRUE(pairs(op) == expected);
+        GetRuntimeConfig().exec_join_memory_bytes = saved;
+    });
+
+    suite.addTest("hash join: SQL join, with and without spilling", [](){
+        StorageEngine se("data/test_hash_join.db", 64);
+        Catalog catalog(&se);
+        catalog.LoadFromStorage();
+        AuthService auth(&se, &catalog);
+        auth.login("root", "root");
+
+        try { runSQL(&catalog, &se, &auth, "DROP TABLE emp;"); } catch(...) {}
+        try { runSQL(&catalog, &se, &auth, "DROP TABLE dept;"); } catch(...) {}
+        runSQL(&catalog, &se, &auth, "CREATE TABLE emp(id INT, name VARCHAR(16), dept INT);");
+        runSQL(&catalog, &se, &auth, "CREATE TABLE dept(id INT, dname VARCHAR(16));");
+        for (int i = 0; i < 40; ++i)
+            runSQL(&catalog, &se, &auth, "INSERT INTO emp(id,name,dept) VALUES (" + std::to_string(i) +
+                   ",'e" + std::to_string(i) + "'," + std::to_string(i % 5) + ");");
+        for (int d = 0; d < 4; ++d) // dept 4 无对应部门
+            runSQL(&catalog, &se, &auth, "INSERT INTO dept(id,dname) VALUES (" + std::to_string(d) + ",'d" + std::to_string(d) + "');");
+
+        auto check = [](const std::vector<Row>& rows){
+            ASSERT_EQ(32, (int)rows.size());
+            std::map<std::string, int> per_dept;
+            for (auto& r : rows) {
+                ASSERT_TRUE(r.getValue("emp.dept") == r.getValue("dept.id"));
+                ASSERT_TRUE("d" + r.getValue("dept.id") == r.getValue("dept.dname"));
+                ++per_dept[r.getValue("dept.id")];
+            }
+            ASSERT_EQ(4, (int)per_dept.size());
+        };
+
+        check(runSQL(&catalog, &se, &auth, "SELECT * FROM emp JOIN dept ON emp.dept = dept.id;"));
+        check(runSQL(&catalog, &se, &auth, "SELECT * FROM emp JOIN dept ON dept.id = emp.dept;"));
+
+        size_t saved = GetRuntimeConfig().exec_join_memory_bytes;
+        GetRuntimeConfig().exec_join_memory_bytes = 256;
+        check(runSQL(&catalog, &se, &auth, "SELECT * FROM emp JOIN dept ON emp.dept = dept.id;"));
+        GetRuntimeConfig().exec_join_memory_bytes = saved;
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,168 @@
+#include "../test_helpers.h"
+#include "../../src/engine/operators/sort_operator.h"
+#include "../../src/optimizer/plan_optimizer.h"
+
+#include <filesystem>
+
+using namespace minidb;
+using namespace SimpleTest;
+using namespace TestHelpers;
+
+// 记录被拉取了多少行的数据源
+class CountingSource : public PhysicalOperator {
+public:
+    CountingSource(int n, int* pulled) : n_(n), pulled_(pulled) {}
+    void Open() override { i_ = 0; }
+    bool Next(Row& out) override {
+        if (i_ >= n_) return false;
+        ++*pulled_;
+        out.columns = {{"v", std::to_string((i_ * 37) % 101)}, {"seq", std::to_string(i_)}};
+        ++i_;
+        return true;
+    }
+    void Close() override {}
+private:
+    int n_, i_{0};
+    int* pulled_;
+};
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("limit: operator stops pulling once satisfied", [](){
+        int pulled = 0;
+        LimitOperator op(std::make_unique<CountingSource>(1000, &pulled), 10, 5);
+        op.Open();
+        Row row;
+        int n = 0;
+        while (op.Next(row)) ASSERT_EQ(5 + n++, std::stoi(row.getValue("seq")));
+        op.Close();
+        ASSERT_EQ(10, n);
+        ASSERT_EQ(15, pulled);
+
+        pulled = 0;
+        LimitOperator zero(std::make_unique<CountingSource>(1000, &pulled), 0, 0);
+        zero.Open();
+        ASSERT_FALSE(zero.Next(row));
+        zero.Close();
+        ASSERT_EQ(0, pulled);
+    });
+
+    suite.addTest("limit: top-n matches the full sort prefix", [](){
+        int pulled = 0;
+        std::vector<SortKeySpec> keys = {{"v", ValueType::Int, true}};
+        ExternalSortOperator full(std::make_unique<CountingSource>(500, &pulled), keys, nullptr, 1 << 30);
+        TopNOperator top(std::make_unique<CountingSource>(500, &pulled), keys, 20);
+        std::vector<std::string> a, b;
+        Row row;
+        full.Open();
+        while (a.size() < 20 && full.Next(row)) a.push_back(row.getValue("seq"));
+        full.Close();
+        top.Open();
+        while (top.Next(row)) b.push_back(row.getValue("seq"));
+        top.Close();
+        ASSERT_EQ(20, (int)b.size());
+        ASSERT_TRUE(a == b);
+    });
+
+    suite.addTest("limit: SQL LIMIT / OFFSET and optimizer pushdown", [](){
+        StorageEngine se("data/test_limit.db", 64);
+        Catalog catalog(&se);
+        catalog.LoadFromStorage();
+        AuthService auth(&se, &catalog);
+        auth.login("root", "root");
+
+        try { runSQL(&catalog, &se, &auth, "DROP TABLE orders;"); } catch(...) {}
+        runSQL(&catalog, &se, &auth, "CREATE TABLE orders(id INT, amount INT);");
+        for (int i = 0; i < 40; ++i)
+            runSQL(&catalog, &se, &auth, "INSERT INTO orders(id,amount) VALUES (" + std::to_string(i) + "," +
+                   std::to_string((i * 13) % 40) + ");");
+
+        ASSERT_EQ(7, (int)runSQL(&catalog, &se, &auth, "SELECT * FROM orders LIMIT 7;").size());
+        ASSERT_EQ(5, (int)runSQL(&catalog, &se, &auth, "SELECT id FROM orders LIMIT 10 OFFSET 35;").size());
+        ASSERT_EQ(0, (int)runSQL(&catalog, &se, &auth, "SELECT * FROM orders LIMIT 0;").size());
+
+        auto top = runSQL(&catalog, &se, &auth, "SELECT * FROM orders ORDER BY amount DESC LIMIT 3 OFFSET 1;");
+        ASSERT_EQ(3, (int)top.size());
+        ASSERT_EQ(38, std::stoi(top[0].getValue("amount")));
+        ASSERT_EQ(36, std::stoi(top[2].getValue("amount")));
+
+        // Limit(Project(Filter/SeqScan)) -> Project(Limit(...))
+        auto plan = OptimizePlan(planSQL(&catalog, "SELECT id FROM orders WHERE amount > 10 LIMIT 4;"));
+        ASSERT_TRUE(plan->type == PlanType::Project);
+        ASSERT_TRUE(plan->children[0]->type == PlanType::Limit);
+        auto rows = runPlan(&catalog, &se, &auth, plan.get());
+        ASSERT_EQ(4, (int)rows.size());
+
+        // Limit(OrderBy) -> OrderBy 带 Top-N 提示
+        auto sorted = OptimizePlan(planSQL(&catalog, "SELECT * FROM orders ORDER BY amount LIMIT 5 OFFSET 2;"));
+        ASSERT_TRUE(sorted->type == PlanType::Limit);
+        ASSERT_EQ(7, (int)sorted->children[0]->limit);
+
+        // 只做 Limit 下推的入口给出同样的提示；执行器只读取提示，不改写计划
+        auto hinted = PushDownLimits(planSQL(&catalog, "SELECT * FROM orders ORDER BY amount LIMIT 5 OFFSET 2;"));
+        ASSERT_EQ(7, (int)hinted->children[0]->limit);
+        auto unhinted = planSQL(&catalog, "SELECT * FROM orders ORDER BY amount LIMIT 5 OFFSET 2;");
+        ASSERT_EQ(5, (int)runPlan(&catalog, &se, &auth, unhinted.get()).size());
+        ASSERT_TRUE(unhinted->children[0]->limit < 0);
+
+        // offset + limit 超过排序内存预算能容纳的行数：不用 Top-N 堆，外部排序后由 Limit 截取
+        {
+            RuntimeConfig& cfg = GetRuntimeConfig();
+            const size_t saved = cfg.exec_sort_memory_bytes;
+            cfg.exec_sort_memory_bytes = 1024;
+            ASSERT_TRUE(TopNRowBound(catalog.GetTable("orders"), 1, cfg.exec_sort_memory_bytes) < 23);
+            auto all = runSQL(&catalog, &se, &auth, "SELECT * FROM orders ORDER BY amount;");
+            auto page = runSQL(&catalog, &se, &auth, "SELECT * FROM orders ORDER BY amount LIMIT 20 OFFSET 3;");
+            cfg.exec_sort_memory_bytes = saved;
+            ASSERT_EQ(40, (int)all.size());
+            ASSERT_EQ(20, (int)page.size());
+            for (int i = 0; i < 20; ++i)
+                ASSERT_TRUE(page[i].getValue("amount") == all[i + 3].getValue("amount"));
+        }
+
+        // 超出 long long 的行数是语法错误；offset + limit 溢出时不加 Top-N 提示，照常全量排序
+        bool rejected = false;
+        try { planSQL(&catalog, "SELECT * FROM orders LIMIT 99999999999999999999;"); }
+        catch (const ParseError&) { rejected = true; }
+        ASSERT_TRUE(rejected);
+        const std::string huge = "SELECT * FROM orders ORDER BY amount LIMIT 9223372036854775807 OFFSET 38;";
+        auto unbounded = OptimizePlan(planSQL(&catalog, huge));
+        ASSERT_TRUE(unbounded->children[0]->limit < 0);
+        ASSERT_EQ(2, (int)runSQL(&catalog, &se, &auth, huge).size());
+    });
+
+    suite.addTest("limit: SQL LIMIT over a multi-page table reads only the pages it needs", [](){
+        std::filesystem::remove_all("data/test_limit_pages.db");
+        std::filesystem::remove_all("data/test_limit_pages.db.wal");
+        StorageEngine se("data/test_limit_pages.db", 256);
+        Catalog catalog(&se);
+        catalog.LoadFromStorage();
+        AuthService auth(&se, &catalog);
+        auth.login("root", "root");
+
+        // 默认扫描配置（并行扫描、向量化）；每行约 200 字节，表远多于一个 morsel
+        try { runSQL(&catalog, &se, &auth, "DROP TABLE wide;"); } catch(...) {}
+        runSQL(&catalog, &se, &auth, "CREATE TABLE wide(id INT, pad VARCHAR);");
+        const std::string pad(200, 'x');
+        for (int i = 0; i < 6000; i += 50) {
+            std::string sql = "INSERT INTO wide(id,pad) VALUES ";
+            for (int k = i; k < i + 50; ++k)
+                sql += (k > i ? "," : "") + std::string("(") + std::to_string(k) + ",'" + pad + "')";
+            runSQL(&catalog, &se, &auth, sql + ";");
+        }
+
+        size_t before = se.GetNumPageAccesses();
+        ASSERT_EQ(6000, (int)runSQL(&catalog, &se, &auth, "SELECT * FROM wide;").size());
+        const size_t full = se.GetNumPageAccesses() - before;
+        before = se.GetNumPageAccesses();
+        ASSERT_EQ(5, (int)runSQL(&catalog, &se, &auth, "SELECT * FROM wide LIMIT 5;").size());
+        const size_t limited = se.GetNumPageAccesses() - before;
+        // 页链读取与解码各取一次页：整表约两倍页数；LIMIT 只碰到第一个 morsel
+        ASSERT_TRUE(full > 150);
+        ASSERT_TRUE(limited * 4 < full);
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,151 @@
+#include "../simple_test_framework.h"
+#include "../../src/storage/storage_engine.h"
+#include "../../src/storage/page/disk_manager.h"
+#include "../../src/storage/page/page_utils.h"
+#include "../../src/util/lz_codec.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace minidb;
+using namespace SimpleTest;
+
+// 不可压缩的内容：简单线性同余序列
+static void fillRandom(char* buf, size_t n, uint32_t seed){
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = static_cast<char>(seed >> 16);
+    }
+}
+
+// 像定长 VARCHAR 那样：短文本后面补 NUL
+static void fillPadded(char* buf, size_t n, uint32_t pid){
+    std::memset(buf, 0, n);
+    for (size_t off = 0; off + 64 <= n; off += 64) {
+        std::string s = "row-" + std::to_string(pid) + "-" + std::to_string(off / 64);
+        std::memcpy(buf + off, s.data(), s.size());
+    }
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("lz codec: roundtrip, incompressible input and corrupt input", [](){
+        std::vector<char> src(PAGE_SIZE), out(PAGE_SIZE), dst(lz::MaxCompressedSize(PAGE_SIZE));
+        fillPadded(src.data(), src.size(), 7);
+        size_t n = lz::Compress(src.data(), src.size(), dst.data(), dst.size());
+        ASSERT_TRUE(n > 0 && n < PAGE_SIZE / 4);
+        ASSERT_TRUE(lz::Decompress(dst.data(), n, out.data(), out.size()));
+        ASSERT_TRUE(std::memcmp(src.data(), out.data(), src.size()) == 0);
+        // 长度不符、截断的输入都被拒绝
+        ASSERT_FALSE(lz::Decompress(dst.data(), n, out.data(), out.size() - 1));
+        ASSERT_FALSE(lz::Decompress(dst.data(), n / 2, out.data(), out.size()));
+
+        fillRandom(src.data(), src.size(), 42);
+        ASSERT_EQ(0, (int)lz::Compress(src.data(), src.size(), dst.data(), PAGE_SIZE - 32));
+        n = lz::Compress(src.data(), src.size(), dst.data(), dst.size());
+        ASSERT_TRUE(n > 0);
+        ASSERT_TRUE(lz::Decompress(dst.data(), n, out.data(), out.size()));
+        ASSERT_TRUE(std::memcmp(src.data(), out.data(), src.size()) == 0);
+    });
+
+    suite.addTest("compressed database: NUL-padded rows shrink on disk and reopen keeps the format", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const bool saved = cfg.page_compression;
+        cfg.page_compression = true;
+        const char* path = "data/test_page_compression.db";
+        std::remove(path);
+        std::vector<page_id_t> pids;
+        {
+            StorageEngine se(path, 16);
+            ASSERT_TRUE(se.IsCompressed());
+            std::vector<char> rec(100, 0);
+            for (int p = 0; p < 60; ++p) {
+                page_id_t pid = INVALID_PAGE_ID;
+                Page* page = se.CreateDataPage(&pid);
+                ASSERT_TRUE(page != nullptr);
+                for (int r = 0;; ++r) {
+                    std::fill(rec.begin(), rec.end(), 0);
+                    std::string s = "name-" + std::to_string(p) + "-" + std::to_string(r);
+                    std::memcpy(rec.data(), s.data(), s.size());
+                    if (!AppendRow(page, rec.data(), static_cast<uint16_t>(rec.size()))) break;
+                }
+                se.PutPage(pid, true);
+                pids.push_back(pid);
+            }
+            se.Checkpoint();
+            ASSERT_TRUE(se.GetCompressionRatio() < 0.25);
+        }
+        // 打开已有库时以元数据为准：配置关闭压缩也仍按压缩格式读写
+        cfg.page_compression = false;
+        {
+            StorageEngine se(path, 16);
+            ASSERT_TRUE(se.IsCompressed());
+            for (size_t i = 0; i < pids.size(); i += 7) {
+                Page* page = se.GetDataPage(pids[i]);
+                ASSERT_TRUE(page != nullptr);
+                ASSERT_TRUE(page->GetSlotCount() > 30);
+                uint16_t len = 0;
+                const unsigned char* row = GetRow(page, 3, &len);
+                ASSERT_EQ(100, (int)len);
+                const std::string expect = "name-" + std::to_string(i) + "-3";
+                ASSERT_TRUE(std::string(reinterpret_cast<const char*>(row)) == expect);
+                se.PutPage(pids[i]);
+            }
+        }
+        cfg.page_compression = saved;
+    });
+
+    suite.addTest("compressed database: writes after the last checkpoint are replayed on open", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const bool saved = cfg.page_compression;
+        cfg.page_compression = true;
+        const char* path = "data/test_page_compression_crash.db";
+        const char* copy = "data/test_page_compression_crash_copy.db";
+        std::remove(path);
+        std::remove(copy);
+        std::vector<char> buf(PAGE_SIZE);
+        {
+            DiskManager dm(path);
+            ASSERT_TRUE(dm.IsCompressed());
+            for (page_id_t pid = 1; pid <= 40; ++pid) {
+                fillPadded(buf.data(), buf.size(), pid);
+                ASSERT_TRUE(dm.WritePage(pid, buf.data()) == Status::OK);
+            }
+            ASSERT_TRUE(dm.PersistMeta());
+            // 检查点之后：页 1..10 改为不可压缩的内容（放不进原槽，须换槽），并新写页 41..45
+            for (page_id_t pid = 1; pid <= 10; ++pid) {
+                fillRandom(buf.data(), buf.size(), pid);
+                ASSERT_TRUE(dm.WritePage(pid, buf.data()) == Status::OK);
+            }
+            for (page_id_t pid = 41; pid <= 45; ++pid) {
+                fillPadded(buf.data(), buf.size(), pid);
+                ASSERT_TRUE(dm.WritePage(pid, buf.data()) == Status::OK);
+            }
+            // 模拟崩溃：复制此刻的文件，不经过关闭时的元数据持久化
+            std::filesystem::copy_file(path, copy, std::filesystem::copy_options::overwrite_existing);
+        }
+        cfg.page_compression = false;
+        {
+            DiskManager dm(copy);
+            ASSERT_TRUE(dm.IsCompressed());
+            ASSERT_TRUE(dm.GetNumPages() >= 46);
+            std::vector<char> expect(PAGE_SIZE);
+            for (page_id_t pid = 1; pid <= 45; ++pid) {
+                if (pid <= 10)
+                    fillRandom(expect.data(), expect.size(), pid);
+                else
+                    fillPadded(expect.data(), expect.size(), pid);
+                ASSERT_TRUE(dm.ReadPage(pid, buf.data()) == Status::OK);
+                ASSERT_TRUE(std::memcmp(expect.data(), buf.data(), PAGE_SIZE) == 0);
+            }
+        }
+        cfg.page_compression = saved;
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
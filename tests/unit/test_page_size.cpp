@@ -0,0 +1,110 @@
+#include "../simple_test_framework.h"
+#include "../../src/storage/storage_engine.h"
+#include "../../src/storage/index/bplus_tree.h"
+#include "../../src/storage/page/page_utils.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace minidb;
+using namespace SimpleTest;
+
+// 写满一个数据页，每条记录 len 字节且内容为序号；返回写入条数
+static int fillPage(Page* page, uint16_t len){
+    std::vector<char> rec(len);
+    int n = 0;
+    for (;; ++n) {
+        std::fill(rec.begin(), rec.end(), static_cast<char>(n & 0x7F));
+        if (!AppendRow(page, rec.data(), len)) break;
+    }
+    return n;
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("16KB pages: slots, frames, B+ tree and reopen use the database page size", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const size_t saved = cfg.page_size;
+        cfg.page_size = 16 * 1024;
+        const char* path = "data/test_page_size_16k.db";
+        std::remove(path);
+        page_id_t data_pid = INVALID_PAGE_ID, root = INVALID_PAGE_ID;
+        int rows = 0;
+        {
+            StorageEngine se(path, 16);
+            ASSERT_EQ(16 * 1024, (int)se.GetPageSize());
+            Page* page = se.CreateDataPage(&data_pid);
+            ASSERT_TRUE(page != nullptr);
+            ASSERT_EQ(16 * 1024, (int)page->GetPageSize());
+            ASSERT_EQ(16 * 1024 - PAGE_HEADER_SIZE, (int)GetFreeSpace(page));
+            // 80 字节的行：16KB 页放得下 (16384 - 16) / 84 = 194 行，4KB 页只有 48 行
+            rows = fillPage(page, 80);
+            ASSERT_EQ(194, rows);
+            se.PutPage(data_pid, true);
+
+            BPlusTree tree(&se);
+            root = tree.CreateNew();
+            for (int32_t k = 0; k < 3000; ++k)
+                ASSERT_TRUE(tree.Insert(k, RID{static_cast<page_id_t>(k), 0}));
+            root = tree.GetRoot();
+        }
+        // 打开已有数据库时以元数据中的页大小为准，与当前配置无关
+        cfg.page_size = PAGE_SIZE;
+        {
+            StorageEngine se(path, 16);
+            ASSERT_EQ(16 * 1024, (int)se.GetPageSize());
+            Page* page = se.GetDataPage(data_pid);
+            ASSERT_TRUE(page != nullptr);
+            ASSERT_EQ(rows, (int)page->GetSlotCount());
+            uint16_t len = 0;
+            const unsigned char* last = GetRow(page, static_cast<uint16_t>(rows - 1), &len);
+            ASSERT_EQ(80, (int)len);
+            ASSERT_EQ((rows - 1) & 0x7F, (int)last[79]);
+            se.PutPage(data_pid);
+
+            BPlusTree tree(&se);
+            tree.SetRoot(root);
+            for (int32_t k = 0; k < 3000; k += 7) {
+                auto rid = tree.Search(k);
+                ASSERT_TRUE(rid.has_value());
+                ASSERT_EQ(k, (int)rid->page_id);
+            }
+        }
+        cfg.page_size = saved;
+    });
+
+    suite.addTest("64KB pages keep 16-bit slot offsets in range; invalid sizes fall back", [](){
+        RuntimeConfig& cfg = GetRuntimeConfig();
+        const size_t saved = cfg.page_size;
+        cfg.page_size = 64 * 1024;
+        const char* path = "data/test_page_size_64k.db";
+        std::remove(path);
+        {
+            StorageEngine se(path, 8);
+            ASSERT_EQ(64 * 1024, (int)se.GetPageSize());
+            page_id_t pid = INVALID_PAGE_ID;
+            Page* page = se.CreateDataPage(&pid);
+            ASSERT_TRUE(page != nullptr);
+            ASSERT_EQ(64 * 1024 - PAGE_HEADER_SIZE, (int)GetFreeSpace(page));
+            const int rows = fillPage(page, 1000);
+            ASSERT_EQ(65, rows);
+            uint16_t len = 0;
+            const unsigned char* last = GetRow(page, static_cast<uint16_t>(rows - 1), &len);
+            ASSERT_EQ(1000, (int)len);
+            ASSERT_EQ(rows - 1, (int)last[0]);
+            se.PutPage(pid, true);
+        }
+        cfg.page_size = 10000;
+        path = "data/test_page_size_bad.db";
+        std::remove(path);
+        {
+            StorageEngine se(path, 8);
+            ASSERT_EQ((int)PAGE_SIZE, (int)se.GetPageSize());
+        }
+        cfg.page_size = saved;
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,161 @@
+#include "../test_helpers.h"
+#include "../../src/engine/operators/parallel_aggregate_operator.h"
+#include "../../src/engine/operators/parallel_join_operator.h"
+#include "../../src/util/config.h"
+#include "../../src/storage/page/page_utils.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <map>
+
+using namespace minidb;
+using namespace SimpleTest;
+using namespace TestHelpers;
+
+// name(id INT, v INT)：直接按页链写入 n 行，每页 rows_per_page 行，v = id * 7 % 10
+static TableSchema buildTable(StorageEngine& se, int n, int rows_per_page, const std::string& name = "t"){
+    return TestHelpers::buildTable(se, name, {{"id", "INT", -1}, {"v", "INT", -1}}, n, rows_per_page, [](int i){
+        return std::vector<std::string>{std::to_string(i), std::to_string((i * 7) % 10)};
+    });
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("parallel scan: same rows and order as serial scan", [](){
+        std::remove("data/test_parallel_scan.db");
+        StorageEngine se("data/test_parallel_scan.db", 32);
+        TableSchema schema = buildTable(se, 2000, 50); // 40 页
+
+        SeqScanOperator serial(&se, schema);
+        auto expected = drainColumn(serial, "id");
+        ASSERT_EQ(2000, (int)expected.size());
+
+        ParallelSeqScanOperator par(&se, schema, 4, 3);
+        ASSERT_TRUE(drainColumn(par, "id") == expected);
+        ASSERT_EQ(4, (int)par.GetWorkerCount());
+        ASSERT_EQ(40, (int)par.GetPagesRead());
+        // 重复 Open 结果一致
+        ASSERT_TRUE(drainColumn(par, "id") == expected);
+
+        // 谓词在扫描线程中执行
+        ParallelSeqScanOperator filtered(&se, schema, 4, 2);
+        filtered.SetPredicate([](const Row& r){ return r.getValue("v") == "3"; });
+        auto ids = drainColumn(filtered, "id");
+        ASSERT_EQ(200, (int)ids.size());
+        for (size_t i = 1; i < ids.size(); ++i)
+            ASSERT_TRUE(std::stoi(ids[i - 1]) < std::stoi(ids[i]));
+    });
+
+    suite.addTest("parallel scan: small table and early close", [](){
+        std::remove("data/test_parallel_scan_small.db");
+        StorageEngine se("data/test_parallel_scan_small.db", 32);
+        TableSchema small = buildTable(se, 60, 50); // 2 页，一个 morsel 即可扫完
+        ParallelSeqScanOperator op(&se, small, 4, 8);
+        ASSERT_EQ(60, (int)drainColumn(op, "id").size());
+        ASSERT_EQ(0, (int)op.GetWorkerCount());
+
+        TableSchema big = buildTable(se, 1500, 50);
+        LimitOperator limit(std::make_unique<ParallelSeqScanOperator>(&se, big, 4, 1), 5, 0);
+        auto ids = drainColumn(limit, "id");
+        ASSERT_EQ(5, (int)ids.size());
+        ASSERT_TRUE(ids[4] == "4");
+    });
+
+    suite.addTest("parallel aggregate: matches serial hash aggregate", [](){
+        std::remove("data/test_parallel_agg.db");
+        StorageEngine se("data/test_parallel_agg.db", 32);
+        TableSchema schema = buildTable(se, 2000, 50);
+
+        std::vector<AggregateExpr> aggs = {{"COUNT", "id", ""}, {"SUM", "id", ""}, {"MIN", "id", ""},
+                                           {"MAX", "id", ""}, {"AVG", "id", ""}};
+        std::vector<ValueType> types(aggs.size(), ValueType::Int);
+        auto collect = [](PhysicalOperator& op){
+            std::map<std::string, std::vector<std::string>> groups;
+            op.Open();
+            Row row;
+            while (op.Next(row)) {
+                std::vector<std::string> vals;
+                for (size_t i = 1; i < row.columns.size(); ++i) vals.push_back(row.columns[i].value);
+                ASSERT_TRUE(groups.emplace(row.columns[0].value, vals).second);
+            }
+            op.Close();
+            return groups;
+        };
+
+        HashAggregateOperator serial(std::make_unique<SeqScanOperator>(&se, schema), std::vector<std::string>{"v"},
+                                     std::vector<ValueType>{ValueType::Int}, aggs, types, nullptr, 1 << 20);
+        ParallelHashAggregateOperator par(std::make_unique<ParallelSeqScanOperator>(&se, schema, 4, 2),
+                                          std::vector<std::string>{"v"}, std::vector<ValueType>{ValueType::Int},
+                                          aggs, types, 1 << 20);
+        auto expected = collect(serial);
+        ASSERT_EQ(10, (int)expected.size());
+        ASSERT_TRUE(expected["3"][0] == "200");
+        ASSERT_TRUE(collect(par) == expected);
+        ASSERT_TRUE(par.OutputColumns() == serial.OutputColumns());
+        ASSERT_FALSE(par.UsedFallback());
+
+        // 按 id 分组得到 2000 组，超过 exec_agg_max_groups 时改用可溢写的哈希聚合
+        RuntimeConfig saved = GetRuntimeConfig();
+        GetRuntimeConfig().exec_agg_max_groups = 100;
+        HashAggregateOperator serial_ids(std::make_unique<SeqScanOperator>(&se, schema), std::vector<std::string>{"id"},
+                                         std::vector<ValueType>{ValueType::Int}, aggs, types, nullptr, 1 << 20);
+        ParallelHashAggregateOperator par_ids(std::make_unique<ParallelSeqScanOperator>(&se, schema, 4, 2),
+                                              std::vector<std::string>{"id"}, std::vector<ValueType>{ValueType::Int},
+                                              aggs, types, GetRuntimeConfig().exec_agg_max_groups);
+        auto expected_ids = collect(serial_ids);
+        ASSERT_EQ(2000, (int)expected_ids.size());
+        ASSERT_TRUE(collect(par_ids) == expected_ids);
+        ASSERT_TRUE(par_ids.UsedFallback());
+        ASSERT_TRUE(par_ids.IsSpilled());
+        // 重复 Open 结果一致
+        ASSERT_TRUE(collect(par_ids) == expected_ids);
+        GetRuntimeConfig() = saved;
+    });
+
+    suite.addTest("parallel join: matches serial hash join", [](){
+        std::remove("data/test_parallel_join.db");
+        StorageEngine se("data/test_parallel_join.db", 32);
+        TableSchema t = buildTable(se, 2000, 50, "t");
+        TableSchema u = buildTable(se, 300, 50, "u");
+        JoinKeySpec key{"t.v", "u.v", ValueType::Int};
+
+        auto pairs = [](PhysicalOperator& op){
+            std::vector<std::pair<int, int>> out;
+            op.Open();
+            Row row;
+            while (op.Next(row)) out.emplace_back(std::stoi(row.getValue("t.id")), std::stoi(row.getValue("u.id")));
+            op.Close();
+            std::sort(out.begin(), out.end());
+            return out;
+        };
+
+        HashJoinOperator serial(std::make_unique<QualifyOperator>(std::make_unique<SeqScanOperator>(&se, t), "t"),
+                                std::make_unique<QualifyOperator>(std::make_unique<SeqScanOperator>(&se, u), "u"),
+                                key, false, nullptr, 1 << 30);
+        auto expected = pairs(serial);
+        ASSERT_EQ(2000 * 30, (int)expected.size());
+
+        for (bool build_left : {false, true}) {
+            ParallelHashJoinOperator par(std::make_unique<ParallelSeqScanOperator>(&se, t, 4, 2), "t",
+                                         std::make_unique<ParallelSeqScanOperator>(&se, u, 4, 2), "u",
+                                         key, build_left, build_left ? 40 : 6);
+            ASSERT_TRUE(pairs(par) == expected);
+            ASSERT_TRUE(par.OutputColumns() == serial.OutputColumns());
+        }
+
+        // 提前结束：LIMIT 取够后关闭连接，探测线程随之退出
+        LimitOperator limit(std::make_unique<ParallelHashJoinOperator>(
+            std::make_unique<ParallelSeqScanOperator>(&se, t, 4, 1), "t",
+            std::make_unique<ParallelSeqScanOperator>(&se, u, 4, 1), "u", key, false, 6), 10, 0);
+        limit.Open();
+        Row row;
+        int n = 0;
+        while (limit.Next(row)) ++n;
+        limit.Close();
+        ASSERT_EQ(10, n);
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,117 @@
+#include "../simple_test_framework.h"
+#include "../../src/engine/operators/expression.h"
+
+using namespace minidb;
+using namespace SimpleTest;
+
+static std::shared_ptr<PlanExpr> col(const std::string& name){
+    auto e = std::make_shared<PlanExpr>();
+    e->kind = PlanExpr::Kind::Column;
+    e->name = name;
+    return e;
+}
+
+static std::shared_ptr<PlanExpr> lit(const std::string& value, bool is_string = false){
+    auto e = std::make_shared<PlanExpr>();
+    e->kind = PlanExpr::Kind::Literal;
+    e->value = value;
+    e->is_string = is_string;
+    return e;
+}
+
+static std::shared_ptr<PlanExpr> bin(const std::string& op, std::shared_ptr<PlanExpr> l, std::shared_ptr<PlanExpr> r){
+    auto e = std::make_shared<PlanExpr>();
+    e->kind = PlanExpr::Kind::Binary;
+    e->op = op;
+    e->left = std::move(l);
+    e->right = std::move(r);
+    return e;
+}
+
+int main(){
+    TestSuite suite;
+    const std::vector<std::string> layout = {"id", "name", "score"};
+    const Row r1{{"id", "7"}, {"name", "Alice"}, {"score", "9.500000"}};
+    const Row r2{{"id", "12"}, {"name", "Bob"}, {"score", "3.000000"}};
+
+    suite.addTest("compiled predicate: numeric comparisons", [&](){
+        auto gt = CompilePredicate(bin(">", col("id"), lit("10")).get(), layout);
+        ASSERT_FALSE(gt(r1));
+        ASSERT_TRUE(gt(r2));
+
+        // 数值比较而非字典序："7" < "12"
+        auto le = CompilePredicate(bin("<=", col("id"), lit("12")).get(), layout);
+        ASSERT_TRUE(le(r1));
+        ASSERT_TRUE(le(r2));
+
+        // 常量在左侧
+        auto flipped = CompilePredicate(bin("<", lit("8"), col("id")).get(), layout);
+        ASSERT_FALSE(flipped(r1));
+        ASSERT_TRUE(flipped(r2));
+
+        auto dbl = CompilePredicate(bin(">", col("score"), lit("9")).get(), layout);
+        ASSERT_TRUE(dbl(r1));
+        ASSERT_FALSE(dbl(r2));
+    });
+
+    suite.addTest("compiled predicate: strings, arithmetic and qualified names", [&](){
+        auto eq = CompilePredicate(bin("=", col("name"), lit("Bob", true)).get(), layout);
+        ASSERT_FALSE(eq(r1));
+        ASSERT_TRUE(eq(r2));
+
+        auto ne = CompilePredicate(bin("!=", col("name"), lit("Bob", true)).get(), layout);
+        ASSERT_TRUE(ne(r1));
+
+        auto arith = CompilePredicate(bin("=", bin("+", col("id"), lit("5")), lit("12")).get(), layout);
+        ASSERT_TRUE(arith(r1));
+        ASSERT_FALSE(arith(r2));
+
+        auto qualified = CompilePredicate(bin("=", col("t.id"), lit("7")).get(), layout);
+        ASSERT_TRUE(qualified(r1));
+    });
+
+    suite.addTest("compiled predicate: string fallback", [&](){
+        auto p = CompilePlanPredicate(nullptr, "id >= 12", layout);
+        ASSERT_FALSE(p(r1));
+        ASSERT_TRUE(p(r2));
+
+        auto q = CompilePlanPredicate(nullptr, "name = 'Alice'", layout);
+        ASSERT_TRUE(q(r1));
+
+        auto all = CompilePlanPredicate(nullptr, "", layout);
+        ASSERT_TRUE(all(r1));
+
+        // 列布局未知时按列名查找
+        auto unbound = CompilePlanPredicate(nullptr, "score < 5", {});
+        ASSERT_TRUE(unbound(r2));
+    });
+
+    suite.addTest("compiled predicate: schema column types", [&](){
+        const std::vector<ValueType> types = {ValueType::Int, ValueType::String, ValueType::Double};
+        auto gt = CompilePredicate(bin(">", col("id"), lit("10")).get(), layout, types);
+        ASSERT_FALSE(gt(r1));
+        ASSERT_TRUE(gt(r2));
+
+        auto dbl = CompilePredicate(bin(">=", col("score"), lit("9.5")).get(), layout, types);
+        ASSERT_TRUE(dbl(r1));
+        ASSERT_FALSE(dbl(r2));
+
+        auto arith = CompilePredicate(bin("=", bin("*", col("id"), lit("2")), lit("24")).get(), layout, types);
+        ASSERT_FALSE(arith(r1));
+        ASSERT_TRUE(arith(r2));
+
+        // INT 列里解析不了的值与未知类型时一样按文本比较
+        const Row odd{{"id", "+7"}, {"name", ""}, {"score", ""}};
+        auto eq = CompilePredicate(bin("=", col("id"), lit("7")).get(), layout, types);
+        ASSERT_TRUE(eq(odd));
+        auto empty = CompilePredicate(bin("<", col("score"), lit("1")).get(), layout, types);
+        ASSERT_EQ(CompilePredicate(bin("<", col("score"), lit("1")).get(), layout)(odd), empty(odd));
+
+        auto p = CompilePlanPredicate(nullptr, "id >= 12", layout, types);
+        ASSERT_FALSE(p(r1));
+        ASSERT_TRUE(p(r2));
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,77 @@
+#include "../test_helpers.h"
+#include "../../src/engine/operators/parallel_scan_operator.h"
+#include "../../src/storage/page/page_utils.h"
+
+#include <cstdio>
+
+using namespace minidb;
+using namespace SimpleTest;
+
+// t(id INT, v INT)：直接按页链写入 n 行，每页 rows_per_page 行
+static TableSchema buildTable(StorageEngine& se, int n, int rows_per_page){
+    return TestHelpers::buildTable(se, "t", {{"id", "INT", -1}, {"v", "INT", -1}}, n, rows_per_page, [](int i){
+        return std::vector<std::string>{std::to_string(i), std::to_string(i % 10)};
+    });
+}
+
+static long long sumIds(PhysicalOperator& op, size_t& rows){
+    long long sum = 0;
+    rows = 0;
+    op.Open();
+    Row row;
+    while (op.Next(row)) {
+        sum += std::stoll(row.getValue("id"));
+        ++rows;
+    }
+    op.Close();
+    return sum;
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("read-only mmap: scans see the same rows through page views", [](){
+        const char* path = "data/test_readonly_mmap.db";
+        std::remove(path);
+        TableSchema schema;
+        page_id_t catalog_root = INVALID_PAGE_ID;
+        {
+            StorageEngine se(path, 16);
+            schema = buildTable(se, 4000, 50); // 80 页，多于缓冲池
+            catalog_root = schema.first_page_id;
+            ASSERT_TRUE(se.SetCatalogRoot(catalog_root));
+        }
+
+        StorageEngine ro(path, 16, OpenMode::ReadOnlyMmap);
+        ASSERT_TRUE(ro.IsReadOnly());
+        ASSERT_TRUE(ro.IsMemoryMapped());
+        ASSERT_EQ(0, (int)ro.GetBufferPoolSize());
+        ASSERT_EQ((int)catalog_root, (int)ro.GetCatalogRoot());
+
+        const long long expected = 4000LL * 3999 / 2;
+        size_t rows = 0;
+        SeqScanOperator serial(&ro, schema);
+        ASSERT_TRUE(sumIds(serial, rows) == expected);
+        ASSERT_EQ(4000, (int)rows);
+        for (size_t degree : {1, 4}) {
+            ParallelSeqScanOperator parallel(&ro, schema, degree, 4);
+            ASSERT_TRUE(sumIds(parallel, rows) == expected);
+            ASSERT_EQ(4000, (int)rows);
+        }
+
+        // 页视图是同一个对象，pin / unpin 不计数；写操作被拒绝
+        Page* a = ro.GetPage(schema.first_page_id);
+        Page* b = ro.GetPage(schema.first_page_id);
+        ASSERT_TRUE(a != nullptr && a == b);
+        ASSERT_EQ(0, a->GetPinCount());
+        ASSERT_TRUE(ro.PutPage(schema.first_page_id, false));
+        ASSERT_TRUE(!ro.PutPage(schema.first_page_id, true));
+        page_id_t pid = INVALID_PAGE_ID;
+        ASSERT_TRUE(ro.CreatePage(&pid) == nullptr);
+        ASSERT_TRUE(ro.GetPage(static_cast<page_id_t>(ro.GetNumPages() + 1000000)) == nullptr);
+        ASSERT_EQ(80, (int)ro.GetPageChain(schema.first_page_id).size());
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
@@ -0,0 +1,229 @@
+#include "../test_helpers.h"
+#include "../../src/engine/operators/vectorized_aggregate_operator.h"
+#include "../../src/util/config.h"
+#include "../../src/storage/page/page_utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+
+using namespace minidb;
+using namespace SimpleTest;
+using namespace TestHelpers;
+
+// t(id INT, v INT, d DOUBLE, name CHAR(8))：v = id * 7 % 10，d = id * 0.5 - 100，name = "n" + id % 5
+static TableSchema buildTable(StorageEngine& se, int n, int rows_per_page){
+    return TestHelpers::buildTable(se, "t", {{"id", "INT", -1}, {"v", "INT", -1}, {"d", "DOUBLE", -1}, {"name", "CHAR", 8}},
+                                   n, rows_per_page, [](int i){
+        return std::vector<std::string>{std::to_string(i), std::to_string((i * 7) % 10),
+                                        std::to_string(i * 0.5 - 100), "n" + std::to_string(i % 5)};
+    });
+}
+
+static std::shared_ptr<PlanExpr> cmp(const std::string& col, const std::string& op, const std::string& lit,
+                                     bool is_string = false){
+    auto l = std::make_shared<PlanExpr>();
+    l->kind = PlanExpr::Kind::Column;
+    l->name = col;
+    auto r = std::make_shared<PlanExpr>();
+    r->kind = PlanExpr::Kind::Literal;
+    r->value = lit;
+    r->is_string = is_string;
+    auto e = std::make_shared<PlanExpr>();
+    e->kind = PlanExpr::Kind::Binary;
+    e->op = op;
+    e->left = l;
+    e->right = r;
+    return e;
+}
+
+static std::map<std::string, std::vector<std::string>> collectGroups(PhysicalOperator& op, size_t key_cols){
+    std::map<std::string, std::vector<std::string>> groups;
+    op.Open();
+    Row row;
+    while (op.Next(row)) {
+        std::string key = key_cols ? row.columns[0].value : "";
+        std::vector<std::string> vals;
+        for (size_t i = key_cols; i < row.columns.size(); ++i) vals.push_back(row.columns[i].value);
+        ASSERT_TRUE(groups.emplace(key, vals).second);
+    }
+    op.Close();
+    return groups;
+}
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("kernels: every SIMD level matches the scalar result", [](){
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int32_t> dist(-50, 50);
+        const size_t n = 1037; // 不是向量宽度的整数倍，覆盖尾部
+        std::vector<int32_t> ints(n);
+        std::vector<double> dbls(n);
+        for (size_t i = 0; i < n; ++i) {
+            ints[i] = dist(rng);
+            dbls[i] = dist(rng) * 0.25;
+        }
+        const VectorCmp ops[] = {VectorCmp::EQ, VectorCmp::NE, VectorCmp::LT,
+                                 VectorCmp::GT, VectorCmp::LE, VectorCmp::GE};
+        auto expect = [](VectorCmp op, double a, double b){
+            switch (op) {
+                case VectorCmp::EQ: return a == b;
+                case VectorCmp::NE: return a != b;
+                case VectorCmp::LT: return a < b;
+                case VectorCmp::GT: return a > b;
+                case VectorCmp::LE: return a <= b;
+                default: return a >= b;
+            }
+        };
+
+        const SimdLevel original = GetSimdLevel();
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2}) {
+            SetSimdLevel(level);
+            std::vector<uint32_t> sel(n);
+            for (VectorCmp op : ops) {
+                size_t k = SelectInt32(ints.data(), n, op, 7, sel.data());
+                std::vector<uint32_t> want;
+                for (size_t i = 0; i < n; ++i) if (expect(op, ints[i], 7)) want.push_back((uint32_t)i);
+                ASSERT_TRUE(std::vector<uint32_t>(sel.begin(), sel.begin() + k) == want);
+
+                k = SelectDouble(dbls.data(), n, op, 2.5, sel.data());
+                want.clear();
+                for (size_t i = 0; i < n; ++i) if (expect(op, dbls[i], 2.5)) want.push_back((uint32_t)i);
+                ASSERT_TRUE(std::vector<uint32_t>(sel.begin(), sel.begin() + k) == want);
+            }
+
+            int64_t isum = 0;
+            double dsum = 0;
+            for (size_t i = 0; i < n; ++i) { isum += ints[i]; dsum += dbls[i]; }
+            ASSERT_EQ(isum, SumInt32(ints.data(), n));
+            ASSERT_TRUE(SumDouble(dbls.data(), n) == dsum); // 0.25 的倍数，求和无舍入
+            int32_t mn, mx;
+            MinMaxInt32(ints.data(), n, mn, mx);
+            ASSERT_EQ(*std::min_element(ints.begin(), ints.end()), mn);
+            ASSERT_EQ(*std::max_element(ints.begin(), ints.end()), mx);
+            double dmn, dmx;
+            MinMaxDouble(dbls.data() + 1, 3, dmn, dmx);
+            ASSERT_TRUE(dmn == std::min({dbls[1], dbls[2], dbls[3]}));
+            ASSERT_TRUE(dmx == std::max({dbls[1], dbls[2], dbls[3]}));
+        }
+        SetSimdLevel(original);
+    });
+
+    suite.addTest("vector predicate: same rows as the row predicate", [](){
+        std::remove("data/test_vectorized_filter.db");
+        StorageEngine se("data/test_vectorized_filter.db", 32);
+        TableSchema schema = buildTable(se, 3000, 60); // 50 页
+
+        struct Case { std::shared_ptr<PlanExpr> expr; bool vectorizable; };
+        std::vector<Case> cases = {
+            {cmp("v", "=", "3"), true},
+            {cmp("t.id", ">=", "2500"), true},
+            {cmp("d", "<", "-50.5"), true},
+            {cmp("name", "!=", "n2", true), true},
+            {cmp("name", "<=", "n1", true), true},
+            {cmp("v", ">", "2.5"), false},     // INT 列与小数：逐行按浮点比较
+            {cmp("name", "=", "n1"), false},   // 字符列与未加引号的常量
+        };
+        for (const auto& c : cases) {
+            VectorPredicate vp;
+            ASSERT_TRUE(CompileVectorPredicate(c.expr.get(), schema, vp) == c.vectorizable);
+
+            ParallelSeqScanOperator rows(&se, schema, 4, 3);
+            rows.SetPredicate(CompilePredicate(c.expr.get(), rows.OutputColumns()));
+            auto expected = drainColumn(rows, "id");
+            ASSERT_TRUE(!expected.empty());
+            if (!c.vectorizable) continue;
+
+            for (size_t degree : {1, 4}) {
+                ParallelSeqScanOperator vec(&se, schema, degree, 3);
+                vec.SetVectorPredicate(vp);
+                ASSERT_TRUE(drainColumn(vec, "id") == expected);
+            }
+        }
+
+        // 常量在左侧时交换比较方向：5 > v 等价于 v < 5
+        VectorPredicate flipped;
+        auto e = cmp("v", ">", "5");
+        std::swap(e->left, e->right);
+        ASSERT_TRUE(CompileVectorPredicate(e.get(), schema, flipped));
+        ASSERT_TRUE(flipped.op == VectorCmp::LT);
+    });
+
+    suite.addTest("vectorized aggregate: matches serial hash aggregate", [](){
+        std::remove("data/test_vectorized_agg.db");
+        StorageEngine se("data/test_vectorized_agg.db", 32);
+        TableSchema schema = buildTable(se, 3000, 60);
+
+        std::vector<AggregateExpr> aggs = {{"COUNT", "id", ""}, {"SUM", "id", ""}, {"MIN", "d", ""},
+                                           {"MAX", "id", ""}, {"AVG", "d", "avg_d"}, {"SUM", "d", ""}};
+        std::vector<ValueType> types = {ValueType::Int, ValueType::Int, ValueType::Double,
+                                        ValueType::Int, ValueType::Double, ValueType::Double};
+        ASSERT_TRUE(VectorizedAggregateOperator::Supports(schema, {"v"}, aggs));
+        ASSERT_TRUE(VectorizedAggregateOperator::Supports(schema, {}, aggs));
+        ASSERT_TRUE(!VectorizedAggregateOperator::Supports(schema, {"name"}, aggs));
+        ASSERT_TRUE(!VectorizedAggregateOperator::Supports(schema, {"v"}, {{"SUM", "name", ""}}));
+
+        for (bool filtered : {false, true}) {
+            auto expr = cmp("id", "<", "1234");
+            for (std::vector<std::string> keys : {std::vector<std::string>{"v"}, std::vector<std::string>{}}) {
+                std::vector<ValueType> key_types(keys.size(), ValueType::Int);
+                std::unique_ptr<PhysicalOperator> input = std::make_unique<SeqScanOperator>(&se, schema);
+                if (filtered)
+                    input = std::make_unique<FilterOperator>(std::move(input), CompilePredicate(expr.get(), {}));
+                HashAggregateOperator serial(std::move(input), keys, key_types, aggs, types, nullptr, 1 << 20);
+                auto expected = collectGroups(serial, keys.size());
+                ASSERT_EQ(keys.empty() ? 1 : 10, (int)expected.size());
+
+                for (size_t degree : {1, 4}) {
+                    auto scan = std::make_unique<ParallelSeqScanOperator>(&se, schema, degree, 2);
+                    if (filtered) {
+                        VectorPredicate vp;
+                        ASSERT_TRUE(CompileVectorPredicate(expr.get(), schema, vp));
+                        scan->SetVectorPredicate(vp);
+                    }
+                    VectorizedAggregateOperator vec(std::move(scan), keys, aggs, 1 << 20);
+                    ASSERT_TRUE(collectGroups(vec, keys.size()) == expected);
+                    ASSERT_TRUE(vec.OutputColumns() == serial.OutputColumns());
+                    ASSERT_FALSE(vec.UsedFallback());
+                }
+            }
+        }
+    });
+
+    suite.addTest("vectorized aggregate: falls back past the group budget", [](){
+        std::remove("data/test_vectorized_agg_budget.db");
+        StorageEngine se("data/test_vectorized_agg_budget.db", 32);
+        TableSchema schema = buildTable(se, 3000, 60);
+
+        std::vector<AggregateExpr> aggs = {{"COUNT", "id", ""}, {"SUM", "v", ""}, {"MAX", "d", ""}};
+        std::vector<ValueType> types = {ValueType::Int, ValueType::Int, ValueType::Double};
+        std::vector<std::string> keys = {"id"};
+        auto expr = cmp("id", "<", "2500");
+
+        RuntimeConfig saved = GetRuntimeConfig();
+        GetRuntimeConfig().exec_agg_max_groups = 200;
+        auto input = std::make_unique<FilterOperator>(std::make_unique<SeqScanOperator>(&se, schema),
+                                                      CompilePredicate(expr.get(), {}));
+        HashAggregateOperator serial(std::move(input), keys, {ValueType::Int}, aggs, types, nullptr, 1 << 20);
+        auto expected = collectGroups(serial, 1);
+        ASSERT_EQ(2500, (int)expected.size());
+
+        for (size_t degree : {1, 4}) {
+            auto scan = std::make_unique<ParallelSeqScanOperator>(&se, schema, degree, 2);
+            VectorPredicate vp;
+            ASSERT_TRUE(CompileVectorPredicate(expr.get(), schema, vp));
+            scan->SetVectorPredicate(vp);
+            VectorizedAggregateOperator vec(std::move(scan), keys, aggs, GetRuntimeConfig().exec_agg_max_groups);
+            ASSERT_TRUE(collectGroups(vec, 1) == expected);
+            ASSERT_TRUE(vec.UsedFallback());
+            ASSERT_TRUE(vec.IsSpilled());
+            ASSERT_TRUE(vec.OutputColumns() == serial.OutputColumns());
+        }
+        GetRuntimeConfig() = saved;
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}
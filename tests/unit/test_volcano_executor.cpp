@@ -0,0 +1,62 @@
+#include "../test_helpers.h"
+
+using namespace minidb;
+using namespace SimpleTest;
+using namespace TestHelpers;
+
+int main(){
+    TestSuite suite;
+
+    suite.addTest("volcano pipeline: filter / project / order by / group by", [](){
+        StorageEngine se("data/test_volcano_executor.db", 64);
+        Catalog catalog(&se);
+        catalog.LoadFromStorage();
+        AuthService auth(&se, &catalog);
+        auth.login("root", "root");
+
+        try { runSQL(&catalog, &se, &auth, "DROP TABLE emp;"); } catch(...) {}
+        runSQL(&catalog, &se, &auth, "CREATE TABLE emp(id INT, name VARCHAR(16), dept INT, age INT);");
+        for (int i = 0; i < 40; ++i) {
+            runSQL(&catalog, &se, &auth, "INSERT INTO emp(id,name,dept,age) VALUES (" + std::to_string(i) +
+                   ",'n" + std::to_string(i) + "'," + std::to_string(i % 4) + "," + std::to_string(20 + (i * 7) % 50) + ");");
+        }
+
+        auto all = runSQL(&catalog, &se, &auth, "SELECT * FROM emp;");
+        ASSERT_EQ(40, (int)all.size());
+
+        auto filtered = runSQL(&catalog, &se, &auth, "SELECT id,age FROM emp WHERE age > 60;");
+        ASSERT_TRUE(!filtered.empty());
+        for (auto& r : filtered) {
+            ASSERT_EQ(2, (int)r.columns.size());
+            ASSERT_TRUE(std::stoi(r.getValue("age")) > 60);
+        }
+
+        auto sorted = runSQL(&catalog, &se, &auth, "SELECT * FROM emp ORDER BY age DESC;");
+        ASSERT_EQ(40, (int)sorted.size());
+        for (size_t i = 1; i < sorted.size(); ++i)
+            ASSERT_TRUE(std::stoi(sorted[i - 1].getValue("age")) >= std::stoi(sorted[i].getValue("age")));
+
+        auto grouped = runSQL(&catalog, &se, &auth, "SELECT dept, COUNT(id) FROM emp GROUP BY dept;");
+        ASSERT_EQ(4, (int)grouped.size());
+        for (auto& r : grouped)
+            ASSERT_EQ(10, std::stoi(r.columns.back().value));
+    });
+
+    suite.addTest("volcano pipeline: streaming consumer stops early", [](){
+        StorageEngine se("data/test_volcano_executor.db", 64);
+        Catalog catalog(&se);
+        catalog.LoadFromStorage();
+        AuthService auth(&se, &catalog);
+        auth.login("root", "root");
+
+        auto plan = planSQL(&catalog, "SELECT * FROM emp;");
+        PermissionChecker checker(&auth);
+        auto exec = makeExecutor(&catalog, &se, &auth, &checker);
+        int seen = 0;
+        exec->ExecuteQuery(plan.get(), [&](const Row&) { return ++seen < 5; });
+        ASSERT_EQ(5, seen);
+    });
+
+    suite.runAll();
+    return TestCase::getFailed();
+}